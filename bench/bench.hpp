@@ -0,0 +1,116 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.hpp"
+
+// Minimal benchmark harness shared by the vge_bench_* executables.
+//
+// Throughput is measured over an untimed run of the whole workload, latency
+// percentiles over a second run where every operation is timed on its own.
+namespace Bench {
+
+using Clock = std::chrono::steady_clock;
+
+struct Result {
+    std::string name;
+    std::string workload;
+    U32 threads = 1;
+    double opsPerSec = 0.0;
+    double p50Ns = 0.0;
+    double p99Ns = 0.0;
+};
+
+class LatencyRecorder {
+public:
+    explicit LatencyRecorder(size_t expected = 0) { m_Samples.reserve(expected); }
+
+    void record(Clock::duration d) {
+        m_Samples.push_back(std::chrono::duration<double, std::nano>(d).count());
+    }
+
+    void merge(const LatencyRecorder& other) {
+        m_Samples.insert(m_Samples.end(), other.m_Samples.begin(), other.m_Samples.end());
+    }
+
+    // p in [0, 1]
+    double percentile(double p) {
+        if (m_Samples.empty()) {
+            return 0.0;
+        }
+        const size_t idx = std::min(m_Samples.size() - 1,
+            static_cast<size_t>(p * static_cast<double>(m_Samples.size())));
+        std::nth_element(m_Samples.begin(), m_Samples.begin() + idx, m_Samples.end());
+        return std::max(0.0, m_Samples[idx] - s_ClockOverheadNs);
+    }
+
+    // Cost of a back to back Clock::now() pair, subtracted from every sample.
+    static void calibrate() {
+        constexpr int N = 100000;
+        std::vector<double> samples(N);
+        for (auto& s : samples) {
+            const auto t0 = Clock::now();
+            const auto t1 = Clock::now();
+            s = std::chrono::duration<double, std::nano>(t1 - t0).count();
+        }
+        std::nth_element(samples.begin(), samples.begin() + N / 2, samples.end());
+        s_ClockOverheadNs = samples[N / 2];
+    }
+
+    static double clock_overhead() { return s_ClockOverheadNs; }
+
+private:
+    std::vector<double> m_Samples;
+    static inline double s_ClockOverheadNs = 0.0;
+};
+
+inline double ops_per_sec(size_t ops, Clock::duration elapsed) {
+    const double secs = std::chrono::duration<double>(elapsed).count();
+    return secs > 0.0 ? static_cast<double>(ops) / secs : 0.0;
+}
+
+// Keeps the optimizer from discarding a value.
+template <typename T>
+inline void do_not_optimize(T const& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile const T* sink;
+    sink = &value;
+#endif
+}
+
+inline void print_header(std::string_view title) {
+    std::printf("\n== %.*s ==\n", static_cast<int>(title.size()), title.data());
+    std::printf("%-34s %-12s %7s %12s %10s %10s\n", "subject", "workload", "threads", "Mops/s",
+        "p50 ns", "p99 ns");
+}
+
+inline void print_result(const Result& r) {
+    std::printf("%-34s %-12s %7u %12.2f %10.1f %10.1f\n", r.name.c_str(), r.workload.c_str(),
+        r.threads, r.opsPerSec / 1e6, r.p50Ns, r.p99Ns);
+    std::fflush(stdout);
+}
+
+inline void print_csv(const std::vector<Result>& results) {
+    std::printf("subject,workload,threads,ops_per_sec,p50_ns,p99_ns\n");
+    for (const auto& r : results) {
+        std::printf("%s,%s,%u,%.0f,%.1f,%.1f\n", r.name.c_str(), r.workload.c_str(), r.threads,
+            r.opsPerSec, r.p50Ns, r.p99Ns);
+    }
+}
+
+inline void warn_if_debug() {
+#ifdef BUILD_DEBUG
+    std::printf(
+        "WARNING: benchmarks built in Debug (-O0, logging enabled); "
+        "configure with -DCMAKE_BUILD_TYPE=Release for meaningful numbers.\n");
+#endif
+}
+
+} // namespace Bench
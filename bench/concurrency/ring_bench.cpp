@@ -0,0 +1,275 @@
+// Throughput and latency of the lock-free ring queues against a mutex guarded
+// ring, the handoff they replace.
+//
+// Each case runs P producers against C consumers. The "slow" cases give one
+// side some busy work per element, so the queue runs permanently full (slow
+// consumer) or permanently empty (slow producer). Latency is measured from the
+// moment a producer has an element ready until a consumer holds it, so it
+// includes the time spent waiting for room in a full queue.
+//
+// usage: vge_bench_ring [--ops N] [--threads N] [--csv]
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <barrier>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bench.hpp"
+
+#include "core/concurrency/cpu.hpp"
+#include "core/concurrency/ring_queue.hpp"
+#include "core/logger.hpp"
+
+namespace {
+
+constexpr size_t Capacity = 1024;
+constexpr size_t MaxBatch = 32;
+constexpr U32 SlowWork = 64;
+
+struct Case {
+    std::string name;
+    U32 producers;
+    U32 consumers;
+    U32 producerWork;
+    U32 consumerWork;
+};
+
+// roughly 1 ns per iteration, enough to tip the balance of a case
+void busy_work(U32 iterations) {
+    for (U32 i = 0; i < iterations; ++i) {
+        Bench::do_not_optimize(i);
+    }
+}
+
+U64 now_ticks() { return static_cast<U64>(Bench::Clock::now().time_since_epoch().count()); }
+
+// ---- subjects ----------------------------------------------------------------
+
+// What cross thread handoff looks like without the rings: a bounded ring
+// behind a mutex.
+class MutexQueue {
+public:
+    explicit MutexQueue(size_t capacity)
+        : m_Items(capacity) { }
+
+    bool try_push(U64 value) { return push_batch(&value, &value + 1) == 1; }
+    bool try_pop(U64& out) { return pop_batch(&out, 1) == 1; }
+
+    size_t push_batch(const U64* first, const U64* last) {
+        std::scoped_lock lock { m_Mutex };
+        const size_t count
+            = std::min(static_cast<size_t>(last - first), m_Items.size() - (m_Tail - m_Head));
+        for (size_t i = 0; i < count; ++i) {
+            m_Items[(m_Tail + i) % m_Items.size()] = first[i];
+        }
+        m_Tail += count;
+        return count;
+    }
+
+    size_t pop_batch(U64* out, size_t max) {
+        std::scoped_lock lock { m_Mutex };
+        const size_t count = std::min(max, m_Tail - m_Head);
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = m_Items[(m_Head + i) % m_Items.size()];
+        }
+        m_Head += count;
+        return count;
+    }
+
+private:
+    std::mutex m_Mutex;
+    std::vector<U64> m_Items;
+    size_t m_Head = 0;
+    size_t m_Tail = 0;
+};
+
+// ---- workload ----------------------------------------------------------------
+
+template <typename Queue>
+void produce(Queue& queue, const Case& c, size_t count, size_t batch, bool timed) {
+    std::array<U64, MaxBatch> items {};
+    for (size_t sent = 0; sent < count;) {
+        const size_t n = std::min(batch, count - sent);
+        for (size_t i = 0; i < n; ++i) {
+            busy_work(c.producerWork);
+            items[i] = timed ? now_ticks() : sent + i;
+        }
+
+        Core::Backoff backoff;
+        for (size_t pushed = 0; pushed < n;) {
+            const size_t k = batch == 1 ? (queue.try_push(items[0]) ? 1 : 0)
+                                        : queue.push_batch(items.data() + pushed, items.data() + n);
+            if (k == 0) {
+                backoff.pause();
+            }
+            pushed += k;
+        }
+        sent += n;
+    }
+}
+
+template <typename Queue>
+void consume(Queue& queue, const Case& c, size_t total, size_t batch, std::atomic<size_t>& popped,
+    Bench::LatencyRecorder* latency) {
+    std::array<U64, MaxBatch> items {};
+    Core::Backoff backoff;
+    while (popped.load(std::memory_order_relaxed) < total) {
+        const size_t k
+            = batch == 1 ? (queue.try_pop(items[0]) ? 1 : 0) : queue.pop_batch(items.data(), batch);
+        if (k == 0) {
+            backoff.pause();
+            continue;
+        }
+        backoff = {};
+        popped.fetch_add(k, std::memory_order_relaxed);
+
+        const U64 now = latency ? now_ticks() : 0;
+        for (size_t i = 0; i < k; ++i) {
+            if (latency) {
+                latency->record(Bench::Clock::duration(static_cast<I64>(now - items[i])));
+            } else {
+                Bench::do_not_optimize(items[i]);
+            }
+            busy_work(c.consumerWork);
+        }
+    }
+}
+
+template <typename Queue>
+Bench::Result run_case(const std::string& name, const Case& c, size_t ops, size_t batch,
+    const std::function<std::unique_ptr<Queue>()>& make) {
+    const size_t perProducer = ops / c.producers;
+    const size_t total = perProducer * c.producers;
+    const U32 threads = c.producers + c.consumers;
+
+    Bench::Result result { name, c.name, threads };
+
+    for (const bool timed : { false, true }) {
+        auto queue = make();
+        std::atomic<size_t> popped { 0 };
+        std::vector<Bench::LatencyRecorder> latencies(c.consumers);
+        std::vector<std::pair<Bench::Clock::time_point, Bench::Clock::time_point>> spans(threads);
+        std::barrier sync(threads);
+        std::vector<std::thread> workers;
+
+        for (U32 t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                const bool producer = t < c.producers;
+                if (timed && !producer) {
+                    latencies[t - c.producers] = Bench::LatencyRecorder(total / c.consumers);
+                }
+                sync.arrive_and_wait();
+                spans[t].first = Bench::Clock::now();
+                if (producer) {
+                    produce(*queue, c, perProducer, batch, timed);
+                } else {
+                    consume(*queue, c, total, batch, popped,
+                        timed ? &latencies[t - c.producers] : nullptr);
+                }
+                spans[t].second = Bench::Clock::now();
+            });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        if (timed) {
+            Bench::LatencyRecorder merged(total);
+            for (auto& l : latencies) {
+                merged.merge(l);
+            }
+            result.p50Ns = merged.percentile(0.50);
+            result.p99Ns = merged.percentile(0.99);
+        } else {
+            auto first = spans[0].first;
+            auto last = spans[0].second;
+            for (const auto& [begin, end] : spans) {
+                first = std::min(first, begin);
+                last = std::max(last, end);
+            }
+            result.opsPerSec = Bench::ops_per_sec(total, last - first);
+        }
+    }
+    return result;
+}
+
+void bench_case(const Case& c, size_t ops, std::vector<Bench::Result>& results) {
+    std::vector<Bench::Result> out;
+    for (const size_t batch : { size_t { 1 }, MaxBatch }) {
+        const std::string suffix = batch == 1 ? "" : " x" + std::to_string(batch);
+
+        if (c.producers == 1 && c.consumers == 1) {
+            out.push_back(run_case<Core::SpscRing<U64>>("SpscRing" + suffix, c, ops, batch,
+                [] { return std::make_unique<Core::SpscRing<U64>>(Capacity); }));
+        }
+        out.push_back(run_case<Core::MpmcRing<U64>>("MpmcRing" + suffix, c, ops, batch,
+            [] { return std::make_unique<Core::MpmcRing<U64>>(Capacity); }));
+        out.push_back(run_case<MutexQueue>("mutex + ring" + suffix, c, ops, batch,
+            [] { return std::make_unique<MutexQueue>(Capacity); }));
+    }
+
+    for (const auto& r : out) {
+        Bench::print_result(r);
+    }
+    results.insert(results.end(), out.begin(), out.end());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t ops = 1'000'000;
+    U32 threads = std::clamp(std::thread::hardware_concurrency() / 2, 2u, 4u);
+    bool csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            ops = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1u, static_cast<U32>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        }
+    }
+    ops = std::max(ops, static_cast<size_t>(threads * MaxBatch));
+
+    Core::Logger::initialize();
+    Bench::warn_if_debug();
+    Bench::LatencyRecorder::calibrate();
+
+    std::printf("ops per case: %zu, capacity: %zu, clock overhead: %.1f ns (subtracted)\n", ops,
+        Capacity, Bench::LatencyRecorder::clock_overhead());
+
+    // --threads is the size of the "many" side of the imbalanced cases
+    const std::string n = std::to_string(threads);
+    const std::vector<Case> cases = {
+        { "1:1", 1, 1, 0, 0 },
+        { "1:1 slow-c", 1, 1, 0, SlowWork },
+        { "1:1 slow-p", 1, 1, SlowWork, 0 },
+        { n + ":1", threads, 1, 0, 0 },
+        { "1:" + n, 1, threads, 0, 0 },
+        { n + ":" + n, threads, threads, 0, 0 },
+    };
+
+    std::vector<Bench::Result> results;
+    for (const auto& c : cases) {
+        Bench::print_header("producers:consumers " + c.name);
+        bench_case(c, ops, results);
+    }
+
+    if (csv) {
+        std::printf("\n");
+        Bench::print_csv(results);
+    }
+
+    Core::Logger::shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,422 @@
+// Throughput and latency of the engine allocators against the C library
+// allocator and std::pmr::new_delete_resource().
+//
+// Every workload keeps a window of live blocks: each operation frees the
+// oldest block of the window and allocates a new one. Frame style allocators
+// (stack, destack) cannot free individual blocks, they are reset every time the
+// window wraps around instead, which is how they are used in a frame.
+//
+// usage: vge_bench_memory [--ops N] [--threads N] [--csv]
+
+#include <array>
+#include <barrier>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <memory_resource>
+#include <mutex>
+#include <random>
+#include <thread>
+
+#include "bench.hpp"
+
+#include "core/logger.hpp"
+#include "core/memory/destack_allocator.hpp"
+#include "core/memory/pool_allocator.hpp"
+#include "core/memory/stack_allocator.hpp"
+#include "core/stl/FixedPoolResource.hpp"
+#include "core/stl/MultipoolMemoryResource.hpp"
+#include "core/stl/StackMemoryResource.hpp"
+
+using namespace Core::Allocator;
+using namespace Core::MemoryResource;
+
+namespace {
+
+constexpr size_t Window = 64;
+constexpr size_t Align = 16;
+constexpr U32 FrameBytes = 1u << 20;
+
+struct Distribution {
+    const char* name;
+    size_t maxSize;
+    std::function<size_t(std::mt19937&)> sample;
+};
+
+const std::array<Distribution, 3> Distributions = { {
+    { "fixed-32", 32, [](std::mt19937&) -> size_t { return 32; } },
+    { "uniform-256", 256,
+        [](std::mt19937& rng) -> size_t {
+            return std::uniform_int_distribution<size_t>(16, 256)(rng);
+        } },
+    // 80% small, 15% medium, 5% large: roughly what asset import code does
+    { "mixed-8k", 8192,
+        [](std::mt19937& rng) -> size_t {
+            const U32 bucket = std::uniform_int_distribution<U32>(0, 99)(rng);
+            if (bucket < 80) {
+                return std::uniform_int_distribution<size_t>(16, 128)(rng);
+            }
+            if (bucket < 95) {
+                return std::uniform_int_distribution<size_t>(129, 1024)(rng);
+            }
+            return std::uniform_int_distribution<size_t>(1025, 8192)(rng);
+        } },
+} };
+
+std::vector<U32> make_sizes(const Distribution& dist, size_t count, U32 seed) {
+    std::mt19937 rng(seed);
+    std::vector<U32> sizes(count);
+    for (auto& s : sizes) {
+        s = static_cast<U32>(dist.sample(rng));
+    }
+    return sizes;
+}
+
+// ---- subjects ----------------------------------------------------------------
+
+struct MallocSubject {
+    void* allocate(size_t n) { return std::malloc(n); }
+    void deallocate(void* p, size_t) { std::free(p); }
+    void reset() { }
+};
+
+struct ResourceSubject {
+    explicit ResourceSubject(std::pmr::memory_resource* r, std::function<void()> reset = {})
+        : resource(r)
+        , onReset(std::move(reset)) { }
+
+    std::pmr::memory_resource* resource;
+    std::function<void()> onReset;
+
+    void* allocate(size_t n) { return resource->allocate(n, Align); }
+    void deallocate(void* p, size_t n) { resource->deallocate(p, n, Align); }
+    void reset() {
+        if (onReset) {
+            onReset();
+        }
+    }
+};
+
+struct StackSubject {
+    StackAllocator stack { FrameBytes };
+
+    void* allocate(size_t n) { return stack.allocate(static_cast<U32>(n), Align); }
+    void deallocate(void*, size_t) { }
+    void reset() { stack.clear(); }
+};
+
+struct DestackSubject {
+    DestackAllocator destack { FrameBytes };
+    bool top = false;
+
+    void* allocate(size_t n) {
+        top = !top;
+        return destack.alloc(static_cast<U32>(n),
+            top ? DestackAllocator::HeapDirection::FRAME_TOP
+                : DestackAllocator::HeapDirection::FRAME_BOTTOM,
+            Align);
+    }
+    void deallocate(void*, size_t) { }
+    void reset() { destack.clear(); }
+};
+
+template <size_t BlockSize>
+struct PoolSubject {
+    struct alignas(Align) Block {
+        std::byte bytes[BlockSize];
+    };
+
+    explicit PoolSubject(size_t blocks)
+        : pool(blocks) { }
+
+    void* allocate(size_t) { return pool.allocate(); }
+    void deallocate(void* p, size_t) { pool.deallocate(static_cast<Block*>(p)); }
+    void reset() { }
+
+    PoolAllocator<Block> pool;
+};
+
+struct FixedPoolSubject {
+    FixedPoolSubject(size_t blockSize, size_t blocks)
+        : pool(blockSize, Align, blocks) { }
+
+    void* allocate(size_t) { return pool.allocate_block(); }
+    void deallocate(void* p, size_t) { pool.deallocate_block(p); }
+    void reset() { }
+
+    FixedPoolAllocator pool;
+};
+
+// Engine allocators are not thread safe: sharing one between threads means
+// putting a lock around it.
+template <typename Subject>
+struct LockedSubject {
+    Subject& inner;
+    std::mutex& mutex;
+
+    void* allocate(size_t n) {
+        std::scoped_lock lock { mutex };
+        return inner.allocate(n);
+    }
+    void deallocate(void* p, size_t n) {
+        std::scoped_lock lock { mutex };
+        inner.deallocate(p, n);
+    }
+    void reset() { }
+};
+
+// ---- workload ----------------------------------------------------------------
+
+template <typename Subject, bool Timed>
+void run_ops(Subject& subject, const std::vector<U32>& sizes, Bench::LatencyRecorder* latency) {
+    std::array<std::pair<void*, U32>, Window> live {};
+
+    for (size_t i = 0; i < sizes.size(); ++i) {
+        const size_t slot = i % Window;
+
+        [[maybe_unused]] Bench::Clock::time_point start;
+        if constexpr (Timed) {
+            start = Bench::Clock::now();
+        }
+
+        if (slot == 0) {
+            subject.reset();
+        }
+        if (live[slot].first) {
+            subject.deallocate(live[slot].first, live[slot].second);
+        }
+
+        void* p = subject.allocate(sizes[i]);
+        static_cast<U8*>(p)[0] = static_cast<U8>(i);
+        live[slot] = { p, sizes[i] };
+
+        if constexpr (Timed) {
+            latency->record(Bench::Clock::now() - start);
+        }
+    }
+
+    for (auto& [p, size] : live) {
+        if (p) {
+            subject.deallocate(p, size);
+        }
+    }
+    subject.reset();
+}
+
+template <typename Subject>
+Bench::Result run_single(const char* name, const Distribution& dist, size_t ops,
+    const std::function<std::unique_ptr<Subject>()>& make) {
+    const auto sizes = make_sizes(dist, ops, 1234);
+
+    Bench::Result result { name, dist.name, 1 };
+    {
+        auto subject = make();
+        run_ops<Subject, false>(*subject, sizes, nullptr); // warm up
+        const auto start = Bench::Clock::now();
+        run_ops<Subject, false>(*subject, sizes, nullptr);
+        result.opsPerSec = Bench::ops_per_sec(ops, Bench::Clock::now() - start);
+    }
+    {
+        auto subject = make();
+        Bench::LatencyRecorder latency(ops);
+        run_ops<Subject, true>(*subject, sizes, &latency);
+        result.p50Ns = latency.percentile(0.50);
+        result.p99Ns = latency.percentile(0.99);
+    }
+    return result;
+}
+
+// @makeForThread returns the subject a worker thread runs against: a shared
+// (locked) allocator for the contended cases, a private one otherwise.
+template <typename Subject>
+Bench::Result run_threaded(const char* name, const Distribution& dist, size_t ops, U32 threads,
+    const std::function<std::unique_ptr<Subject>(U32)>& makeForThread) {
+    const size_t perThread = ops / threads;
+    std::vector<std::vector<U32>> sizes;
+    for (U32 t = 0; t < threads; ++t) {
+        sizes.push_back(make_sizes(dist, perThread, 1234 + t));
+    }
+
+    Bench::Result result { name, dist.name, threads };
+
+    for (const bool timed : { false, true }) {
+        std::vector<Bench::LatencyRecorder> latencies(threads);
+        std::vector<std::pair<Bench::Clock::time_point, Bench::Clock::time_point>> spans(threads);
+        std::barrier sync(threads);
+        std::vector<std::thread> workers;
+
+        // each worker stamps its own span, the wall time is first start to last
+        // finish so that a late scheduled main thread does not skew it
+        for (U32 t = 0; t < threads; ++t) {
+            workers.emplace_back([&, t]() {
+                auto subject = makeForThread(t);
+                if (timed) {
+                    latencies[t] = Bench::LatencyRecorder(perThread);
+                }
+                sync.arrive_and_wait();
+                spans[t].first = Bench::Clock::now();
+                if (timed) {
+                    run_ops<Subject, true>(*subject, sizes[t], &latencies[t]);
+                } else {
+                    run_ops<Subject, false>(*subject, sizes[t], nullptr);
+                }
+                spans[t].second = Bench::Clock::now();
+            });
+        }
+
+        for (auto& w : workers) {
+            w.join();
+        }
+
+        if (timed) {
+            Bench::LatencyRecorder merged(ops);
+            for (auto& l : latencies) {
+                merged.merge(l);
+            }
+            result.p50Ns = merged.percentile(0.50);
+            result.p99Ns = merged.percentile(0.99);
+        } else {
+            auto first = spans[0].first;
+            auto last = spans[0].second;
+            for (const auto& [begin, end] : spans) {
+                first = std::min(first, begin);
+                last = std::max(last, end);
+            }
+            result.opsPerSec = Bench::ops_per_sec(perThread * threads, last - first);
+        }
+    }
+    return result;
+}
+
+template <size_t BlockSize>
+void bench_pool(const Distribution& dist, size_t ops, U32 threads, std::vector<Bench::Result>& out) {
+    using Pool = PoolSubject<BlockSize>;
+    out.push_back(run_single<Pool>(
+        "PoolAllocator<T>", dist, ops, [] { return std::make_unique<Pool>(Window); }));
+
+    Pool shared(Window * threads);
+    std::mutex mutex;
+    out.push_back(run_threaded<LockedSubject<Pool>>("PoolAllocator<T> (locked)", dist, ops, threads,
+        [&](U32) { return std::make_unique<LockedSubject<Pool>>(shared, mutex); }));
+}
+
+void bench_distribution(const Distribution& dist, size_t ops, U32 threads,
+    std::vector<Bench::Result>& results) {
+    std::vector<Bench::Result> out;
+    const size_t maxSize = dist.maxSize;
+
+    // ---- single threaded ----
+    out.push_back(run_single<MallocSubject>(
+        "malloc/free (libc)", dist, ops, [] { return std::make_unique<MallocSubject>(); }));
+    out.push_back(run_single<ResourceSubject>("pmr::new_delete_resource", dist, ops, [] {
+        return std::make_unique<ResourceSubject>(std::pmr::new_delete_resource());
+    }));
+
+    out.push_back(run_single<StackSubject>(
+        "StackAllocator", dist, ops, [] { return std::make_unique<StackSubject>(); }));
+    out.push_back(run_single<DestackSubject>(
+        "DestackAllocator", dist, ops, [] { return std::make_unique<DestackSubject>(); }));
+
+    switch (maxSize) {
+    case 32:
+        bench_pool<32>(dist, ops, threads, out);
+        break;
+    case 256:
+        bench_pool<256>(dist, ops, threads, out);
+        break;
+    default:
+        bench_pool<8192>(dist, ops, threads, out);
+        break;
+    }
+
+    out.push_back(run_single<FixedPoolSubject>("FixedPoolAllocator", dist, ops,
+        [&] { return std::make_unique<FixedPoolSubject>(maxSize, Window); }));
+
+    StackAllocator stack { FrameBytes };
+    StackMemoryResource stackResource { stack };
+    out.push_back(run_single<ResourceSubject>("StackMemoryResource", dist, ops, [&] {
+        return std::make_unique<ResourceSubject>(&stackResource, [&] { stack.clear(); });
+    }));
+
+    FixedPoolAllocator fixedPool { maxSize, Align, Window };
+    FixedPoolResource fixedPoolResource { fixedPool, std::pmr::new_delete_resource() };
+    out.push_back(run_single<ResourceSubject>("FixedPoolResource", dist, ops,
+        [&] { return std::make_unique<ResourceSubject>(&fixedPoolResource); }));
+
+    MultipoolMemoryResource multipool { 16, 8192, Window };
+    out.push_back(run_single<ResourceSubject>("MultipoolMemoryResource", dist, ops,
+        [&] { return std::make_unique<ResourceSubject>(&multipool); }));
+
+    // ---- multi threaded ----
+    out.push_back(run_threaded<MallocSubject>("malloc/free (libc)", dist, ops, threads,
+        [](U32) { return std::make_unique<MallocSubject>(); }));
+    out.push_back(run_threaded<ResourceSubject>("pmr::new_delete_resource", dist, ops, threads,
+        [](U32) { return std::make_unique<ResourceSubject>(std::pmr::new_delete_resource()); }));
+
+    // frame allocators are per thread by design
+    out.push_back(run_threaded<StackSubject>("StackAllocator (per thread)", dist, ops, threads,
+        [](U32) { return std::make_unique<StackSubject>(); }));
+
+    FixedPoolSubject sharedFixed { maxSize, Window * threads };
+    std::mutex fixedMutex;
+    out.push_back(run_threaded<LockedSubject<FixedPoolSubject>>("FixedPoolAllocator (locked)", dist,
+        ops, threads, [&](U32) {
+            return std::make_unique<LockedSubject<FixedPoolSubject>>(sharedFixed, fixedMutex);
+        }));
+
+    MultipoolMemoryResource sharedMultipool { 16, 8192, Window * threads };
+    std::mutex multipoolMutex;
+    ResourceSubject sharedMultipoolSubject { &sharedMultipool };
+    out.push_back(run_threaded<LockedSubject<ResourceSubject>>("MultipoolMemoryResource (locked)",
+        dist, ops, threads, [&](U32) {
+            return std::make_unique<LockedSubject<ResourceSubject>>(
+                sharedMultipoolSubject, multipoolMutex);
+        }));
+
+    for (const auto& r : out) {
+        Bench::print_result(r);
+    }
+    results.insert(results.end(), out.begin(), out.end());
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    size_t ops = 1'000'000;
+    U32 threads = std::clamp(std::thread::hardware_concurrency(), 2u, 8u);
+    bool csv = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ops") == 0 && i + 1 < argc) {
+            ops = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::max(1u, static_cast<U32>(std::strtoul(argv[++i], nullptr, 10)));
+        } else if (std::strcmp(argv[i], "--csv") == 0) {
+            csv = true;
+        }
+    }
+    ops = std::max(ops, static_cast<size_t>(Window * threads));
+
+    // the pmr resources log through the core logger in debug builds
+    Core::Logger::initialize();
+    Bench::warn_if_debug();
+    Bench::LatencyRecorder::calibrate();
+
+    std::printf("ops per case: %zu, threads: %u, clock overhead: %.1f ns (subtracted)\n", ops,
+        threads, Bench::LatencyRecorder::clock_overhead());
+
+    std::vector<Bench::Result> results;
+    for (const auto& dist : Distributions) {
+        Bench::print_header(dist.name);
+        bench_distribution(dist, ops, threads, results);
+    }
+
+    if (csv) {
+        std::printf("\n");
+        Bench::print_csv(results);
+    }
+
+    Core::Logger::shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,194 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <iterator>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include <core/concurrency/ring_queue.hpp>
+#include <defines.hpp>
+
+using Core::MpmcRing;
+using Core::SpscRing;
+
+TEST(SpscRingTest, FifoAndBounds) {
+    SpscRing<U32> ring(3);
+    EXPECT_EQ(ring.capacity(), 4u);
+    EXPECT_TRUE(ring.empty_approx());
+
+    for (U32 i = 0; i < 4; ++i) {
+        EXPECT_TRUE(ring.try_push(i));
+    }
+    EXPECT_FALSE(ring.try_push(99));
+    EXPECT_EQ(ring.size_approx(), 4u);
+
+    U32 value = 0;
+    for (U32 i = 0; i < 4; ++i) {
+        ASSERT_TRUE(ring.try_pop(value));
+        EXPECT_EQ(value, i);
+    }
+    EXPECT_FALSE(ring.try_pop(value));
+}
+
+TEST(SpscRingTest, BatchWrapsAround) {
+    SpscRing<U32> ring(8);
+    std::vector<U32> in(6);
+    std::iota(in.begin(), in.end(), 0u);
+
+    EXPECT_EQ(ring.push_batch(in.begin(), in.end()), 6u);
+    std::vector<U32> out;
+    EXPECT_EQ(ring.pop_batch(std::back_inserter(out), 4), 4u);
+
+    // 2 left, so only 6 of the next 8 fit, and they wrap past the end
+    std::vector<U32> more(8, 7u);
+    EXPECT_EQ(ring.push_batch(more.begin(), more.end()), 6u);
+    EXPECT_EQ(ring.pop_batch(std::back_inserter(out), 100), 8u);
+    EXPECT_EQ(out.size(), 12u);
+    EXPECT_EQ(out[5], 5u);
+    EXPECT_EQ(out[6], 7u);
+}
+
+TEST(SpscRingTest, DestroysRemainingElements) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        SpscRing<std::shared_ptr<int>> ring(4);
+        ring.try_push(tracked);
+        ring.try_push(tracked);
+        EXPECT_EQ(tracked.use_count(), 3);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(SpscRingTest, PreservesOrderAcrossThreads) {
+    constexpr U32 Count = 100000;
+    SpscRing<U32> ring(64);
+
+    std::thread producer([&]() {
+        U32 next = 0;
+        U32 batch[16];
+        while (next < Count) {
+            if (next % 3 == 0) {
+                const U32 n = std::min<U32>(16, Count - next);
+                std::iota(batch, batch + n, next);
+                next += static_cast<U32>(ring.push_batch(batch, batch + n));
+            } else if (ring.try_push(next)) {
+                next++;
+            } else {
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    U32 expected = 0;
+    std::vector<U32> out;
+    while (expected < Count) {
+        out.clear();
+        if (ring.pop_batch(std::back_inserter(out), 32) == 0) {
+            std::this_thread::yield();
+        }
+        for (U32 v : out) {
+            ASSERT_EQ(v, expected);
+            expected++;
+        }
+    }
+    producer.join();
+    EXPECT_TRUE(ring.empty_approx());
+}
+
+TEST(MpmcRingTest, FifoAndBounds) {
+    MpmcRing<U32> ring(1);
+    EXPECT_EQ(ring.capacity(), 2u);
+
+    EXPECT_TRUE(ring.try_push(1));
+    EXPECT_TRUE(ring.try_push(2));
+    EXPECT_FALSE(ring.try_push(3));
+
+    U32 value = 0;
+    ASSERT_TRUE(ring.try_pop(value));
+    EXPECT_EQ(value, 1u);
+    EXPECT_TRUE(ring.try_push(3));
+
+    std::vector<U32> out;
+    EXPECT_EQ(ring.pop_batch(std::back_inserter(out), 8), 2u);
+    EXPECT_EQ(out, (std::vector<U32>{2, 3}));
+    EXPECT_FALSE(ring.try_pop(value));
+}
+
+TEST(MpmcRingTest, DestroysRemainingElements) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        MpmcRing<std::shared_ptr<int>> ring(8);
+        std::vector<std::shared_ptr<int>> items(5, tracked);
+        EXPECT_EQ(ring.push_batch(items.begin(), items.end()), 5u);
+        items.clear();
+
+        std::shared_ptr<int> popped;
+        ring.try_pop(popped);
+        EXPECT_EQ(tracked.use_count(), 6);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+// Every value pushed by every producer is popped exactly once, with single
+// and batch operations mixed on both sides.
+TEST(MpmcRingTest, ManyProducersManyConsumers) {
+    constexpr U32 Producers = 4;
+    constexpr U32 Consumers = 4;
+    constexpr U32 PerProducer = 50000;
+    MpmcRing<U32> ring(256);
+
+    std::vector<std::atomic<U32>> seen(Producers * PerProducer);
+    std::atomic<U32> popped{0};
+    std::vector<std::thread> threads;
+
+    for (U32 p = 0; p < Producers; ++p) {
+        threads.emplace_back([&, p]() {
+            const U32 base = p * PerProducer;
+            U32 next = 0;
+            U32 batch[8];
+            while (next < PerProducer) {
+                if (p % 2 == 0) {
+                    const U32 n = std::min<U32>(8, PerProducer - next);
+                    std::iota(batch, batch + n, base + next);
+                    next += static_cast<U32>(ring.push_batch(batch, batch + n));
+                } else if (ring.try_push(base + next)) {
+                    next++;
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (U32 c = 0; c < Consumers; ++c) {
+        threads.emplace_back([&, c]() {
+            U32 batch[8];
+            while (popped.load(std::memory_order_relaxed) < Producers * PerProducer) {
+                std::size_t n = 0;
+                if (c % 2 == 0) {
+                    n = ring.pop_batch(batch, 8);
+                } else {
+                    n = ring.try_pop(batch[0]) ? 1 : 0;
+                }
+                if (n == 0) {
+                    std::this_thread::yield();
+                }
+                for (std::size_t i = 0; i < n; ++i) {
+                    seen[batch[i]].fetch_add(1, std::memory_order_relaxed);
+                }
+                popped.fetch_add(static_cast<U32>(n), std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(popped.load(), Producers * PerProducer);
+    for (const auto& count : seen) {
+        ASSERT_EQ(count.load(), 1u);
+    }
+    EXPECT_TRUE(ring.empty_approx());
+}
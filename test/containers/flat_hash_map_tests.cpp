@@ -0,0 +1,220 @@
+#include <gtest/gtest.h>
+#include <memory_resource>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+#include <core/containers/flat_hash_map.hpp>
+#include <core/hash.hpp>
+
+using Core::FlatHashMap;
+
+namespace {
+
+class CountingResource final : public std::pmr::memory_resource {
+   public:
+    std::size_t allocations = 0;
+    std::size_t live = 0;
+
+   private:
+    void* do_allocate(std::size_t bytes, std::size_t align) override {
+        allocations++;
+        live++;
+        return std::pmr::new_delete_resource()->allocate(bytes, align);
+    }
+    void do_deallocate(void* p, std::size_t bytes, std::size_t align) override {
+        live--;
+        std::pmr::new_delete_resource()->deallocate(p, bytes, align);
+    }
+    bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override {
+        return this == &other;
+    }
+};
+
+// Throws from its constructor when asked to.
+struct Fragile {
+    std::string text;
+
+    explicit Fragile(bool fail) : text("constructed") {
+        if (fail) {
+            throw std::runtime_error("Fragile");
+        }
+    }
+};
+
+}  // namespace
+
+TEST(HashTest, BytesDependOnLengthAndSeed) {
+    const char data[64] = {};
+    EXPECT_NE(Core::hash_bytes(data, 3), Core::hash_bytes(data, 4));
+    EXPECT_NE(Core::hash_bytes(data, 17), Core::hash_bytes(data, 49));
+    EXPECT_NE(Core::hash_bytes(data, 8, 1), Core::hash_bytes(data, 8, 2));
+    EXPECT_EQ(Core::hash_bytes("vulkan", 6), Core::hash_bytes(std::string("vulkan").data(), 6));
+}
+
+TEST(HashTest, IntegersAreMixed) {
+    Core::Hash<U32> hash;
+    // consecutive keys must not land in consecutive buckets
+    std::size_t sameLowBits = 0;
+    for (U32 i = 0; i < 1024; ++i) {
+        sameLowBits += (hash(i) & 0x7F) == (i & 0x7F);
+    }
+    EXPECT_LT(sameLowBits, 64u);
+}
+
+TEST(FlatHashMapTest, InsertFindErase) {
+    FlatHashMap<U32, U32> map;
+    EXPECT_TRUE(map.empty());
+    EXPECT_EQ(map.find(1), map.end());
+
+    EXPECT_TRUE(map.try_emplace(1, 10).second);
+    EXPECT_FALSE(map.try_emplace(1, 20).second);
+    map[2] = 20;
+
+    EXPECT_EQ(map.size(), 2u);
+    EXPECT_EQ(map.at(1), 10u);
+    EXPECT_EQ(map[2], 20u);
+    EXPECT_TRUE(map.contains(2));
+    EXPECT_THROW((void)map.at(3), std::out_of_range);
+
+    EXPECT_EQ(map.erase(1), 1u);
+    EXPECT_EQ(map.erase(1), 0u);
+    EXPECT_FALSE(map.contains(1));
+    EXPECT_EQ(map.size(), 1u);
+}
+
+TEST(FlatHashMapTest, GrowsAndIteratesAllElements) {
+    FlatHashMap<U32, U32> map;
+    for (U32 i = 0; i < 10000; ++i) {
+        map.try_emplace(i, i * 2);
+    }
+    EXPECT_EQ(map.size(), 10000u);
+    EXPECT_LE(map.load_factor(), 0.875f);
+
+    U64 sum = 0;
+    std::size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        EXPECT_EQ(value, key * 2);
+        sum += key;
+        visited++;
+    }
+    EXPECT_EQ(visited, 10000u);
+    EXPECT_EQ(sum, 10000ull * 9999ull / 2ull);
+}
+
+TEST(FlatHashMapTest, MatchesUnorderedMapUnderChurn) {
+    FlatHashMap<U32, U32> map;
+    std::unordered_map<U32, U32> reference;
+    std::mt19937 rng(42);
+
+    for (int i = 0; i < 100000; ++i) {
+        const U32 key = rng() % 2048;
+        switch (rng() % 3) {
+            case 0:
+                map.insert_or_assign(key, static_cast<U32>(i));
+                reference[key] = static_cast<U32>(i);
+                break;
+            case 1:
+                EXPECT_EQ(map.erase(key), reference.erase(key));
+                break;
+            default: {
+                auto it = map.find(key);
+                auto ref = reference.find(key);
+                ASSERT_EQ(it == map.end(), ref == reference.end());
+                if (ref != reference.end()) {
+                    EXPECT_EQ(it->second, ref->second);
+                }
+            }
+        }
+    }
+
+    EXPECT_EQ(map.size(), reference.size());
+    for (const auto& [key, value] : reference) {
+        EXPECT_EQ(map.at(key), value);
+    }
+    // tombstones are recycled instead of growing forever
+    EXPECT_LE(map.capacity(), 8192u);
+}
+
+TEST(FlatHashMapTest, EraseWhileIterating) {
+    FlatHashMap<U32, U32> map;
+    for (U32 i = 0; i < 100; ++i) {
+        map[i] = i;
+    }
+    for (auto it = map.begin(); it != map.end();) {
+        it = it->first % 2 ? map.erase(it) : std::next(it);
+    }
+    EXPECT_EQ(map.size(), 50u);
+    for (const auto& kv : map) {
+        EXPECT_EQ(kv.first % 2, 0u);
+    }
+}
+
+TEST(FlatHashMapTest, StringKeysWithTransparentLookup) {
+    FlatHashMap<std::string, std::string> map{{"format", "srgb"}, {"filter", "linear"}};
+
+    EXPECT_EQ(map.at(std::string_view("format")), "srgb");
+    EXPECT_TRUE(map.contains("filter"));
+    EXPECT_FALSE(map.contains("mips"));
+
+    map["mips"] = "on";
+    EXPECT_EQ(map.size(), 3u);
+}
+
+TEST(FlatHashMapTest, CopyAndMove) {
+    FlatHashMap<std::string, U32> a;
+    a["one"] = 1;
+    a["two"] = 2;
+
+    FlatHashMap<std::string, U32> b = a;
+    EXPECT_EQ(b.size(), 2u);
+    EXPECT_EQ(b.at("two"), 2u);
+
+    FlatHashMap<std::string, U32> c = std::move(a);
+    EXPECT_EQ(c.size(), 2u);
+    EXPECT_TRUE(a.empty());
+
+    a = c;
+    EXPECT_EQ(a.at("one"), 1u);
+}
+
+TEST(FlatHashMapTest, AllocatesFromResource) {
+    CountingResource resource;
+    {
+        FlatHashMap<U32, U32> map(&resource);
+        map.reserve(1000);
+        const std::size_t afterReserve = resource.allocations;
+        for (U32 i = 0; i < 1000; ++i) {
+            map[i] = i;
+        }
+        EXPECT_EQ(resource.allocations, afterReserve);
+        EXPECT_EQ(resource.live, 1u);
+
+        FlatHashMap<U32, U32> other(&resource);
+        other = std::move(map);
+        EXPECT_EQ(other.size(), 1000u);
+        EXPECT_EQ(resource.live, 1u);
+    }
+    EXPECT_EQ(resource.live, 0u);
+}
+
+TEST(FlatHashMapTest, ThrowingConstructorLeavesNoElement) {
+    FlatHashMap<U32, Fragile> map;
+    for (U32 i = 0; i < 100; ++i) {
+        if (i % 3 == 0) {
+            EXPECT_THROW(map.try_emplace(i, true), std::runtime_error);
+        } else {
+            map.try_emplace(i, false);
+        }
+    }
+    EXPECT_EQ(map.size(), 66u);
+    EXPECT_FALSE(map.contains(3));
+    std::size_t visited = 0;
+    for (const auto& [key, value] : map) {
+        EXPECT_NE(key % 3, 0u);
+        EXPECT_EQ(value.text, "constructed");
+        visited++;
+    }
+    EXPECT_EQ(visited, 66u);
+}
@@ -0,0 +1,99 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+#include <core/containers/small_vector.hpp>
+#include <defines.hpp>
+
+using Core::small_vector;
+
+TEST(SmallVectorTest, StaysInlineUpToN) {
+    std::pmr::monotonic_buffer_resource upstream;
+    small_vector<int, 4> v(&upstream);
+    for (int i = 0; i < 4; ++i) {
+        v.push_back(i);
+    }
+    EXPECT_TRUE(v.is_inline());
+    EXPECT_EQ(v.capacity(), 4u);
+
+    v.push_back(4);
+    EXPECT_FALSE(v.is_inline());
+    EXPECT_GE(v.capacity(), 5u);
+    for (int i = 0; i < 5; ++i) {
+        EXPECT_EQ(v[static_cast<std::size_t>(i)], i);
+    }
+}
+
+TEST(SmallVectorTest, SpillsToResource) {
+    std::byte buffer[1024];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                              std::pmr::null_memory_resource());
+    small_vector<U32, 2> v(&arena);
+    v.resize(16, 7u);
+    EXPECT_FALSE(v.is_inline());
+
+    const auto* begin = reinterpret_cast<const std::byte*>(v.data());
+    EXPECT_GE(begin, buffer);
+    EXPECT_LT(begin, buffer + sizeof(buffer));
+}
+
+TEST(SmallVectorTest, EmplaceBackOfOwnElementWhileGrowing) {
+    small_vector<std::string, 2> v{"first", "second"};
+    v.push_back(v[0]);
+    EXPECT_EQ(v.size(), 3u);
+    EXPECT_EQ(v[2], "first");
+}
+
+TEST(SmallVectorTest, InsertAndErase) {
+    small_vector<int, 2> v{1, 3};
+    v.insert(v.begin() + 1, 2);
+    EXPECT_EQ(v, (small_vector<int, 2>{1, 2, 3}));
+
+    v.erase(v.begin());
+    EXPECT_EQ(v, (small_vector<int, 2>{2, 3}));
+}
+
+TEST(SmallVectorTest, MoveInlineAndHeap) {
+    small_vector<std::string, 2> inlineVec{"a"};
+    small_vector<std::string, 2> moved = std::move(inlineVec);
+    EXPECT_EQ(moved.size(), 1u);
+    EXPECT_TRUE(inlineVec.empty());
+
+    small_vector<std::string, 2> heapVec{"a", "b", "c"};
+    const std::string* data = heapVec.data();
+    small_vector<std::string, 2> stolen = std::move(heapVec);
+    EXPECT_EQ(stolen.data(), data);
+    EXPECT_TRUE(heapVec.is_inline());
+    EXPECT_TRUE(heapVec.empty());
+
+    heapVec.push_back("d");
+    EXPECT_EQ(heapVec[0], "d");
+}
+
+TEST(SmallVectorTest, MoveAssignAcrossResourcesCopiesElements) {
+    std::pmr::monotonic_buffer_resource a;
+    std::pmr::monotonic_buffer_resource b;
+
+    small_vector<int, 1> src({1, 2, 3}, &a);
+    small_vector<int, 1> dst(&b);
+    dst = std::move(src);
+
+    EXPECT_EQ(dst.resource(), &b);
+    EXPECT_EQ(dst, (small_vector<int, 1>{1, 2, 3}));
+    EXPECT_TRUE(src.empty());
+}
+
+TEST(SmallVectorTest, DestroysElements) {
+    auto counter = std::make_shared<int>(0);
+    {
+        small_vector<std::shared_ptr<int>, 1> v;
+        v.push_back(counter);
+        v.push_back(counter);
+        v.push_back(counter);
+        EXPECT_EQ(counter.use_count(), 4);
+        v.erase(v.begin(), v.begin() + 2);
+        EXPECT_EQ(counter.use_count(), 2);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
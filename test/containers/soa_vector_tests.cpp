@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <string>
+
+#include <core/containers/soa_vector.hpp>
+#include <defines.hpp>
+
+using Core::SoaVector;
+
+namespace {
+
+struct Vec3 {
+    F32 x, y, z;
+};
+
+bool is_aligned(const void* p, std::size_t alignment) {
+    return reinterpret_cast<std::uintptr_t>(p) % alignment == 0;
+}
+
+}  // namespace
+
+TEST(SoaVectorTest, ColumnsStayInLockstep) {
+    SoaVector<Vec3, U32, std::string> v;
+    for (U32 i = 0; i < 100; ++i) {
+        EXPECT_EQ(v.push_back({F32(i), 0.0f, 0.0f}, i * 2, std::to_string(i)), i);
+    }
+
+    auto positions = v.column<0>();
+    auto ids = v.column<1>();
+    auto names = v.column<2>();
+    ASSERT_EQ(positions.size(), 100u);
+    ASSERT_EQ(names.size(), 100u);
+    for (U32 i = 0; i < 100; ++i) {
+        EXPECT_EQ(positions[i].x, F32(i));
+        EXPECT_EQ(ids[i], i * 2);
+        EXPECT_EQ(names[i], std::to_string(i));
+    }
+
+    auto [position, id, name] = v.row(42);
+    id = 7;
+    EXPECT_EQ(v.get<1>(42), 7u);
+    EXPECT_EQ(name, "42");
+    EXPECT_EQ(position.x, 42.0f);
+}
+
+TEST(SoaVectorTest, ColumnsAreAligned) {
+    SoaVector<U8, double, U16> v;
+    v.resize(37);
+    EXPECT_TRUE(is_aligned(v.column<0>().data(), Core::CacheLineSize));
+    EXPECT_TRUE(is_aligned(v.column<1>().data(), Core::CacheLineSize));
+    EXPECT_TRUE(is_aligned(v.column<2>().data(), Core::CacheLineSize));
+    EXPECT_EQ(v.get<1>(36), 0.0);
+}
+
+TEST(SoaVectorTest, SameTypeInSeveralColumns) {
+    SoaVector<F32, F32> v;
+    v.push_back(1.0f, 2.0f);
+    v.push_back(3.0f, 4.0f);
+    EXPECT_EQ(v.get<0>(1), 3.0f);
+    EXPECT_EQ(v.get<1>(1), 4.0f);
+}
+
+TEST(SoaVectorTest, EraseAndSwapErase) {
+    SoaVector<U32, std::string> v;
+    for (U32 i = 0; i < 5; ++i) {
+        v.push_back(i, std::to_string(i));
+    }
+
+    v.erase(1);  // 0 2 3 4
+    ASSERT_EQ(v.size(), 4u);
+    EXPECT_EQ(v.get<0>(1), 2u);
+    EXPECT_EQ(v.get<1>(1), "2");
+
+    EXPECT_EQ(v.swap_erase(0), 3u);  // 4 2 3
+    ASSERT_EQ(v.size(), 3u);
+    EXPECT_EQ(v.get<0>(0), 4u);
+    EXPECT_EQ(v.get<1>(0), "4");
+    EXPECT_EQ(v.get<1>(2), "3");
+
+    v.pop_back();
+    EXPECT_EQ(v.size(), 2u);
+}
+
+TEST(SoaVectorTest, DestroysEveryColumn) {
+    auto tracked = std::make_shared<int>(0);
+    {
+        SoaVector<std::shared_ptr<int>, U32, std::shared_ptr<int>> v;
+        for (U32 i = 0; i < 20; ++i) {
+            v.push_back(tracked, i, tracked);
+        }
+        EXPECT_EQ(tracked.use_count(), 41);
+        v.swap_erase(3);
+        v.erase(0);
+        EXPECT_EQ(tracked.use_count(), 37);
+    }
+    EXPECT_EQ(tracked.use_count(), 1);
+}
+
+TEST(SoaVectorTest, PushReferencingOwnRowWhileGrowing) {
+    SoaVector<std::string, U32> v;
+    v.push_back(std::string(64, 'x'), 1u);
+    while (v.size() < v.capacity()) {
+        v.push_back("filler", 0u);
+    }
+    v.push_back(v.get<0>(0), v.get<1>(0));
+    EXPECT_EQ(v.get<0>(v.size() - 1), std::string(64, 'x'));
+    EXPECT_EQ(v.get<1>(v.size() - 1), 1u);
+}
+
+TEST(SoaVectorTest, AllocatesFromResource) {
+    std::byte buffer[4096];
+    std::pmr::monotonic_buffer_resource arena(buffer, sizeof(buffer),
+                                              std::pmr::null_memory_resource());
+    SoaVector<U32, F32> v(&arena);
+    v.reserve(64);
+    for (U32 i = 0; i < 64; ++i) {
+        v.push_back(i, 0.5f);
+    }
+    const auto* first = reinterpret_cast<const std::byte*>(v.column<0>().data());
+    EXPECT_GE(first, buffer);
+    EXPECT_LT(first, buffer + sizeof(buffer));
+
+    SoaVector<U32, F32> copy = v;
+    EXPECT_EQ(copy.resource(), std::pmr::get_default_resource());
+    EXPECT_EQ(copy.get<0>(63), 63u);
+
+    SoaVector<U32, F32> moved(&arena);
+    moved = std::move(v);
+    EXPECT_TRUE(v.empty());
+    EXPECT_EQ(moved.column<0>().data(), reinterpret_cast<const U32*>(first));
+}
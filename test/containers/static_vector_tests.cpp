@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+
+#include <core/containers/static_vector.hpp>
+#include <core/logger.hpp>
+
+using Core::static_vector;
+
+class StaticVectorTest : public ::testing::Test {
+   protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+};
+
+TEST_F(StaticVectorTest, PushAndAccess) {
+    static_vector<int, 4> v;
+    EXPECT_TRUE(v.empty());
+    v.push_back(1);
+    v.emplace_back(2);
+    v.push_back(3);
+
+    EXPECT_EQ(v.size(), 3u);
+    EXPECT_EQ(v.front(), 1);
+    EXPECT_EQ(v.back(), 3);
+    EXPECT_EQ(v[1], 2);
+    EXPECT_THROW((void)v.at(3), std::out_of_range);
+    EXPECT_EQ((static_vector<int, 4>::capacity()), 4u);
+}
+
+TEST_F(StaticVectorTest, ThrowsBadAllocWhenFull) {
+    static_vector<int, 2> v{1, 2};
+    EXPECT_TRUE(v.full());
+    EXPECT_THROW(v.push_back(3), std::bad_alloc);
+    EXPECT_THROW(v.resize(3), std::bad_alloc);
+    EXPECT_EQ(v.size(), 2u);
+}
+
+TEST_F(StaticVectorTest, InsertAndErase) {
+    static_vector<int, 8> v{1, 2, 4, 5};
+    v.insert(v.begin() + 2, 3);
+    EXPECT_EQ(v, (static_vector<int, 8>{1, 2, 3, 4, 5}));
+
+    auto it = v.erase(v.begin() + 1);
+    EXPECT_EQ(*it, 3);
+    EXPECT_EQ(v, (static_vector<int, 8>{1, 3, 4, 5}));
+
+    v.erase(v.begin(), v.begin() + 2);
+    EXPECT_EQ(v, (static_vector<int, 8>{4, 5}));
+
+    v.swap_erase(v.begin());
+    EXPECT_EQ(v, (static_vector<int, 8>{5}));
+}
+
+TEST_F(StaticVectorTest, ResizeValueInitializes) {
+    static_vector<int, 8> v;
+    v.resize(4);
+    for (int x : v) {
+        EXPECT_EQ(x, 0);
+    }
+    v.resize(6, 7);
+    EXPECT_EQ(v[5], 7);
+    v.resize(1);
+    EXPECT_EQ(v.size(), 1u);
+}
+
+TEST_F(StaticVectorTest, DestroysElements) {
+    auto counter = std::make_shared<int>(0);
+    {
+        static_vector<std::shared_ptr<int>, 4> v;
+        v.push_back(counter);
+        v.push_back(counter);
+        EXPECT_EQ(counter.use_count(), 3);
+        v.pop_back();
+        EXPECT_EQ(counter.use_count(), 2);
+    }
+    EXPECT_EQ(counter.use_count(), 1);
+}
+
+TEST_F(StaticVectorTest, CopyAndMove) {
+    static_vector<std::string, 4> a{"albedo", "normal"};
+    static_vector<std::string, 4> b = a;
+    EXPECT_EQ(a, b);
+
+    static_vector<std::string, 4> c = std::move(a);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(c, b);
+
+    a = std::move(c);
+    EXPECT_EQ(a[1], "normal");
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <thread>
+
+#include <core/memory/allocation_profiler.hpp>
+#include <core/logger.hpp>
+
+using namespace Core;
+
+// Drives the counting logic through on_allocate() directly, so these tests do
+// not depend on the operator new hooks being compiled in.
+class AllocationProfilerTest : public ::testing::Test {
+   protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        AllocationProfiler::reset();
+    }
+    void TearDown() override {
+        AllocationProfiler::reset();
+        Core::Logger::shutdown();
+    }
+
+    static const AllocationProfiler::ScopeStats* find(
+        std::span<const AllocationProfiler::ScopeStats> stats, const char* name) {
+        for (const auto& s : stats) {
+            if (s.name == name) {
+                return &s;
+            }
+        }
+        return nullptr;
+    }
+
+    static inline int s_Violations = 0;
+    static void count_violation(const AllocationProfiler::Callstack&) { s_Violations++; }
+};
+
+TEST_F(AllocationProfilerTest, CountsPerFrame) {
+    AllocationProfiler::begin_frame();
+    AllocationProfiler::on_allocate(64);
+    AllocationProfiler::on_allocate(32);
+    AllocationProfiler::on_free();
+    auto first = AllocationProfiler::end_frame();
+
+    EXPECT_EQ(first.frame, 0u);
+    EXPECT_EQ(first.allocations, 2u);
+    EXPECT_EQ(first.bytes, 96u);
+    EXPECT_EQ(first.frees, 1u);
+
+    AllocationProfiler::begin_frame();
+    auto second = AllocationProfiler::end_frame();
+    EXPECT_EQ(second.frame, 1u);
+    EXPECT_EQ(second.allocations, 0u);
+    EXPECT_EQ(AllocationProfiler::last_frame().frame, 1u);
+}
+
+TEST_F(AllocationProfilerTest, AttributesToInnermostScopeAndTag) {
+    static const char* Outer = "Outer";
+    static const char* Inner = "Inner";
+
+    AllocationProfiler::begin_frame();
+    {
+        AllocationScope outer{Outer, MemoryTag::MEMORY_TAG_RENDERER};
+        AllocationProfiler::on_allocate(16);
+        {
+            AllocationScope inner{Inner};
+            EXPECT_EQ(AllocationProfiler::current_tag(), MemoryTag::MEMORY_TAG_RENDERER);
+            AllocationProfiler::on_allocate(32);
+            {
+                AllocationScope tag{MemoryTag::MEMORY_TAG_TEXTURE};
+                EXPECT_EQ(AllocationProfiler::current_scope(), Inner);
+                AllocationProfiler::on_allocate(8);
+            }
+        }
+    }
+    AllocationProfiler::on_allocate(4);
+    AllocationProfiler::end_frame();
+
+    EXPECT_EQ(AllocationProfiler::current_scope(), nullptr);
+    EXPECT_EQ(AllocationProfiler::tag_stats(MemoryTag::MEMORY_TAG_RENDERER).allocations, 2u);
+    EXPECT_EQ(AllocationProfiler::tag_stats(MemoryTag::MEMORY_TAG_RENDERER).bytes, 48u);
+    EXPECT_EQ(AllocationProfiler::tag_stats(MemoryTag::MEMORY_TAG_TEXTURE).bytes, 8u);
+    EXPECT_EQ(AllocationProfiler::tag_stats(MemoryTag::MEMORY_TAG_UNKNOWN).bytes, 4u);
+
+    std::array<AllocationProfiler::ScopeStats, AllocationProfiler::MaxScopes> stats;
+    const auto count = AllocationProfiler::scope_stats(stats);
+    std::span<const AllocationProfiler::ScopeStats> seen{stats.data(), count};
+
+    ASSERT_NE(find(seen, Outer), nullptr);
+    ASSERT_NE(find(seen, Inner), nullptr);
+    EXPECT_EQ(find(seen, Outer)->lastFrame.bytes, 16u);
+    EXPECT_EQ(find(seen, Inner)->lastFrame.allocations, 2u);
+    EXPECT_EQ(find(seen, Inner)->total.bytes, 40u);
+}
+
+TEST_F(AllocationProfilerTest, ScopesAreThreadLocal) {
+    AllocationScope scope{"Main"};
+
+    std::thread worker([] { EXPECT_EQ(AllocationProfiler::current_scope(), nullptr); });
+    worker.join();
+
+    EXPECT_STREQ(AllocationProfiler::current_scope(), "Main");
+}
+
+TEST_F(AllocationProfilerTest, SamplesCallstacks) {
+    AllocationProfiler::set_sample_interval(2);
+
+    for (int i = 0; i < 6; ++i) {
+        AllocationProfiler::on_allocate(static_cast<std::size_t>(i));
+    }
+
+    std::array<AllocationProfiler::Callstack, AllocationProfiler::MaxCallstacks> samples;
+    const auto count = AllocationProfiler::sampled_callstacks(samples);
+    ASSERT_EQ(count, 3u);
+    // most recent first
+    EXPECT_EQ(samples[0].bytes, 4u);
+    EXPECT_EQ(samples[2].bytes, 0u);
+    EXPECT_STREQ(samples[0].scope, "<unscoped>");
+}
+
+TEST_F(AllocationProfilerTest, ZeroAllocationFramesAfterWarmup) {
+    s_Violations = 0;
+    AllocationProfiler::enforce_zero_allocation_frames(2, &count_violation);
+
+    for (int frame = 0; frame < 4; ++frame) {
+        AllocationProfiler::begin_frame();
+        AllocationProfiler::on_allocate(16);
+        AllocationProfiler::end_frame();
+    }
+    EXPECT_EQ(s_Violations, 2);
+
+    // outside of a frame nothing is enforced
+    AllocationProfiler::on_allocate(16);
+    EXPECT_EQ(s_Violations, 2);
+
+    AllocationProfiler::disable_zero_allocation_frames();
+    AllocationProfiler::begin_frame();
+    AllocationProfiler::on_allocate(16);
+    AllocationProfiler::end_frame();
+    EXPECT_EQ(s_Violations, 2);
+}
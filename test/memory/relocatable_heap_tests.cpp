@@ -0,0 +1,154 @@
+#include <gtest/gtest.h>
+#include <cstring>
+#include <vector>
+
+#include <core/memory/relocatable_heap.hpp>
+#include <core/logger.hpp>
+
+using namespace Core::Allocator;
+
+class RelocatableHeapTest : public ::testing::Test {
+   protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+
+    static void fill(RelocatableHeap& heap, RelocatableHeap::Handle h, U8 value) {
+        std::memset(heap.get(h), value, heap.size_of(h));
+    }
+
+    static bool holds(const RelocatableHeap& heap, RelocatableHeap::Handle h, U8 value) {
+        const auto* bytes = static_cast<const U8*>(heap.get(h));
+        for (std::size_t i = 0; i < heap.size_of(h); ++i) {
+            if (bytes[i] != value) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    RelocatableHeap heap{1024, 16};
+};
+
+TEST_F(RelocatableHeapTest, AllocateAndGet) {
+    auto h = heap.allocate(100);
+    ASSERT_TRUE(h);
+    ASSERT_NE(heap.get(h), nullptr);
+    EXPECT_TRUE(Core::MemoryUtil::IsAligned(heap.get(h), 16));
+    EXPECT_EQ(heap.size_of(h), 112u);
+    EXPECT_EQ(heap.used_bytes(), 112u);
+}
+
+TEST_F(RelocatableHeapTest, FreeInvalidatesHandle) {
+    auto h = heap.allocate(64);
+    heap.free(h);
+
+    EXPECT_EQ(heap.get(h), nullptr);
+    EXPECT_EQ(heap.used_bytes(), 0u);
+
+    auto h2 = heap.allocate(64);
+    EXPECT_EQ(h2.index(), h.index());
+    EXPECT_NE(h2.gen(), h.gen());
+    EXPECT_EQ(heap.get(h), nullptr);
+}
+
+TEST_F(RelocatableHeapTest, ReturnsNullWhenFull) {
+    auto a = heap.allocate(1024);
+    ASSERT_TRUE(a);
+    EXPECT_FALSE(heap.allocate(16));
+}
+
+TEST_F(RelocatableHeapTest, ReusesHoles) {
+    auto a = heap.allocate(256);
+    auto b = heap.allocate(256);
+    auto c = heap.allocate(512);
+    ASSERT_TRUE(a && b && c);
+
+    void* old_b = heap.get(b);
+    heap.free(b);
+
+    auto d = heap.allocate(128);
+    ASSERT_TRUE(d);
+    EXPECT_EQ(heap.get(d), old_b);
+}
+
+TEST_F(RelocatableHeapTest, CompactionClosesHolesAndKeepsContents) {
+    std::vector<RelocatableHeap::Handle> handles;
+    for (U8 i = 0; i < 8; ++i) {
+        handles.push_back(heap.allocate(128));
+        fill(heap, handles.back(), i);
+    }
+
+    for (std::size_t i = 0; i < handles.size(); i += 2) {
+        heap.free(handles[i]);
+    }
+
+    EXPECT_GT(heap.fragmentation(), 0.0f);
+    EXPECT_FALSE(heap.allocate(512));
+
+    EXPECT_GT(heap.compact_full(), 0u);
+    EXPECT_FLOAT_EQ(heap.fragmentation(), 0.0f);
+
+    for (std::size_t i = 1; i < handles.size(); i += 2) {
+        EXPECT_TRUE(holds(heap, handles[i], static_cast<U8>(i)));
+    }
+
+    EXPECT_TRUE(heap.allocate(512));
+}
+
+TEST_F(RelocatableHeapTest, PinnedBlocksDoNotMove) {
+    auto a = heap.allocate(128);
+    auto b = heap.allocate(128);
+    auto c = heap.allocate(128);
+    fill(heap, c, 0xCC);
+
+    void* pinned = heap.pin(b);
+    heap.free(a);
+    heap.compact_full();
+
+    EXPECT_EQ(heap.get(b), pinned);
+    EXPECT_TRUE(heap.is_pinned(b));
+    EXPECT_TRUE(holds(heap, c, 0xCC));
+
+    heap.unpin(b);
+    EXPECT_FALSE(heap.is_pinned(b));
+    heap.compact_full();
+    EXPECT_NE(heap.get(b), pinned);
+    EXPECT_EQ(heap.stats().largestFreeBlock, heap.capacity() - heap.used_bytes());
+}
+
+TEST_F(RelocatableHeapTest, ZeroBudgetMakesIncrementalProgress) {
+    std::vector<RelocatableHeap::Handle> handles;
+    for (int i = 0; i < 8; ++i) {
+        handles.push_back(heap.allocate(64));
+    }
+    heap.free(handles[0]);
+
+    // each call with an exhausted budget still visits a single block
+    std::size_t passes = 0;
+    while (heap.fragmentation() > 0.0f && passes < 64) {
+        heap.compact(std::chrono::microseconds{0});
+        ++passes;
+    }
+
+    EXPECT_GE(passes, 7u);
+    EXPECT_FLOAT_EQ(heap.fragmentation(), 0.0f);
+    EXPECT_EQ(heap.total_bytes_moved(), 7u * 64u);
+}
+
+TEST_F(RelocatableHeapTest, FreeingCursorBlockDuringIncrementalCompaction) {
+    auto a = heap.allocate(64);
+    auto b = heap.allocate(64);
+    auto c = heap.allocate(64);
+    auto d = heap.allocate(64);
+    fill(heap, d, 0xDD);
+
+    heap.free(a);
+    heap.compact(std::chrono::microseconds{0});  // moves b, cursor now at c
+    heap.free(c);
+    heap.compact_full();
+
+    EXPECT_TRUE(holds(heap, d, 0xDD));
+    EXPECT_EQ(heap.stats().liveBlocks, 2u);
+    EXPECT_FLOAT_EQ(heap.fragmentation(), 0.0f);
+    (void)b;
+}
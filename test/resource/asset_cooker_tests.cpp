@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <resource/asset_cooker.hpp>
+#include <resource/texture_file.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+void write_text(const std::filesystem::path& path, const std::string& text) {
+    std::ofstream file(path);
+    file << text;
+}
+
+} // namespace
+
+class AssetCookerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        dir = std::filesystem::temp_directory_path() / "vge_asset_cooker_tests";
+        std::filesystem::remove_all(dir);
+        std::filesystem::create_directories(dir / "textures");
+        jobs = std::make_unique<Core::JobPool>();
+    }
+
+    void TearDown() override {
+        jobs.reset();
+        std::filesystem::remove_all(dir);
+        Core::Logger::shutdown();
+    }
+
+    CookStats cook(bool force = false) {
+        AssetCooker cooker(dir);
+        return cooker.cook(*jobs, force);
+    }
+
+    std::filesystem::path dir;
+    std::unique_ptr<Core::JobPool> jobs;
+};
+
+TEST_F(AssetCookerTest, CooksOnlyWhatChanged) {
+    write_ppm(dir / "textures" / "albedo.ppm", 100);
+    write_ppm(dir / "textures" / "detail.PPM", 200);
+    write_text(dir / "notes.txt", "not an asset");
+
+    CookStats stats = cook();
+    EXPECT_EQ(stats.assets, 2u);
+    EXPECT_EQ(stats.cooked, 2u);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_TRUE(std::filesystem::exists(dir / "textures" / "albedo.ppm.vgetex"));
+    EXPECT_TRUE(std::filesystem::exists(dir / AssetCooker::ManifestName));
+
+    stats = cook();
+    EXPECT_EQ(stats.cooked, 0u);
+    EXPECT_EQ(stats.upToDate, 2u);
+
+    // rewritten with the same contents: rehashed, not cooked
+    write_ppm(dir / "textures" / "albedo.ppm", 100);
+    EXPECT_EQ(cook().cooked, 0u);
+
+    write_ppm(dir / "textures" / "albedo.ppm", 101);
+    EXPECT_EQ(cook().cooked, 1u);
+
+    std::filesystem::remove(dir / "textures" / "detail.PPM.vgetex");
+    EXPECT_EQ(cook().cooked, 1u);
+
+    EXPECT_EQ(cook(true).cooked, 2u);
+}
+
+TEST_F(AssetCookerTest, ImportSettingsAreInputs) {
+    const std::filesystem::path source = dir / "textures" / "normal.ppm";
+    write_ppm(source, 128);
+    cook();
+
+    TextureFile file;
+    ASSERT_TRUE(file.open(cooked_texture_path(source)));
+    EXPECT_EQ(file.format(), PixelFormat::BC7);
+    EXPECT_TRUE(file.srgb());
+    file.close();
+
+    write_text(dir / "textures" / "normal.ppm.import",
+        "# tangent space normals\nusage = normal\ncolor_space = linear\n");
+    const TextureDescriptor desc = AssetCooker::texture_settings(source);
+    EXPECT_EQ(desc.usage, TextureDescriptor::Usage::Normal);
+    EXPECT_EQ(desc.metadata.at("color_space"), "linear");
+
+    EXPECT_EQ(cook().cooked, 1u);
+    ASSERT_TRUE(file.open(cooked_texture_path(source)));
+    EXPECT_EQ(file.format(), PixelFormat::BC5);
+    EXPECT_FALSE(file.srgb());
+    EXPECT_TRUE(file.normal_map());
+    file.close();
+
+    EXPECT_EQ(cook().cooked, 0u);
+}
+
+TEST_F(AssetCookerTest, DamagedManifestCooksEverything) {
+    write_ppm(dir / "textures" / "albedo.ppm", 100);
+    write_text(dir / "broken.png", "not an image");
+
+    CookStats stats = cook();
+    EXPECT_EQ(stats.cooked, 1u);
+    EXPECT_EQ(stats.failed, 1u);
+
+    // failed assets are tried again, cooked ones are not
+    stats = cook();
+    EXPECT_EQ(stats.failed, 1u);
+    EXPECT_EQ(stats.cooked, 0u);
+
+    write_text(dir / AssetCooker::ManifestName, "vge_cook 0 0 0\n");
+    EXPECT_EQ(cook().cooked, 1u);
+}
+
+TEST_F(AssetCookerTest, ImportsObjAndRecordsItsTextures) {
+    // the texture lives outside the asset directory and is cooked anyway
+    std::filesystem::create_directories(dir / "models");
+    write_ppm(dir / "shared.ppm", 50);
+    write_text(dir / "models" / "quad.mtl", "newmtl quad\nmap_Kd ../../shared.ppm\n");
+    write_text(dir / "models" / "quad.obj",
+        "mtllib quad.mtl\nv 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nusemtl quad\nf 1 2 4 3\n");
+
+    std::filesystem::rename(dir / "models", dir / "textures" / "models");
+    AssetCooker cooker(dir / "textures");
+    const CookStats stats = cooker.cook(*jobs);
+    EXPECT_EQ(stats.failed, 0u);
+    EXPECT_EQ(stats.cooked, 2u);
+    EXPECT_EQ(cooker.dependencies("models/quad.obj"), (std::vector<std::string> { "../shared.ppm" }));
+    EXPECT_TRUE(std::filesystem::exists(dir / "shared.ppm.vgetex"));
+    EXPECT_TRUE(std::filesystem::exists(dir / "textures" / "models" / "quad.obj.vgemesh"));
+
+    EXPECT_EQ(cooker.cook(*jobs).upToDate, 2u);
+}
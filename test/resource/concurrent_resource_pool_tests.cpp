@@ -0,0 +1,124 @@
+#include <gtest/gtest.h>
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+#include <core/concurrency/ring_queue.hpp>
+#include <core/logger.hpp>
+#include <resource/concurrent_resource_pool.hpp>
+#include <resource/handle.hpp>
+
+using namespace Resource;
+
+namespace {
+
+struct StreamedResource {
+    U32 id;
+    std::string name;
+
+    StreamedResource(U32 i)
+        : id(i)
+        , name(std::to_string(i)) { }
+};
+
+} // namespace
+
+class ConcurrentResourcePoolTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+
+    void TearDown() override { Core::Logger::shutdown(); }
+
+    ConcurrentResourcePool<StreamedResource, 64> pool;
+};
+
+TEST_F(ConcurrentResourcePoolTest, InsertGetFree) {
+    Handle h = pool.emplace(7u);
+    ASSERT_TRUE(h);
+    ASSERT_NE(pool.get(h), nullptr);
+    EXPECT_EQ(pool.get(h)->name, "7");
+    EXPECT_EQ(pool.size(), 1u);
+
+    pool.free(h);
+    EXPECT_EQ(pool.get(h), nullptr);
+    EXPECT_EQ(pool.size(), 0u);
+
+    // double free and stale handles are rejected
+    pool.free(h);
+    Handle reused = pool.emplace(8u);
+    EXPECT_EQ(reused.index(), h.index());
+    EXPECT_EQ(reused.gen(), h.gen() + 1);
+    EXPECT_EQ(pool.get(h), nullptr);
+    EXPECT_EQ(pool.get(reused)->id, 8u);
+
+    EXPECT_EQ(pool.get(Handle::null()), nullptr);
+    EXPECT_EQ(pool.get(Handle::make(5000, 1)), nullptr);
+    EXPECT_EQ(pool.get(Handle::make(reused.index() + 1, 1)), nullptr);
+}
+
+TEST_F(ConcurrentResourcePoolTest, AddressesStayStable) {
+    Handle first = pool.emplace(1u);
+    StreamedResource* cached = pool.get(first);
+    for (U32 i = 0; i < 1000; ++i) {
+        pool.emplace(i);
+    }
+    EXPECT_EQ(pool.get(first), cached);
+}
+
+// Workers stream resources in and hand the handles to the "render" threads,
+// which resolve them and must always see fully constructed values. Workers
+// also free half of what they create straight away, so slots are recycled
+// through the freelist while other threads insert.
+TEST_F(ConcurrentResourcePoolTest, WorkersInsertWhileRenderThreadsResolve) {
+    constexpr U32 Workers = 4;
+    constexpr U32 Readers = 2;
+    constexpr U32 PerWorker = 4000;
+    constexpr U32 Published = Workers * PerWorker / 2;
+
+    Core::MpmcRing<Handle> handoff(256);
+    std::atomic<U32> resolved { 0 };
+    std::atomic<U32> failures { 0 };
+    std::vector<std::thread> threads;
+
+    for (U32 w = 0; w < Workers; ++w) {
+        threads.emplace_back([&, w]() {
+            for (U32 i = 0; i < PerWorker; ++i) {
+                const U32 id = w * PerWorker + i;
+                Handle h = pool.emplace(id);
+                if (i % 2) {
+                    pool.free(h);
+                    continue;
+                }
+                while (!handoff.try_push(h)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+
+    for (U32 r = 0; r < Readers; ++r) {
+        threads.emplace_back([&]() {
+            Handle h;
+            while (resolved.load(std::memory_order_relaxed) < Published) {
+                if (!handoff.try_pop(h)) {
+                    std::this_thread::yield();
+                    continue;
+                }
+                const StreamedResource* res = pool.get(h);
+                if (!res || res->name != std::to_string(res->id)) {
+                    failures.fetch_add(1, std::memory_order_relaxed);
+                }
+                pool.free(h);
+                resolved.fetch_add(1, std::memory_order_relaxed);
+            }
+        });
+    }
+
+    for (auto& t : threads) {
+        t.join();
+    }
+
+    EXPECT_EQ(failures.load(), 0u);
+    EXPECT_EQ(resolved.load(), Published);
+    EXPECT_EQ(pool.size(), 0u);
+}
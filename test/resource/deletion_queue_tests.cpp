@@ -0,0 +1,61 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <resource/deletion_queue.hpp>
+#include <core/logger.hpp>
+
+using namespace Resource;
+
+class DeletionQueueTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+
+    void TearDown() override { Core::Logger::shutdown(); }
+
+    DeletionQueue queue;
+};
+
+TEST_F(DeletionQueueTest, CollectRunsOnlyCompletedFrames) {
+    std::vector<int> destroyed;
+    queue.retire(1, [&] { destroyed.push_back(1); });
+    queue.retire(1, [&] { destroyed.push_back(2); });
+    queue.retire(3, [&] { destroyed.push_back(3); });
+
+    EXPECT_EQ(queue.collect(0), 0u);
+    EXPECT_TRUE(destroyed.empty());
+
+    EXPECT_EQ(queue.collect(2), 2u);
+    EXPECT_EQ(destroyed, (std::vector<int> { 1, 2 }));
+    EXPECT_EQ(queue.size(), 1u);
+
+    EXPECT_EQ(queue.collect(3), 1u);
+    EXPECT_EQ(destroyed, (std::vector<int> { 1, 2, 3 }));
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(DeletionQueueTest, FlushAndDestructorRunEverything) {
+    int destroyed = 0;
+    queue.retire(10, [&] { destroyed++; });
+    queue.retire(20, [&] { destroyed++; });
+    EXPECT_EQ(queue.flush(), 2u);
+    EXPECT_EQ(destroyed, 2);
+
+    {
+        DeletionQueue scoped;
+        scoped.retire(5, [&] { destroyed++; });
+    }
+    EXPECT_EQ(destroyed, 3);
+}
+
+TEST_F(DeletionQueueTest, DeleterMayRetireMoreWork) {
+    int destroyed = 0;
+    queue.retire(1, [&] {
+        destroyed++;
+        queue.retire(2, [&] { destroyed++; });
+    });
+
+    queue.collect(1);
+    EXPECT_EQ(destroyed, 1);
+    EXPECT_EQ(queue.size(), 1u);
+    queue.collect(2);
+    EXPECT_EQ(destroyed, 2);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <resource/dense_resource_pool.hpp>
+#include <resource/handle.hpp>
+#include <core/logger.hpp>
+
+using namespace Resource;
+
+namespace {
+
+struct MockResource {
+    int value;
+    std::string name;
+
+    MockResource(int v = 0, std::string n = "")
+        : value(v)
+        , name(std::move(n)) { }
+};
+
+} // namespace
+
+class DenseResourcePoolTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+
+    void TearDown() override { Core::Logger::shutdown(); }
+
+    DenseResourcePool<MockResource> pool;
+};
+
+TEST_F(DenseResourcePoolTest, EmplaceGetFree) {
+    Handle h = pool.emplace(42, "test");
+    ASSERT_TRUE(h);
+
+    MockResource* res = pool.get(h);
+    ASSERT_NE(res, nullptr);
+    EXPECT_EQ(res->value, 42);
+    EXPECT_EQ(res->name, "test");
+    EXPECT_TRUE(pool.contains(h));
+
+    pool.free(h);
+    EXPECT_EQ(pool.get(h), nullptr);
+    EXPECT_TRUE(pool.empty());
+    EXPECT_EQ(pool.get(Handle::null()), nullptr);
+    EXPECT_EQ(pool.get(Handle::make(9999, 1)), nullptr);
+}
+
+TEST_F(DenseResourcePoolTest, ReusesSlotWithNewGeneration) {
+    Handle h1 = pool.insert(MockResource { 1, "gen1" });
+    pool.free(h1);
+    Handle h2 = pool.insert(MockResource { 2, "gen2" });
+
+    EXPECT_EQ(h2.index(), h1.index());
+    EXPECT_EQ(h2.gen(), h1.gen() + 1);
+    EXPECT_EQ(pool.get(h1), nullptr);
+    EXPECT_EQ(pool.get(h2)->value, 2);
+}
+
+TEST_F(DenseResourcePoolTest, FreeKeepsValuesPacked) {
+    std::vector<Handle> handles;
+    for (int i = 0; i < 5; ++i) {
+        handles.push_back(pool.emplace(i, "v"));
+    }
+
+    pool.free(handles[1]);
+    pool.free(handles[3]);
+
+    ASSERT_EQ(pool.size(), 3u);
+    ASSERT_EQ(pool.values().size(), 3u);
+
+    int sum = 0;
+    for (const MockResource& r : pool) {
+        sum += r.value;
+    }
+    EXPECT_EQ(sum, 0 + 2 + 4);
+
+    // the values that moved are still reachable through their old handles
+    EXPECT_EQ(pool.get(handles[0])->value, 0);
+    EXPECT_EQ(pool.get(handles[2])->value, 2);
+    EXPECT_EQ(pool.get(handles[4])->value, 4);
+
+    for (size_t i = 0; i < pool.size(); ++i) {
+        EXPECT_EQ(pool.get(pool.handle_at(i)), &pool.values()[i]);
+    }
+}
+
+TEST_F(DenseResourcePoolTest, ForgedHandleOfFreeSlotIsRejected) {
+    Handle a = pool.emplace(1, "a");
+    Handle b = pool.emplace(2, "b");
+    pool.free(a);
+
+    // current generation of the free slot, but no value lives there
+    EXPECT_EQ(pool.get(Handle::make(a.index(), a.gen() + 1)), nullptr);
+    EXPECT_EQ(pool.get(b)->value, 2);
+}
+
+TEST_F(DenseResourcePoolTest, MatchesReferenceUnderChurn) {
+    std::unordered_map<U32, int> live;
+    std::vector<Handle> handles;
+    std::mt19937 rng(7);
+
+    for (int i = 0; i < 20000; ++i) {
+        if (handles.empty() || rng() % 3 != 0) {
+            Handle h = pool.emplace(i, "churn");
+            handles.push_back(h);
+            live[h.value] = i;
+        } else {
+            const size_t pick = rng() % handles.size();
+            pool.free(handles[pick]);
+            live.erase(handles[pick].value);
+            handles[pick] = handles.back();
+            handles.pop_back();
+        }
+    }
+
+    ASSERT_EQ(pool.size(), live.size());
+    for (Handle h : handles) {
+        ASSERT_NE(pool.get(h), nullptr);
+        EXPECT_EQ(pool.get(h)->value, live[h.value]);
+    }
+
+    pool.clear();
+    EXPECT_TRUE(pool.empty());
+    for (Handle h : handles) {
+        EXPECT_EQ(pool.get(h), nullptr);
+    }
+}
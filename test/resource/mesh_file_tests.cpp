@@ -0,0 +1,205 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <resource/mesh_file.hpp>
+#include <core/concurrency/job_system.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+MeshData triangle(F32 z, U32 materialIndex) {
+    MeshData mesh;
+    mesh.vertices = { { { 0.0f, 0.0f, z }, { 1.0f, 0.0f, 0.0f }, { 0.0f, 0.0f } },
+        { { 1.0f, 0.0f, z }, { 0.0f, 1.0f, 0.0f }, { 1.0f, 0.0f } },
+        { { 0.0f, 1.0f, z }, { 0.0f, 0.0f, 1.0f }, { 0.0f, 1.0f } } };
+    mesh.indices = { 0, 1, 2 };
+    mesh.materialIndex = materialIndex;
+    return mesh;
+}
+
+} // namespace
+
+class MeshFileTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        dir = std::filesystem::temp_directory_path() / "vge_mesh_file_tests";
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+        Core::Logger::shutdown();
+    }
+
+    std::filesystem::path dir;
+};
+
+TEST_F(MeshFileTest, RoundTripsGeometryAndMaterials) {
+    const std::vector<MeshData> meshes = { triangle(0.0f, 1), triangle(1.0f, 0) };
+    const PackedGeometry packed = pack_meshes(meshes);
+    const std::vector<MaterialData> materials
+        = { { "plain", "" }, { "albedo", (dir / "textures" / "albedo.png").generic_string() } };
+
+    const std::filesystem::path path = dir / "model.vgemesh";
+    ASSERT_TRUE(write_mesh_file(path, materials, packed.view(), 42));
+    EXPECT_FALSE(std::filesystem::exists(dir / "model.vgemesh.tmp"));
+
+    MeshFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_EQ(file.source_hash(), 42u);
+
+    const GeometryView geometry = file.geometry();
+    EXPECT_EQ(reinterpret_cast<uintptr_t>(geometry.vertices.data()) % MeshFileAlignment, 0u);
+    ASSERT_EQ(geometry.vertices.size(), 6u);
+    EXPECT_TRUE(std::equal(geometry.vertices.begin(), geometry.vertices.end(),
+        packed.vertices.begin(), packed.vertices.end()));
+    EXPECT_TRUE(std::equal(geometry.indices.begin(), geometry.indices.end(),
+        packed.indices.begin(), packed.indices.end()));
+    ASSERT_EQ(geometry.meshes.size(), 2u);
+    EXPECT_EQ(geometry.meshes[1].firstIndex, 3u);
+    EXPECT_EQ(geometry.meshes[1].vertexOffset, 3);
+    EXPECT_EQ(geometry.meshes[1].materialIndex, 0u);
+
+    // texture paths are stored relative to the file and resolved on load
+    const std::vector<MaterialData> loaded = file.materials();
+    ASSERT_EQ(loaded.size(), 2u);
+    EXPECT_EQ(loaded[0].name, "plain");
+    EXPECT_TRUE(loaded[0].diffusePath.empty());
+    EXPECT_EQ(loaded[1].name, "albedo");
+    EXPECT_EQ(loaded[1].diffusePath, (dir / "textures" / "albedo.png").generic_string());
+}
+
+TEST_F(MeshFileTest, PackingOnJobsMatchesPackingInOrder) {
+    std::vector<MeshData> meshes;
+    for (U32 i = 0; i < 64; ++i) {
+        meshes.push_back(triangle(static_cast<F32>(i), i % 3));
+        // meshes of different sizes, so every offset differs
+        for (U32 j = 0; j < i % 5; ++j) {
+            meshes.back().indices.insert(meshes.back().indices.end(), { 2, 1, 0 });
+        }
+    }
+    meshes.push_back({}); // an empty mesh still gets its range
+
+    Core::JobPool jobs;
+    const PackedGeometry serial = pack_meshes(meshes);
+    const PackedGeometry parallel = pack_meshes(meshes, &jobs);
+    EXPECT_EQ(parallel.vertices, serial.vertices);
+    EXPECT_EQ(parallel.indices, serial.indices);
+    ASSERT_EQ(parallel.meshes.size(), meshes.size());
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        EXPECT_EQ(parallel.meshes[i].firstIndex, serial.meshes[i].firstIndex);
+        EXPECT_EQ(parallel.meshes[i].vertexOffset, serial.meshes[i].vertexOffset);
+        EXPECT_EQ(parallel.meshes[i].materialIndex, meshes[i].materialIndex);
+    }
+    EXPECT_EQ(parallel.meshes.back().firstIndex, parallel.indices.size());
+    EXPECT_EQ(parallel.meshes.back().indexCount, 0u);
+}
+
+TEST_F(MeshFileTest, RoundTripsLevelsOfDetailAndBounds) {
+    std::vector<MeshData> meshes = { triangle(0.0f, 0), triangle(2.0f, 0) };
+    meshes[0].indices.insert(meshes[0].indices.end(), { 2, 1, 0 });
+    meshes[0].lods = { { { 0, 1, 2 }, 0.5f } };
+    const PackedGeometry packed = pack_meshes(meshes);
+
+    // levels follow their mesh in the index buffer
+    ASSERT_EQ(packed.lods.size(), 1u);
+    EXPECT_EQ(packed.lods[0].firstIndex, 6u);
+    EXPECT_EQ(packed.lods[0].indexCount, 3u);
+    EXPECT_EQ(packed.meshes[0].lodCount, 1u);
+    EXPECT_EQ(packed.meshes[1].firstIndex, 9u);
+    EXPECT_EQ(packed.meshes[1].lodCount, 0u);
+    EXPECT_FLOAT_EQ(packed.meshes[1].bounds[2], 2.0f);
+    EXPECT_FLOAT_EQ(packed.meshes[1].bounds[3], std::sqrt(0.5f));
+
+    const std::filesystem::path path = dir / "model.vgemesh";
+    ASSERT_TRUE(write_mesh_file(path, {}, packed.view(), 1));
+    MeshFile file;
+    ASSERT_TRUE(file.open(path));
+    const GeometryView geometry = file.geometry();
+    ASSERT_EQ(geometry.lods.size(), 1u);
+    EXPECT_EQ(geometry.lods[0].firstIndex, 6u);
+    EXPECT_FLOAT_EQ(geometry.lods[0].error, 0.5f);
+    EXPECT_EQ(geometry.indices[6], 0u);
+    ASSERT_EQ(geometry.meshes.size(), 2u);
+    EXPECT_EQ(geometry.meshes[0].firstLod, 0u);
+    EXPECT_EQ(geometry.meshes[0].lodCount, 1u);
+    EXPECT_EQ(geometry.meshes[1].bounds, packed.meshes[1].bounds);
+}
+
+TEST_F(MeshFileTest, RoundTripsMeshlets) {
+    std::vector<MeshData> meshes = { triangle(0.0f, 0), triangle(1.0f, 0) };
+    meshes[1].meshlets = { { 0, 3, { 0.5f, 0.5f, 1.0f, 0.75f }, { 0.0f, 0.0f, 1.0f, 0.0f } } };
+    const PackedGeometry packed = pack_meshes(meshes);
+
+    const std::filesystem::path path = dir / "model.vgemesh";
+    ASSERT_TRUE(write_mesh_file(path, {}, packed.view(), 1));
+    MeshFile file;
+    ASSERT_TRUE(file.open(path));
+    const GeometryView geometry = file.geometry();
+    ASSERT_EQ(geometry.meshlets.size(), 1u);
+    EXPECT_EQ(geometry.meshlets[0].firstIndex, 3u); // moved with its mesh
+    EXPECT_EQ(geometry.meshlets[0].indexCount, 3u);
+    EXPECT_EQ(geometry.meshlets[0].bounds, meshes[1].meshlets[0].bounds);
+    EXPECT_EQ(geometry.meshlets[0].cone, meshes[1].meshlets[0].cone);
+    EXPECT_EQ(geometry.meshes[0].meshletCount, 0u);
+    EXPECT_EQ(geometry.meshes[1].firstMeshlet, 0u);
+    EXPECT_EQ(geometry.meshes[1].meshletCount, 1u);
+}
+
+TEST_F(MeshFileTest, CooksModelsMeasuringTheOrderDrawn) {
+    ModelData data;
+    data.meshes = { make_grid(24), make_grid(8) };
+    Core::JobPool jobs;
+    const CookedModel cooked = cook_model(data, &jobs);
+
+    const GeometryView geometry = cooked.geometry.view();
+    ASSERT_EQ(geometry.meshes.size(), 2u);
+    VertexCacheStats drawn;
+    for (const MeshRange& range : geometry.meshes) {
+        EXPECT_GT(range.meshletCount, 0u);
+        EXPECT_GT(range.lodCount, 0u);
+        drawn += analyze_vertex_cache(geometry.indices.subspan(range.firstIndex, range.indexCount),
+            range.vertexCount);
+    }
+    EXPECT_EQ(cooked.stats.before.triangles, 24u * 24u * 2u + 8u * 8u * 2u);
+    EXPECT_EQ(cooked.stats.after.triangles, drawn.triangles);
+    EXPECT_EQ(cooked.stats.after.transforms, drawn.transforms);
+    EXPECT_LT(cooked.stats.after.acmr(), cooked.stats.before.acmr());
+}
+
+TEST_F(MeshFileTest, RejectsOtherVersionsAndDamagedFiles) {
+    const std::vector<MeshData> meshes = { triangle(0.0f, 0) };
+    const PackedGeometry packed = pack_meshes(meshes);
+    const std::filesystem::path path = dir / "model.vgemesh";
+    ASSERT_TRUE(write_mesh_file(path, {}, packed.view(), 1));
+
+    std::vector<char> bytes(std::filesystem::file_size(path));
+    std::ifstream(path, std::ios::binary).read(bytes.data(), static_cast<std::streamsize>(bytes.size()));
+    auto rewrite = [&](const std::vector<char>& contents) {
+        std::ofstream(path, std::ios::binary | std::ios::trunc)
+            .write(contents.data(), static_cast<std::streamsize>(contents.size()));
+    };
+
+    MeshFile file;
+    EXPECT_FALSE(file.open(dir / "missing.vgemesh"));
+
+    std::vector<char> otherVersion = bytes;
+    otherVersion[offsetof(MeshFileHeader, version)] = static_cast<char>(MeshFileVersion + 1);
+    rewrite(otherVersion);
+    EXPECT_FALSE(file.open(path));
+
+    std::vector<char> truncated(bytes.begin(), bytes.end() - 4);
+    rewrite(truncated);
+    EXPECT_FALSE(file.open(path));
+    EXPECT_FALSE(file.is_open());
+
+    rewrite(bytes);
+    EXPECT_TRUE(file.open(path));
+}
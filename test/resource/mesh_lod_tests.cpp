@@ -0,0 +1,129 @@
+#include <gtest/gtest.h>
+#include <cmath>
+#include <numbers>
+#include <set>
+#include <vector>
+#include <resource/mesh_lod.hpp>
+#include <core/concurrency/job_system.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+// Signed area of the triangles seen from +z, negative for flipped ones.
+F32 area(std::span<const MeshVertex> vertices, const U32* t) {
+    const auto& a = vertices[t[0]].position;
+    const auto& b = vertices[t[1]].position;
+    const auto& c = vertices[t[2]].position;
+    return 0.5f * ((b[0] - a[0]) * (c[1] - a[1]) - (b[1] - a[1]) * (c[0] - a[0]));
+}
+
+} // namespace
+
+class MeshLodTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+};
+
+TEST_F(MeshLodTest, SimplifiesFlatSurfaceWithoutError) {
+    const MeshData mesh = make_grid(32);
+    F32 error = -1.0f;
+    const std::vector<U32> indices
+        = simplify_mesh(mesh.vertices, mesh.indices, mesh.indices.size() / 4, INFINITY, &error);
+
+    ASSERT_EQ(indices.size() % 3, 0u);
+    EXPECT_LE(indices.size(), mesh.indices.size() / 4);
+    EXPECT_NEAR(error, 0.0f, 1e-4f);
+
+    // still covers the whole square, no triangle turned over
+    F32 total = 0.0f;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        const F32 a = area(mesh.vertices, &indices[i]);
+        EXPECT_GT(a, 0.0f);
+        total += a;
+    }
+    EXPECT_NEAR(total, 32.0f * 32.0f, 1e-2f);
+}
+
+TEST_F(MeshLodTest, StopsAtTheErrorLimit) {
+    const MeshData mesh = make_grid(
+        24, 1.0f, [](F32 x, F32 y) { return 2.0f * std::sin(x * 0.7f) * std::cos(y * 0.5f); });
+    F32 error = 0.0f;
+    const std::vector<U32> indices = simplify_mesh(mesh.vertices, mesh.indices, 0, 0.05f, &error);
+    EXPECT_LT(indices.size(), mesh.indices.size());
+    EXPECT_GT(indices.size(), 0u);
+    EXPECT_LE(error, 0.05f);
+
+    // a looser limit simplifies further
+    const std::vector<U32> coarser = simplify_mesh(mesh.vertices, mesh.indices, 0, 1.0f, &error);
+    EXPECT_LT(coarser.size(), indices.size());
+    EXPECT_LE(error, 1.0f);
+}
+
+TEST_F(MeshLodTest, KeepsBorderAndSeamVertices) {
+    const MeshData mesh = make_grid(16, 1.0f, flat, 8);
+    const std::vector<U32> indices = simplify_mesh(mesh.vertices, mesh.indices, 0);
+    EXPECT_LT(indices.size(), mesh.indices.size() / 2);
+
+    const std::set<U32> used(indices.begin(), indices.end());
+    for (U32 v = 0; v < mesh.vertices.size(); ++v) {
+        const auto& p = mesh.vertices[v].position;
+        if (p[0] == 0.0f || p[0] == 16.0f || p[1] == 0.0f || p[1] == 16.0f || p[0] == 8.0f) {
+            EXPECT_TRUE(used.contains(v)) << "vertex " << v << " at " << p[0] << ", " << p[1];
+        }
+    }
+}
+
+TEST_F(MeshLodTest, GeneratesChainOfShrinkingLevels) {
+    std::vector<MeshData> meshes = { make_grid(32), make_grid(2) };
+    Core::JobPool jobs;
+    generate_lods(meshes, &jobs);
+
+    const MeshData& mesh = meshes[0];
+    ASSERT_GE(mesh.lods.size(), 2u);
+    EXPECT_LT(mesh.lods.size(), MaxMeshLods);
+    size_t previous = mesh.indices.size();
+    F32 previousError = 0.0f;
+    for (const MeshLodData& lod : mesh.lods) {
+        EXPECT_LE(F32(lod.indices.size()), LodMinReduction * F32(previous));
+        EXPECT_GE(lod.error, previousError);
+        for (U32 index : lod.indices) {
+            ASSERT_LT(index, mesh.vertices.size());
+        }
+        previous = lod.indices.size();
+        previousError = lod.error;
+    }
+
+    // too few triangles to be worth a level
+    EXPECT_TRUE(meshes[1].lods.empty());
+}
+
+TEST_F(MeshLodTest, SelectsCoarsestLevelWithHysteresis) {
+    const std::vector<MeshLod> lods = { { 0, 300, 0.0f }, { 300, 150, 0.01f }, { 450, 75, 0.1f },
+        { 525, 36, 1.0f } };
+
+    EXPECT_EQ(select_lod(lods, 5.0f, 0), 2u);
+    EXPECT_EQ(select_lod(lods, 5.0f, 3), 2u);
+    EXPECT_EQ(select_lod(lods, 0.5f, 0), 3u);
+    EXPECT_EQ(select_lod(lods, 1000.0f, 3), 0u);
+
+    // level 2 shows 0.9 pixels: kept once drawn, not switched to from finer levels
+    EXPECT_EQ(select_lod(lods, 9.0f, 2), 2u);
+    EXPECT_EQ(select_lod(lods, 9.0f, 0), 1u);
+    EXPECT_EQ(select_lod(lods, 9.0f, 2, 1.0f, 0.0f), 2u);
+    EXPECT_EQ(select_lod(lods, 9.0f, 0, 1.0f, 0.0f), 2u);
+
+    // a level that is gone after a reload is clamped
+    EXPECT_EQ(select_lod(std::span(lods).first(2), 5.0f, 3), 1u);
+    EXPECT_EQ(select_lod({}, 5.0f, 3), 0u);
+}
+
+TEST_F(MeshLodTest, ProjectsObjectUnitsToPixels) {
+    // a 90 degree field of view sees 2 units across at distance 1
+    EXPECT_NEAR(lod_pixels_per_unit(std::numbers::pi_v<F32> * 0.5f, 1000.0f, 1.0f), 500.0f, 1e-2f);
+    EXPECT_NEAR(lod_pixels_per_unit(std::numbers::pi_v<F32> * 0.5f, 1000.0f, 10.0f), 50.0f, 1e-3f);
+}
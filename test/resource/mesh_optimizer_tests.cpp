@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <vector>
+#include <resource/mesh_optimizer.hpp>
+#include <core/concurrency/job_system.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+MeshVertex vertex(F32 x, F32 y, F32 z = 0.0f) { return { { x, y, z }, { 1.0f, 1.0f, 1.0f }, { x, y } }; }
+
+// size x size quads with shared vertices, triangles shuffled
+MeshData shuffled_grid(U32 size) {
+    MeshData mesh = make_grid(size);
+    std::vector<std::array<U32, 3>> triangles;
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        triangles.push_back({ mesh.indices[i], mesh.indices[i + 1], mesh.indices[i + 2] });
+    }
+    U32 state = 12345;
+    for (size_t i = triangles.size() - 1; i > 0; --i) {
+        state = state * 1664525u + 1013904223u;
+        std::swap(triangles[i], triangles[state % (i + 1)]);
+    }
+    mesh.indices.clear();
+    for (const auto& triangle : triangles) {
+        mesh.indices.insert(mesh.indices.end(), triangle.begin(), triangle.end());
+    }
+    return mesh;
+}
+
+// Triangles by their vertices, in a canonical order, to compare meshes
+// whatever their triangle and vertex order.
+std::vector<std::array<MeshVertex, 3>> triangle_set(const MeshData& mesh) {
+    std::vector<std::array<MeshVertex, 3>> triangles;
+    for (size_t i = 0; i < mesh.indices.size(); i += 3) {
+        std::array<MeshVertex, 3> triangle { mesh.vertices[mesh.indices[i]],
+            mesh.vertices[mesh.indices[i + 1]], mesh.vertices[mesh.indices[i + 2]] };
+        // rotate the smallest vertex first, keeping the winding
+        auto less = [](const MeshVertex& a, const MeshVertex& b) { return a.position < b.position; };
+        std::rotate(triangle.begin(), std::min_element(triangle.begin(), triangle.end(), less),
+            triangle.end());
+        triangles.push_back(triangle);
+    }
+    std::sort(triangles.begin(), triangles.end(), [](const auto& a, const auto& b) {
+        for (U32 k = 0; k < 3; ++k) {
+            if (a[k].position != b[k].position) {
+                return a[k].position < b[k].position;
+            }
+        }
+        return false;
+    });
+    return triangles;
+}
+
+} // namespace
+
+class MeshOptimizerTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+};
+
+TEST_F(MeshOptimizerTest, CountsFifoCacheMisses) {
+    // two triangles sharing an edge shade four vertices
+    const std::vector<U32> quad = { 0, 1, 2, 2, 1, 3 };
+    VertexCacheStats stats = analyze_vertex_cache(quad, 4);
+    EXPECT_EQ(stats.triangles, 2u);
+    EXPECT_EQ(stats.vertices, 4u);
+    EXPECT_EQ(stats.transforms, 4u);
+    EXPECT_DOUBLE_EQ(stats.acmr(), 2.0);
+    EXPECT_DOUBLE_EQ(stats.atvr(), 1.0);
+
+    // with a cache of three, vertex 0 is gone by the time it comes back
+    const std::vector<U32> strip = { 0, 1, 2, 3, 4, 5, 0, 1, 2 };
+    stats = analyze_vertex_cache(strip, 6, 3);
+    EXPECT_EQ(stats.transforms, 9u);
+    stats = analyze_vertex_cache(strip, 6, 6);
+    EXPECT_EQ(stats.transforms, 6u);
+}
+
+TEST_F(MeshOptimizerTest, MergesIdenticalVertices) {
+    MeshData mesh;
+    mesh.vertices = { vertex(0, 0), vertex(1, 0), vertex(0, 1), vertex(0, 1), vertex(1, 0),
+        vertex(1, 1) };
+    mesh.indices = { 0, 1, 2, 3, 4, 5 };
+
+    deduplicate_vertices(mesh);
+    ASSERT_EQ(mesh.vertices.size(), 4u);
+    EXPECT_EQ(mesh.indices, (std::vector<U32> { 0, 1, 2, 2, 1, 3 }));
+    EXPECT_EQ(mesh.vertices[3], vertex(1, 1));
+}
+
+TEST_F(MeshOptimizerTest, VertexCacheOrderKeepsTrianglesAndCutsMisses) {
+    MeshData mesh = shuffled_grid(32);
+    const auto triangles = triangle_set(mesh);
+    const VertexCacheStats before = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+
+    const std::vector<U32> clusters = optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+    ASSERT_FALSE(clusters.empty());
+    EXPECT_EQ(clusters[0], 0u);
+    EXPECT_TRUE(std::is_sorted(clusters.begin(), clusters.end()));
+    EXPECT_EQ(triangle_set(mesh), triangles);
+
+    const VertexCacheStats after = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+    EXPECT_GT(before.acmr(), 1.5);
+    EXPECT_LT(after.acmr(), 0.8);
+    EXPECT_LT(after.atvr(), 1.5);
+}
+
+TEST_F(MeshOptimizerTest, OverdrawDrawsOutwardFacingClustersFirst) {
+    // both face +z, the one in front of the center is the likely occluder
+    const std::vector<MeshVertex> vertices = { vertex(0, 0, -1), vertex(1, 0, -1),
+        vertex(0, 1, -1), vertex(0, 0, 1), vertex(1, 0, 1), vertex(0, 1, 1) };
+    std::vector<U32> indices = { 0, 1, 2, 3, 4, 5 };
+    const std::vector<U32> clusters = { 0, 1 };
+
+    optimize_overdraw(indices, vertices, clusters);
+    EXPECT_EQ(indices, (std::vector<U32> { 3, 4, 5, 0, 1, 2 }));
+}
+
+TEST_F(MeshOptimizerTest, FetchOrderFollowsFirstUse) {
+    MeshData mesh;
+    mesh.vertices = { vertex(0, 0), vertex(1, 0), vertex(0, 1), vertex(5, 5) };
+    mesh.indices = { 2, 0, 1 };
+
+    optimize_vertex_fetch(mesh);
+    EXPECT_EQ(mesh.indices, (std::vector<U32> { 0, 1, 2 }));
+    EXPECT_EQ(mesh.vertices, (std::vector<MeshVertex> { vertex(0, 1), vertex(0, 0), vertex(1, 0) }));
+}
+
+TEST_F(MeshOptimizerTest, OptimizingMeshesOnJobsReportsBothSides) {
+    std::vector<MeshData> meshes = { shuffled_grid(16), shuffled_grid(24) };
+    // a point list is left alone
+    meshes.push_back({ { vertex(0, 0), vertex(1, 1) }, { 0, 1 }, 0, {}, {} });
+    const auto first = triangle_set(meshes[0]);
+
+    Core::JobPool jobs;
+    const MeshOptimizeStats stats = optimize_meshes(meshes, &jobs);
+    EXPECT_EQ(stats.before.triangles, stats.after.triangles);
+    EXPECT_LT(stats.after.acmr(), stats.before.acmr());
+    EXPECT_LT(stats.after.atvr(), stats.before.atvr());
+
+    EXPECT_EQ(triangle_set(meshes[0]), first);
+    EXPECT_EQ(meshes[2].indices, (std::vector<U32> { 0, 1 }));
+}
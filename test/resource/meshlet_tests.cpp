@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <set>
+#include <vector>
+#include <resource/meshlet.hpp>
+#include <core/concurrency/job_system.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+// Triangles rotated to start at their smallest index, keeping the winding.
+std::multiset<std::array<U32, 3>> triangle_set(std::span<const U32> indices) {
+    std::multiset<std::array<U32, 3>> triangles;
+    for (size_t i = 0; i < indices.size(); i += 3) {
+        std::array<U32, 3> t { indices[i], indices[i + 1], indices[i + 2] };
+        std::rotate(t.begin(), std::min_element(t.begin(), t.end()), t.end());
+        triangles.insert(t);
+    }
+    return triangles;
+}
+
+Meshlet meshlet(U32 firstIndex, std::array<F32, 4> bounds, std::array<F32, 4> cone) {
+    return { firstIndex, 3, bounds, cone };
+}
+
+} // namespace
+
+class MeshletTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+};
+
+TEST_F(MeshletTest, SplitsWithinLimitsKeepingEveryTriangle) {
+    MeshData mesh = make_grid(32);
+    const auto triangles = triangle_set(mesh.indices);
+
+    const std::vector<Meshlet> meshlets = build_meshlets(mesh.indices, mesh.vertices);
+    EXPECT_EQ(triangle_set(mesh.indices), triangles);
+    // 8 x 8 vertices hold 98 triangles of the grid, a few meshlets more than
+    // 2048 / 98 are left at the borders
+    EXPECT_LT(meshlets.size(), 40u);
+
+    U32 next = 0;
+    for (const Meshlet& m : meshlets) {
+        EXPECT_EQ(m.firstIndex, next);
+        EXPECT_EQ(m.indexCount % 3, 0u);
+        EXPECT_LE(m.indexCount / 3, MeshletMaxTriangles);
+        const auto begin = mesh.indices.begin() + m.firstIndex;
+        const std::set<U32> used(begin, begin + m.indexCount);
+        EXPECT_LE(used.size(), MeshletMaxVertices);
+
+        // the sphere holds every vertex, the cone of a flat patch is a line
+        for (U32 v : used) {
+            const auto& p = mesh.vertices[v].position;
+            F32 distance = 0.0f;
+            for (U32 k = 0; k < 3; ++k) {
+                distance += (p[k] - m.bounds[k]) * (p[k] - m.bounds[k]);
+            }
+            distance = std::sqrt(distance);
+            EXPECT_LE(distance, m.bounds[3] + 1e-4f);
+        }
+        EXPECT_NEAR(m.cone[2], 1.0f, 1e-5f);
+        EXPECT_NEAR(m.cone[3], 0.0f, 1e-3f);
+        next += m.indexCount;
+    }
+    EXPECT_EQ(next, mesh.indices.size());
+}
+
+TEST_F(MeshletTest, BuildsMeshesOnJobsAndPackingRebasesThem) {
+    std::vector<MeshData> meshes = { make_grid(8), make_grid(16) };
+    Core::JobPool jobs;
+    build_meshlets(meshes, &jobs);
+    ASSERT_FALSE(meshes[0].meshlets.empty());
+    ASSERT_FALSE(meshes[1].meshlets.empty());
+
+    const PackedGeometry packed = pack_meshes(meshes);
+    ASSERT_EQ(packed.meshlets.size(), meshes[0].meshlets.size() + meshes[1].meshlets.size());
+    EXPECT_EQ(packed.meshes[1].firstMeshlet, meshes[0].meshlets.size());
+    EXPECT_EQ(packed.meshes[1].meshletCount, meshes[1].meshlets.size());
+    const Meshlet& first = packed.meshlets[packed.meshes[1].firstMeshlet];
+    EXPECT_EQ(first.firstIndex, packed.meshes[1].firstIndex);
+}
+
+TEST_F(MeshletTest, CullsOutsideTheFrustumAndFacingAway) {
+    // the identity clip matrix sees -1 <= x, y <= 1 and 0 <= z <= 1
+    std::array<F32, 16> clip {};
+    clip[0] = clip[5] = clip[10] = clip[15] = 1.0f;
+    const ClusterView view = make_cluster_view(clip, { 0.0f, 0.0f, -5.0f });
+
+    const std::vector<Meshlet> meshlets = {
+        meshlet(0, { 0.0f, 0.0f, 0.5f, 0.1f }, { 0.0f, 0.0f, 1.0f, 0.1f }), // faces away
+        meshlet(3, { 0.0f, 0.0f, 0.5f, 0.1f }, { 0.0f, 0.0f, -1.0f, 0.1f }),
+        meshlet(6, { 1.05f, 0.0f, 0.5f, 0.1f }, { 0.0f, 0.0f, -1.0f, 0.1f }), // crosses x = 1
+        meshlet(9, { 5.0f, 0.0f, 0.5f, 0.1f }, { 0.0f, 0.0f, -1.0f, 0.1f }), // outside
+        meshlet(12, { 0.0f, 0.0f, 0.5f, 0.1f }, { 0.0f, 0.0f, 1.0f, 1.0f }), // normals all around
+    };
+
+    std::vector<IndexRange> ranges;
+    EXPECT_EQ(cull_meshlets(meshlets, view, ranges), 3u);
+    ASSERT_EQ(ranges.size(), 2u);
+    EXPECT_EQ(ranges[0].firstIndex, 3u);
+    EXPECT_EQ(ranges[0].indexCount, 6u);
+    EXPECT_EQ(ranges[1].firstIndex, 12u);
+    EXPECT_EQ(ranges[1].indexCount, 3u);
+}
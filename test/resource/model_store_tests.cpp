@@ -0,0 +1,362 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <vector>
+#include <resource/material_store.hpp>
+#include <resource/mesh_file.hpp>
+#include <resource/model_store.hpp>
+#include <resource/texture_store.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+MeshData quad(U32 materialIndex) {
+    MeshData mesh;
+    for (F32 y : { 0.0f, 1.0f }) {
+        for (F32 x : { 0.0f, 1.0f }) {
+            mesh.vertices.push_back({ { x, y, 0.0f }, { 1.0f, 1.0f, 1.0f }, { x, y } });
+        }
+    }
+    mesh.indices = { 0, 1, 2, 2, 1, 3 };
+    mesh.materialIndex = materialIndex;
+    return mesh;
+}
+
+// two quads sharing one material, one quad with its own
+ModelData two_material_model() {
+    ModelData data;
+    data.meshes = { quad(0), quad(0), quad(1) };
+    data.materials = { { "shared", "" }, { "other", "" } };
+    return data;
+}
+
+// Waits until every import job has been handed back, then polls once.
+template <typename Store, typename H> size_t poll_all(Store& store, std::vector<H>& ready) {
+    while (store.loads_in_flight() > 0) {
+        std::this_thread::yield();
+    }
+    return store.poll_loads(ready);
+}
+
+} // namespace
+
+class ModelStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        materials.set_default_texture(
+            textures.acquire("white", TextureData { 1, 1, { 255, 255, 255, 255 } }));
+    }
+
+    void TearDown() override { Core::Logger::shutdown(); }
+
+    MockBackend backend;
+    TextureStore textures { backend };
+    MaterialStore materials { textures };
+    ModelStore models { backend, materials };
+};
+
+TEST_F(ModelStoreTest, PacksMeshesIntoOneUpload) {
+    ModelHandle h = models.load("model", two_material_model());
+    const Model* model = models.get(h);
+    ASSERT_NE(model, nullptr);
+    ASSERT_EQ(model->meshes.size(), 3u);
+    EXPECT_EQ(model->materials.size(), 2u);
+
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    EXPECT_EQ(backend.vertices.size(), 12u);
+    EXPECT_EQ(backend.indices.size(), 18u);
+
+    const Mesh* third = models.get(model->meshes[2]);
+    EXPECT_EQ(third->firstIndex, 12u);
+    EXPECT_EQ(third->indexCount, 6u);
+    EXPECT_EQ(third->vertexOffset, 8);
+    EXPECT_EQ(third->geometry, model->geometry);
+    EXPECT_EQ(third->material, model->materials[1]);
+    EXPECT_EQ(models.get(model->meshes[0])->material, model->materials[0]);
+
+    // both materials use the default texture
+    EXPECT_EQ(materials.get(model->materials[1])->diffuseTexture,
+        materials.get(model->materials[0])->diffuseTexture);
+}
+
+TEST_F(ModelStoreTest, UploadsCompactVerticesWhenEnabled) {
+    models.set_compact_vertices(true);
+    ModelData data = two_material_model();
+    for (MeshVertex& vertex : data.meshes[2].vertices) {
+        vertex.position[0] = vertex.position[0] * 4.0f - 2.0f;
+    }
+    const Model* model = models.get(models.load("model", data));
+    ASSERT_NE(model, nullptr);
+
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    EXPECT_TRUE(backend.vertices.empty());
+    EXPECT_EQ(backend.compactVertices.size(), 12u);
+    EXPECT_TRUE(backend.colors.empty());
+    EXPECT_EQ(backend.indices.size(), 18u);
+
+    // the third quad spans -2 to 2 along x, the model matrix scales it back
+    const Mesh* third = models.get(model->meshes[2]);
+    EXPECT_EQ(third->quantization.offset, (std::array<F32, 3> { -2.0f, 0.0f, 0.0f }));
+    EXPECT_EQ(third->quantization.scale, (std::array<F32, 3> { 4.0f, 1.0f, 1.0f }));
+    const CompactVertex& corner = backend.compactVertices[third->vertexOffset + 3];
+    EXPECT_EQ(corner.position, (std::array<U16, 4> { 0xFFFF, 0xFFFF, 0, 0 }));
+}
+
+TEST_F(ModelStoreTest, HundredCopiesShareOneImport) {
+    std::vector<ModelHandle> copies;
+    for (int i = 0; i < 100; ++i) {
+        copies.push_back(models.load("model", two_material_model()));
+    }
+
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    EXPECT_EQ(models.size(), 1u);
+    EXPECT_EQ(models.mesh_count(), 3u);
+    EXPECT_EQ(materials.size(), 2u);
+    EXPECT_EQ(models.get(copies[0])->refCount, 100u);
+
+    for (int i = 0; i < 99; ++i) {
+        models.release(copies[i]);
+    }
+    EXPECT_EQ(backend.geometryReleases, 0u);
+
+    models.release(copies[99]);
+    EXPECT_EQ(backend.geometryReleases, 1u);
+    EXPECT_EQ(models.get(copies[0]), nullptr);
+    EXPECT_EQ(models.mesh_count(), 0u);
+    EXPECT_EQ(materials.size(), 0u);
+
+    // loading it again imports again
+    models.load("model", two_material_model());
+    EXPECT_EQ(backend.geometryUploads, 2u);
+}
+
+TEST_F(ModelStoreTest, ReleasingModelsReleasesTheirTextures) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_tests";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "albedo.ppm", std::ios::binary);
+        file << "P6\n1 1\n255\n" << '\x80' << '\x80' << '\x80';
+    }
+
+    ModelData a = two_material_model();
+    a.materials[0].diffusePath = (dir / "albedo.ppm").string();
+    ModelData b = a;
+
+    ModelHandle ha = models.load("a", a);
+    ModelHandle hb = models.load("b", b);
+    EXPECT_EQ(backend.textureUploads, 2u); // white + albedo, shared by both models
+
+    const TextureHandle albedo = materials.get(models.get(ha)->materials[0])->diffuseTexture;
+    EXPECT_EQ(textures.get(albedo)->refCount, 2u);
+
+    models.release(ha);
+    EXPECT_EQ(textures.get(albedo)->refCount, 1u);
+    models.release(hb);
+    EXPECT_EQ(textures.get(albedo)->refCount, 0u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ModelStoreTest, LoadsTexturesInParallelOnJobs) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_parallel";
+    std::filesystem::create_directories(dir);
+    for (const char* name : { "a.ppm", "b.ppm" }) {
+        std::ofstream file(dir / name, std::ios::binary);
+        file << "P6\n1 1\n255\n" << name[0] << '\x80' << '\x80';
+    }
+
+    // a cooked model, three materials over two textures, one of them missing
+    const std::filesystem::path source = dir / "model.obj";
+    {
+        std::ofstream file(source);
+        file << "source";
+    }
+    ModelData data;
+    data.meshes = { quad(0), quad(1), quad(2), quad(3) };
+    data.materials = { { "a", (dir / "a.ppm").string() }, { "b", (dir / "b.ppm").string() },
+        { "a again", (dir / "a.ppm").string() }, { "broken", (dir / "missing.ppm").string() } };
+    const PackedGeometry packed = pack_meshes(data.meshes);
+    ASSERT_TRUE(write_mesh_file(
+        cooked_mesh_path(source), data.materials, packed.view(), hash_source_file(source)));
+
+    Core::JobPool jobs;
+    ModelHandle h = models.load(jobs, source);
+    ASSERT_TRUE(h);
+    EXPECT_EQ(models.get(h)->state, LoadState::Ready);
+    EXPECT_EQ(backend.textureUploads, 3u); // white + a + b
+
+    const Model* model = models.get(h);
+    ASSERT_EQ(model->materials.size(), 4u);
+    const TextureHandle a = materials.get(model->materials[0])->diffuseTexture;
+    EXPECT_EQ(materials.get(model->materials[2])->diffuseTexture, a);
+    EXPECT_EQ(textures.get(a)->state, LoadState::Ready);
+    EXPECT_EQ(textures.get(a)->refCount, 2u);
+    EXPECT_NE(materials.get(model->materials[1])->diffuseTexture, a);
+    // the missing texture falls back to the default one
+    const TextureHandle white = textures.acquire("white", TextureData { 1, 1, { 255, 255, 255, 255 } });
+    EXPECT_EQ(materials.get(model->materials[3])->diffuseTexture, white);
+    textures.release(white);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ModelStoreTest, ImportsObjOnceByNormalizedPath) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_obj";
+    std::filesystem::create_directories(dir / "sub");
+    {
+        std::ofstream file(dir / "quad.obj");
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+             << "vt 0 0\nvt 1 0\nvt 0 1\nvt 1 1\n"
+             << "f 1/1 2/2 4/4 3/3\n";
+    }
+
+    ModelHandle a = models.load(dir / "quad.obj");
+    ModelHandle b = models.load(dir / "sub" / ".." / "quad.obj");
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    ASSERT_EQ(models.get(a)->meshes.size(), 1u);
+    EXPECT_EQ(models.get(models.get(a)->meshes[0])->indexCount, 6u);
+
+    EXPECT_FALSE(models.load(dir / "missing.obj"));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ModelStoreTest, FailedAsyncLoadKeepsResolvingToThePlaceholder) {
+    Core::JobPool jobs;
+    ModelHandle placeholder = models.load("placeholder", two_material_model());
+    models.set_placeholder(placeholder);
+
+    ModelHandle h = models.load_async(jobs, "/nonexistent/model.obj");
+    ASSERT_TRUE(h);
+    EXPECT_EQ(models.get(h)->state, LoadState::Loading);
+    EXPECT_EQ(models.resolve(h), models.get(placeholder));
+    EXPECT_EQ(models.load_async(jobs, "/nonexistent/../nonexistent/model.obj"), h);
+
+    std::vector<ModelHandle> ready;
+    EXPECT_EQ(poll_all(models, ready), 0u);
+    EXPECT_EQ(models.get(h)->state, LoadState::Failed);
+    EXPECT_EQ(models.resolve(h), models.get(placeholder));
+    EXPECT_EQ(backend.geometryUploads, 1u);
+
+    models.release(h);
+    models.release(h);
+    EXPECT_EQ(models.get(h), nullptr);
+    EXPECT_EQ(models.size(), 1u);
+}
+
+TEST_F(ModelStoreTest, ImportsObjAsynchronously) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_async";
+    std::filesystem::create_directories(dir);
+    {
+        std::ofstream file(dir / "quad.obj");
+        file << "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\n"
+             << "f 1 2 4 3\n";
+    }
+
+    Core::JobPool jobs;
+    ModelHandle h = models.load_async(jobs, dir / "quad.obj");
+    EXPECT_EQ(models.resolve(h), nullptr); // no placeholder set
+    EXPECT_EQ(backend.geometryUploads, 0u);
+
+    std::vector<ModelHandle> ready;
+    EXPECT_EQ(poll_all(models, ready), 1u);
+    EXPECT_EQ(ready[0], h);
+    EXPECT_EQ(models.resolve(h), models.get(h));
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    EXPECT_EQ(models.get(models.get(h)->meshes[0])->indexCount, 6u);
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ModelStoreTest, LoadsCurrentCookedFileWithoutImporting) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_cooked";
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path source = dir / "model.obj";
+    {
+        // not a model any importer reads, only the cooked file can load it
+        std::ofstream file(source);
+        file << "source v1";
+    }
+
+    const ModelData data = two_material_model();
+    const PackedGeometry packed = pack_meshes(data.meshes);
+    ASSERT_TRUE(write_mesh_file(
+        cooked_mesh_path(source), data.materials, packed.view(), hash_source_file(source)));
+
+    ModelHandle h = models.load(source);
+    ASSERT_TRUE(h);
+    EXPECT_EQ(models.get(h)->meshes.size(), 3u);
+    EXPECT_EQ(backend.vertices, packed.vertices);
+    EXPECT_EQ(backend.indices, packed.indices);
+    models.release(h);
+
+    // the cooked file can be loaded by itself as well
+    ModelHandle cooked = models.load(cooked_mesh_path(source));
+    ASSERT_TRUE(cooked);
+    models.release(cooked);
+
+    // a changed source invalidates the cooked file and goes back to the importer
+    {
+        std::ofstream file(source);
+        file << "source v2";
+    }
+    EXPECT_FALSE(models.load(source));
+
+    std::filesystem::remove_all(dir);
+}
+
+TEST_F(ModelStoreTest, ReloadRebuildsAChangedModel) {
+    std::filesystem::path dir = std::filesystem::temp_directory_path() / "vge_model_store_reload";
+    std::filesystem::create_directories(dir);
+    const std::filesystem::path source = dir / "model.obj";
+    auto cook = [&](const char* contents, const ModelData& data) {
+        {
+            std::ofstream file(source);
+            file << contents;
+        }
+        const PackedGeometry packed = pack_meshes(data.meshes);
+        ASSERT_TRUE(write_mesh_file(
+            cooked_mesh_path(source), data.materials, packed.view(), hash_source_file(source)));
+    };
+
+    cook("source v1", two_material_model());
+    ModelHandle h = models.load(source);
+    ASSERT_TRUE(h);
+    const MeshHandle firstMesh = models.get(h)->meshes[0];
+
+    Core::JobPool jobs;
+    std::vector<ModelHandle> ready;
+    ModelData smaller;
+    smaller.meshes = { quad(0) };
+    smaller.materials = { { "only", "" } };
+    cook("source v2", smaller);
+
+    EXPECT_EQ(models.reload(jobs, source), 1u);
+    EXPECT_EQ(models.get(h)->meshes.size(), 3u); // until polled
+    EXPECT_EQ(poll_all(models, ready), 1u);
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0], h);
+    EXPECT_EQ(models.get(h)->meshes.size(), 1u);
+    EXPECT_EQ(models.get(firstMesh), nullptr);
+    EXPECT_EQ(models.mesh_count(), 1u);
+    EXPECT_EQ(materials.size(), 1u);
+    EXPECT_EQ(backend.geometryUploads, 2u);
+    EXPECT_EQ(backend.geometryReleases, 1u);
+
+    // the cooked file written for a source that did not change rebuilds nothing
+    EXPECT_EQ(models.reload(jobs, cooked_mesh_path(source)), 1u);
+    EXPECT_EQ(poll_all(models, ready), 0u);
+    EXPECT_EQ(models.reload(jobs, dir / "other.obj"), 0u);
+    EXPECT_EQ(backend.geometryUploads, 2u);
+
+    models.release(h);
+    std::filesystem::remove_all(dir);
+}
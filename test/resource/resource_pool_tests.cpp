@@ -1,5 +1,7 @@
 #include <gtest/gtest.h>
+#include <memory>
 #include <resource/resource_pool.hpp>
+#include <resource/deletion_queue.hpp>
 #include <resource/handle.hpp>
 #include <core/logger.hpp>
 
@@ -225,3 +227,73 @@ TEST_F(ResourcePoolTest, StressTestAllocFreePattern) {
 
     EXPECT_EQ(pool.size(), 100u);
 }
+
+TEST_F(ResourcePoolTest, AddressesStayStableWhilePoolGrows) {
+    Handle first = pool.allocate(MockResource { 1, "first" });
+    MockResource* cached = pool.get(first);
+
+    std::vector<Handle> handles;
+    for (int i = 0; i < 5000; ++i) {
+        handles.push_back(pool.allocate(MockResource { i, "grow" }));
+    }
+    for (size_t i = 0; i < handles.size(); i += 3) {
+        pool.free(handles[i]);
+    }
+
+    EXPECT_EQ(pool.get(first), cached);
+    EXPECT_EQ(cached->value, 1);
+    EXPECT_EQ(cached->name, "first");
+}
+
+TEST_F(ResourcePoolTest, ReservePreallocatesChunks) {
+    pool.reserve(1000);
+    const size_t capacity = pool.capacity();
+    EXPECT_GE(capacity, 1000u);
+
+    for (int i = 0; i < 1000; ++i) {
+        pool.allocate(MockResource { i, "reserved" });
+    }
+    EXPECT_EQ(pool.capacity(), capacity);
+}
+
+TEST_F(ResourcePoolTest, RetireDefersDestructionUntilFrameCompletes) {
+    DeletionQueue queue;
+    auto tracked = std::make_shared<int>(0);
+    ResourcePool<std::shared_ptr<int>> gpuPool;
+
+    Handle h = gpuPool.insert(tracked);
+    gpuPool.retire(h, queue, 5);
+
+    // the handle dies right away, the value lives until frame 5 completes
+    EXPECT_EQ(gpuPool.get(h), nullptr);
+    EXPECT_EQ(gpuPool.size(), 0u);
+    EXPECT_EQ(tracked.use_count(), 2);
+
+    // a forged handle with the bumped generation does not see the value
+    EXPECT_EQ(gpuPool.get(Handle::make(h.index(), h.gen() + 1)), nullptr);
+
+    // the slot is not recycled while the value waits
+    Handle other = gpuPool.insert(tracked);
+    EXPECT_NE(other.index(), h.index());
+
+    queue.collect(4);
+    EXPECT_EQ(tracked.use_count(), 3);
+    queue.collect(5);
+    EXPECT_EQ(tracked.use_count(), 2);
+
+    Handle reused = gpuPool.insert(tracked);
+    EXPECT_EQ(reused.index(), h.index());
+    EXPECT_EQ(reused.gen(), h.gen() + 1);
+}
+
+TEST_F(ResourcePoolTest, RetireOrFreeTwiceIsRejected) {
+    DeletionQueue queue;
+    Handle h = pool.emplace(1, "retired");
+    pool.retire(h, queue, 1);
+    pool.retire(h, queue, 1);
+    pool.free(h);
+
+    EXPECT_EQ(queue.size(), 1u);
+    queue.flush();
+    EXPECT_EQ(pool.size(), 0u);
+}
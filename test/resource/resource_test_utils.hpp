@@ -0,0 +1,111 @@
+#pragma once
+
+// Helpers shared by the resource tests.
+
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+#include <resource/model_data.hpp>
+#include <resource/model_store.hpp>
+#include <resource/texture_store.hpp>
+
+namespace ResourceTest {
+
+using namespace Resource;
+
+// Counts and remembers what the stores upload. Every format is accepted
+// unless supportsBc is cleared, a texture costs the bytes of its levels.
+class MockBackend : public TextureBackend, public GeometryBackend {
+public:
+    GpuTextureInfo upload_texture(const TextureImage& image, const TextureDescriptor&) override {
+        textureUploads++;
+        format = image.format;
+        levels = image.levels.size();
+        return { Handle::make(textureUploads, 1), static_cast<U32>(levels), image.data.size() };
+    }
+    void release_texture(Handle texture) override { releasedTextures.push_back(texture.index()); }
+    bool supports_format(PixelFormat f) const override {
+        return f == PixelFormat::RGBA8 || supportsBc;
+    }
+
+    Handle upload_geometry(std::span<const MeshVertex> v, std::span<const U32> i) override {
+        geometryUploads++;
+        vertexCount = v.size();
+        vertices.assign(v.begin(), v.end());
+        indices.assign(i.begin(), i.end());
+        return Handle::make(geometryUploads, 1);
+    }
+    Handle upload_compact_geometry(std::span<const CompactVertex> v,
+        std::span<const VertexColor> c, std::span<const U32> i) override {
+        geometryUploads++;
+        vertexCount = v.size();
+        compactVertices.assign(v.begin(), v.end());
+        colors.assign(c.begin(), c.end());
+        indices.assign(i.begin(), i.end());
+        return Handle::make(geometryUploads, 1);
+    }
+    void release_geometry(Handle) override { geometryReleases++; }
+
+    bool supportsBc = true;
+    U32 textureUploads = 0;
+    std::vector<U32> releasedTextures; // handle indices
+    PixelFormat format = PixelFormat::RGBA8; // of the last upload
+    size_t levels = 0;
+
+    U32 geometryUploads = 0;
+    U32 geometryReleases = 0;
+    size_t vertexCount = 0;
+    std::vector<MeshVertex> vertices;
+    std::vector<CompactVertex> compactVertices;
+    std::vector<VertexColor> colors;
+    std::vector<U32> indices;
+};
+
+// A 2x2 binary PPM, the simplest format stb_image decodes, every channel value.
+inline void write_ppm(const std::filesystem::path& path, U8 value) {
+    std::ofstream file(path, std::ios::binary);
+    file << "P6\n2 2\n255\n";
+    for (int i = 0; i < 2 * 2 * 3; ++i) {
+        file.put(static_cast<char>(value));
+    }
+}
+
+inline F32 flat(F32, F32) { return 0.0f; }
+
+// size x size quads, spacing apart in x and y and two triangles each,
+// counter-clockwise seen from +z. z = height(x, y) and the texture
+// coordinates count quads. With a seam the column of vertices at x = seam is
+// split in two as a UV seam would, the right copies start over at u = 0.
+template <typename Height = F32 (*)(F32, F32)>
+MeshData make_grid(U32 size, F32 spacing = 1.0f, Height height = flat, U32 seam = 0) {
+    MeshData mesh;
+    std::vector<U32> left((size + 1) * (size + 1));
+    std::vector<U32> right(left.size());
+    for (U32 y = 0; y <= size; ++y) {
+        for (U32 x = 0; x <= size; ++x) {
+            const F32 px = F32(x) * spacing;
+            const F32 py = F32(y) * spacing;
+            const F32 z = height(px, py);
+            const U32 v = y * (size + 1) + x;
+            left[v] = right[v] = static_cast<U32>(mesh.vertices.size());
+            mesh.vertices.push_back({ { px, py, z }, { 1.0f, 1.0f, 1.0f }, { F32(x), F32(y) } });
+            if (seam != 0 && x == seam) {
+                right[v] = static_cast<U32>(mesh.vertices.size());
+                mesh.vertices.push_back({ { px, py, z }, { 1.0f, 1.0f, 1.0f }, { 0.0f, F32(y) } });
+            }
+        }
+    }
+    for (U32 y = 0; y < size; ++y) {
+        for (U32 x = 0; x < size; ++x) {
+            const U32 v = y * (size + 1) + x;
+            const std::vector<U32>& side = seam != 0 && x >= seam ? right : left;
+            mesh.indices.insert(mesh.indices.end(),
+                { side[v], side[v + 1], side[v + size + 1], side[v + size + 1], side[v + 1],
+                    side[v + size + 2] });
+        }
+    }
+    return mesh;
+}
+
+} // namespace ResourceTest
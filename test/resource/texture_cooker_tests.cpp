@@ -0,0 +1,262 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <array>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <resource/mesh_file.hpp>
+#include <resource/texture_cooker.hpp>
+#include <resource/texture_file.hpp>
+#include <resource/texture_store.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+U32 read_bits(const U8* block, U32& position, U32 count) {
+    U32 value = 0;
+    for (U32 i = 0; i < count; ++i, ++position) {
+        value |= U32((block[position / 8] >> (position % 8)) & 1) << i;
+    }
+    return value;
+}
+
+// Reference decoder for the only mode the cooker writes.
+std::array<U8, 64> decode_bc7_mode6(const U8* block) {
+    constexpr U32 weights[16] = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55, 60, 64 };
+    U32 position = 0;
+    EXPECT_EQ(read_bits(block, position, 7), 1u << 6);
+
+    U32 endpoints[2][4];
+    for (U32 c = 0; c < 4; ++c) {
+        endpoints[0][c] = read_bits(block, position, 7);
+        endpoints[1][c] = read_bits(block, position, 7);
+    }
+    const U32 p0 = read_bits(block, position, 1);
+    const U32 p1 = read_bits(block, position, 1);
+    for (U32 c = 0; c < 4; ++c) {
+        endpoints[0][c] = (endpoints[0][c] << 1) | p0;
+        endpoints[1][c] = (endpoints[1][c] << 1) | p1;
+    }
+
+    std::array<U8, 64> texels;
+    for (U32 t = 0; t < 16; ++t) {
+        const U32 index = read_bits(block, position, t == 0 ? 3 : 4);
+        for (U32 c = 0; c < 4; ++c) {
+            texels[t * 4 + c] = static_cast<U8>(
+                ((64 - weights[index]) * endpoints[0][c] + weights[index] * endpoints[1][c] + 32)
+                >> 6);
+        }
+    }
+    return texels;
+}
+
+std::array<U8, 16> decode_bc4(const U8* block) {
+    const U32 r0 = block[0], r1 = block[1];
+    U32 palette[8] = { r0, r1 };
+    for (U32 i = 2; i < 8; ++i) {
+        palette[i] = r0 > r1 ? ((8 - i) * r0 + (i - 1) * r1) / 7 : 0;
+    }
+    if (r0 <= r1) {
+        for (U32 i = 2; i < 6; ++i) {
+            palette[i] = ((6 - i) * r0 + (i - 1) * r1) / 5;
+        }
+        palette[6] = 0;
+        palette[7] = 255;
+    }
+
+    U32 position = 16;
+    std::array<U8, 16> values;
+    for (U8& value : values) {
+        value = static_cast<U8>(palette[read_bits(block, position, 3)]);
+    }
+    return values;
+}
+
+int max_error(std::span<const U8> a, std::span<const U8> b) {
+    int error = 0;
+    for (size_t i = 0; i < a.size(); ++i) {
+        error = std::max(error, std::abs(int(a[i]) - int(b[i])));
+    }
+    return error;
+}
+
+} // namespace
+
+class TextureCookerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        dir = std::filesystem::temp_directory_path() / "vge_texture_cooker_tests";
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+        Core::Logger::shutdown();
+    }
+
+    std::filesystem::path dir;
+    MockBackend backend;
+};
+
+TEST_F(TextureCookerTest, MipChainFiltersInLinearSpace) {
+    // black and white columns, half transparent
+    TextureData top { 4, 2, {} };
+    for (U32 i = 0; i < 8; ++i) {
+        const U8 value = i % 2 ? 255 : 0;
+        top.pixels.insert(top.pixels.end(), { value, value, value, value });
+    }
+
+    const std::vector<TextureData> srgb = build_mip_chain(top, true, false);
+    ASSERT_EQ(srgb.size(), 3u);
+    EXPECT_EQ(srgb[1].width, 2u);
+    EXPECT_EQ(srgb[1].height, 1u);
+    EXPECT_EQ(srgb[2].width, 1u);
+    EXPECT_EQ(srgb[2].height, 1u);
+    // half the light is 188 in sRGB, not 128, alpha stays linear
+    EXPECT_EQ(srgb[2].pixels[0], 188);
+    EXPECT_EQ(srgb[2].pixels[3], 128);
+
+    const std::vector<TextureData> linear = build_mip_chain(top, false, false);
+    EXPECT_EQ(linear[2].pixels[0], 128);
+}
+
+TEST_F(TextureCookerTest, MipChainRenormalizesNormals) {
+    // +x and +z average to a unit vector halfway between
+    const TextureData top { 2, 1, { 255, 128, 128, 255, 128, 128, 255, 255 } };
+    const std::vector<TextureData> chain = build_mip_chain(top, false, true);
+    ASSERT_EQ(chain.size(), 2u);
+    EXPECT_NEAR(chain[1].pixels[0], 218, 1);
+    EXPECT_NEAR(chain[1].pixels[1], 128, 1);
+    EXPECT_NEAR(chain[1].pixels[2], 218, 1);
+}
+
+TEST_F(TextureCookerTest, Bc7DecodesCloseToTheSource) {
+    std::array<U8, 64> gradient, solid;
+    for (U32 t = 0; t < 16; ++t) {
+        const U8 v = static_cast<U8>(t * 16);
+        const std::array<U8, 4> texel { v, static_cast<U8>(255 - v), static_cast<U8>(v / 2), 255 };
+        std::copy(texel.begin(), texel.end(), gradient.begin() + t * 4);
+        const std::array<U8, 4> flat { 37, 190, 91, 200 };
+        std::copy(flat.begin(), flat.end(), solid.begin() + t * 4);
+    }
+
+    std::array<U8, 16> block;
+    encode_bc7_block(gradient, block);
+    EXPECT_LE(max_error(decode_bc7_mode6(block.data()), gradient), 8);
+
+    encode_bc7_block(solid, block);
+    EXPECT_LE(max_error(decode_bc7_mode6(block.data()), solid), 1);
+}
+
+TEST_F(TextureCookerTest, Bc5KeepsRedAndGreen) {
+    std::array<U8, 64> texels {};
+    for (U32 t = 0; t < 16; ++t) {
+        texels[t * 4 + 0] = static_cast<U8>(t * 17);
+        texels[t * 4 + 1] = static_cast<U8>(100 + t);
+    }
+
+    std::array<U8, 16> block;
+    encode_bc5_block(texels, block);
+    const std::array<U8, 16> red = decode_bc4(block.data());
+    const std::array<U8, 16> green = decode_bc4(block.data() + 8);
+    for (U32 t = 0; t < 16; ++t) {
+        EXPECT_NEAR(red[t], texels[t * 4 + 0], 19);
+        EXPECT_NEAR(green[t], texels[t * 4 + 1], 2);
+    }
+}
+
+TEST_F(TextureCookerTest, LevelsArePackedAndAligned) {
+    const TextureData top { 5, 3, std::vector<U8>(5 * 3 * 4, 90) };
+
+    const CookedTexture bc7 = cook_texture(top, {});
+    EXPECT_EQ(bc7.format, PixelFormat::BC7);
+    ASSERT_EQ(bc7.levels.size(), 3u); // 5x3, 2x1, 1x1
+    EXPECT_EQ(bc7.levels[0].size, 2u * 16);
+    EXPECT_EQ(bc7.levels[1].offset, 32u);
+    EXPECT_EQ(bc7.levels[2].offset, 48u);
+    EXPECT_EQ(bc7.data.size(), 64u);
+
+    TextureCookOptions uncompressed;
+    uncompressed.compress = false;
+    const CookedTexture rgba = cook_texture(top, uncompressed);
+    for (const TextureLevel& level : rgba.levels) {
+        EXPECT_EQ(level.offset % TextureLevelAlignment, 0u);
+    }
+    EXPECT_EQ(rgba.levels[2].size, 4u);
+
+    TextureCookOptions normals;
+    normals.normalMap = true;
+    EXPECT_EQ(cook_texture(top, normals).format, PixelFormat::BC5);
+}
+
+TEST_F(TextureCookerTest, TextureFileRoundTrips) {
+    const TextureData top { 8, 8, std::vector<U8>(8 * 8 * 4, 200) };
+    const CookedTexture cooked = cook_texture(top, {});
+    const std::filesystem::path path = dir / "albedo.vgetex";
+    ASSERT_TRUE(write_texture_file(path, cooked.image(), TextureFileSrgb, 1234));
+
+    TextureFile file;
+    ASSERT_TRUE(file.open(path));
+    EXPECT_EQ(file.source_hash(), 1234u);
+    EXPECT_EQ(file.format(), PixelFormat::BC7);
+    EXPECT_TRUE(file.srgb());
+    EXPECT_FALSE(file.normal_map());
+
+    const TextureImage image = file.image();
+    EXPECT_EQ(image.width, 8u);
+    ASSERT_EQ(image.levels.size(), 4u);
+    EXPECT_TRUE(std::equal(image.data.begin(), image.data.end(), cooked.data.begin()));
+    file.close();
+
+    // a truncated file is rejected
+    std::filesystem::resize_file(path, std::filesystem::file_size(path) - 16);
+    EXPECT_FALSE(file.open(path));
+}
+
+TEST_F(TextureCookerTest, StoreUsesCurrentCookedFile) {
+    const std::filesystem::path source = dir / "albedo.ppm";
+    write_ppm(source, 120);
+
+    CookedTexture cooked;
+    ASSERT_TRUE(cook_texture_file(source, {}, cooked));
+    ASSERT_TRUE(write_texture_file(
+        cooked_texture_path(source), cooked.image(), TextureFileSrgb, hash_source_file(source)));
+
+    {
+        TextureStore store(backend);
+        ASSERT_TRUE(store.acquire(source));
+        EXPECT_EQ(backend.format, PixelFormat::BC7);
+        EXPECT_EQ(backend.levels, 2u);
+
+        // linear sampling needs another cook, this one decodes the source
+        TextureDescriptor linear;
+        linear.format = TextureDescriptor::Format::RGBA8;
+        ASSERT_TRUE(store.acquire(source, linear));
+        EXPECT_EQ(backend.format, PixelFormat::RGBA8);
+
+        // the cooked file on its own resolves to the same texture as its source
+        EXPECT_EQ(store.acquire(cooked_texture_path(source)), store.acquire(source));
+        EXPECT_EQ(backend.textureUploads, 2u);
+    }
+
+    // without BC support, or once the source changed, the source is decoded
+    {
+        backend.supportsBc = false;
+        TextureStore store(backend);
+        ASSERT_TRUE(store.acquire(source));
+        EXPECT_EQ(backend.format, PixelFormat::RGBA8);
+    }
+    {
+        backend.supportsBc = true;
+        write_ppm(source, 121);
+        TextureStore store(backend);
+        ASSERT_TRUE(store.acquire(source));
+        EXPECT_EQ(backend.format, PixelFormat::RGBA8);
+    }
+}
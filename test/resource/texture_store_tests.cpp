@@ -0,0 +1,328 @@
+#include <gtest/gtest.h>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include <resource/texture_store.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+TextureData solid(U32 size, U8 value) {
+    return { size, size, std::vector<U8>(size * size * 4, value) };
+}
+
+// Waits until every decode job has been handed back, then polls once.
+size_t poll_all(TextureStore& store, std::vector<TextureHandle>& ready) {
+    while (store.loads_in_flight() > 0) {
+        std::this_thread::yield();
+    }
+    return store.poll_loads(ready);
+}
+
+} // namespace
+
+class TextureStoreTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        dir = std::filesystem::temp_directory_path() / "vge_texture_store_tests";
+        std::filesystem::create_directories(dir / "sub");
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+        Core::Logger::shutdown();
+    }
+
+    std::filesystem::path dir;
+    MockBackend backend;
+};
+
+TEST_F(TextureStoreTest, DeduplicatesByPathAndContent) {
+    write_ppm(dir / "albedo.ppm", 200);
+    write_ppm(dir / "copy.ppm", 200);
+    write_ppm(dir / "other.ppm", 10);
+
+    TextureStore store(backend);
+    TextureHandle a = store.acquire(dir / "albedo.ppm");
+    TextureHandle b = store.acquire(dir / "sub" / ".." / "albedo.ppm");
+    TextureHandle c = store.acquire(dir / "copy.ppm");
+    TextureHandle d = store.acquire(dir / "other.ppm");
+
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(a, c);
+    EXPECT_NE(a, d);
+    EXPECT_EQ(backend.textureUploads, 2u);
+    EXPECT_EQ(store.get(a)->refCount, 3u);
+    EXPECT_EQ(store.get(a)->width, 2u);
+
+    // another format is another GPU image
+    TextureDescriptor linear;
+    linear.format = TextureDescriptor::Format::RGBA8;
+    EXPECT_NE(store.acquire(dir / "albedo.ppm", linear), a);
+    EXPECT_EQ(backend.textureUploads, 3u);
+
+    EXPECT_FALSE(store.acquire(dir / "missing.ppm"));
+}
+
+TEST_F(TextureStoreTest, NormalizesSeparators) {
+    EXPECT_EQ(TextureStore::normalize_path("models\\sponza\\./textures/../a.png"),
+        "models/sponza/a.png");
+}
+
+TEST_F(TextureStoreTest, UnusedTexturesStayCachedUntilEvicted) {
+    TextureStore store(backend);
+    TextureHandle h = store.acquire("white", solid(4, 255));
+    store.release(h);
+
+    // still resident, acquiring it again does not upload
+    EXPECT_EQ(store.acquire("white", solid(4, 255)), h);
+    EXPECT_EQ(backend.textureUploads, 1u);
+
+    store.release(h);
+    store.evict_unused();
+    EXPECT_EQ(store.get(h), nullptr);
+    EXPECT_EQ(backend.releasedTextures.size(), 1u);
+    EXPECT_EQ(store.vram_usage(), 0u);
+
+    store.acquire("white", solid(4, 255));
+    EXPECT_EQ(backend.textureUploads, 2u);
+}
+
+TEST_F(TextureStoreTest, EvictsLeastRecentlyReleasedOverBudget) {
+    // three 8x8 textures fit, four do not
+    TextureStore store(backend, 3 * 8 * 8 * 4);
+    TextureHandle t1 = store.acquire("t1", solid(8, 1));
+    TextureHandle t2 = store.acquire("t2", solid(8, 2));
+    TextureHandle t3 = store.acquire("t3", solid(8, 3));
+
+    store.release(t2);
+    store.release(t1);
+    EXPECT_EQ(store.size(), 3u);
+
+    // t2 was released first, it goes first
+    TextureHandle t4 = store.acquire("t4", solid(8, 4));
+    EXPECT_EQ(store.get(t2), nullptr);
+    EXPECT_NE(store.get(t1), nullptr);
+    EXPECT_EQ(backend.releasedTextures, (std::vector<U32> { 2 }));
+
+    // referenced textures are never evicted, the budget is exceeded instead
+    store.add_ref(t1);
+    store.acquire("t5", solid(8, 5));
+    EXPECT_NE(store.get(t1), nullptr);
+    EXPECT_NE(store.get(t3), nullptr);
+    EXPECT_NE(store.get(t4), nullptr);
+    EXPECT_GT(store.vram_usage(), store.vram_budget());
+
+    // unused again while over budget: evicted right away
+    store.release(t1);
+    EXPECT_EQ(store.get(t1), nullptr);
+    EXPECT_EQ(store.vram_usage(), store.vram_budget());
+
+    store.set_vram_budget(0);
+    EXPECT_EQ(store.size(), 3u); // t3, t4 and t5 are still referenced
+}
+
+TEST_F(TextureStoreTest, ClearReleasesEverything) {
+    {
+        TextureStore store(backend);
+        store.acquire("a", solid(2, 1));
+        store.acquire("b", solid(2, 2));
+    }
+    EXPECT_EQ(backend.releasedTextures.size(), 2u);
+}
+
+TEST_F(TextureStoreTest, AsyncAcquireResolvesToPlaceholderUntilPolled) {
+    write_ppm(dir / "albedo.ppm", 200);
+
+    Core::JobPool jobs;
+    TextureStore store(backend);
+    TextureHandle white = store.acquire("white", solid(1, 255));
+    store.set_placeholder(white);
+    const Handle placeholderGpu = store.get(white)->gpu.texture;
+
+    TextureHandle a = store.acquire_async(jobs, dir / "albedo.ppm");
+    TextureHandle b = store.acquire_async(jobs, dir / "sub" / ".." / "albedo.ppm");
+    TextureHandle missing = store.acquire_async(jobs, dir / "missing.ppm");
+    ASSERT_TRUE(a);
+    EXPECT_EQ(a, b);
+    EXPECT_EQ(store.get(a)->state, LoadState::Loading);
+    EXPECT_EQ(store.get(a)->gpu.texture, placeholderGpu);
+    EXPECT_EQ(store.vram_usage(), 4u);
+
+    std::vector<TextureHandle> ready;
+    EXPECT_EQ(poll_all(store, ready), 1u);
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0], a);
+    EXPECT_EQ(backend.textureUploads, 2u);
+
+    EXPECT_EQ(store.get(a)->state, LoadState::Ready);
+    EXPECT_NE(store.get(a)->gpu.texture, placeholderGpu);
+    EXPECT_EQ(store.get(a)->width, 2u);
+    EXPECT_EQ(store.get(a)->refCount, 2u);
+    EXPECT_EQ(store.vram_usage(), 4u + 16u);
+
+    // a failed load keeps the placeholder, dropping it never releases the placeholder's image
+    EXPECT_EQ(store.get(missing)->state, LoadState::Failed);
+    EXPECT_EQ(store.get(missing)->gpu.texture, placeholderGpu);
+    store.release(missing);
+    store.evict_unused();
+    EXPECT_TRUE(backend.releasedTextures.empty());
+
+    // the loaded content is deduplicated against synchronous loads
+    write_ppm(dir / "copy.ppm", 200);
+    EXPECT_EQ(store.acquire(dir / "copy.ppm"), a);
+}
+
+TEST_F(TextureStoreTest, AsyncLoadsOfTheSameBytesUploadOnce) {
+    write_ppm(dir / "albedo.ppm", 200);
+    write_ppm(dir / "sub" / "copy.ppm", 200);
+
+    Core::JobPool jobs;
+    TextureStore store(backend);
+    TextureHandle a = store.acquire_async(jobs, dir / "albedo.ppm");
+    TextureHandle b = store.acquire_async(jobs, dir / "sub" / "copy.ppm");
+    EXPECT_NE(a, b);
+
+    std::vector<TextureHandle> ready;
+    poll_all(store, ready);
+    EXPECT_EQ(ready.size(), 2u);
+    EXPECT_EQ(backend.textureUploads, 1u);
+    EXPECT_EQ(store.size(), 1u);
+    EXPECT_EQ(store.vram_usage(), 16u);
+
+    // both handles resolve to the one texture and keep their references
+    ASSERT_EQ(store.get(a), store.get(b));
+    EXPECT_EQ(store.get(b)->state, LoadState::Ready);
+    EXPECT_EQ(store.get(b)->refCount, 2u);
+    // each path keeps handing out the handle it was loaded under
+    EXPECT_EQ(store.acquire(dir / "albedo.ppm"), a);
+    EXPECT_EQ(store.acquire(dir / "sub" / "copy.ppm"), b);
+    store.release(a);
+    store.release(a);
+    store.release(b);
+    store.release(b);
+    EXPECT_EQ(store.get(b)->refCount, 0u);
+
+    // a reload lists every handle showing the image
+    write_ppm(dir / "albedo.ppm", 10);
+    ready.clear();
+    EXPECT_EQ(store.reload(jobs, dir / "albedo.ppm"), 1u);
+    poll_all(store, ready);
+    EXPECT_EQ(ready.size(), 2u);
+
+    store.evict_unused();
+    EXPECT_EQ(store.get(a), nullptr);
+    EXPECT_EQ(store.get(b), nullptr);
+    EXPECT_EQ(backend.releasedTextures.size(), 2u);
+}
+
+TEST_F(TextureStoreTest, AsyncLoadReleasedBeforeItFinishesIsDropped) {
+    write_ppm(dir / "albedo.ppm", 200);
+
+    Core::JobPool jobs;
+    TextureStore store(backend);
+    TextureHandle h = store.acquire_async(jobs, dir / "albedo.ppm");
+    store.release(h);
+    store.evict_unused();
+    EXPECT_EQ(store.get(h), nullptr);
+
+    std::vector<TextureHandle> ready;
+    EXPECT_EQ(poll_all(store, ready), 0u);
+    EXPECT_EQ(backend.textureUploads, 0u);
+    EXPECT_EQ(store.size(), 0u);
+}
+
+TEST_F(TextureStoreTest, ReloadSwapsTheImageInPlace) {
+    write_ppm(dir / "albedo.ppm", 200);
+
+    Core::JobPool jobs;
+    TextureStore store(backend);
+    TextureHandle h = store.acquire(dir / "albedo.ppm");
+    const Handle before = store.get(h)->gpu.texture;
+
+    // saved without changes, nothing to upload
+    std::vector<TextureHandle> ready;
+    EXPECT_EQ(store.reload(jobs, dir / "sub" / ".." / "albedo.ppm"), 1u);
+    EXPECT_EQ(poll_all(store, ready), 0u);
+    EXPECT_EQ(backend.textureUploads, 1u);
+
+    write_ppm(dir / "albedo.ppm", 10);
+    EXPECT_EQ(store.reload(jobs, dir / "albedo.ppm"), 1u);
+    EXPECT_EQ(store.get(h)->gpu.texture, before); // until polled
+    EXPECT_EQ(poll_all(store, ready), 1u);
+    ASSERT_EQ(ready.size(), 1u);
+    EXPECT_EQ(ready[0], h);
+    EXPECT_NE(store.get(h)->gpu.texture, before);
+    ASSERT_EQ(backend.releasedTextures.size(), 1u);
+    EXPECT_EQ(backend.releasedTextures[0], before.index());
+    EXPECT_EQ(store.vram_usage(), 16u);
+
+    // the new contents are what deduplicates from now on
+    write_ppm(dir / "copy.ppm", 10);
+    EXPECT_EQ(store.acquire(dir / "copy.ppm"), h);
+
+    // a broken file keeps the current image, unrelated files reload nothing
+    {
+        std::ofstream file(dir / "albedo.ppm");
+        file << "not an image";
+    }
+    EXPECT_EQ(store.reload(jobs, dir / "albedo.ppm"), 1u);
+    EXPECT_EQ(poll_all(store, ready), 0u);
+    EXPECT_EQ(store.get(h)->state, LoadState::Ready);
+    EXPECT_EQ(store.reload(jobs, dir / "other.ppm"), 0u);
+}
+
+TEST_F(TextureStoreTest, AcquireAllDecodesInParallelAndUploadsBeforeReturning) {
+    for (int i = 0; i < 8; ++i) {
+        write_ppm(dir / ("albedo" + std::to_string(i) + ".ppm"), static_cast<U8>(i * 20));
+    }
+    write_ppm(dir / "sub" / "copy.ppm", 5 * 20);
+
+    Core::JobPool jobs;
+    TextureStore store(backend);
+    const TextureHandle loaded = store.acquire(dir / "albedo0.ppm");
+    // an asynchronous load started before, still reported by poll_loads()
+    const TextureHandle streaming = store.acquire_async(jobs, dir / "albedo7.ppm");
+
+    std::vector<std::string> paths;
+    for (int i = 0; i < 7; ++i) {
+        paths.push_back((dir / ("albedo" + std::to_string(i) + ".ppm")).string());
+    }
+    paths.push_back((dir / "sub" / ".." / "albedo3.ppm").string());
+    paths.push_back((dir / "missing.ppm").string());
+    paths.push_back((dir / "sub" / "copy.ppm").string());
+
+    std::vector<TextureHandle> out(paths.size());
+    store.acquire_all(jobs, paths, out);
+
+    EXPECT_EQ(out[0], loaded);
+    EXPECT_EQ(store.get(loaded)->refCount, 2u);
+    EXPECT_EQ(out[7], out[3]);
+    EXPECT_EQ(store.get(out[3])->refCount, 2u);
+    EXPECT_FALSE(out[8]);
+    // the same bytes as albedo5 under another name, one texture
+    ASSERT_TRUE(out[9]);
+    EXPECT_EQ(store.get(out[9]), store.get(out[5]));
+    EXPECT_EQ(store.get(out[5])->refCount, 2u);
+    for (size_t i = 0; i < 8; ++i) {
+        ASSERT_TRUE(out[i]);
+        EXPECT_EQ(store.get(out[i])->state, LoadState::Ready);
+        EXPECT_EQ(store.acquire(paths[i]), out[i]);
+    }
+
+    std::vector<TextureHandle> ready;
+    poll_all(store, ready);
+    EXPECT_EQ(ready, (std::vector<TextureHandle> { streaming }));
+    EXPECT_EQ(backend.textureUploads, 8u); // one per image, none for the duplicates or the missing one
+
+    // the failed load is forgotten
+    EXPECT_EQ(store.size(), 8u);
+}
@@ -0,0 +1,133 @@
+#include <gtest/gtest.h>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <random>
+#include <vector>
+#include <resource/vertex_quantization.hpp>
+#include <core/concurrency/job_system.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+std::array<F32, 3> dequantize(const CompactVertex& vertex, const VertexQuantization& q) {
+    std::array<F32, 3> p {};
+    for (U32 k = 0; k < 3; ++k) {
+        p[k] = q.offset[k] + q.scale[k] * (F32(vertex.position[k]) / 65535.0f);
+    }
+    return p;
+}
+
+} // namespace
+
+class VertexQuantizationTest : public ::testing::Test {
+protected:
+    void SetUp() override { Core::Logger::initialize(); }
+    void TearDown() override { Core::Logger::shutdown(); }
+};
+
+TEST_F(VertexQuantizationTest, ConvertsHalfFloats) {
+    EXPECT_EQ(f32_to_f16(0.0f), 0x0000);
+    EXPECT_EQ(f32_to_f16(-0.0f), 0x8000);
+    EXPECT_EQ(f32_to_f16(1.0f), 0x3C00);
+    EXPECT_EQ(f32_to_f16(0.5f), 0x3800);
+    EXPECT_EQ(f32_to_f16(-2.0f), 0xC000);
+    EXPECT_EQ(f32_to_f16(65504.0f), 0x7BFF);
+    EXPECT_EQ(f32_to_f16(65520.0f), 0x7C00); // rounds past the largest half
+    EXPECT_EQ(f32_to_f16(std::ldexp(1.0f, -24)), 0x0001); // smallest subnormal
+    EXPECT_EQ(f32_to_f16(INFINITY), 0x7C00);
+    EXPECT_EQ(f32_to_f16(-INFINITY), 0xFC00);
+    EXPECT_TRUE(std::isnan(f16_to_f32(f32_to_f16(NAN))));
+    // halfway between 1 and the next half rounds to the even one
+    EXPECT_EQ(f32_to_f16(1.0f + std::ldexp(1.0f, -11)), 0x3C00);
+    EXPECT_EQ(f32_to_f16(1.0f + 3.0f * std::ldexp(1.0f, -11)), 0x3C02);
+
+    // the four wide conversion agrees with the scalar one everywhere
+    std::vector<F32> values = { 0.0f, -0.0f, 1.0f, 65504.0f, 65520.0f, 1e6f, INFINITY,
+        -INFINITY, NAN, 6.1e-5f, 6.0e-5f, 1e-8f, -1e-7f, 0.333f, -123.456f };
+    std::mt19937 random(7);
+    std::uniform_real_distribution<F32> exponent(-26.0f, 17.0f);
+    for (int i = 0; i < 4096; ++i) {
+        values.push_back((i % 2 ? -1.0f : 1.0f) * std::exp2(exponent(random)));
+    }
+    std::vector<U16> halves(values.size());
+    f32_to_f16(values, halves);
+    for (size_t i = 0; i < values.size(); ++i) {
+        ASSERT_EQ(halves[i], f32_to_f16(values[i])) << values[i];
+        const F32 back = f16_to_f32(halves[i]);
+        if (std::abs(values[i]) >= 6.1e-5f && std::abs(values[i]) <= 65504.0f) {
+            EXPECT_NEAR(back, values[i], std::abs(values[i]) * (1.0f / 2048.0f)) << values[i];
+        }
+    }
+}
+
+TEST_F(VertexQuantizationTest, EncodesOctahedralNormals) {
+    for (const std::array<F32, 3>& axis : std::vector<std::array<F32, 3>> {
+             { 1, 0, 0 }, { -1, 0, 0 }, { 0, 1, 0 }, { 0, -1, 0 }, { 0, 0, 1 }, { 0, 0, -1 } }) {
+        const std::array<F32, 3> n = decode_octahedral(encode_octahedral(axis));
+        for (U32 k = 0; k < 3; ++k) {
+            EXPECT_NEAR(n[k], axis[k], 1e-4f);
+        }
+    }
+
+    std::mt19937 random(11);
+    std::normal_distribution<F32> gaussian;
+    for (int i = 0; i < 1000; ++i) {
+        std::array<F32, 3> v { gaussian(random), gaussian(random), gaussian(random) };
+        const F32 length = std::sqrt(v[0] * v[0] + v[1] * v[1] + v[2] * v[2]);
+        for (F32& k : v) {
+            k /= length;
+        }
+        const std::array<F32, 3> n = decode_octahedral(encode_octahedral(v));
+        EXPECT_GT(n[0] * v[0] + n[1] * v[1] + n[2] * v[2], 0.99999f);
+    }
+}
+
+TEST_F(VertexQuantizationTest, CompactsMeshesIntoTheirOwnBounds) {
+    std::vector<MeshData> meshes = { make_grid(4, 1.0f), make_grid(8, 0.01f) };
+    for (MeshVertex& vertex : meshes[1].vertices) {
+        vertex.position[2] = 10.0f;
+    }
+    const PackedGeometry packed = pack_meshes(meshes);
+    Core::JobPool jobs;
+    const CompactGeometry compact = compact_geometry(packed.view(), &jobs);
+
+    ASSERT_EQ(compact.vertices.size(), packed.vertices.size());
+    ASSERT_EQ(compact.meshes.size(), 2u);
+    EXPECT_TRUE(compact.colors.empty());
+    EXPECT_EQ(compact.meshes[1].offset, (std::array<F32, 3> { 0.0f, 0.0f, 10.0f }));
+    EXPECT_NEAR(compact.meshes[1].scale[0], 0.08f, 1e-6f);
+
+    for (size_t m = 0; m < packed.meshes.size(); ++m) {
+        const MeshRange& range = packed.meshes[m];
+        // within half a step of the bounds of their own mesh
+        const F32 step = compact.meshes[m].scale[0] / 65535.0f;
+        for (U32 i = 0; i < range.vertexCount; ++i) {
+            const MeshVertex& vertex = packed.vertices[range.vertexOffset + i];
+            const CompactVertex& c = compact.vertices[range.vertexOffset + i];
+            const std::array<F32, 3> p = dequantize(c, compact.meshes[m]);
+            for (U32 k = 0; k < 3; ++k) {
+                EXPECT_NEAR(p[k], vertex.position[k], step * 0.5f + 1e-6f);
+            }
+            EXPECT_EQ(c.position[3], 0);
+            EXPECT_NEAR(f16_to_f32(c.texCoord[0]), vertex.texCoord[0], 1.0f / 2048.0f);
+            EXPECT_NEAR(f16_to_f32(c.texCoord[1]), vertex.texCoord[1], 1.0f / 2048.0f);
+            EXPECT_NEAR(decode_octahedral(c.normal)[2], 1.0f, 1e-5f);
+        }
+    }
+}
+
+TEST_F(VertexQuantizationTest, KeepsColorsOnlyWhenNotAllWhite) {
+    MeshData mesh = make_grid(2, 1.0f);
+    mesh.vertices[4].color = { 1.0f, 0.0f, 0.5f };
+    const PackedGeometry packed = pack_meshes(std::span(&mesh, 1));
+    const CompactGeometry compact = compact_geometry(packed.view());
+
+    ASSERT_EQ(compact.colors.size(), packed.vertices.size());
+    EXPECT_EQ(compact.colors[0], (VertexColor { 255, 255, 255, 255 }));
+    EXPECT_EQ(compact.colors[4], (VertexColor { 255, 0, 128, 255 }));
+}
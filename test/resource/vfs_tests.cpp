@@ -0,0 +1,203 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <resource/material_store.hpp>
+#include <resource/mesh_file.hpp>
+#include <resource/model_store.hpp>
+#include <resource/pack_file.hpp>
+#include <resource/texture_cooker.hpp>
+#include <resource/texture_store.hpp>
+#include <resource/vfs.hpp>
+#include <core/logger.hpp>
+#include "resource_test_utils.hpp"
+
+using namespace Resource;
+using namespace ResourceTest;
+
+namespace {
+
+void write_text(const std::filesystem::path& path, const std::string& text) {
+    std::filesystem::create_directories(path.parent_path());
+    std::ofstream file(path, std::ios::binary);
+    file << text;
+}
+
+std::string text_of(const VfsFile& file) {
+    return { reinterpret_cast<const char*>(file.data()), file.size() };
+}
+
+} // namespace
+
+class VfsTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Core::Logger::initialize();
+        dir = std::filesystem::temp_directory_path() / "vge_vfs_tests";
+        std::filesystem::create_directories(dir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(dir);
+        Core::Logger::shutdown();
+    }
+
+    std::filesystem::path dir;
+};
+
+TEST_F(VfsTest, PackRoundTripsWithAlignedEntries) {
+    write_text(dir / "src" / "a.txt", "alpha");
+    write_text(dir / "src" / "b.bin", std::string(5000, 'b'));
+    write_text(dir / "src" / "empty", "");
+
+    const std::vector<PackSource> files { { "shaders/a.txt", dir / "src" / "a.txt" },
+        { "textures\\b.bin", dir / "src" / "b.bin" }, { "empty", dir / "src" / "empty" } };
+    ASSERT_TRUE(write_pack_file(dir / "test.vgepak", files));
+
+    PackFile pack;
+    ASSERT_TRUE(pack.open(dir / "test.vgepak"));
+    ASSERT_EQ(pack.entries().size(), 3u);
+    for (size_t i = 1; i < pack.entries().size(); ++i) {
+        EXPECT_LT(pack.entries()[i - 1].id, pack.entries()[i].id);
+    }
+
+    const auto a = pack.find("shaders/./a.txt");
+    ASSERT_TRUE(a);
+    EXPECT_EQ(std::string(reinterpret_cast<const char*>(a->data()), a->size()), "alpha");
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(a->data()) % PackFileAlignment, 0u);
+
+    const auto b = pack.find(AssetId::from_path("textures/b.bin"));
+    ASSERT_TRUE(b);
+    EXPECT_EQ(b->size(), 5000u);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(b->data()) % PackFileAlignment, 0u);
+
+    ASSERT_TRUE(pack.find("empty"));
+    EXPECT_TRUE(pack.find("empty")->empty());
+    EXPECT_FALSE(pack.find("shaders/missing.txt"));
+    pack.close();
+
+    // the same virtual path twice, and a truncated pack, are rejected
+    const std::vector<PackSource> twice { { "a", dir / "src" / "a.txt" },
+        { "./a", dir / "src" / "b.bin" } };
+    EXPECT_FALSE(write_pack_file(dir / "twice.vgepak", twice));
+    std::filesystem::resize_file(dir / "test.vgepak", 4096);
+    EXPECT_FALSE(pack.open(dir / "test.vgepak"));
+}
+
+TEST_F(VfsTest, LaterMountsTakePrecedence) {
+    write_text(dir / "src" / "config.txt", "packed");
+    write_text(dir / "src" / "only_packed.txt", "packed only");
+    const std::vector<PackSource> files { { "config.txt", dir / "src" / "config.txt" },
+        { "only_packed.txt", dir / "src" / "only_packed.txt" } };
+    ASSERT_TRUE(write_pack_file(dir / "assets.vgepak", files));
+    write_text(dir / "loose" / "config.txt", "loose");
+
+    Vfs vfs;
+    ASSERT_TRUE(vfs.mount_pack("", dir / "assets.vgepak"));
+    ASSERT_TRUE(vfs.mount_directory("", dir / "loose"));
+    EXPECT_FALSE(vfs.mount_directory("", dir / "missing"));
+    EXPECT_FALSE(vfs.mount_pack("", dir / "missing.vgepak"));
+    EXPECT_EQ(vfs.mount_count(), 2u);
+
+    EXPECT_EQ(text_of(vfs.open("config.txt")), "loose");
+    EXPECT_EQ(text_of(vfs.open("only_packed.txt")), "packed only");
+    EXPECT_FALSE(vfs.open("missing.txt").is_open());
+    EXPECT_TRUE(vfs.exists("only_packed.txt"));
+    EXPECT_FALSE(vfs.exists("missing.txt"));
+
+    // only loose files resolve to a host path
+    EXPECT_EQ(vfs.resolve("config.txt"), dir / "loose" / "config.txt");
+    EXPECT_TRUE(vfs.resolve("only_packed.txt").empty());
+
+    // a pack mounted under a prefix only answers for paths below it
+    Vfs mounted;
+    mounted.mount_directory("", dir / "loose");
+    mounted.mount_pack("data/", dir / "assets.vgepak");
+    EXPECT_EQ(text_of(mounted.open("config.txt")), "loose");
+    EXPECT_EQ(text_of(mounted.open("data/config.txt")), "packed");
+    EXPECT_FALSE(mounted.open("database/config.txt").is_open());
+
+    // absolute paths bypass the mounts
+    EXPECT_EQ(text_of(vfs.open(dir / "src" / "config.txt")), "packed");
+}
+
+TEST_F(VfsTest, PackedFilesAreViewsIntoOneMapping) {
+    write_text(dir / "src" / "a.txt", "alpha");
+    write_text(dir / "src" / "b.txt", "beta");
+    const std::vector<PackSource> files { { "a.txt", dir / "src" / "a.txt" },
+        { "b.txt", dir / "src" / "b.txt" } };
+    ASSERT_TRUE(write_pack_file(dir / "assets.vgepak", files));
+
+    Vfs vfs;
+    ASSERT_TRUE(vfs.mount_pack("", dir / "assets.vgepak"));
+    const VfsFile a = vfs.open("a.txt");
+    const VfsFile again = vfs.open("a.txt");
+    const VfsFile b = vfs.open("b.txt");
+    ASSERT_TRUE(a.is_open());
+    EXPECT_EQ(a.data(), again.data());
+    EXPECT_EQ(std::max(a.data(), b.data()) - std::min(a.data(), b.data()),
+        static_cast<std::ptrdiff_t>(PackFileAlignment));
+}
+
+TEST_F(VfsTest, StoresLoadCookedAssetsFromAPack) {
+    // a model and its texture, cooked and packed without their sources
+    const TextureData albedo { 8, 8, std::vector<U8>(8 * 8 * 4, 90) };
+    const CookedTexture cooked = cook_texture(albedo, {});
+    ASSERT_TRUE(write_texture_file(dir / "albedo.png.vgetex", cooked.image(), TextureFileSrgb, 77));
+
+    MeshData quad;
+    quad.vertices.resize(4);
+    quad.indices = { 0, 1, 2, 2, 1, 3 };
+    const PackedGeometry packed = pack_meshes(std::span(&quad, 1));
+    const std::vector<MaterialData> materials { { "helmet", (dir / "albedo.png").string() } };
+    ASSERT_TRUE(write_mesh_file(dir / "helmet.obj.vgemesh", materials, packed.view(), 99));
+
+    const std::vector<PackSource> files {
+        { "models/helmet/helmet.obj.vgemesh", dir / "helmet.obj.vgemesh" },
+        { "models/helmet/albedo.png.vgetex", dir / "albedo.png.vgetex" }
+    };
+    ASSERT_TRUE(write_pack_file(dir / "assets.vgepak", files));
+
+    Vfs vfs;
+    ASSERT_TRUE(vfs.mount_pack("", dir / "assets.vgepak"));
+
+    MockBackend backend;
+    TextureStore textures(backend);
+    MaterialStore materialStore(textures);
+    ModelStore models(backend, materialStore);
+    textures.set_vfs(&vfs);
+    models.set_vfs(&vfs);
+
+    ModelHandle h = models.load("models/helmet/helmet.obj");
+    ASSERT_TRUE(h);
+    EXPECT_EQ(backend.geometryUploads, 1u);
+    EXPECT_EQ(backend.vertexCount, 4u);
+
+    // the texture path stored in the model is virtual and resolves into the pack
+    const Material* material = materialStore.get(models.get(h)->materials[0]);
+    ASSERT_NE(material, nullptr);
+    const Texture* texture = textures.get(material->diffuseTexture);
+    ASSERT_NE(texture, nullptr);
+    EXPECT_EQ(texture->paths[0], "models/helmet/albedo.png");
+    EXPECT_EQ(backend.format, PixelFormat::BC7);
+    EXPECT_EQ(backend.textureUploads, 1u);
+}
+
+TEST_F(VfsTest, MapsHostFilesBackToVirtualPaths) {
+    std::filesystem::create_directories(dir / "assets" / "textures");
+    std::filesystem::create_directories(dir / "mods");
+
+    Vfs vfs;
+    vfs.mount_directory("", dir / "assets");
+    vfs.mount_directory("mods", dir / "mods");
+    ASSERT_EQ(vfs.directories().size(), 2u);
+    EXPECT_EQ(vfs.directories()[1], dir / "mods");
+
+    EXPECT_EQ(vfs.virtual_path(dir / "assets" / "textures" / "albedo.png"), "textures/albedo.png");
+    EXPECT_EQ(vfs.virtual_path(dir / "mods" / "sword.obj"), "mods/sword.obj");
+    EXPECT_EQ(vfs.virtual_path(dir / "elsewhere.png"), "");
+}
@@ -0,0 +1,66 @@
+// Cooks the assets under a directory ahead of time: images to .vgetex, models
+// to .vgemesh, next to their sources. Only assets whose source or import
+// settings changed since the last run are cooked again, see
+// Resource::AssetCooker. With --pack the cooked tree is packed into
+// <asset directory>/assets.vgepak afterwards, which the renderer mounts.
+//
+// usage: vge_cook [--force] [--pack] [asset directory, defaults to vge/assets]
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+
+#include "core/logger.hpp"
+#include "core/timer.hpp"
+#include "core/concurrency/job_system.hpp"
+#include "resource/asset_cooker.hpp"
+#include "resource/pack_file.hpp"
+
+int main(int argc, char** argv) {
+    std::filesystem::path root = VGE_ASSET_DIR;
+    bool force = false;
+    bool pack = false;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--force") == 0) {
+            force = true;
+        } else if (std::strcmp(argv[i], "--pack") == 0) {
+            pack = true;
+        } else if (std::strcmp(argv[i], "--help") == 0) {
+            std::printf("usage: vge_cook [--force] [--pack] [asset directory]\n");
+            return EXIT_SUCCESS;
+        } else {
+            root = argv[i];
+        }
+    }
+
+    Core::Logger::initialize();
+
+    Resource::CookStats stats;
+    bool packed = true;
+    double milliseconds = 0.0;
+    {
+        Core::JobPool jobs;
+        Core::Timer timer;
+        timer.start();
+        Resource::AssetCooker cooker(root);
+        stats = cooker.cook(jobs, force);
+        if (pack) {
+            packed = cooker.pack(root / Resource::AssetPackName);
+        }
+        milliseconds = timer.stop<Core::Timer::Milliseconds>();
+    }
+
+    std::printf("%s: %zu assets, %zu cooked, %zu up to date, %zu failed in %.1f ms\n",
+        root.string().c_str(), stats.assets, stats.cooked, stats.upToDate, stats.failed,
+        milliseconds);
+    if (stats.meshes.before.triangles > 0) {
+        std::printf("vertex cache: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+            stats.meshes.before.acmr(), stats.meshes.after.acmr(), stats.meshes.before.atvr(),
+            stats.meshes.after.atvr());
+    }
+
+    Core::Logger::shutdown();
+    return stats.failed == 0 && packed ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstddef>
+#include <thread>
+
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+#include <intrin.h>
+#elif defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace Core {
+
+// Not std::hardware_destructive_interference_size: GCC warns that its value
+// is ABI unstable, and every target we ship on uses 64 byte lines anyway.
+inline constexpr std::size_t CacheLineSize = 64;
+
+// Hint for busy wait loops, lets the sibling hyperthread run and saves power
+// while spinning on a cache line owned by another core.
+inline void cpu_relax() noexcept {
+#if defined(_MSC_VER) && (defined(_M_X64) || defined(_M_IX86))
+    _mm_pause();
+#elif defined(__x86_64__) || defined(__i386__)
+    _mm_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+    asm volatile("yield" ::: "memory");
+#endif
+}
+
+// Spins for a while, then starts yielding: the thread being waited on may
+// have been preempted, and on an oversubscribed machine it can only run if
+// this one gets out of the way.
+class Backoff {
+   public:
+    void pause() noexcept {
+        if (m_Spins < SpinLimit) {
+            m_Spins++;
+            cpu_relax();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+   private:
+    static constexpr unsigned SpinLimit = 64;
+    unsigned m_Spins = 0;
+};
+
+}  // namespace Core
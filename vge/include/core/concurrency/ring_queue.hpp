@@ -0,0 +1,321 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+#include "core/concurrency/cpu.hpp"
+#include "core/memory/allocation_profiler.hpp"
+#include "core/memory/memory.hpp"
+
+// Bounded lock-free queues for handing work between threads without a mutex:
+// input -> game, game -> render, I/O completions -> workers.
+//
+// Both queues round their capacity up to a power of two and allocate all of
+// their storage once, in the constructor. Pushing to a full queue or popping
+// from an empty one fails instead of blocking, the caller decides whether to
+// spin, yield or drop.
+namespace Core {
+
+// Single producer, single consumer. Each side owns one index and keeps a
+// cached copy of the other side's, so in the common case a push or pop only
+// touches its own cache line and the slot.
+template <typename Type>
+class SpscRing {
+   public:
+    explicit SpscRing(const std::size_t capacity,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource), m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 1)) - 1) {
+        PROFILE_ALLOCATION_TAG(MemoryTag::MEMORY_TAG_RING_QUEUE);
+        m_Slots = static_cast<Type*>(
+            m_Resource->allocate(this->capacity() * sizeof(Type), alignof(Type)));
+    }
+
+    ~SpscRing() {
+        for (std::size_t i = m_Head.load(); i != m_Tail.load(); ++i) {
+            std::destroy_at(m_Slots + (i & m_Mask));
+        }
+        m_Resource->deallocate(m_Slots, capacity() * sizeof(Type), alignof(Type));
+    }
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    // ---- producer ----
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+        if (tail - m_CachedHead > m_Mask) {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+            if (tail - m_CachedHead > m_Mask) {
+                return false;
+            }
+        }
+        std::construct_at(m_Slots + (tail & m_Mask), std::forward<Args>(args)...);
+        m_Tail.store(tail + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const Type& value) { return try_emplace(value); }
+    bool try_push(Type&& value) { return try_emplace(std::move(value)); }
+
+    // Pushes as many of [first, last) as fit, publishing them with a single
+    // store. Returns how many were pushed. Pass move iterators to move.
+    template <std::forward_iterator It>
+    std::size_t push_batch(It first, It last) {
+        const std::size_t tail = m_Tail.load(std::memory_order_relaxed);
+        const auto wanted = static_cast<std::size_t>(std::distance(first, last));
+        if (capacity() - (tail - m_CachedHead) < wanted) {
+            m_CachedHead = m_Head.load(std::memory_order_acquire);
+        }
+        const std::size_t count = std::min(wanted, capacity() - (tail - m_CachedHead));
+        for (std::size_t i = 0; i < count; ++i, ++first) {
+            std::construct_at(m_Slots + ((tail + i) & m_Mask), *first);
+        }
+        m_Tail.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    // ---- consumer ----
+
+    bool try_pop(Type& out) {
+        const std::size_t head = m_Head.load(std::memory_order_relaxed);
+        if (head == m_CachedTail) {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+            if (head == m_CachedTail) {
+                return false;
+            }
+        }
+        Type* slot = m_Slots + (head & m_Mask);
+        out = std::move(*slot);
+        std::destroy_at(slot);
+        m_Head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Pops up to max elements into out, returns how many were popped.
+    template <typename OutIt>
+    std::size_t pop_batch(OutIt out, const std::size_t max) {
+        const std::size_t head = m_Head.load(std::memory_order_relaxed);
+        if (m_CachedTail - head < max) {
+            m_CachedTail = m_Tail.load(std::memory_order_acquire);
+        }
+        const std::size_t count = std::min(max, m_CachedTail - head);
+        for (std::size_t i = 0; i < count; ++i) {
+            Type* slot = m_Slots + ((head + i) & m_Mask);
+            *out = std::move(*slot);
+            ++out;
+            std::destroy_at(slot);
+        }
+        m_Head.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // ---- either side ----
+
+    // Only a snapshot when the other side is running.
+    std::size_t size_approx() const noexcept {
+        const std::size_t head = m_Head.load(std::memory_order_acquire);
+        return m_Tail.load(std::memory_order_acquire) - head;
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    std::size_t capacity() const noexcept { return m_Mask + 1; }
+
+   private:
+    // read only after construction, shared by both sides
+    std::pmr::memory_resource* m_Resource;
+    const std::size_t m_Mask;
+    Type* m_Slots = nullptr;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_Tail{0};  // written by the producer
+    std::size_t m_CachedHead = 0;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_Head{0};  // written by the consumer
+    std::size_t m_CachedTail = 0;
+};
+
+// Multi producer, multi consumer (Dmitry Vyukov's bounded queue). Every cell
+// carries a sequence number telling which lap of the ring it is ready for, so
+// producers and consumers only contend on their own index with a single CAS
+// and never on each other's.
+//
+// Not strictly lock-free: a thread preempted between claiming a cell and
+// publishing it holds up the other side at that cell until it resumes.
+template <typename Type>
+class MpmcRing {
+   public:
+    explicit MpmcRing(const std::size_t capacity,
+                      std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource), m_Mask(std::bit_ceil(std::max<std::size_t>(capacity, 2)) - 1) {
+        PROFILE_ALLOCATION_TAG(MemoryTag::MEMORY_TAG_RING_QUEUE);
+        m_Cells = static_cast<Cell*>(
+            m_Resource->allocate(this->capacity() * sizeof(Cell), alignof(Cell)));
+        for (std::size_t i = 0; i < this->capacity(); ++i) {
+            std::construct_at(&m_Cells[i].sequence, i);
+        }
+    }
+
+    // Must not race with pushes or pops.
+    ~MpmcRing() {
+        const std::size_t enqueue = m_EnqueuePos.load();
+        for (std::size_t pos = m_DequeuePos.load(); pos != enqueue; ++pos) {
+            std::destroy_at(m_Cells[pos & m_Mask].value());
+        }
+        m_Resource->deallocate(m_Cells, capacity() * sizeof(Cell), alignof(Cell));
+    }
+
+    MpmcRing(const MpmcRing&) = delete;
+    MpmcRing& operator=(const MpmcRing&) = delete;
+
+    template <typename... Args>
+    bool try_emplace(Args&&... args) {
+        std::size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &m_Cells[pos & m_Mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if (diff == 0) {
+                if (m_EnqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;  // still holds the element from the previous lap
+            } else {
+                pos = m_EnqueuePos.load(std::memory_order_relaxed);
+            }
+        }
+        std::construct_at(cell->value(), std::forward<Args>(args)...);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_push(const Type& value) { return try_emplace(value); }
+    bool try_push(Type&& value) { return try_emplace(std::move(value)); }
+
+    bool try_pop(Type& out) {
+        std::size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+        Cell* cell = nullptr;
+        for (;;) {
+            cell = &m_Cells[pos & m_Mask];
+            const std::size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - (pos + 1));
+            if (diff == 0) {
+                if (m_DequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                pos = m_DequeuePos.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(*cell->value());
+        std::destroy_at(cell->value());
+        cell->sequence.store(pos + m_Mask + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Claims a run of cells with one CAS instead of one per element, then
+    // fills them in order. Returns how many of [first, last) were pushed.
+    // A claimed cell may still be being read by a consumer that claimed it
+    // earlier, in which case we wait until it is released.
+    template <std::forward_iterator It>
+    std::size_t push_batch(It first, It last) {
+        const auto wanted = static_cast<std::size_t>(std::distance(first, last));
+        std::size_t pos = m_EnqueuePos.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (;;) {
+            const std::size_t used = distance(m_DequeuePos.load(std::memory_order_acquire), pos);
+            count = std::min(wanted, capacity() - used);
+            if (count == 0) {
+                return 0;
+            }
+            if (m_EnqueuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i, ++first) {
+            Cell& cell = m_Cells[(pos + i) & m_Mask];
+            Backoff backoff;
+            while (cell.sequence.load(std::memory_order_acquire) != pos + i) {
+                backoff.pause();
+            }
+            std::construct_at(cell.value(), *first);
+            cell.sequence.store(pos + i + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Pops up to max elements into out with a single CAS, waiting on any cell
+    // whose producer has claimed but not yet published it.
+    template <typename OutIt>
+    std::size_t pop_batch(OutIt out, const std::size_t max) {
+        std::size_t pos = m_DequeuePos.load(std::memory_order_relaxed);
+        std::size_t count = 0;
+        for (;;) {
+            count = std::min(max, distance(pos, m_EnqueuePos.load(std::memory_order_acquire)));
+            if (count == 0) {
+                return 0;
+            }
+            if (m_DequeuePos.compare_exchange_weak(pos, pos + count, std::memory_order_relaxed)) {
+                break;
+            }
+        }
+
+        for (std::size_t i = 0; i < count; ++i) {
+            Cell& cell = m_Cells[(pos + i) & m_Mask];
+            Backoff backoff;
+            while (cell.sequence.load(std::memory_order_acquire) != pos + i + 1) {
+                backoff.pause();
+            }
+            *out = std::move(*cell.value());
+            ++out;
+            std::destroy_at(cell.value());
+            cell.sequence.store(pos + i + m_Mask + 1, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Claimed, not necessarily published, elements. Only a snapshot.
+    std::size_t size_approx() const noexcept {
+        const std::size_t dequeue = m_DequeuePos.load(std::memory_order_acquire);
+        return distance(dequeue, m_EnqueuePos.load(std::memory_order_acquire));
+    }
+    bool empty_approx() const noexcept { return size_approx() == 0; }
+    std::size_t capacity() const noexcept { return m_Mask + 1; }
+
+   private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        alignas(Type) std::byte storage[sizeof(Type)];
+
+        Type* value() noexcept { return std::launder(reinterpret_cast<Type*>(storage)); }
+    };
+
+    // The two indices are loaded separately, so the other one may have moved
+    // past in between: clamp to [0, capacity].
+    std::size_t distance(const std::size_t from, const std::size_t to) const noexcept {
+        const auto diff = static_cast<std::ptrdiff_t>(to - from);
+        return std::min(static_cast<std::size_t>(std::max<std::ptrdiff_t>(diff, 0)), capacity());
+    }
+
+    // read only after construction
+    std::pmr::memory_resource* m_Resource;
+    const std::size_t m_Mask;
+    Cell* m_Cells = nullptr;
+
+    alignas(CacheLineSize) std::atomic<std::size_t> m_EnqueuePos{0};
+    alignas(CacheLineSize) std::atomic<std::size_t> m_DequeuePos{0};
+};
+
+}  // namespace Core
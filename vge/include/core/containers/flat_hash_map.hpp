@@ -0,0 +1,586 @@
+#pragma once
+
+#include <bit>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VGE_FLAT_HASH_SSE2 1
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#include <arm_neon.h>
+#define VGE_FLAT_HASH_NEON 1
+#endif
+
+#include "defines.hpp"
+#include "core/assert.hpp"
+#include "core/hash.hpp"
+
+namespace Core {
+
+namespace FlatHashDetail {
+
+// One control byte per slot: the top bit marks it empty or deleted, otherwise
+// the low 7 bits hold H2, the low 7 bits of the hash. Probing compares H2
+// against 16 control bytes at once and only touches slots that match.
+using Ctrl = I8;
+inline constexpr Ctrl Empty = static_cast<Ctrl>(0x80);
+inline constexpr Ctrl Deleted = static_cast<Ctrl>(0xFE);
+inline constexpr std::size_t GroupWidth = 16;
+
+// Iterable mask of matching lanes in a group. @Shift is log2 of the bits per
+// lane (NEON produces 4 bits per byte).
+template <int Shift>
+struct BitMask {
+    U64 mask;
+
+    explicit operator bool() const { return mask != 0; }
+    U32 lowest() const { return static_cast<U32>(std::countr_zero(mask)) >> Shift; }
+    U32 leading() const {
+        constexpr int Bits = static_cast<int>(GroupWidth << Shift);
+        return static_cast<U32>(std::countl_zero(mask) - (64 - Bits)) >> Shift;
+    }
+    void clear_lowest() { mask &= mask - 1; }
+};
+
+#if defined(VGE_FLAT_HASH_SSE2)
+
+struct Group {
+    using Mask = BitMask<0>;
+
+    explicit Group(const Ctrl* ctrl)
+        : m_Ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ctrl))) {}
+
+    Mask match(const Ctrl h2) const {
+        return Mask{static_cast<U32>(_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(h2), m_Ctrl)))};
+    }
+    Mask match_empty() const { return match(Empty); }
+    // empty and deleted are the only bytes with the sign bit set
+    Mask match_free() const { return Mask{static_cast<U32>(_mm_movemask_epi8(m_Ctrl))}; }
+
+    __m128i m_Ctrl;
+};
+
+#elif defined(VGE_FLAT_HASH_NEON)
+
+struct Group {
+    using Mask = BitMask<2>;
+
+    explicit Group(const Ctrl* ctrl) : m_Ctrl(vld1q_s8(ctrl)) {}
+
+    static Mask to_mask(const uint8x16_t lanes) {
+        // narrow every byte to a nibble, keep one bit per nibble
+        const uint8x8_t nibbles = vshrn_n_u16(vreinterpretq_u16_u8(lanes), 4);
+        return Mask{vget_lane_u64(vreinterpret_u64_u8(nibbles), 0) & 0x8888888888888888ull};
+    }
+
+    Mask match(const Ctrl h2) const { return to_mask(vceqq_s8(vdupq_n_s8(h2), m_Ctrl)); }
+    Mask match_empty() const { return match(Empty); }
+    Mask match_free() const { return to_mask(vcltzq_s8(m_Ctrl)); }
+
+    int8x16_t m_Ctrl;
+};
+
+#else
+
+struct Group {
+    using Mask = BitMask<0>;
+
+    explicit Group(const Ctrl* ctrl) { std::memcpy(m_Ctrl, ctrl, GroupWidth); }
+
+    Mask match(const Ctrl h2) const {
+        U64 mask = 0;
+        for (std::size_t i = 0; i < GroupWidth; ++i) {
+            mask |= static_cast<U64>(m_Ctrl[i] == h2) << i;
+        }
+        return Mask{mask};
+    }
+    Mask match_empty() const { return match(Empty); }
+    Mask match_free() const {
+        U64 mask = 0;
+        for (std::size_t i = 0; i < GroupWidth; ++i) {
+            mask |= static_cast<U64>(m_Ctrl[i] < 0) << i;
+        }
+        return Mask{mask};
+    }
+
+    Ctrl m_Ctrl[GroupWidth];
+};
+
+#endif
+
+}  // namespace FlatHashDetail
+
+// Open addressing hash map with SwissTable style metadata. Slots live in one
+// flat array next to their control bytes, so a lookup touches at most a couple
+// of cache lines instead of chasing bucket nodes.
+//
+// Differences from std::unordered_map:
+// - value_type is std::pair<Key, Value>: never modify the key through an
+//   iterator.
+// - Any insertion may rehash and invalidate iterators and references.
+// - Memory comes from a std::pmr::memory_resource.
+template <typename Key,
+          typename Value,
+          typename HashFn = Hash<Key>,
+          typename KeyEqual = std::equal_to<>>
+class FlatHashMap {
+    using Ctrl = FlatHashDetail::Ctrl;
+    using Group = FlatHashDetail::Group;
+    static constexpr std::size_t GroupWidth = FlatHashDetail::GroupWidth;
+
+   public:
+    using key_type = Key;
+    using mapped_type = Value;
+    using value_type = std::pair<Key, Value>;
+    using size_type = std::size_t;
+    using hasher = HashFn;
+    using key_equal = KeyEqual;
+
+    template <bool Const>
+    class Iterator {
+        using Map = std::conditional_t<Const, const FlatHashMap, FlatHashMap>;
+
+       public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = FlatHashMap::value_type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const value_type&, value_type&>;
+        using pointer = std::conditional_t<Const, const value_type*, value_type*>;
+
+        Iterator() = default;
+        Iterator(Map* map, const std::size_t index) : m_Map(map), m_Index(index) { skip_free(); }
+
+        // iterator -> const_iterator
+        template <bool C = Const, typename = std::enable_if_t<C>>
+        Iterator(const Iterator<false>& other) : m_Map(other.m_Map), m_Index(other.m_Index) {}
+
+        reference operator*() const { return m_Map->m_Slots[m_Index]; }
+        pointer operator->() const { return &m_Map->m_Slots[m_Index]; }
+
+        Iterator& operator++() {
+            ++m_Index;
+            skip_free();
+            return *this;
+        }
+        Iterator operator++(int) {
+            Iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        friend bool operator==(const Iterator& a, const Iterator& b) {
+            return a.m_Index == b.m_Index;
+        }
+
+       private:
+        friend class FlatHashMap;
+        template <bool>
+        friend class Iterator;
+
+        void skip_free() {
+            while (m_Index < m_Map->m_Capacity && m_Map->m_Ctrl[m_Index] < 0) {
+                ++m_Index;
+            }
+        }
+
+        Map* m_Map = nullptr;
+        std::size_t m_Index = 0;
+    };
+
+    using iterator = Iterator<false>;
+    using const_iterator = Iterator<true>;
+
+    explicit FlatHashMap(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {}
+
+    FlatHashMap(const std::size_t capacity,
+                std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        reserve(capacity);
+    }
+
+    FlatHashMap(std::initializer_list<value_type> init,
+                std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        reserve(init.size());
+        for (const auto& kv : init) {
+            try_emplace(kv.first, kv.second);
+        }
+    }
+
+    // Like std::pmr containers, copies use the default resource and the
+    // resource is never propagated on assignment.
+    FlatHashMap(const FlatHashMap& other) {
+        reserve(other.m_Size);
+        for (const auto& kv : other) {
+            try_emplace(kv.first, kv.second);
+        }
+    }
+
+    FlatHashMap(FlatHashMap&& other) noexcept { steal(other); }
+
+    FlatHashMap& operator=(const FlatHashMap& other) {
+        if (this != &other) {
+            clear();
+            reserve(other.m_Size);
+            for (const auto& kv : other) {
+                try_emplace(kv.first, kv.second);
+            }
+        }
+        return *this;
+    }
+
+    // Moving between maps on different resources moves the elements one by one.
+    FlatHashMap& operator=(FlatHashMap&& other) {
+        if (this == &other) {
+            return *this;
+        }
+        release();
+        if (m_Resource == other.m_Resource) {
+            steal(other);
+        } else {
+            reserve(other.m_Size);
+            for (auto& kv : other) {
+                try_emplace(std::move(kv.first), std::move(kv.second));
+            }
+            other.clear();
+        }
+        return *this;
+    }
+
+    ~FlatHashMap() { release(); }
+
+    iterator begin() { return iterator(this, 0); }
+    iterator end() { return iterator(this, m_Capacity); }
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_Capacity); }
+    const_iterator cbegin() const { return begin(); }
+    const_iterator cend() const { return end(); }
+
+    [[nodiscard]] bool empty() const noexcept { return m_Size == 0; }
+    size_type size() const noexcept { return m_Size; }
+    size_type capacity() const noexcept { return m_Capacity; }
+    float load_factor() const noexcept {
+        return m_Capacity ? static_cast<float>(m_Size) / static_cast<float>(m_Capacity) : 0.0f;
+    }
+    std::pmr::memory_resource* resource() const noexcept { return m_Resource; }
+
+    // ---- lookup ----
+
+    template <typename K = Key>
+    iterator find(const K& key) {
+        return iterator(this, find_index(key));
+    }
+    template <typename K = Key>
+    const_iterator find(const K& key) const {
+        return const_iterator(this, find_index(key));
+    }
+    template <typename K = Key>
+    bool contains(const K& key) const {
+        return find_index(key) != m_Capacity;
+    }
+    template <typename K = Key>
+    size_type count(const K& key) const {
+        return contains(key) ? 1 : 0;
+    }
+
+    template <typename K = Key>
+    Value& at(const K& key) {
+        const std::size_t idx = find_index(key);
+        if (idx == m_Capacity) {
+            throw std::out_of_range("[FlatHashMap]: Key not found");
+        }
+        return m_Slots[idx].second;
+    }
+    template <typename K = Key>
+    const Value& at(const K& key) const {
+        return const_cast<FlatHashMap*>(this)->at(key);
+    }
+
+    Value& operator[](const Key& key) { return try_emplace(key).first->second; }
+    Value& operator[](Key&& key) { return try_emplace(std::move(key)).first->second; }
+
+    // ---- modifiers ----
+
+    template <typename K, typename... Args>
+    std::pair<iterator, bool> try_emplace(K&& key, Args&&... args) {
+        const std::size_t hash = hash_of(key);
+        const std::size_t existing = find_index(key, hash);
+        if (existing != m_Capacity) {
+            return {iterator(this, existing), false};
+        }
+
+        const std::size_t idx = prepare_insert(hash);
+        std::construct_at(&m_Slots[idx], std::piecewise_construct,
+                          std::forward_as_tuple(std::forward<K>(key)),
+                          std::forward_as_tuple(std::forward<Args>(args)...));
+        commit_insert(idx, hash);
+        return {iterator(this, idx), true};
+    }
+
+    std::pair<iterator, bool> insert(const value_type& kv) {
+        return try_emplace(kv.first, kv.second);
+    }
+    std::pair<iterator, bool> insert(value_type&& kv) {
+        return try_emplace(std::move(kv.first), std::move(kv.second));
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> emplace(K&& key, V&& value) {
+        return try_emplace(std::forward<K>(key), std::forward<V>(value));
+    }
+
+    template <typename K, typename V>
+    std::pair<iterator, bool> insert_or_assign(K&& key, V&& value) {
+        auto result = try_emplace(std::forward<K>(key), std::forward<V>(value));
+        if (!result.second) {
+            result.first->second = std::forward<V>(value);
+        }
+        return result;
+    }
+
+    template <typename K = Key>
+    size_type erase(const K& key) {
+        const std::size_t idx = find_index(key);
+        if (idx == m_Capacity) {
+            return 0;
+        }
+        erase_at(idx);
+        return 1;
+    }
+
+    iterator erase(const_iterator pos) {
+        erase_at(pos.m_Index);
+        return iterator(this, pos.m_Index + 1);
+    }
+    iterator erase(iterator pos) { return erase(const_iterator(pos)); }
+
+    void clear() {
+        for (std::size_t i = 0; i < m_Capacity; ++i) {
+            if (m_Ctrl[i] >= 0) {
+                std::destroy_at(&m_Slots[i]);
+            }
+        }
+        if (m_Capacity) {
+            std::memset(m_Ctrl, FlatHashDetail::Empty, m_Capacity + GroupWidth);
+        }
+        m_Size = 0;
+        m_GrowthLeft = max_load(m_Capacity);
+    }
+
+    // Makes room for @count elements without rehashing.
+    void reserve(const size_type count) {
+        if (count <= m_Size + m_GrowthLeft) {
+            return;
+        }
+        std::size_t capacity = std::max(GroupWidth, m_Capacity);
+        while (max_load(capacity) < count) {
+            capacity *= 2;
+        }
+        rehash(capacity);
+    }
+
+   private:
+    // 7/8 maximum load factor
+    static std::size_t max_load(const std::size_t capacity) { return capacity - capacity / 8; }
+
+    static Ctrl h2(const std::size_t hash) { return static_cast<Ctrl>(hash & 0x7F); }
+    static std::size_t h1(const std::size_t hash) { return hash >> 7; }
+
+    template <typename K>
+    std::size_t hash_of(const K& key) const {
+        return m_Hash(key);
+    }
+
+    // Triangular probing over groups, visits every group once when the
+    // capacity is a power of two.
+    struct ProbeSeq {
+        ProbeSeq(const std::size_t hash, const std::size_t mask)
+            : mask(mask), offset(h1(hash) & mask) {}
+        void next() {
+            index += GroupWidth;
+            offset = (offset + index) & mask;
+        }
+        std::size_t mask;
+        std::size_t offset;
+        std::size_t index = 0;
+    };
+
+    template <typename K>
+    std::size_t find_index(const K& key) const {
+        return m_Capacity ? find_index(key, hash_of(key)) : m_Capacity;
+    }
+
+    template <typename K>
+    std::size_t find_index(const K& key, const std::size_t hash) const {
+        if (!m_Capacity) {
+            return m_Capacity;
+        }
+        ProbeSeq seq(hash, m_Capacity - 1);
+        for (;;) {
+            const Group g(m_Ctrl + seq.offset);
+            for (auto m = g.match(h2(hash)); m; m.clear_lowest()) {
+                const std::size_t idx = (seq.offset + m.lowest()) & (m_Capacity - 1);
+                if (m_Eq(m_Slots[idx].first, key)) {
+                    return idx;
+                }
+            }
+            if (g.match_empty()) {
+                return m_Capacity;
+            }
+            seq.next();
+        }
+    }
+
+    std::size_t find_free(const std::size_t hash) const {
+        ProbeSeq seq(hash, m_Capacity - 1);
+        for (;;) {
+            const Group g(m_Ctrl + seq.offset);
+            if (auto m = g.match_free()) {
+                return (seq.offset + m.lowest()) & (m_Capacity - 1);
+            }
+            seq.next();
+        }
+    }
+
+    // Bytes [capacity, capacity + GroupWidth) mirror the first group, so a
+    // group load starting anywhere in the table stays in bounds.
+    void set_ctrl(const std::size_t idx, const Ctrl value) {
+        m_Ctrl[idx] = value;
+        if (idx < GroupWidth) {
+            m_Ctrl[m_Capacity + idx] = value;
+        }
+    }
+
+    // Slot for a new element, growing the table first if it is full. The slot
+    // stays free until commit_insert(), so a constructor that throws in
+    // between leaves no full slot over uninitialized storage.
+    std::size_t prepare_insert(const std::size_t hash) {
+        if (m_GrowthLeft == 0) {
+            // mostly tombstones: rebuild in place instead of growing
+            const bool mostlyTombstones = m_Capacity && m_Size < max_load(m_Capacity) / 2;
+            rehash(mostlyTombstones ? m_Capacity : std::max(GroupWidth, m_Capacity * 2));
+        }
+        return find_free(hash);
+    }
+
+    // Marks the slot full once its element is constructed.
+    void commit_insert(const std::size_t idx, const std::size_t hash) {
+        if (m_Ctrl[idx] == FlatHashDetail::Empty) {
+            m_GrowthLeft--;
+        }
+        set_ctrl(idx, h2(hash));
+        m_Size++;
+    }
+
+    void erase_at(const std::size_t idx) {
+        std::destroy_at(&m_Slots[idx]);
+        m_Size--;
+
+        // The slot can go straight back to empty if no probe sequence ever
+        // passed through it: its group window was never full.
+        const std::size_t before = (idx - GroupWidth) & (m_Capacity - 1);
+        const auto emptyAfter = Group(m_Ctrl + idx).match_empty();
+        const auto emptyBefore = Group(m_Ctrl + before).match_empty();
+        const bool wasNeverFull = emptyAfter && emptyBefore &&
+                                  emptyBefore.leading() + emptyAfter.lowest() < GroupWidth;
+        if (wasNeverFull) {
+            set_ctrl(idx, FlatHashDetail::Empty);
+            m_GrowthLeft++;
+        } else {
+            set_ctrl(idx, FlatHashDetail::Deleted);
+        }
+    }
+
+    void rehash(const std::size_t newCapacity) {
+        ASSERT_MSG(std::has_single_bit(newCapacity) && newCapacity >= GroupWidth,
+                   "[FlatHashMap]: Capacity must be a power of two");
+
+        Ctrl* oldCtrl = m_Ctrl;
+        value_type* oldSlots = m_Slots;
+        const std::size_t oldCapacity = m_Capacity;
+
+        allocate(newCapacity);
+
+        for (std::size_t i = 0; i < oldCapacity; ++i) {
+            if (oldCtrl[i] < 0) {
+                continue;
+            }
+            const std::size_t hash = m_Hash(oldSlots[i].first);
+            const std::size_t idx = find_free(hash);
+            set_ctrl(idx, h2(hash));
+            std::construct_at(&m_Slots[idx], std::move(oldSlots[i]));
+            std::destroy_at(&oldSlots[i]);
+        }
+        m_GrowthLeft = max_load(m_Capacity) - m_Size;
+
+        deallocate(oldCtrl, oldCapacity);
+    }
+
+    static std::size_t slots_offset(const std::size_t capacity) {
+        const std::size_t ctrlBytes = capacity + GroupWidth;
+        return (ctrlBytes + alignof(value_type) - 1) / alignof(value_type) * alignof(value_type);
+    }
+
+    static std::size_t alloc_bytes(const std::size_t capacity) {
+        return slots_offset(capacity) + capacity * sizeof(value_type);
+    }
+
+    static constexpr std::size_t alloc_align() {
+        return std::max(alignof(value_type), alignof(std::max_align_t));
+    }
+
+    // control bytes and slots share one allocation
+    void allocate(const std::size_t capacity) {
+        auto* block =
+            static_cast<std::byte*>(m_Resource->allocate(alloc_bytes(capacity), alloc_align()));
+        m_Ctrl = reinterpret_cast<Ctrl*>(block);
+        m_Slots = reinterpret_cast<value_type*>(block + slots_offset(capacity));
+        m_Capacity = capacity;
+        std::memset(m_Ctrl, FlatHashDetail::Empty, capacity + GroupWidth);
+    }
+
+    void deallocate(Ctrl* ctrl, const std::size_t capacity) {
+        if (ctrl) {
+            m_Resource->deallocate(ctrl, alloc_bytes(capacity), alloc_align());
+        }
+    }
+
+    void release() {
+        clear();
+        deallocate(m_Ctrl, m_Capacity);
+        m_Ctrl = nullptr;
+        m_Slots = nullptr;
+        m_Capacity = 0;
+        m_GrowthLeft = 0;
+    }
+
+    void steal(FlatHashMap& other) {
+        m_Resource = other.m_Resource;
+        m_Ctrl = std::exchange(other.m_Ctrl, nullptr);
+        m_Slots = std::exchange(other.m_Slots, nullptr);
+        m_Capacity = std::exchange(other.m_Capacity, 0);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_GrowthLeft = std::exchange(other.m_GrowthLeft, 0);
+    }
+
+    std::pmr::memory_resource* m_Resource{std::pmr::get_default_resource()};
+    Ctrl* m_Ctrl{};
+    value_type* m_Slots{};
+    std::size_t m_Capacity{0};
+    std::size_t m_Size{0};
+    // insertions left before the table has to grow, tombstones count as used
+    std::size_t m_GrowthLeft{0};
+
+    [[no_unique_address]] HashFn m_Hash{};
+    [[no_unique_address]] KeyEqual m_Eq{};
+};
+
+}  // namespace Core
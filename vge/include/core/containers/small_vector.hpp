@@ -0,0 +1,300 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <memory_resource>
+#include <new>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace Core {
+
+// std::vector interface that keeps up to N elements inline and only spills to
+// its memory resource past that. Moving a small_vector whose elements are
+// inline moves them one by one, so element addresses do not survive a move
+// (unlike std::vector).
+template <class Type, std::size_t N>
+class small_vector {
+   public:
+    using value_type = Type;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = Type&;
+    using const_reference = const Type&;
+    using pointer = Type*;
+    using const_pointer = const Type*;
+    using iterator = Type*;
+    using const_iterator = const Type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    explicit small_vector(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {}
+
+    explicit small_vector(const size_type count,
+                          std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        resize(count);
+    }
+
+    small_vector(const size_type count,
+                 const Type& value,
+                 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        resize(count, value);
+    }
+
+    small_vector(std::initializer_list<Type> init,
+                 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        assign(init.begin(), init.end());
+    }
+
+    template <std::input_iterator It>
+    small_vector(It first,
+                 It last,
+                 std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        assign(first, last);
+    }
+
+    // Like std::pmr containers, copies use the default resource.
+    small_vector(const small_vector& other) { assign(other.begin(), other.end()); }
+
+    small_vector(small_vector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+        : m_Resource(other.m_Resource) {
+        take(std::move(other));
+    }
+
+    small_vector& operator=(const small_vector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
+        }
+        return *this;
+    }
+
+    // The resource is never propagated: heap storage is only stolen when both
+    // vectors share one.
+    small_vector& operator=(small_vector&& other) {
+        if (this != &other) {
+            clear();
+            if (m_Resource == other.m_Resource) {
+                release();
+                take(std::move(other));
+            } else {
+                reserve(other.m_Size);
+                std::uninitialized_move(other.begin(), other.end(), begin());
+                m_Size = other.m_Size;
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    small_vector& operator=(std::initializer_list<Type> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    ~small_vector() {
+        clear();
+        release();
+    }
+
+    template <std::input_iterator It>
+    void assign(It first, It last) {
+        clear();
+        if constexpr (std::forward_iterator<It>) {
+            reserve(static_cast<size_type>(std::distance(first, last)));
+        }
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    // ---- element access ----
+
+    reference operator[](const size_type pos) { return m_Data[pos]; }
+    const_reference operator[](const size_type pos) const { return m_Data[pos]; }
+
+    reference at(const size_type pos) {
+        if (pos >= m_Size) {
+            throw std::out_of_range("[SmallVector]: Index out of range");
+        }
+        return m_Data[pos];
+    }
+    const_reference at(const size_type pos) const {
+        return const_cast<small_vector*>(this)->at(pos);
+    }
+
+    reference front() { return m_Data[0]; }
+    const_reference front() const { return m_Data[0]; }
+    reference back() { return m_Data[m_Size - 1]; }
+    const_reference back() const { return m_Data[m_Size - 1]; }
+
+    pointer data() noexcept { return m_Data; }
+    const_pointer data() const noexcept { return m_Data; }
+
+    // ---- iterators ----
+
+    iterator begin() noexcept { return m_Data; }
+    iterator end() noexcept { return m_Data + m_Size; }
+    const_iterator begin() const noexcept { return m_Data; }
+    const_iterator end() const noexcept { return m_Data + m_Size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // ---- capacity ----
+
+    [[nodiscard]] bool empty() const noexcept { return m_Size == 0; }
+    size_type size() const noexcept { return m_Size; }
+    size_type capacity() const noexcept { return m_Capacity; }
+    static constexpr size_type inline_capacity() noexcept { return N; }
+    // true while the elements live in the inline buffer
+    bool is_inline() const noexcept { return m_Data == inline_data(); }
+    std::pmr::memory_resource* resource() const noexcept { return m_Resource; }
+
+    void reserve(const size_type count) {
+        if (count > m_Capacity) {
+            grow(count);
+        }
+    }
+
+    // ---- modifiers ----
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        if (m_Size == m_Capacity) {
+            // construct first: args may reference an element of this vector
+            Type value(std::forward<Args>(args)...);
+            grow(m_Capacity * 2);
+            return *std::construct_at(m_Data + m_Size++, std::move(value));
+        }
+        return *std::construct_at(m_Data + m_Size++, std::forward<Args>(args)...);
+    }
+
+    void push_back(const Type& value) { emplace_back(value); }
+    void push_back(Type&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --m_Size;
+        std::destroy_at(m_Data + m_Size);
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const size_type idx = static_cast<size_type>(pos - begin());
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + idx, end() - 1, end());
+        return begin() + idx;
+    }
+
+    iterator insert(const_iterator pos, const Type& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, Type&& value) { return emplace(pos, std::move(value)); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        iterator dst = begin() + (first - begin());
+        iterator src = begin() + (last - begin());
+        iterator newEnd = std::move(src, end(), dst);
+        std::destroy(newEnd, end());
+        m_Size = static_cast<size_type>(newEnd - begin());
+        return dst;
+    }
+
+    // O(1) erase that does not keep the order of the elements.
+    void swap_erase(const_iterator pos) {
+        iterator it = begin() + (pos - begin());
+        if (it != end() - 1) {
+            *it = std::move(back());
+        }
+        pop_back();
+    }
+
+    void resize(const size_type count) {
+        reserve(count);
+        if (count > m_Size) {
+            std::uninitialized_value_construct(end(), begin() + count);
+        } else {
+            std::destroy(begin() + count, end());
+        }
+        m_Size = count;
+    }
+
+    void resize(const size_type count, const Type& value) {
+        reserve(count);
+        if (count > m_Size) {
+            std::uninitialized_fill(end(), begin() + count, value);
+        } else {
+            std::destroy(begin() + count, end());
+        }
+        m_Size = count;
+    }
+
+    // Keeps the capacity, like std::vector::clear().
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        m_Size = 0;
+    }
+
+    friend bool operator==(const small_vector& a, const small_vector& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
+    }
+
+   private:
+    Type* inline_data() noexcept { return std::launder(reinterpret_cast<Type*>(m_Inline)); }
+    const Type* inline_data() const noexcept {
+        return std::launder(reinterpret_cast<const Type*>(m_Inline));
+    }
+
+    void grow(size_type count) {
+        count = std::max<size_type>(count, std::max<size_type>(N, 1));
+        auto* heap = static_cast<Type*>(m_Resource->allocate(count * sizeof(Type), alignof(Type)));
+
+        std::uninitialized_move(begin(), end(), heap);
+        std::destroy(begin(), end());
+        release();
+
+        m_Data = heap;
+        m_Capacity = count;
+    }
+
+    // frees the heap buffer, elements must already be destroyed or moved out
+    void release() noexcept {
+        if (!is_inline()) {
+            m_Resource->deallocate(m_Data, m_Capacity * sizeof(Type), alignof(Type));
+        }
+        m_Data = inline_data();
+        m_Capacity = N;
+    }
+
+    // this must be empty and inline
+    void take(small_vector&& other) {
+        if (other.is_inline()) {
+            std::uninitialized_move(other.begin(), other.end(), begin());
+            m_Size = other.m_Size;
+            other.clear();
+            return;
+        }
+        m_Data = std::exchange(other.m_Data, other.inline_data());
+        m_Capacity = std::exchange(other.m_Capacity, N);
+        m_Size = std::exchange(other.m_Size, 0);
+    }
+
+    std::pmr::memory_resource* m_Resource{std::pmr::get_default_resource()};
+    Type* m_Data{inline_data()};
+    size_type m_Size{0};
+    size_type m_Capacity{N};
+    alignas(Type) std::byte m_Inline[sizeof(Type) * (N > 0 ? N : 1)];
+};
+
+}  // namespace Core
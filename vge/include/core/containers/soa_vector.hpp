@@ -0,0 +1,299 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <memory>
+#include <memory_resource>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "core/concurrency/cpu.hpp"
+
+namespace Core {
+
+// Structure of arrays: row i is made of the i-th element of every column, and
+// every column is its own contiguous, cache line aligned array. A system that
+// only needs transforms walks column<0>() and never pulls the rest of the row
+// into cache.
+//
+// All columns live in a single allocation from the memory resource and always
+// have the same length: push, erase and swap_erase move every column together.
+// Column element types must be nothrow move constructible, growing moves them.
+template <typename... Ts>
+class SoaVector {
+    static_assert(sizeof...(Ts) > 0, "SoaVector needs at least one column");
+    static_assert((std::is_nothrow_move_constructible_v<Ts> && ...),
+                  "SoaVector columns are relocated when growing");
+
+   public:
+    using size_type = std::size_t;
+    template <std::size_t I>
+    using column_type = std::tuple_element_t<I, std::tuple<Ts...>>;
+
+    static constexpr std::size_t column_count = sizeof...(Ts);
+    static constexpr std::size_t column_alignment = std::max({CacheLineSize, alignof(Ts)...});
+
+    explicit SoaVector(std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {}
+
+    // Like std::pmr containers, copies use the default resource unless told otherwise.
+    SoaVector(const SoaVector& other,
+              std::pmr::memory_resource* resource = std::pmr::get_default_resource())
+        : m_Resource(resource) {
+        reserve(other.m_Size);
+        for_each_column([&](auto I) {
+            std::uninitialized_copy_n(std::get<I>(other.m_Columns), other.m_Size,
+                                      std::get<I>(m_Columns));
+        });
+        m_Size = other.m_Size;
+    }
+
+    SoaVector(SoaVector&& other) noexcept : m_Resource(other.m_Resource) { steal(other); }
+
+    SoaVector& operator=(const SoaVector& other) {
+        if (this != &other) {
+            SoaVector copy(other, m_Resource);
+            clear();
+            release();
+            steal(copy);
+        }
+        return *this;
+    }
+
+    // The resource is never propagated: storage is only stolen when both
+    // vectors share one, otherwise the rows are moved over.
+    SoaVector& operator=(SoaVector&& other) {
+        if (this != &other) {
+            clear();
+            if (m_Resource == other.m_Resource) {
+                release();
+                steal(other);
+            } else {
+                reserve(other.m_Size);
+                for_each_column([&](auto I) {
+                    std::uninitialized_move_n(std::get<I>(other.m_Columns), other.m_Size,
+                                              std::get<I>(m_Columns));
+                });
+                m_Size = other.m_Size;
+                other.clear();
+            }
+        }
+        return *this;
+    }
+
+    ~SoaVector() {
+        clear();
+        release();
+    }
+
+    // ---- columns ----
+
+    template <std::size_t I>
+    std::span<column_type<I>> column() noexcept {
+        return {std::get<I>(m_Columns), m_Size};
+    }
+    template <std::size_t I>
+    std::span<const column_type<I>> column() const noexcept {
+        return {std::get<I>(m_Columns), m_Size};
+    }
+
+    template <std::size_t I>
+    column_type<I>& get(const size_type row) noexcept {
+        return std::get<I>(m_Columns)[row];
+    }
+    template <std::size_t I>
+    const column_type<I>& get(const size_type row) const noexcept {
+        return std::get<I>(m_Columns)[row];
+    }
+
+    // References to every field of a row, for code that does need all of them.
+    std::tuple<Ts&...> row(const size_type index) noexcept {
+        return std::apply([index](Ts*... columns) { return std::tuple<Ts&...>{columns[index]...}; },
+                          m_Columns);
+    }
+    std::tuple<const Ts&...> row(const size_type index) const noexcept {
+        return std::apply(
+            [index](Ts*... columns) { return std::tuple<const Ts&...>{columns[index]...}; },
+            m_Columns);
+    }
+
+    // ---- capacity ----
+
+    [[nodiscard]] bool empty() const noexcept { return m_Size == 0; }
+    size_type size() const noexcept { return m_Size; }
+    size_type capacity() const noexcept { return m_Capacity; }
+    std::pmr::memory_resource* resource() const noexcept { return m_Resource; }
+
+    void reserve(const size_type count) {
+        if (count > m_Capacity) {
+            grow(count);
+        }
+    }
+
+    // ---- modifiers ----
+
+    // One argument per column, returns the index of the new row.
+    template <typename... Args>
+        requires(sizeof...(Args) == sizeof...(Ts))
+    size_type emplace_back(Args&&... args) {
+        if (m_Size == m_Capacity) {
+            // build the row first: args may reference one of our own rows
+            std::tuple<Ts...> values(std::forward<Args>(args)...);
+            grow(std::max<size_type>(m_Capacity * 2, 8));
+            construct_row(m_Size, std::move(values), Indices{});
+        } else {
+            construct_row(m_Size, std::forward_as_tuple(std::forward<Args>(args)...), Indices{});
+        }
+        return m_Size++;
+    }
+
+    size_type push_back(const Ts&... values) { return emplace_back(values...); }
+    size_type push_back(Ts&&... values) { return emplace_back(std::move(values)...); }
+
+    void pop_back() noexcept {
+        --m_Size;
+        for_each_column([&](auto I) { std::destroy_at(std::get<I>(m_Columns) + m_Size); });
+    }
+
+    // Keeps the order of the rows, shifts every column down by one.
+    void erase(const size_type row) {
+        for_each_column([&](auto I) {
+            auto* column = std::get<I>(m_Columns);
+            std::move(column + row + 1, column + m_Size, column + row);
+        });
+        pop_back();
+    }
+
+    // O(1): moves the last row into the erased one. Returns the old index of
+    // the row that moved, so callers holding indices can patch them up.
+    size_type swap_erase(const size_type row) {
+        const size_type last = m_Size - 1;
+        if (row != last) {
+            for_each_column([&](auto I) {
+                std::get<I>(m_Columns)[row] = std::move(std::get<I>(m_Columns)[last]);
+            });
+        }
+        pop_back();
+        return last;
+    }
+
+    // New rows are value initialized.
+    void resize(const size_type count) {
+        if (count < m_Size) {
+            destroy_rows(count, m_Size);
+        } else if (count > m_Size) {
+            reserve(count);
+            for_each_column([&](auto I) {
+                std::uninitialized_value_construct(std::get<I>(m_Columns) + m_Size,
+                                                   std::get<I>(m_Columns) + count);
+            });
+        }
+        m_Size = count;
+    }
+
+    // Keeps the capacity.
+    void clear() noexcept {
+        destroy_rows(0, m_Size);
+        m_Size = 0;
+    }
+
+   private:
+    using Indices = std::index_sequence_for<Ts...>;
+
+    // Calls f(std::integral_constant<std::size_t, I>) for every column index.
+    template <typename F>
+    static void for_each_column(F&& f) {
+        [&]<std::size_t... I>(std::index_sequence<I...>) {
+            (f(std::integral_constant<std::size_t, I>{}), ...);
+        }(Indices{});
+    }
+
+    static constexpr size_type align_up(const size_type offset) {
+        return (offset + column_alignment - 1) & ~(column_alignment - 1);
+    }
+
+    // Each column starts on its own cache line, right after the previous one.
+    static constexpr size_type block_size(const size_type capacity) {
+        size_type bytes = 0;
+        ((bytes = align_up(bytes) + sizeof(Ts) * capacity), ...);
+        return bytes;
+    }
+
+    static std::tuple<Ts*...> columns_in(std::byte* block, const size_type capacity) {
+        size_type offset = 0;
+        auto place = [&]<typename T>(std::type_identity<T>) {
+            offset = align_up(offset);
+            T* column = reinterpret_cast<T*>(block + offset);
+            offset += sizeof(T) * capacity;
+            return column;
+        };
+        // braced init: evaluated left to right
+        return std::tuple<Ts*...>{place(std::type_identity<Ts>{})...};
+    }
+
+    void grow(const size_type count) {
+        auto* block =
+            static_cast<std::byte*>(m_Resource->allocate(block_size(count), column_alignment));
+        std::tuple<Ts*...> columns = columns_in(block, count);
+
+        for_each_column([&](auto I) {
+            std::uninitialized_move_n(std::get<I>(m_Columns), m_Size, std::get<I>(columns));
+        });
+        destroy_rows(0, m_Size);
+
+        release();
+        m_Block = block;
+        m_Columns = columns;
+        m_Capacity = count;
+    }
+
+    // frees the block, rows must already be destroyed or moved out
+    void release() noexcept {
+        if (m_Block) {
+            m_Resource->deallocate(m_Block, block_size(m_Capacity), column_alignment);
+        }
+        m_Block = nullptr;
+        m_Columns = {};
+        m_Capacity = 0;
+    }
+
+    // this must be empty and released
+    void steal(SoaVector& other) noexcept {
+        m_Block = std::exchange(other.m_Block, nullptr);
+        m_Columns = std::exchange(other.m_Columns, {});
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Capacity = std::exchange(other.m_Capacity, 0);
+    }
+
+    // Destroys the columns already built if a later one throws, so a failed
+    // push leaves the vector as it was.
+    template <typename Tuple, std::size_t... I>
+    void construct_row(const size_type row, Tuple&& values, std::index_sequence<I...>) {
+        std::size_t constructed = 0;
+        try {
+            ((std::construct_at(std::get<I>(m_Columns) + row,
+                                std::get<I>(std::forward<Tuple>(values))),
+              ++constructed),
+             ...);
+        } catch (...) {
+            ((I < constructed ? std::destroy_at(std::get<I>(m_Columns) + row) : void()), ...);
+            throw;
+        }
+    }
+
+    void destroy_rows(const size_type first, const size_type last) noexcept {
+        for_each_column([&](auto I) {
+            std::destroy(std::get<I>(m_Columns) + first, std::get<I>(m_Columns) + last);
+        });
+    }
+
+    std::pmr::memory_resource* m_Resource{std::pmr::get_default_resource()};
+    std::byte* m_Block{nullptr};
+    std::tuple<Ts*...> m_Columns{};
+    size_type m_Size{0};
+    size_type m_Capacity{0};
+};
+
+}  // namespace Core
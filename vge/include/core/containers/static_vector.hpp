@@ -1,37 +1,223 @@
 #pragma once
 
+#include <algorithm>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
 #include <memory>
 #include <new>
+#include <stdexcept>
 #include <type_traits>
+#include <utility>
 
 #include "core/logger.hpp"
 
+namespace Core {
+
+// std::vector interface over inline storage for at most N elements, never
+// touches the heap. Growing past N logs FATAL and throws std::bad_alloc, like
+// the engine allocators.
 template <class Type, std::size_t N>
 class static_vector {
    public:
-    template <typename... Args>
-    void emplace_back(Args&&... args) {
-        if (m_Size >= N) {
-            // bad alloc
-            CORE_LOG_FATAL("[StaticVector]: Bad alloc");
-            return;
+    using value_type = Type;
+    using size_type = std::size_t;
+    using difference_type = std::ptrdiff_t;
+    using reference = Type&;
+    using const_reference = const Type&;
+    using pointer = Type*;
+    using const_pointer = const Type*;
+    using iterator = Type*;
+    using const_iterator = const Type*;
+    using reverse_iterator = std::reverse_iterator<iterator>;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+    static_vector() noexcept = default;
+
+    explicit static_vector(const size_type count) { resize(count); }
+    static_vector(const size_type count, const Type& value) { resize(count, value); }
+    static_vector(std::initializer_list<Type> init) { assign(init.begin(), init.end()); }
+
+    template <std::input_iterator It>
+    static_vector(It first, It last) {
+        assign(first, last);
+    }
+
+    static_vector(const static_vector& other) { assign(other.begin(), other.end()); }
+
+    static_vector(static_vector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        std::uninitialized_move(other.begin(), other.end(), begin());
+        m_Size = other.m_Size;
+        other.clear();
+    }
+
+    static_vector& operator=(const static_vector& other) {
+        if (this != &other) {
+            assign(other.begin(), other.end());
         }
+        return *this;
+    }
+
+    static_vector& operator=(static_vector&& other) noexcept(
+        std::is_nothrow_move_constructible_v<Type>) {
+        if (this != &other) {
+            clear();
+            std::uninitialized_move(other.begin(), other.end(), begin());
+            m_Size = other.m_Size;
+            other.clear();
+        }
+        return *this;
+    }
+
+    static_vector& operator=(std::initializer_list<Type> init) {
+        assign(init.begin(), init.end());
+        return *this;
+    }
+
+    ~static_vector() { clear(); }
+
+    template <std::input_iterator It>
+    void assign(It first, It last) {
+        clear();
+        for (; first != last; ++first) {
+            emplace_back(*first);
+        }
+    }
+
+    // ---- element access ----
+
+    reference operator[](const size_type pos) { return data()[pos]; }
+    const_reference operator[](const size_type pos) const { return data()[pos]; }
+
+    reference at(const size_type pos) {
+        if (pos >= m_Size) {
+            throw std::out_of_range("[StaticVector]: Index out of range");
+        }
+        return data()[pos];
+    }
+    const_reference at(const size_type pos) const {
+        return const_cast<static_vector*>(this)->at(pos);
+    }
+
+    reference front() { return data()[0]; }
+    const_reference front() const { return data()[0]; }
+    reference back() { return data()[m_Size - 1]; }
+    const_reference back() const { return data()[m_Size - 1]; }
+
+    pointer data() noexcept { return std::launder(reinterpret_cast<Type*>(m_Storage)); }
+    const_pointer data() const noexcept {
+        return std::launder(reinterpret_cast<const Type*>(m_Storage));
+    }
 
-        ::new (&data[m_Size]) Type(std::forward<Args>(args)...);
+    // ---- iterators ----
+
+    iterator begin() noexcept { return data(); }
+    iterator end() noexcept { return data() + m_Size; }
+    const_iterator begin() const noexcept { return data(); }
+    const_iterator end() const noexcept { return data() + m_Size; }
+    const_iterator cbegin() const noexcept { return begin(); }
+    const_iterator cend() const noexcept { return end(); }
+    reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+    reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+    const_reverse_iterator rbegin() const noexcept { return const_reverse_iterator(end()); }
+    const_reverse_iterator rend() const noexcept { return const_reverse_iterator(begin()); }
+
+    // ---- capacity ----
+
+    [[nodiscard]] bool empty() const noexcept { return m_Size == 0; }
+    [[nodiscard]] bool full() const noexcept { return m_Size == N; }
+    size_type size() const noexcept { return m_Size; }
+    static constexpr size_type capacity() noexcept { return N; }
+    static constexpr size_type max_size() noexcept { return N; }
+
+    // ---- modifiers ----
+
+    template <typename... Args>
+    reference emplace_back(Args&&... args) {
+        check_capacity(m_Size + 1);
+        Type* slot = std::construct_at(data() + m_Size, std::forward<Args>(args)...);
         ++m_Size;
+        return *slot;
+    }
+
+    void push_back(const Type& value) { emplace_back(value); }
+    void push_back(Type&& value) { emplace_back(std::move(value)); }
+
+    void pop_back() {
+        --m_Size;
+        std::destroy_at(data() + m_Size);
+    }
+
+    template <typename... Args>
+    iterator emplace(const_iterator pos, Args&&... args) {
+        const size_type idx = static_cast<size_type>(pos - begin());
+        emplace_back(std::forward<Args>(args)...);
+        std::rotate(begin() + idx, end() - 1, end());
+        return begin() + idx;
+    }
+
+    iterator insert(const_iterator pos, const Type& value) { return emplace(pos, value); }
+    iterator insert(const_iterator pos, Type&& value) { return emplace(pos, std::move(value)); }
+
+    iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+    iterator erase(const_iterator first, const_iterator last) {
+        iterator dst = begin() + (first - begin());
+        iterator src = begin() + (last - begin());
+        iterator newEnd = std::move(src, end(), dst);
+        std::destroy(newEnd, end());
+        m_Size = static_cast<size_type>(newEnd - begin());
+        return dst;
     }
 
-    const Type& operator[](std::size_t pos) const {
-        return *std::launder(reinterpret_cast<const Type*>(&data[pos]));
+    // O(1) erase that does not keep the order of the elements.
+    void swap_erase(const_iterator pos) {
+        iterator it = begin() + (pos - begin());
+        if (it != end() - 1) {
+            *it = std::move(back());
+        }
+        pop_back();
     }
 
-    ~static_vector() {
-        for (std::size_t pos = 0; pos < m_Size; ++pos) {
-            std::destroy_at(std::launder(reinterpret_cast<Type*>(&data[pos])));
+    void resize(const size_type count) {
+        check_capacity(count);
+        if (count > m_Size) {
+            std::uninitialized_value_construct(end(), begin() + count);
+        } else {
+            std::destroy(begin() + count, end());
         }
+        m_Size = count;
+    }
+
+    void resize(const size_type count, const Type& value) {
+        check_capacity(count);
+        if (count > m_Size) {
+            std::uninitialized_fill(end(), begin() + count, value);
+        } else {
+            std::destroy(begin() + count, end());
+        }
+        m_Size = count;
+    }
+
+    void clear() noexcept {
+        std::destroy(begin(), end());
+        m_Size = 0;
+    }
+
+    friend bool operator==(const static_vector& a, const static_vector& b) {
+        return std::equal(a.begin(), a.end(), b.begin(), b.end());
     }
 
    private:
-    std::size_t m_Size = 0;
-    std::aligned_storage<sizeof(Type), alignof(Type)> data[N];
+    static void check_capacity(const size_type count) {
+        if (count > N) {
+            CORE_LOG_FATAL("[StaticVector]: Capacity of {} exceeded ({} elements)", N, count);
+            throw std::bad_alloc();
+        }
+    }
+
+    alignas(Type) std::byte m_Storage[sizeof(Type) * (N > 0 ? N : 1)];
+    size_type m_Size = 0;
 };
+
+}  // namespace Core
@@ -0,0 +1,152 @@
+#pragma once
+
+#include <cstring>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#if defined(_MSC_VER) && defined(_M_X64)
+#include <intrin.h>
+#endif
+
+#include "defines.hpp"
+
+// wyhash (Wang Yi, public domain): fast, and strong enough that the low bits
+// can be used directly by open addressing tables. std::hash<integer> is the
+// identity on the major standard libraries, which is not.
+namespace Core {
+
+namespace Detail {
+
+inline constexpr U64 WySecret[4] = {0x2d358dccaa6c78a5ull, 0x8bb84b93962eacc9ull,
+                                    0x4b33a62ed433d4a3ull, 0x4d5a2da51de1aa47ull};
+
+inline void wymum(U64& a, U64& b) {
+#if defined(__SIZEOF_INT128__)
+    const __uint128_t r = static_cast<__uint128_t>(a) * b;
+    a = static_cast<U64>(r);
+    b = static_cast<U64>(r >> 64);
+#elif defined(_MSC_VER) && defined(_M_X64)
+    a = _umul128(a, b, &b);
+#else
+    const U64 ha = a >> 32, hb = b >> 32, la = static_cast<U32>(a), lb = static_cast<U32>(b);
+    const U64 rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    const U64 t = rl + (rm0 << 32);
+    U64 c = t < rl;
+    const U64 lo = t + (rm1 << 32);
+    c += lo < t;
+    a = lo;
+    b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+inline U64 wymix(U64 a, U64 b) {
+    wymum(a, b);
+    return a ^ b;
+}
+
+inline U64 wyr8(const U8* p) {
+    U64 v;
+    std::memcpy(&v, p, 8);
+    return v;
+}
+
+inline U64 wyr4(const U8* p) {
+    U32 v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+inline U64 wyr3(const U8* p, const std::size_t k) {
+    return (static_cast<U64>(p[0]) << 16) | (static_cast<U64>(p[k >> 1]) << 8) | p[k - 1];
+}
+
+}  // namespace Detail
+
+inline U64 hash_bytes(const void* key, std::size_t len, U64 seed = 0) {
+    using namespace Detail;
+    const auto* p = static_cast<const U8*>(key);
+    const U64* s = WySecret;
+
+    seed ^= wymix(seed ^ s[0], s[1]);
+    U64 a = 0;
+    U64 b = 0;
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (wyr4(p) << 32) | wyr4(p + ((len >> 3) << 2));
+            b = (wyr4(p + len - 4) << 32) | wyr4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = wyr3(p, len);
+        }
+    } else {
+        std::size_t i = len;
+        if (i > 48) {
+            U64 see1 = seed;
+            U64 see2 = seed;
+            do {
+                seed = wymix(wyr8(p) ^ s[1], wyr8(p + 8) ^ seed);
+                see1 = wymix(wyr8(p + 16) ^ s[2], wyr8(p + 24) ^ see1);
+                see2 = wymix(wyr8(p + 32) ^ s[3], wyr8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i > 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = wymix(wyr8(p) ^ s[1], wyr8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = wyr8(p + i - 16);
+        b = wyr8(p + i - 8);
+    }
+
+    a ^= s[1];
+    b ^= seed;
+    wymum(a, b);
+    return wymix(a ^ s[0] ^ len, b ^ s[1]);
+}
+
+inline U64 hash_u64(const U64 value, const U64 seed = 0) {
+    return Detail::wymix(value ^ Detail::WySecret[0], seed ^ Detail::WySecret[1]);
+}
+
+inline U64 hash_combine(const U64 seed, const U64 value) {
+    return Detail::wymix(seed ^ Detail::WySecret[2], value ^ Detail::WySecret[3]);
+}
+
+// Default hasher of the engine containers. Strings hash their characters,
+// types without padding or floats their bytes, everything else goes through
+// std::hash and gets remixed.
+template <typename T>
+struct Hash {
+    std::size_t operator()(const T& value) const {
+        if constexpr (std::is_integral_v<T> || std::is_enum_v<T> || std::is_pointer_v<T>) {
+            U64 bits = 0;
+            std::memcpy(&bits, &value, sizeof(T));
+            return static_cast<std::size_t>(hash_u64(bits));
+        } else if constexpr (std::has_unique_object_representations_v<T>) {
+            return static_cast<std::size_t>(hash_bytes(&value, sizeof(T)));
+        } else {
+            return static_cast<std::size_t>(hash_u64(std::hash<T>{}(value)));
+        }
+    }
+};
+
+// Transparent: a FlatHashMap<std::string, V> can be searched with a
+// std::string_view or a literal without building a std::string.
+struct StringHash {
+    using is_transparent = void;
+
+    std::size_t operator()(const std::string_view s) const {
+        return static_cast<std::size_t>(hash_bytes(s.data(), s.size()));
+    }
+};
+
+template <>
+struct Hash<std::string> : StringHash {};
+template <>
+struct Hash<std::string_view> : StringHash {};
+
+}  // namespace Core
@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+
+#include "defines.hpp"
+#include "core/memory/memory.hpp"
+
+namespace Core {
+
+// Counts heap allocations per frame and attributes them to the innermost
+// profiler scope / MemoryTag of the allocating thread.
+//
+// The counting logic is always compiled. The global operator new/delete hooks
+// that feed it are only installed when the engine is configured with
+// -DENABLE_ALLOCATION_PROFILER=ON (VGE_ALLOCATION_PROFILER), the PROFILE_*
+// macros compile to nothing otherwise.
+//
+// Everything reachable from on_allocate() is allocation free: scopes live in a
+// fixed thread local stack, counters in fixed tables, callstacks in a fixed
+// ring. Allocations made by the profiler itself (reports, logging) are not
+// counted.
+class AllocationProfiler {
+   public:
+    static constexpr U32 MaxScopeDepth = 32;
+    static constexpr U32 MaxScopes = 128;
+    static constexpr U32 MaxCallstackDepth = 16;
+    static constexpr U32 MaxCallstacks = 64;
+
+    struct FrameStats {
+        U64 frame;
+        U64 allocations;
+        U64 frees;
+        U64 bytes;
+    };
+
+    struct Counters {
+        U64 allocations;
+        U64 bytes;
+    };
+
+    struct ScopeStats {
+        const char* name;
+        Counters lastFrame;
+        Counters total;
+    };
+
+    struct Callstack {
+        U64 frame;
+        std::size_t bytes;
+        const char* scope;
+        MemoryTag tag;
+        U32 depth;
+        std::array<void*, MaxCallstackDepth> frames;
+    };
+
+    using ViolationHandler = void (*)(const Callstack&);
+
+    // Entry points of the operator new/delete hooks.
+    static void on_allocate(std::size_t bytes) noexcept;
+    static void on_free() noexcept;
+
+    // Scopes nest per thread. A scope pushed with only a name inherits the
+    // enclosing tag and vice versa. @name must outlive the profiler (string
+    // literal), scopes are keyed by pointer.
+    static void push_scope(const char* name, MemoryTag tag) noexcept;
+    static void push_scope(const char* name) noexcept;
+    static void push_scope(MemoryTag tag) noexcept;
+    static void pop_scope() noexcept;
+
+    static const char* current_scope() noexcept;
+    static MemoryTag current_tag() noexcept;
+
+    static void begin_frame() noexcept;
+    // Closes the frame and makes its counters available through last_frame(),
+    // tag_stats() and scope_stats().
+    static FrameStats end_frame() noexcept;
+
+    static FrameStats last_frame() noexcept;
+    static Counters tag_stats(MemoryTag tag) noexcept;
+    // Fills @out with every scope seen so far, returns the number written.
+    static std::size_t scope_stats(std::span<ScopeStats> out) noexcept;
+
+    // Captures the callstack of every @interval-th allocation, 0 disables.
+    static void set_sample_interval(U32 interval) noexcept;
+    // Most recent samples first, returns the number written.
+    static std::size_t sampled_callstacks(std::span<Callstack> out) noexcept;
+
+    // Once @warmupFrames frames have completed, any allocation made between
+    // begin_frame() and end_frame() calls @handler. The default handler prints
+    // the offending callstack and aborts.
+    static void enforce_zero_allocation_frames(U32 warmupFrames,
+                                               ViolationHandler handler = nullptr) noexcept;
+    static void disable_zero_allocation_frames() noexcept;
+
+    // Logs the last frame's allocations per tag and scope, and the sampled
+    // callstacks.
+    static void report();
+
+    // Clears every counter, sample and the enforcement state.
+    static void reset() noexcept;
+
+   private:
+    AllocationProfiler() = delete;
+};
+
+class AllocationScope {
+   public:
+    explicit AllocationScope(const char* name) noexcept { AllocationProfiler::push_scope(name); }
+    explicit AllocationScope(MemoryTag tag) noexcept { AllocationProfiler::push_scope(tag); }
+    AllocationScope(const char* name, MemoryTag tag) noexcept {
+        AllocationProfiler::push_scope(name, tag);
+    }
+    ~AllocationScope() noexcept { AllocationProfiler::pop_scope(); }
+
+    AllocationScope(const AllocationScope&) = delete;
+    AllocationScope& operator=(const AllocationScope&) = delete;
+};
+
+}  // namespace Core
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+#ifdef VGE_ALLOCATION_PROFILER
+#define PROFILE_ALLOCATION_SCOPE(name) \
+    ::Core::AllocationScope PROFILE_CONCAT(_allocScope, __LINE__) { name }
+#define PROFILE_ALLOCATION_TAG(tag) \
+    ::Core::AllocationScope PROFILE_CONCAT(_allocScope, __LINE__) { tag }
+#else
+#define PROFILE_ALLOCATION_SCOPE(name)
+#define PROFILE_ALLOCATION_TAG(tag)
+#endif
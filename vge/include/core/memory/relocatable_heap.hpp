@@ -0,0 +1,350 @@
+#pragma once
+
+#include <chrono>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <vector>
+
+#include "defines.hpp"
+#include "align_utils.hpp"
+#include "core/assert.hpp"
+#include "core/logger.hpp"
+#include "core/timer.hpp"
+#include "resource/handle.hpp"
+
+namespace Core::Allocator {
+
+// RelocatableHeap hands out handles instead of pointers, so that live blocks
+// can be slid towards the start of the buffer to close the holes left by
+// freed blocks. Blocks are moved with memmove: only store trivially
+// relocatable data in them.
+//
+// Raw pointers returned by get() are valid until the next call to compact().
+// Callers that hold a pointer across a compaction must pin() the block first,
+// pinned blocks are never moved.
+//
+// [ A | hole | B | C | hole | D(pinned) | hole | E |         ]
+//  compact() ->
+// [ A | B | C |      hole      | D(pinned) | E |            ]
+class RelocatableHeap {
+   public:
+    using Handle = Resource::Handle;
+
+    struct Stats {
+        std::size_t capacity;
+        std::size_t usedBytes;
+        std::size_t freeBytes;
+        std::size_t largestFreeBlock;
+        std::size_t liveBlocks;
+        std::size_t pinnedBlocks;
+    };
+
+    explicit RelocatableHeap(const std::size_t capacity, const std::size_t alignment = 16)
+        : m_Capacity(MemoryUtil::RoundToAlignment(capacity, alignment)), m_Alignment(alignment) {
+        ASSERT_MSG(MemoryUtil::IsPowerOfTwo(alignment),
+                   "[RelocatableHeap]: Alignment must be power of 2");
+        m_Buffer = static_cast<std::byte*>(
+            ::operator new(m_Capacity, static_cast<std::align_val_t>(m_Alignment)));
+    }
+
+    RelocatableHeap(const RelocatableHeap&) = delete;
+    RelocatableHeap& operator=(const RelocatableHeap&) = delete;
+    RelocatableHeap(RelocatableHeap&&) = delete;
+    RelocatableHeap& operator=(RelocatableHeap&&) = delete;
+
+    ~RelocatableHeap() {
+        ::operator delete(m_Buffer, static_cast<std::align_val_t>(m_Alignment));
+        m_Buffer = nullptr;
+    }
+
+    // Returns a null handle if no hole (nor the tail) is large enough.
+    // Running compact() and retrying may succeed in that case.
+    [[nodiscard]] Handle allocate(const std::size_t bytes) {
+        const std::size_t size = MemoryUtil::RoundToAlignment(bytes > 0 ? bytes : 1, m_Alignment);
+
+        U32 prev = InvalidIndex;
+        std::size_t offset = 0;
+        if (!find_fit(size, prev, offset)) {
+            CORE_LOG_WARN("[RelocatableHeap]: No block of {} bytes available ({} bytes free).",
+                          size, m_Capacity - m_UsedBytes);
+            return Handle::null();
+        }
+
+        const U32 idx = acquire_entry();
+        if (idx == InvalidIndex) {
+            CORE_LOG_ERROR("[RelocatableHeap]: Out of handles!");
+            return Handle::null();
+        }
+
+        Entry& e = m_Entries[idx];
+        e.offset = offset;
+        e.size = size;
+        e.pins = 0;
+        e.live = true;
+        link_after(prev, idx);
+
+        m_UsedBytes += size;
+        return Handle::make(idx, e.generation);
+    }
+
+    void free(const Handle h) {
+        Entry* e = resolve(h);
+        if (!e) {
+            CORE_LOG_WARN("[RelocatableHeap]: Freeing an invalid or outdated handle.");
+            return;
+        }
+        ASSERT_MSG(e->pins == 0, "[RelocatableHeap]: Freeing a pinned block");
+
+        const U32 idx = h.index();
+        if (m_Cursor == idx) {
+            m_Cursor = e->next;
+        }
+        unlink(idx);
+
+        m_UsedBytes -= e->size;
+        e->live = false;
+        e->pins = 0;
+        e->generation++;
+
+        // retire the entry once its generation counter is exhausted
+        if (e->generation == Handle::GenMask) {
+            CORE_LOG_WARN("[RelocatableHeap]: Entry with index {} is overflown!", idx);
+            return;
+        }
+
+        e->next = m_FreeEntries;
+        m_FreeEntries = idx;
+    }
+
+    // Pointer is invalidated by the next compact() unless the block is pinned.
+    [[nodiscard]] void* get(const Handle h) const {
+        const Entry* e = resolve(h);
+        return e ? m_Buffer + e->offset : nullptr;
+    }
+
+    [[nodiscard]] void* pin(const Handle h) {
+        Entry* e = resolve(h);
+        if (!e) {
+            return nullptr;
+        }
+        ASSERT_MSG(e->pins < std::numeric_limits<U16>::max(),
+                   "[RelocatableHeap]: Pin count overflow");
+        e->pins++;
+        return m_Buffer + e->offset;
+    }
+
+    void unpin(const Handle h) {
+        Entry* e = resolve(h);
+        if (!e || e->pins == 0) {
+            CORE_LOG_WARN("[RelocatableHeap]: Unpinning a block that is not pinned.");
+            return;
+        }
+        e->pins--;
+    }
+
+    [[nodiscard]] bool is_pinned(const Handle h) const {
+        const Entry* e = resolve(h);
+        return e && e->pins > 0;
+    }
+
+    [[nodiscard]] std::size_t size_of(const Handle h) const {
+        const Entry* e = resolve(h);
+        return e ? e->size : 0;
+    }
+
+    // Incremental defragmentation: slides unpinned blocks down onto the end of
+    // their predecessor, resuming where the previous call stopped. At least one
+    // block is visited per call, after that the walk stops as soon as @budget
+    // has elapsed. Returns the number of bytes moved.
+    std::size_t compact(const std::chrono::microseconds budget) {
+        Timer timer;
+        timer.start();
+
+        std::size_t moved = 0;
+        U32 idx = m_Cursor != InvalidIndex ? m_Cursor : m_Head;
+
+        while (idx != InvalidIndex) {
+            Entry& e = m_Entries[idx];
+            const std::size_t target = e.prev != InvalidIndex ? end_of(m_Entries[e.prev]) : 0;
+
+            if (e.pins == 0 && e.offset > target) {
+                std::memmove(m_Buffer + target, m_Buffer + e.offset, e.size);
+                e.offset = target;
+                moved += e.size;
+            }
+
+            idx = e.next;
+            if (timer.elapsed<Timer::Microseconds>() >= static_cast<double>(budget.count())) {
+                break;
+            }
+        }
+
+        m_Cursor = idx;
+        m_BytesMoved += moved;
+        return moved;
+    }
+
+    // Runs compaction passes until no block can be moved any further.
+    std::size_t compact_full() {
+        std::size_t total = 0;
+        m_Cursor = InvalidIndex;
+        for (;;) {
+            const std::size_t moved = compact(std::chrono::microseconds::max());
+            total += moved;
+            if (moved == 0) {
+                return total;
+            }
+        }
+    }
+
+    [[nodiscard]] Stats stats() const {
+        Stats s{};
+        s.capacity = m_Capacity;
+        s.usedBytes = m_UsedBytes;
+        s.freeBytes = m_Capacity - m_UsedBytes;
+
+        std::size_t cursor = 0;
+        for (U32 idx = m_Head; idx != InvalidIndex; idx = m_Entries[idx].next) {
+            const Entry& e = m_Entries[idx];
+            s.largestFreeBlock = std::max(s.largestFreeBlock, e.offset - cursor);
+            s.liveBlocks++;
+            s.pinnedBlocks += e.pins > 0 ? 1 : 0;
+            cursor = end_of(e);
+        }
+        s.largestFreeBlock = std::max(s.largestFreeBlock, m_Capacity - cursor);
+        return s;
+    }
+
+    // 0 when all free memory is one contiguous range, approaching 1 as it is
+    // scattered into many small holes.
+    [[nodiscard]] float fragmentation() const {
+        const Stats s = stats();
+        if (s.freeBytes == 0) {
+            return 0.0f;
+        }
+        return 1.0f - static_cast<float>(s.largestFreeBlock) / static_cast<float>(s.freeBytes);
+    }
+
+    std::size_t capacity() const noexcept { return m_Capacity; }
+    std::size_t used_bytes() const noexcept { return m_UsedBytes; }
+    std::size_t total_bytes_moved() const noexcept { return m_BytesMoved; }
+
+   private:
+    static constexpr U32 InvalidIndex = std::numeric_limits<U32>::max();
+    static constexpr U32 MaxEntries = Handle::IndexMask + 1u;
+
+    struct Entry {
+        std::size_t offset = 0;
+        std::size_t size = 0;
+        // neighbours in address order while live, next free entry otherwise
+        U32 prev = InvalidIndex;
+        U32 next = InvalidIndex;
+        U16 generation = 1;  // generation = 0 is a null handle
+        U16 pins = 0;
+        bool live = false;
+    };
+
+    static std::size_t end_of(const Entry& e) { return e.offset + e.size; }
+
+    Entry* resolve(const Handle h) {
+        if (h.index() >= m_Entries.size()) {
+            return nullptr;
+        }
+        Entry& e = m_Entries[h.index()];
+        return e.live && e.generation == h.gen() ? &e : nullptr;
+    }
+
+    const Entry* resolve(const Handle h) const {
+        return const_cast<RelocatableHeap*>(this)->resolve(h);
+    }
+
+    // First fit: the tail is tried first since it is usually the largest
+    // range, then the holes between blocks in address order.
+    bool find_fit(const std::size_t size, U32& prev, std::size_t& offset) const {
+        const std::size_t top = m_Tail != InvalidIndex ? end_of(m_Entries[m_Tail]) : 0;
+        if (m_Capacity - top >= size) {
+            prev = m_Tail;
+            offset = top;
+            return true;
+        }
+
+        std::size_t cursor = 0;
+        U32 before = InvalidIndex;
+        for (U32 idx = m_Head; idx != InvalidIndex; idx = m_Entries[idx].next) {
+            const Entry& e = m_Entries[idx];
+            if (e.offset - cursor >= size) {
+                prev = before;
+                offset = cursor;
+                return true;
+            }
+            cursor = end_of(e);
+            before = idx;
+        }
+        return false;
+    }
+
+    U32 acquire_entry() {
+        if (m_FreeEntries != InvalidIndex) {
+            const U32 idx = m_FreeEntries;
+            m_FreeEntries = m_Entries[idx].next;
+            return idx;
+        }
+        if (m_Entries.size() >= MaxEntries) {
+            return InvalidIndex;
+        }
+        m_Entries.emplace_back();
+        return static_cast<U32>(m_Entries.size() - 1);
+    }
+
+    void link_after(const U32 prev, const U32 idx) {
+        Entry& e = m_Entries[idx];
+        e.prev = prev;
+        e.next = prev != InvalidIndex ? m_Entries[prev].next : m_Head;
+
+        if (e.next != InvalidIndex) {
+            m_Entries[e.next].prev = idx;
+        } else {
+            m_Tail = idx;
+        }
+
+        if (prev != InvalidIndex) {
+            m_Entries[prev].next = idx;
+        } else {
+            m_Head = idx;
+        }
+    }
+
+    void unlink(const U32 idx) {
+        Entry& e = m_Entries[idx];
+        if (e.prev != InvalidIndex) {
+            m_Entries[e.prev].next = e.next;
+        } else {
+            m_Head = e.next;
+        }
+        if (e.next != InvalidIndex) {
+            m_Entries[e.next].prev = e.prev;
+        } else {
+            m_Tail = e.prev;
+        }
+        e.prev = e.next = InvalidIndex;
+    }
+
+    std::size_t m_Capacity;
+    std::size_t m_Alignment;
+    std::byte* m_Buffer{};
+
+    std::vector<Entry> m_Entries;
+    U32 m_FreeEntries{InvalidIndex};
+
+    // live blocks sorted by offset
+    U32 m_Head{InvalidIndex};
+    U32 m_Tail{InvalidIndex};
+    // where the next compact() resumes
+    U32 m_Cursor{InvalidIndex};
+
+    std::size_t m_UsedBytes{0};
+    std::size_t m_BytesMoved{0};
+};
+
+}  // namespace Core::Allocator
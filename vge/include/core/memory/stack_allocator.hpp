@@ -23,7 +23,9 @@ class StackAllocator {
     }
 
     [[nodiscard]] void* allocate(U32 size, U32 alignment = 16) {
-        U32 topAligned = MemoryUtil::AlignTo<U32>(m_Top, alignment);
+        // align the address, not the offset: malloc only guarantees 16 bytes
+        const U32 topAligned =
+            static_cast<U32>(MemoryUtil::AlignTo(m_Buffer + m_Top, alignment) - m_Buffer);
         if (topAligned + size > m_Size) {
             CORE_LOG_FATAL("[StackAllocator]: Out of pool memory!");
             throw std::bad_alloc();
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <filesystem>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace Platform {
+
+// Reports files written under watched directories, recursively and including
+// directories created later. A file counts as changed once it was closed
+// after writing or renamed into place, so a half written file is never
+// reported. Backed by inotify on Linux. Elsewhere watch() fails and nothing
+// is ever reported.
+//
+// Not thread safe, watch and poll from one thread.
+class FileWatcher {
+public:
+    FileWatcher() = default;
+    ~FileWatcher();
+
+    FileWatcher(const FileWatcher&) = delete;
+    FileWatcher& operator=(const FileWatcher&) = delete;
+
+    // Watches directory and every directory below it. Returns false if it is
+    // not a directory or watching is not supported.
+    bool watch(const std::filesystem::path& directory);
+    // Appends every file changed since the last poll, once each, and returns
+    // how many. Never blocks. When the kernel dropped events the directories
+    // passed to watch() are appended instead, anything below them may have
+    // changed.
+    size_t poll(std::vector<std::filesystem::path>& changed);
+
+    bool isWatching() const { return !m_Directories.empty(); }
+
+private:
+    bool addWatch(const std::filesystem::path& directory);
+
+    int m_Fd = -1;
+    // watch descriptor -> directory
+    std::unordered_map<int, std::filesystem::path> m_Directories;
+    // as passed to watch(), reported when events were lost
+    std::vector<std::filesystem::path> m_Roots;
+};
+
+} // namespace Platform
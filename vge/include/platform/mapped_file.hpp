@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace Platform {
+
+// Read-only mapping of a whole file. Pages are read in on first touch, so
+// opening is cheap and bytes that are never read never leave the disk.
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Closes the current mapping first. Returns false if the file cannot be
+    // opened or mapped. An empty file opens with no bytes.
+    bool open(const std::filesystem::path& path);
+    void close();
+
+    bool isOpen() const { return m_Open; }
+    const std::byte* data() const { return m_Data; }
+    size_t size() const { return m_Size; }
+    std::span<const std::byte> bytes() const { return { m_Data, m_Size }; }
+
+private:
+    const std::byte* m_Data = nullptr;
+    size_t m_Size = 0;
+    bool m_Open = false;
+};
+
+} // namespace Platform
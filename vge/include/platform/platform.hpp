@@ -36,6 +36,10 @@ class Platform {
     static inline const U32 MIN_WINDOW_WIDTH = 420;
     static inline const U32 MIN_WINDOW_HEIGHT = 320;
 
+    // allocation profiler builds only
+    static inline const U32 ALLOCATION_REPORT_INTERVAL = 300;
+    static inline const U32 ZERO_ALLOCATION_WARMUP_FRAMES = 120;
+
    protected:
     virtual void createWindow(const Window::Properties& properties) = 0;
 
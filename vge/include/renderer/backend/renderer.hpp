@@ -1,5 +1,8 @@
 #pragma once
 #include <memory>
+#include <string>
+
+#include "defines.hpp"
 
 namespace Scene {
 class Camera;
@@ -16,6 +19,15 @@ enum class RendererBackendType { Vulkan, OpenGL };
 struct RendererConfig {
     RendererBackendType backend = RendererBackendType::Vulkan;
     bool enableValidation = true;
+    // Mounted at the root of the renderer's Vfs, on top of the assets.vgepak
+    // inside it if there is one.
+    std::string assetDirectory = VGE_ASSET_DIR;
+    // Watch the asset directory and reload textures, models and shaders
+    // that change on disk while running. Off in release builds.
+    bool hotReload = TRUE_IF_DEBUG;
+    // Upload models as quantized 16 byte vertices instead of 32 byte floats,
+    // see Resource::CompactVertex.
+    bool compactVertices = false;
 };
 
 struct RenderContext {
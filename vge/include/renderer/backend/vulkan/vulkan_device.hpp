@@ -43,11 +43,14 @@ public:
     Buffer create_buffer() const;
 
     inline VkDevice device() const { return m_Device; }
+    inline VkPhysicalDevice physical_device() const { return m_PhysicalDevice; }
     inline VmaAllocator allocator() const { return m_Allocator; }
     inline QueueFamilyIndices queue_family_indices() const { return m_QueueIndices; }
     inline SwapchainSupportDetails swapchain_support_details() const {
         return m_SwapchainSupportDetails;
     }
+    // BC1-BC7 sampling (textureCompressionBC) is enabled on the device.
+    inline bool supports_bc_compression() const { return m_BcCompression; }
 
 private:
     QueueFamilyIndices find_queue_families(VkPhysicalDevice pd) const;
@@ -74,6 +77,8 @@ private:
 
     QueueFamilyIndices m_QueueIndices;
     SwapchainSupportDetails m_SwapchainSupportDetails;
+
+    bool m_BcCompression = false;
 };
 
 } // namespace Renderer::Vulkan
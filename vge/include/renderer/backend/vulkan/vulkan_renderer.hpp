@@ -11,18 +11,24 @@
 
 #include "renderer/backend/renderer.hpp"
 #include "defines.hpp"
+#include "core/concurrency/job_system.hpp"
+#include "core/containers/soa_vector.hpp"
 #include "renderer/backend/vulkan/vulkan_context.hpp"
 #include "renderer/backend/vulkan/vulkan_device.hpp"
 #include "renderer/backend/vulkan/vulkan_buffer.hpp"
+#include "platform/file_watcher.hpp"
+#include "resource/deletion_queue.hpp"
+#include "resource/resource_pool.hpp"
+#include "resource/material_store.hpp"
+#include "resource/meshlet.hpp"
+#include "resource/model_store.hpp"
+#include "resource/texture_store.hpp"
+#include "resource/vfs.hpp"
 
 #define GLM_FORCE_RADIANS
 #define GLM_FORCE_DEPTH_ZERO_TO_ONE
 #define GLM_ENABLE_EXPERIMENTAL
 #include <glm/glm.hpp>
-#include <glm/gtx/hash.hpp>
-
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
 
 namespace Platform {
 class Window;
@@ -73,52 +79,101 @@ struct Vertex {
     }
 };
 
-struct Material {
-    VkImage diffuseTexture = VK_NULL_HANDLE;
-    VkDeviceMemory diffuseTextureMemory = VK_NULL_HANDLE;
-    VkImageView diffuseTextureView = VK_NULL_HANDLE;
+// Vertex input of Resource::CompactVertex, half the size of Vertex. The
+// positions are unorm16 inside the bounds of their mesh, the model matrix
+// scales them back (see update_uniform_buffer()). Normals sit at location 3,
+// the color comes from a binding of its own: one per vertex, or a single
+// white one read per instance.
+struct CompactVertexInput {
+    static std::array<VkVertexInputBindingDescription, 2> get_binding_description(bool colors) {
+        std::array<VkVertexInputBindingDescription, 2> bindingDescriptions {};
+
+        bindingDescriptions[0].binding = 0;
+        bindingDescriptions[0].inputRate = VK_VERTEX_INPUT_RATE_VERTEX;
+        bindingDescriptions[0].stride = sizeof(Resource::CompactVertex);
+
+        bindingDescriptions[1].binding = 1;
+        bindingDescriptions[1].inputRate
+            = colors ? VK_VERTEX_INPUT_RATE_VERTEX : VK_VERTEX_INPUT_RATE_INSTANCE;
+        bindingDescriptions[1].stride = colors ? sizeof(Resource::VertexColor) : 0;
+
+        return bindingDescriptions;
+    }
 
-    U32 mipLevels;
+    static std::array<VkVertexInputAttributeDescription, 4> get_attribute_description() {
+        std::array<VkVertexInputAttributeDescription, 4> attributeDescriptions {};
 
-    // TODO: more types such as normal texture, specular texture, etc.
-    std::string name;
-    U32 materialIndex;
-};
+        attributeDescriptions[0].binding = 0;
+        attributeDescriptions[0].location = 0;
+        attributeDescriptions[0].format = VK_FORMAT_R16G16B16A16_UNORM;
+        attributeDescriptions[0].offset = offsetof(Resource::CompactVertex, position);
+
+        attributeDescriptions[1].binding = 1;
+        attributeDescriptions[1].location = 1;
+        attributeDescriptions[1].format = VK_FORMAT_R8G8B8A8_UNORM;
+        attributeDescriptions[1].offset = 0;
+
+        attributeDescriptions[2].binding = 0;
+        attributeDescriptions[2].location = 2;
+        attributeDescriptions[2].format = VK_FORMAT_R16G16_SFLOAT;
+        attributeDescriptions[2].offset = offsetof(Resource::CompactVertex, texCoord);
 
-struct Mesh {
-    std::vector<Vertex> vertices;
-    std::vector<U32> indices;
-    U32 materialIndex; // which material this mesh
-
-    U32 vertexCount;
-    U32 indexCount;
-    VkDeviceSize vertexOffset; // byte offset in vertex buffer
-    VkDeviceSize indexOffset; // byte offset in index buffer
-    U32 firstIndex;
-    I32 vertexOffsetIndex;
+        attributeDescriptions[3].binding = 0;
+        attributeDescriptions[3].location = 3;
+        attributeDescriptions[3].format = VK_FORMAT_R16G16_SNORM;
+        attributeDescriptions[3].offset = offsetof(Resource::CompactVertex, normal);
+
+        return attributeDescriptions;
+    }
 };
 
-struct Model {
-    std::vector<Mesh> meshes;
-    std::vector<Material> materials;
-    std::string directory;
+// Vertex formats geometry is uploaded in, with a graphics pipeline each.
+enum VertexLayout : U8 {
+    VERTEX_LAYOUT_FULL = 0, // Vertex
+    VERTEX_LAYOUT_COMPACT, // CompactVertexInput, white
+    VERTEX_LAYOUT_COMPACT_COLORED, // CompactVertexInput with a color per vertex
+    VERTEX_LAYOUT_COUNT,
 };
 
-} // namespace Renderer::Vulkan
+// Image behind a Resource::TextureHandle, owned by the renderer and resolved
+// through the TextureStore.
+struct GpuTexture {
+    VkImage image = VK_NULL_HANDLE;
+    VkDeviceMemory memory = VK_NULL_HANDLE;
+    VkImageView view = VK_NULL_HANDLE;
+};
 
-namespace std {
-using namespace Renderer::Vulkan;
-template <> struct hash<Vertex> {
-    size_t operator()(Vertex const& vertex) const {
-        return ((hash<glm::vec3>()(vertex.position) ^ (hash<glm::vec3>()(vertex.color) << 1)) >> 1)
-            ^ (hash<glm::vec2>()(vertex.texCoord) << 1);
-    }
+// Vertex and index buffers a model's meshes draw from, see Resource::ModelStore.
+struct GpuGeometry {
+    VkBuffer vertexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory vertexMemory = VK_NULL_HANDLE;
+    VkBuffer indexBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory indexMemory = VK_NULL_HANDLE;
+    // the second binding of compact layouts
+    VkBuffer colorBuffer = VK_NULL_HANDLE;
+    VkDeviceMemory colorMemory = VK_NULL_HANDLE;
+    VertexLayout layout = VERTEX_LAYOUT_FULL;
 };
-} // namespace std
 
-namespace Renderer::Vulkan {
+// Geometry is uploaded as Resource::MeshVertex, which has to match Vertex.
+static_assert(sizeof(Vertex) == sizeof(Resource::MeshVertex));
+static_assert(offsetof(Vertex, color) == offsetof(Resource::MeshVertex, color));
+static_assert(offsetof(Vertex, texCoord) == offsetof(Resource::MeshVertex, texCoord));
 
 static constexpr int MAX_FRAMES_IN_FLIGHT = 2;
+static constexpr U64 TEXTURE_VRAM_BUDGET = 512ull * 1024 * 1024;
+// Streamed textures uploaded per frame, bounds the hitch of a burst of finished decodes
+static constexpr size_t MAX_TEXTURE_UPLOADS_PER_FRAME = 4;
+// Virtual path of the shader the graphics pipeline is built from
+static constexpr std::string_view GRAPHICS_PIPELINE_SHADER = "shaders/triangle.spv";
+static constexpr U32 SPIRV_MAGIC = 0x07230203;
+// Screen pixels a level of detail may deviate from the full mesh by
+static constexpr F32 LOD_MAX_PIXEL_ERROR = 1.0f;
+// Share the error has to drop below that before a coarser level is drawn, so
+// objects at the boundary do not pop back and forth
+static constexpr F32 LOD_HYSTERESIS = 0.25f;
+// Frames between two reports of the triangles and meshlets drawn
+static constexpr U64 DRAW_STATS_INTERVAL = 600;
 
 // Alignment Requirements:
 // float = 4 bytes
@@ -131,22 +186,14 @@ struct UniformBufferObject {
     alignas(16) glm::mat4 proj;
 };
 
-struct GameObject {
+// Game objects are stored column-wise in a Core::SoaVector: the per frame
+// transform pass only touches transforms and mapped pointers, the draw pass
+// only descriptor sets and mesh indices.
+struct GameObjectTransform {
     glm::vec3 position = { 0.0f, 0.0f, 0.0f };
     glm::vec3 rotation = { 0.0f, 0.0f, 0.0f };
     glm::vec3 scale = { 1.0f, 1.0f, 1.0f };
 
-    // Uniform buffer for this object (one per frame in flight)
-    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> uniformBuffers;
-    std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> uniformBufferMemories;
-    std::array<void*, MAX_FRAMES_IN_FLIGHT> uniformBuffersMapped;
-
-    // Descriptor sets for this object's model matrix and combined sampler (one per frame in flight)
-    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets;
-
-    U32 meshIndex; // which mesh from the loaded model
-    U32 materialIndex; // which material to use
-
     // Apply translation, rotation, and scale transformations to get the model matrix
     glm::mat4 get_model_matrix() const {
         glm::mat4 model = glm::mat4(1.0f);
@@ -159,7 +206,39 @@ struct GameObject {
     }
 };
 
-class VulkanRenderer final : public RendererBackend {
+// Uniform buffer for an object (one per frame in flight)
+struct GameObjectUniforms {
+    std::array<VkBuffer, MAX_FRAMES_IN_FLIGHT> uniformBuffers {};
+    std::array<VkDeviceMemory, MAX_FRAMES_IN_FLIGHT> uniformBufferMemories {};
+    std::array<void*, MAX_FRAMES_IN_FLIGHT> uniformBuffersMapped {};
+};
+
+struct GameObjectDraw {
+    // Descriptor sets for this object's model matrix and combined sampler (one per frame in flight)
+    std::array<VkDescriptorSet, MAX_FRAMES_IN_FLIGHT> descriptorSets {};
+
+    Resource::MeshHandle mesh; // owned by the ModelStore, shared by every instance
+    U32 lod = 0; // level of detail of the mesh, chosen every frame by select_lods()
+    // what is visible of it this frame, into m_DrawRanges (see cull_draws())
+    U32 firstRange = 0;
+    U32 rangeCount = 0;
+
+    // One bit per frame in flight whose descriptor set still samples a texture
+    // that finished streaming since, rewritten once that frame's fence signals.
+    U32 staleTextureSets = 0;
+};
+
+enum GameObjectColumn : std::size_t {
+    GAME_OBJECT_TRANSFORM = 0,
+    GAME_OBJECT_UNIFORMS,
+    GAME_OBJECT_DRAW,
+};
+
+using GameObjects = Core::SoaVector<GameObjectTransform, GameObjectUniforms, GameObjectDraw>;
+
+class VulkanRenderer final : public RendererBackend,
+                             public Resource::TextureBackend,
+                             public Resource::GeometryBackend {
 public:
     VulkanRenderer(Platform::Window& window);
     ~VulkanRenderer() override;
@@ -168,10 +247,20 @@ public:
     void shutdown() override;
     void draw_frame(RenderContext context) override;
 
-private:
-    const std::string MODEL_PATH = "../../../../assets/models/sponza/sponza.obj";
-    const std::string MODEL_TEXTURE_PATH = "../../../../assets/models/viking_room.png";
+    // Resource::TextureBackend
+    Resource::GpuTextureInfo upload_texture(
+        const Resource::TextureImage& image, const Resource::TextureDescriptor& desc) override;
+    void release_texture(Resource::Handle texture) override;
+    bool supports_format(Resource::PixelFormat format) const override;
+
+    // Resource::GeometryBackend
+    Resource::Handle upload_geometry(std::span<const Resource::MeshVertex> vertices,
+        std::span<const U32> indices) override;
+    Resource::Handle upload_compact_geometry(std::span<const Resource::CompactVertex> vertices,
+        std::span<const Resource::VertexColor> colors, std::span<const U32> indices) override;
+    void release_geometry(Resource::Handle geometry) override;
 
+private:
     struct VkState {
         VkInstance instance = VK_NULL_HANDLE;
         VkInstanceCreateInfo createInfo;
@@ -200,6 +289,7 @@ private:
     void create_memory_allocator();
     void create_swapchain();
     void create_swapchain_image_views();
+    void mount_assets(const RendererConfig& cfg);
     void create_descriptor_set_layout();
     void create_graphics_pipeline();
     void create_render_pass();
@@ -210,19 +300,26 @@ private:
     void create_texture_image_view();
     void create_texture_sampler();
     void load_model(std::string_view path);
-    void create_vertex_buffer();
-    void create_index_buffer();
     void setup_game_objects();
+    void rebuild_game_objects();
+    void stream_assets();
+    void reload_changed_assets();
+    void reload_asset(const std::filesystem::path& file);
+    void reload_shader(std::string_view path);
     void create_uniform_buffers();
     void create_descriptor_pool();
     void create_descriptor_sets();
     void create_command_buffers();
     void create_sync_objects();
 
-    VkShaderModule create_shader_module(const std::vector<char>& code) const;
+    // code has to be 4 byte aligned, as mapped files are
+    VkShaderModule create_shader_module(std::span<const std::byte> code) const;
 
     void cleanup_swapchain();
     void recreate_swapchain();
+    void retire_swapchain_resources(RetiredSwapchain retired);
+    void select_lods(const Scene::Camera& camera);
+    void cull_draws(const Scene::Camera& camera);
     void record_draw_commands(VkCommandBuffer commandBuffer, U32 image_idx) const;
 
     void create_buffer(VkDeviceSize size, VkBufferUsageFlags usage,
@@ -232,6 +329,8 @@ private:
     void end_single_time_commands(VkCommandBuffer commandBuffer);
 
     void copy_buffer(VkBuffer src, VkBuffer dest, VkDeviceSize size);
+    void upload_device_local(const void* src, VkDeviceSize size, VkBufferUsageFlags usage,
+        VkBuffer& buffer, VkDeviceMemory& bufferMemory);
 
     void update_uniform_buffer(U32 imageIdx, RenderContext context);
 
@@ -243,7 +342,8 @@ private:
     void transition_image_layout(VkImage image, VkFormat format, VkImageLayout oldLayout,
         VkImageLayout newLayout, U32 mipLevels);
 
-    void copy_buffer_to_image(VkBuffer buffer, VkImage image, U32 width, U32 height);
+    void copy_buffer_to_image(VkBuffer buffer, VkImage image, U32 width, U32 height,
+        std::span<const Resource::TextureLevel> levels);
 
     std::vector<const char*> getRequiredExtensions() const;
     bool is_physical_device_suitable(VkPhysicalDevice device);
@@ -258,13 +358,10 @@ private:
         VkFormatFeatureFlags features) const;
     VkFormat find_depth_format() const;
 
-    void process_node(aiNode* node, const aiScene* scene);
-    Mesh process_mesh(aiMesh* mesh, const aiScene* scene);
-    void process_materials(const aiScene* scnee);
-    void load_texture(const std::string& path, VkImage& textureImage, VkDeviceMemory& textureMemory,
-        VkImageView& textureView);
-    void create_default_texture(
-        VkImage& image, VkDeviceMemory& imageMemory, VkImageView& imageView);
+    Resource::TextureHandle acquire_default_texture();
+    VkImageView texture_view(Resource::TextureHandle texture) const;
+    VkImageView mesh_texture_view(Resource::MeshHandle mesh) const;
+    void write_texture_descriptor(VkDescriptorSet set, VkImageView view);
 
     void generate_mipmaps(
         VkImage image, VkFormat imageFormat, U32 width, U32 height, U32 mipLevels);
@@ -272,6 +369,11 @@ private:
     Platform::Window& m_Window;
 
     U32 m_CurrentFrame;
+    // Frames submitted so far. Objects the GPU may still use are retired to
+    // m_DeletionQueue with this number and destroyed MAX_FRAMES_IN_FLIGHT
+    // frames later, once that frame's fence has been waited on.
+    U64 m_FrameNumber;
+    Resource::DeletionQueue m_DeletionQueue;
 
     VulkanContext m_Context;
     VulkanDevice m_Device;
@@ -304,7 +406,8 @@ private:
     // === TODO: VulkanPipeline members ===
     VkRenderPass m_RenderPass;
     VkPipelineLayout m_PipelineLayout;
-    VkPipeline m_GraphicsPipeline;
+    // one per VertexLayout, all built from the same shader
+    std::array<VkPipeline, VERTEX_LAYOUT_COUNT> m_GraphicsPipelines {};
     // ======================================
 
     // === TODO: FrameData members ===
@@ -314,13 +417,7 @@ private:
     VkCommandPool m_CommandPool;
     std::array<VkCommandBuffer, MAX_FRAMES_IN_FLIGHT> m_CommandBuffers;
 
-    VkBuffer m_VertexBuffer;
-    VkDeviceMemory m_VertexBufferMemory;
-
-    VkBuffer m_IndexBuffer;
-    VkDeviceMemory m_IndexBufferMemory;
-
-    std::vector<GameObject> m_GameObjects;
+    GameObjects m_GameObjects;
     VkDescriptorPool m_DescriptorPool;
 
     // === TODO: VulkanTexture members ===
@@ -330,6 +427,38 @@ private:
     VkDeviceMemory m_TextureImageMemory;
     VkImageView m_TextureImageView;
 
+    // outlives the stores, their destructors wait for the loads they kicked
+    Core::JobPool m_JobPool;
+    // outlives the stores as well, they read through it
+    Resource::Vfs m_Vfs;
+    // loose asset directories, see reload_changed_assets()
+    Platform::FileWatcher m_AssetWatcher;
+    std::vector<std::filesystem::path> m_ChangedAssets;
+
+    Resource::ResourcePool<GpuTexture> m_GpuTextures;
+    Resource::TextureStore m_TextureStore;
+
+    Resource::ResourcePool<GpuGeometry> m_GpuGeometry;
+    Resource::MaterialStore m_MaterialStore;
+    Resource::ModelStore m_ModelStore;
+    Resource::ModelHandle m_Model;
+
+    // index ranges every object draws this frame
+    std::vector<Resource::IndexRange> m_DrawRanges;
+    // triangles of the last frame after culling, at the levels picked and at
+    // full detail, and the meshlets of the objects at full detail
+    struct DrawStats {
+        U64 triangles = 0;
+        U64 lodTriangles = 0;
+        U64 fullTriangles = 0;
+        U64 meshlets = 0;
+        U64 visibleMeshlets = 0;
+    } m_DrawStats;
+
+    // handles that finished streaming this frame
+    std::vector<Resource::TextureHandle> m_StreamedTextures;
+    std::vector<Resource::ModelHandle> m_StreamedModels;
+
     VkImage m_DepthImage;
     VmaAllocation m_DepthImageAllocation;
     VkDeviceMemory m_DepthImageMemory;
@@ -340,12 +469,5 @@ private:
     std::vector<VkSemaphore> m_RenderFinishedSemaphores;
 
     std::array<VkFence, MAX_FRAMES_IN_FLIGHT> m_InFlightFences;
-
-    // MODEL SPECIFIC MEMBERS:
-    // TODO remove these, use model now.
-    std::vector<Vertex> m_Vertices;
-    std::vector<U32> m_Indices;
-
-    Model m_LoadedModel;
 };
 } // namespace Renderer::Vulkan
@@ -21,6 +21,12 @@ struct SwapchainSupportDetails {
     std::vector<VkPresentModeKHR> presentModes;
 };
 
+// Handles of a replaced swapchain that frames in flight may still present from.
+struct RetiredSwapchain {
+    VkSwapchainKHR swapchain;
+    std::vector<VkImageView> imageViews;
+};
+
 class VulkanSwapchain {
 public:
     // TODO: window stores surface?
@@ -31,6 +37,11 @@ public:
     void initialize();
     void destroy();
 
+    // Creates a swapchain for the current surface extent from the existing one.
+    // The old handles are handed back instead of destroyed, so the caller can
+    // retire them once the frames using them have completed.
+    RetiredSwapchain recreate();
+
     inline VkSwapchainKHR swapchain() const { return m_Swapchain; }
     inline VkFormat image_format() const { return m_SwapchainImageFormat; }
     inline U32 image_count() const { return m_SwapchainImageCount; }
@@ -63,7 +74,7 @@ private:
     VkFormat m_SwapchainImageFormat;
     VkExtent2D m_SwapchainExtent;
 
-    void create_swapchain();
+    void create_swapchain(VkSwapchainKHR oldSwapchain = VK_NULL_HANDLE);
     void create_swapchain_image_views();
 
     VkExtent2D choose_swap_extent(const VkSurfaceCapabilitiesKHR& capabilities);
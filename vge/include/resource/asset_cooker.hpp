@@ -0,0 +1,125 @@
+#pragma once
+
+#include <filesystem>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.hpp"
+#include "mesh_optimizer.hpp"
+#include "resource_descriptor.hpp"
+#include "core/concurrency/job_system.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+enum class AssetKind : U8 { Texture, Model };
+
+// Size and modification time of a file, both 0 if it does not exist.
+struct FileStamp {
+    U64 size = 0;
+    I64 time = 0;
+
+    bool operator==(const FileStamp&) const = default;
+};
+
+struct CookStats {
+    size_t assets = 0;
+    size_t cooked = 0;
+    size_t upToDate = 0;
+    size_t failed = 0;
+    MeshOptimizeStats meshes; // of the models cooked
+};
+
+// Cooks every source asset under a root directory next to its source:
+// images to .vgetex, models to .vgemesh.
+//
+// Import settings come from an optional sidecar, <source>.import, with one
+// `key = value` per line:
+//
+//   textures: color_space = srgb | linear, usage = color | normal,
+//             mipmaps = true | false
+//   models:   calculate_normals, calculate_tangents = true | false, scale = <float>
+//
+// The input hash of an asset covers the source contents, the settings and the
+// cooked format versions. root/vge_cook.manifest records it per asset
+// together with the size and modification time of the source and its sidecar,
+// and which textures every model uses. An asset whose stamps did not change
+// is up to date without being read, so a run over an unchanged tree only
+// stats files. Stamps that changed are settled by rehashing, only a changed
+// input hash cooks again. Textures used by models are cooked as well, even
+// outside root.
+class AssetCooker {
+public:
+    static constexpr std::string_view ManifestName = "vge_cook.manifest";
+    static constexpr std::string_view SettingsExtension = ".import";
+
+    explicit AssetCooker(const fs::path& root);
+
+    // Cooks whatever changed since the last run, everything if force is set.
+    // Cooking runs on the workers of jobs.
+    CookStats cook(Core::JobPool& jobs, bool force = false);
+
+    // Packs everything under root that a game loads into one .vgepak, with
+    // virtual paths relative to root: cooked files and every other file
+    // (shaders, model buffers), but no source that has a cooked form and no
+    // sidecars. Run after cook().
+    bool pack(const fs::path& output) const;
+
+    // Sources used by the asset at path (relative to root), as recorded by
+    // the last run.
+    std::vector<std::string> dependencies(std::string_view path) const;
+
+    // The kind of asset path is a source of, by extension.
+    static std::optional<AssetKind> asset_kind(const fs::path& path);
+    static fs::path cooked_path(const fs::path& source, AssetKind kind);
+
+    // Settings of a source, defaults for what its sidecar does not set. The
+    // raw pairs are kept in the descriptor's metadata.
+    static TextureDescriptor texture_settings(const fs::path& source);
+    static MeshDescriptor mesh_settings(const fs::path& source);
+    // Hash of everything besides the source contents that changes the
+    // cooked output, including the format version.
+    static U64 settings_hash(const TextureDescriptor& desc);
+    static U64 settings_hash(const MeshDescriptor& desc);
+
+private:
+    static constexpr U32 ManifestVersion = 1;
+
+    struct Entry {
+        AssetKind kind = AssetKind::Texture;
+        U64 inputHash = 0;
+        FileStamp source;
+        FileStamp settings;
+        std::vector<std::string> uses; // relative to root
+    };
+
+    // One asset whose stamps changed, settled on a worker.
+    struct Task {
+        std::string key;
+        fs::path source;
+        Entry entry;
+        bool cook = false; // the input hash changed or there is no output
+        bool failed = false;
+        MeshOptimizeStats optimized;
+    };
+
+    // Settles one task on a worker: rehashes, then cooks if the hash changed.
+    // A model import spreads its meshes over jobs as well.
+    static void run(Core::JobPool& jobs, Task& task, const fs::path& root, const Entry* previous,
+        bool force);
+
+    bool load_manifest();
+    bool save_manifest() const;
+
+    std::string key_of(const fs::path& source) const;
+
+    fs::path m_Root;
+    // ordered, so the manifest diffs cleanly between runs
+    std::map<std::string, Entry> m_Manifest;
+};
+
+} // namespace Resource
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <algorithm>
+#include <compare>
+#include <filesystem>
+#include <string>
+#include <string_view>
+
+#include "defines.hpp"
+#include "core/hash.hpp"
+
+namespace Resource {
+
+// Separator agnostic, lexically normalized form of a path: '/' separated,
+// no "." or resolvable ".." elements. Virtual paths and store keys use it.
+inline std::string normalize_asset_path(const std::filesystem::path& path) {
+    std::string generic = path.generic_string();
+    // model files exported on Windows reference textures with backslashes
+    std::replace(generic.begin(), generic.end(), '\\', '/');
+    return std::filesystem::path(generic).lexically_normal().generic_string();
+}
+
+// Names an asset by its virtual path (relative to a mount point), independent
+// of where the asset lives on disk or in which pack. Stored in pack tables of
+// contents.
+struct AssetId {
+    U64 value = 0;
+
+    static AssetId from_path(std::string_view virtualPath) {
+        const std::string normalized = normalize_asset_path(virtualPath);
+        return { Core::hash_bytes(normalized.data(), normalized.size()) };
+    }
+
+    explicit operator bool() const { return value != 0; }
+    auto operator<=>(const AssetId&) const = default;
+};
+
+} // namespace Resource
@@ -0,0 +1,211 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include "defines.hpp"
+#include "handle.hpp"
+#include "core/concurrency/cpu.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+// ResourcePool that streaming workers can insert into while the render thread
+// resolves handles.
+//
+//  - emplace() reserves a slot lock-free: it pops the shared freelist (a
+//    Treiber stack whose head carries an ABA tag) or bumps the high water mark.
+//  - get() is wait-free: two acquire loads (chunk, slot state) and a compare.
+//  - A slot's state word holds its generation and a LIVE bit. The value is
+//    constructed first and the state published with a release store, so a
+//    thread that sees the handle as live also sees the fully built value.
+//
+// Chunks are allocated on demand and never move, so resource addresses are
+// stable like in ResourcePool. free() destroys the value right away: it must
+// not race with threads still using that resource, retire it through a
+// deletion queue when other threads may hold it.
+template <typename Resource, U32 ChunkSize = 256> class ConcurrentResourcePool {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+        "ConcurrentResourcePool chunk size must be a power of two");
+
+public:
+    ConcurrentResourcePool() = default;
+
+    ConcurrentResourcePool(const ConcurrentResourcePool&) = delete;
+    ConcurrentResourcePool& operator=(const ConcurrentResourcePool&) = delete;
+
+    // Must not race with any other call.
+    ~ConcurrentResourcePool() {
+        for (auto& entry : m_Chunks) {
+            Slot* chunk = entry.load(std::memory_order_acquire);
+            if (!chunk) {
+                continue;
+            }
+            for (U32 i = 0; i < ChunkSize; ++i) {
+                if (chunk[i].state.load(std::memory_order_relaxed) & LiveBit) {
+                    std::destroy_at(chunk[i].value());
+                }
+            }
+            delete[] chunk;
+        }
+    }
+
+    Handle insert(const Resource& value) { return emplace(value); }
+    Handle insert(Resource&& value) { return emplace(std::move(value)); }
+
+    template <class... Args> Handle emplace(Args&&... args) {
+        const U32 idx = reserve_slot();
+        Slot& slot = slot_at(idx);
+
+        try {
+            std::construct_at(slot.value(), std::forward<Args>(args)...);
+        } catch (...) {
+            push_free(idx);
+            throw;
+        }
+
+        const U32 gen = slot.state.load(std::memory_order_relaxed) & GenMask;
+        // publish: everything written to the value happens before this store
+        slot.state.store(gen | LiveBit, std::memory_order_release);
+        m_Size.fetch_add(1, std::memory_order_relaxed);
+
+        return Handle::make(idx, gen);
+    }
+
+    Resource* get(Handle h) {
+        if (!h || h.index() >= MaxSlots) {
+            return nullptr;
+        }
+        Slot* chunk = m_Chunks[h.index() / ChunkSize].load(std::memory_order_acquire);
+        if (!chunk) {
+            return nullptr;
+        }
+        Slot& slot = chunk[h.index() % ChunkSize];
+        if (slot.state.load(std::memory_order_acquire) != (h.gen() | LiveBit)) {
+            return nullptr;
+        }
+        return slot.value();
+    }
+
+    const Resource* get(Handle h) const {
+        return const_cast<ConcurrentResourcePool*>(this)->get(h);
+    }
+
+    // Safe to call from several threads, exactly one of two racing frees of
+    // the same handle wins.
+    void free(Handle h) {
+        Slot* slot = h && h.index() < MaxSlots ? find_slot(h.index()) : nullptr;
+        U32 expected = h.gen() | LiveBit;
+        // retire the handle first: get() fails from here on
+        if (!slot
+            || !slot->state.compare_exchange_strong(expected, (h.gen() + 1) & GenMask,
+                std::memory_order_acq_rel)) {
+            CORE_LOG_WARN("[ConcurrentResourcePool]: Handle is invalid or outdated.");
+            return;
+        }
+
+        std::destroy_at(slot->value());
+        m_Size.fetch_sub(1, std::memory_order_relaxed);
+
+        // if a generation counter overflow occurs, disable the resource slot
+        if (h.gen() + 1 == GenMask) {
+            CORE_LOG_WARN("[ConcurrentResourcePool]: Slot with index {} is overflown!", h.index());
+            return;
+        }
+        push_free(h.index());
+    }
+
+    // Allocates the chunks for count resources up front, so that inserting
+    // them later does not allocate.
+    void reserve(size_t count) {
+        for (U32 chunk = 0; chunk * ChunkSize < count && chunk < MaxChunks; ++chunk) {
+            ensure_chunk(chunk);
+        }
+    }
+
+    // Only a snapshot while other threads insert or free.
+    size_t size() const { return m_Size.load(std::memory_order_relaxed); }
+
+private:
+    static constexpr U32 MaxSlots = static_cast<U32>(Handle::IndexMask) + 1;
+    static constexpr U32 MaxChunks = MaxSlots / ChunkSize;
+    static constexpr U32 GenMask = static_cast<U32>(Handle::GenMask);
+    static constexpr U32 LiveBit = GenMask + 1;
+    static constexpr U32 InvalidIndex = ~0u;
+
+    struct Slot {
+        // generation | LiveBit while a value lives in the slot
+        std::atomic<U32> state { 1 }; // generation = 0 is a null handle
+        std::atomic<U32> nextFree { InvalidIndex };
+        alignas(Resource) std::byte storage[sizeof(Resource)];
+
+        Resource* value() noexcept { return std::launder(reinterpret_cast<Resource*>(storage)); }
+    };
+
+    // freelist head: index in the low half, ABA tag in the high half
+    static constexpr U64 pack(U32 index, U32 tag) { return (static_cast<U64>(tag) << 32) | index; }
+    static constexpr U32 head_index(U64 head) { return static_cast<U32>(head); }
+    static constexpr U32 head_tag(U64 head) { return static_cast<U32>(head >> 32); }
+
+    Slot& slot_at(U32 idx) {
+        return m_Chunks[idx / ChunkSize].load(std::memory_order_acquire)[idx % ChunkSize];
+    }
+
+    Slot* find_slot(U32 idx) {
+        Slot* chunk = m_Chunks[idx / ChunkSize].load(std::memory_order_acquire);
+        return chunk ? &chunk[idx % ChunkSize] : nullptr;
+    }
+
+    U32 reserve_slot() {
+        U64 head = m_FreeHead.load(std::memory_order_acquire);
+        while (head_index(head) != InvalidIndex) {
+            // the slot may be popped and reused by another thread before our
+            // CAS, the tag makes the CAS fail in that case
+            const U32 next = slot_at(head_index(head)).nextFree.load(std::memory_order_relaxed);
+            if (m_FreeHead.compare_exchange_weak(
+                    head, pack(next, head_tag(head) + 1), std::memory_order_acquire)) {
+                return head_index(head);
+            }
+        }
+
+        const U32 idx = m_HighWater.fetch_add(1, std::memory_order_relaxed);
+        if (idx >= MaxSlots) {
+            CORE_LOG_FATAL("[ConcurrentResourcePool]: Out of handle indices ({} slots)", MaxSlots);
+            throw std::bad_alloc();
+        }
+        ensure_chunk(idx / ChunkSize);
+        return idx;
+    }
+
+    void push_free(U32 idx) {
+        Slot& slot = slot_at(idx);
+        U64 head = m_FreeHead.load(std::memory_order_relaxed);
+        do {
+            slot.nextFree.store(head_index(head), std::memory_order_relaxed);
+        } while (!m_FreeHead.compare_exchange_weak(
+            head, pack(idx, head_tag(head) + 1), std::memory_order_release));
+    }
+
+    // Racing threads may both allocate the chunk, the loser frees its copy.
+    void ensure_chunk(U32 chunk) {
+        if (m_Chunks[chunk].load(std::memory_order_acquire)) {
+            return;
+        }
+        auto fresh = std::make_unique<Slot[]>(ChunkSize);
+        Slot* expected = nullptr;
+        if (m_Chunks[chunk].compare_exchange_strong(
+                expected, fresh.get(), std::memory_order_acq_rel)) {
+            fresh.release();
+        }
+    }
+
+    std::array<std::atomic<Slot*>, MaxChunks> m_Chunks {};
+    alignas(Core::CacheLineSize) std::atomic<U64> m_FreeHead { pack(InvalidIndex, 0) };
+    alignas(Core::CacheLineSize) std::atomic<U32> m_HighWater { 0 };
+    std::atomic<size_t> m_Size { 0 };
+};
+
+} // namespace Resource
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <utility>
+
+#include "defines.hpp"
+#include "core/assert.hpp"
+
+namespace Resource {
+
+// Defers destruction until the GPU is done with a resource.
+//
+// Every entry is keyed by the frame (or timeline semaphore value) that may
+// still reference it. collect(completed) runs the deleters of every entry
+// whose key is <= completed, in the order they were retired, so a resource is
+// never destroyed while a frame in flight can touch it and nothing has to
+// wait for the whole device to go idle.
+//
+// Keys must be retired in non-decreasing order (the renderer retires with its
+// current frame number), which keeps collect() a pop from the front.
+class DeletionQueue {
+public:
+    using Deleter = std::function<void()>;
+
+    DeletionQueue() = default;
+    ~DeletionQueue() { flush(); }
+
+    DeletionQueue(const DeletionQueue&) = delete;
+    DeletionQueue& operator=(const DeletionQueue&) = delete;
+
+    // deleter runs once a frame >= frame has completed.
+    void retire(U64 frame, Deleter deleter) {
+        ASSERT_MSG(m_Entries.empty() || m_Entries.back().frame <= frame,
+            "[DeletionQueue]: Frames must be retired in order");
+        m_Entries.push_back({ frame, std::move(deleter) });
+    }
+
+    // Runs every deleter retired up to and including completedFrame.
+    // Returns the number of deleters run.
+    size_t collect(U64 completedFrame) {
+        size_t count = 0;
+        while (!m_Entries.empty() && m_Entries.front().frame <= completedFrame) {
+            // pop before running: a deleter may retire more work
+            Deleter deleter = std::move(m_Entries.front().deleter);
+            m_Entries.pop_front();
+            deleter();
+            count++;
+        }
+        return count;
+    }
+
+    // Runs every pending deleter. Only call once the device is idle.
+    size_t flush() {
+        size_t count = 0;
+        while (!m_Entries.empty()) {
+            count += collect(m_Entries.back().frame);
+        }
+        return count;
+    }
+
+    size_t size() const { return m_Entries.size(); }
+    bool empty() const { return m_Entries.empty(); }
+
+private:
+    struct Entry {
+        U64 frame;
+        Deleter deleter;
+    };
+
+    std::deque<Entry> m_Entries;
+};
+
+} // namespace Resource
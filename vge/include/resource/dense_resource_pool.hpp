@@ -0,0 +1,163 @@
+#pragma once
+
+#include <limits>
+#include <new>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "handle.hpp"
+#include "core/containers/soa_vector.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+// Slot map flavour of ResourcePool: live resources are packed at the front of
+// one array, so iterating them never walks holes.
+//
+//  - sparse table (indexed by Handle::index()): generation + index into the
+//    dense arrays. Free sparse entries form an intrusive LIFO freelist through
+//    the same index field, so freeing and reusing a slot never allocates.
+//  - dense arrays: the values and, per value, the sparse index it belongs to.
+//    free() moves the last value into the hole (swap-remove).
+//
+// Because values move on free(), pointers returned by get() are only valid
+// until the next free() or insertion. Use ResourcePool when addresses have to
+// stay put.
+template <typename Resource> class DenseResourcePool {
+public:
+    DenseResourcePool() = default;
+
+    DenseResourcePool(const DenseResourcePool&) = delete;
+    DenseResourcePool& operator=(const DenseResourcePool&) = delete;
+
+    Handle allocate(Resource value) { return emplace(std::move(value)); }
+
+    Handle insert(const Resource& value) { return emplace(value); }
+    Handle insert(Resource&& value) { return emplace(std::move(value)); }
+
+    template <class... Args> Handle emplace(Args&&... args) {
+        const bool reuse = m_FreeHead != InvalidIndex;
+        const U32 index = reuse ? m_FreeHead : static_cast<U32>(m_Sparse.size());
+        if (!reuse) {
+            if (m_Sparse.size() > static_cast<size_t>(Handle::IndexMask)) {
+                CORE_LOG_FATAL("[DenseResourcePool]: Out of handle indices ({} slots)",
+                    m_Sparse.size());
+                throw std::bad_alloc();
+            }
+            m_Sparse.reserve(m_Sparse.size() + 1);
+        }
+
+        // nothing is touched until the value is constructed, a throwing
+        // constructor leaves the pool as it was
+        const U32 dense = static_cast<U32>(m_Dense.size());
+        m_Dense.emplace_back(Resource(std::forward<Args>(args)...), index);
+
+        if (reuse) {
+            m_FreeHead = m_Sparse[index].dense;
+        } else {
+            m_Sparse.emplace_back();
+        }
+        m_Sparse[index].dense = dense;
+
+        return Handle::make(index, m_Sparse[index].generation);
+    }
+
+    Resource* get(Handle h) {
+        const U32 dense = dense_index(h);
+        return dense == InvalidIndex ? nullptr : &m_Dense.template get<VALUE>(dense);
+    }
+
+    const Resource* get(Handle h) const { return const_cast<DenseResourcePool*>(this)->get(h); }
+
+    bool contains(Handle h) const { return dense_index(h) != InvalidIndex; }
+
+    void free(Handle h) {
+        const U32 dense = dense_index(h);
+        if (dense == InvalidIndex) {
+            CORE_LOG_WARN("[DenseResourcePool]: Handle is invalid or outdated.");
+            return;
+        }
+
+        // the last value moves into the hole, point its sparse entry there
+        const U32 moved = m_Dense.template get<SPARSE_INDEX>(m_Dense.size() - 1);
+        m_Dense.swap_erase(dense);
+        m_Sparse[moved].dense = dense;
+
+        SparseEntry& entry = m_Sparse[h.index()];
+        entry.generation++;
+
+        // if a generation counter overflow occurs, disable the resource slot
+        if (entry.generation == Handle::GenMask) {
+            CORE_LOG_WARN("[DenseResourcePool]: Slot with index {} is overflown!", h.index());
+            entry.dense = InvalidIndex;
+            return;
+        }
+
+        entry.dense = m_FreeHead;
+        m_FreeHead = h.index();
+    }
+
+    // Frees every resource, outstanding handles become invalid.
+    void clear() {
+        while (!m_Dense.empty()) {
+            free(handle_at(m_Dense.size() - 1));
+        }
+    }
+
+    void reserve(size_t count) {
+        m_Sparse.reserve(count);
+        m_Dense.reserve(count);
+    }
+
+    size_t size() const { return m_Dense.size(); }
+    bool empty() const { return m_Dense.empty(); }
+
+    // ---- dense iteration ----
+
+    // Live resources, contiguous and in no particular order.
+    std::span<Resource> values() { return m_Dense.template column<VALUE>(); }
+    std::span<const Resource> values() const { return m_Dense.template column<VALUE>(); }
+
+    Resource* begin() { return values().data(); }
+    Resource* end() { return values().data() + values().size(); }
+    const Resource* begin() const { return values().data(); }
+    const Resource* end() const { return values().data() + values().size(); }
+
+    // Handle of values()[dense].
+    Handle handle_at(size_t dense) const {
+        const U32 index = m_Dense.template get<SPARSE_INDEX>(dense);
+        return Handle::make(index, m_Sparse[index].generation);
+    }
+
+private:
+    static constexpr U32 InvalidIndex = std::numeric_limits<U32>::max();
+
+    struct SparseEntry {
+        // live: position in the dense arrays, free: next free sparse entry
+        U32 dense = InvalidIndex;
+        U16 generation = 1; // generation = 0 is a null handle
+    };
+
+    enum DenseColumn : size_t { VALUE = 0, SPARSE_INDEX };
+
+    U32 dense_index(Handle h) const {
+        if (h.index() >= m_Sparse.size()) {
+            return InvalidIndex;
+        }
+        const SparseEntry& entry = m_Sparse[h.index()];
+        // a free entry's dense field is a freelist link, the back pointer
+        // catches a handle forged with the current generation of a free slot
+        if (entry.generation != h.gen() || entry.dense >= m_Dense.size()
+            || m_Dense.template get<SPARSE_INDEX>(entry.dense) != h.index()) {
+            return InvalidIndex;
+        }
+        return entry.dense;
+    }
+
+    std::vector<SparseEntry> m_Sparse;
+    Core::SoaVector<Resource, U32> m_Dense;
+    U32 m_FreeHead = InvalidIndex;
+};
+
+} // namespace Resource
@@ -33,7 +33,10 @@ struct Handle {
     constexpr bool operator!=(Handle other) const noexcept { return value != other.value; }
 };
 
+// Typed wrapper so a TextureHandle cannot be passed where a MeshHandle is
+// expected. Tag types only exist for the type system.
 template <typename T> class ResourceHandle {
+public:
     constexpr ResourceHandle() noexcept
         : m_Handle {} { }
     explicit constexpr ResourceHandle(Handle handle) noexcept
@@ -41,6 +44,8 @@ template <typename T> class ResourceHandle {
 
     constexpr Handle handle() const noexcept { return m_Handle; }
 
+    constexpr explicit operator bool() const noexcept { return static_cast<bool>(m_Handle); }
+
     constexpr bool operator==(ResourceHandle other) const noexcept {
         return m_Handle == other.m_Handle;
     }
@@ -62,9 +67,16 @@ using MaterialHandle = ResourceHandle<MaterialTag>;
 struct MeshTag { };
 using MeshHandle = ResourceHandle<MeshTag>;
 
+struct ModelTag { };
+using ModelHandle = ResourceHandle<ModelTag>;
+
 struct ShaderTag { };
 using ShaderHandle = ResourceHandle<ShaderTag>;
 
+// Asynchronous loads hand out their handle before the data exists. Until the
+// load is Ready the handle resolves to the store's placeholder.
+enum class LoadState : U8 { Ready, Loading, Failed };
+
 static_assert(Handle::IndexBits + Handle::GenBits == sizeof(Handle::HandleType) * 8);
 
 } // namespace Resource
@@ -80,7 +92,7 @@ template <> struct hash<Resource::Handle> {
 
 template <typename T> struct hash<Resource::ResourceHandle<T>> {
     size_t operator()(Resource::ResourceHandle<T> handle) const noexcept {
-        return std::hash<Resource::Handle> {}(handle.id());
+        return std::hash<Resource::Handle> {}(handle.handle());
     }
 };
 }
\ No newline at end of file
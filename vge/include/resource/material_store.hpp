@@ -1 +1,68 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include "defines.hpp"
+#include "handle.hpp"
+#include "resource_pool.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+class TextureStore;
+struct MaterialData;
+
+struct Material {
+    std::string name;
+    TextureHandle diffuseTexture; // holds one reference in the TextureStore
+    U32 refCount = 0;
+};
+
+// Materials are refcounted by the models that use them. Each material holds a
+// reference to its textures, so releasing the last model that uses a texture
+// makes it evictable in the TextureStore.
+class MaterialStore {
+public:
+    explicit MaterialStore(TextureStore& textures);
+    ~MaterialStore();
+
+    MaterialStore(const MaterialStore&) = delete;
+    MaterialStore& operator=(const MaterialStore&) = delete;
+
+    // Used by materials without a diffuse texture or whose texture fails to
+    // load. Takes over the caller's reference.
+    void set_default_texture(TextureHandle texture);
+
+    // Returns a material with one reference. An empty diffusePath selects the
+    // default texture. With jobs the texture is loaded asynchronously and
+    // samples the TextureStore's placeholder until it is ready.
+    MaterialHandle create(
+        std::string name, const std::string& diffusePath, Core::JobPool* jobs = nullptr);
+    // Creates a material per entry and appends them to out. The textures are
+    // decoded in parallel on the workers of jobs and resident on return.
+    void create_all(
+        Core::JobPool& jobs, std::span<const MaterialData> materials, std::vector<MaterialHandle>& out);
+
+    void add_ref(MaterialHandle h);
+    // At zero the material is destroyed and its texture reference released.
+    void release(MaterialHandle h);
+
+    const Material* get(MaterialHandle h) const { return m_Materials.get(h.handle()); }
+
+    size_t size() const { return m_Materials.size(); }
+
+private:
+    // A null diffuse falls back to the default texture.
+    MaterialHandle insert(std::string name, TextureHandle diffuse);
+
+    TextureStore& r_Textures;
+    ResourcePool<Material> m_Materials;
+    TextureHandle m_DefaultTexture;
+};
+
+} // namespace Resource
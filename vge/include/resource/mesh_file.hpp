@@ -0,0 +1,120 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "mesh_optimizer.hpp"
+#include "model_data.hpp"
+#include "vfs_file.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+// .vgemesh: a cooked model. Everything the ModelStore uploads is stored in the
+// layout it uploads it in, so loading is a mmap and a copy into staging
+// memory, no parsing. Little endian, sections aligned to MeshFileAlignment.
+//
+//   MeshFileHeader
+//   MeshRange[meshCount]
+//   MeshLod[lodCount]
+//   Meshlet[meshletCount]
+//   MeshFileMaterial[materialCount]
+//   strings (material names and texture paths, not terminated)
+//   MeshVertex[vertexCount]
+//   U32[indexCount]
+inline constexpr U32 MeshFileMagic = 0x4d454756; // "VGEM"
+// Bump on any change to the layout or to what the importer produces, every
+// cooked file is re-cooked on its next load.
+inline constexpr U32 MeshFileVersion = 4;
+inline constexpr U64 MeshFileAlignment = 64;
+
+struct MeshFileHeader {
+    U32 magic = MeshFileMagic;
+    U32 version = MeshFileVersion;
+    U64 sourceHash = 0; // hash of the source file the model was cooked from
+    U32 meshCount = 0;
+    U32 materialCount = 0;
+    U64 meshesOffset = 0;
+    U64 lodsOffset = 0;
+    U64 lodCount = 0;
+    U64 meshletsOffset = 0;
+    U64 meshletCount = 0;
+    U64 materialsOffset = 0;
+    U64 stringsOffset = 0;
+    U64 stringsSize = 0;
+    U64 verticesOffset = 0;
+    U64 vertexCount = 0;
+    U64 indicesOffset = 0;
+    U64 indexCount = 0;
+};
+
+// Offsets into the string section. Texture paths are relative to the
+// directory of the .vgemesh file.
+struct MeshFileMaterial {
+    U32 nameOffset = 0;
+    U32 nameSize = 0;
+    U32 diffuseOffset = 0;
+    U32 diffuseSize = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<MeshFileHeader>);
+static_assert(std::is_trivially_copyable_v<MeshFileMaterial>);
+
+// Where the cooked form of a source model lives: next to it, <source>.vgemesh.
+fs::path cooked_mesh_path(const fs::path& source);
+
+// Hash of the contents of a source model, 0 if it cannot be read.
+U64 hash_source_file(const fs::path& source);
+
+// Writes a cooked model, through a temporary file so a reader never maps a
+// half written one. Returns false and logs on failure.
+bool write_mesh_file(const fs::path& path, std::span<const MaterialData> materials,
+    const GeometryView& geometry, U64 sourceHash);
+
+// An imported model processed for drawing, what write_mesh_file() stores.
+struct CookedModel {
+    // after is measured on the final index order, meshlets included
+    MeshOptimizeStats stats;
+    PackedGeometry geometry;
+};
+
+// Optimizes the meshes of data, adds their levels of detail and meshlets and
+// packs them. The cooker and the ModelStore both cook models this way. With
+// jobs every step runs on its workers.
+CookedModel cook_model(ModelData& data, Core::JobPool* jobs = nullptr);
+
+// A mapped .vgemesh, on its own or inside a pack. The views point into the
+// mapping and stay valid while the file is open.
+class MeshFile {
+public:
+    // Maps the file and checks the header and section bounds. Fails for any
+    // other version, so a format change re-cooks every model.
+    bool open(const fs::path& path);
+    // Same for a file opened through the Vfs. Texture paths resolve against
+    // directory, the virtual directory of the file.
+    bool open(VfsFile file, const fs::path& directory);
+    void close() { m_File.close(); }
+
+    bool is_open() const { return m_File.is_open(); }
+
+    U64 source_hash() const { return header().sourceHash; }
+    GeometryView geometry() const;
+    // Texture paths resolved against the directory of the file.
+    std::vector<MaterialData> materials() const;
+
+private:
+    const MeshFileHeader& header() const {
+        return *reinterpret_cast<const MeshFileHeader*>(m_File.data());
+    }
+    template <typename T> const T* section(U64 offset) const {
+        return reinterpret_cast<const T*>(m_File.data() + offset);
+    }
+
+    VfsFile m_File;
+    fs::path m_Directory;
+};
+
+} // namespace Resource
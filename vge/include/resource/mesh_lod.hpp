@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cmath>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "model_data.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// A level stops the chain once it keeps more than this share of the
+// triangles of the level before: seams and borders leave nothing to remove.
+inline constexpr F32 LodMinReduction = 0.8f;
+// Levels with fewer triangles are not worth a draw of their own.
+inline constexpr size_t LodMinTriangles = 16;
+// Largest error a level may have, relative to the radius of the mesh.
+inline constexpr F32 LodMaxRelativeError = 0.25f;
+
+// Simplifies a triangle list by collapsing edges in the order of the quadric
+// error they add (Garland and Heckbert, "Surface Simplification Using Quadric
+// Error Metrics"), until at most targetIndexCount indices are left or the
+// next collapse deviates more than maxError from the surface. Vertices only
+// move onto neighbours, so the result indexes the same vertices. Vertices on
+// borders and on UV seams (several vertices at one position) stay put, so
+// the outline and the texture mapping keep their shape. error receives the
+// largest deviation of any collapse, in object space.
+std::vector<U32> simplify_mesh(std::span<const MeshVertex> vertices,
+    std::span<const U32> indices, size_t targetIndexCount, F32 maxError = INFINITY,
+    F32* error = nullptr);
+
+// Fills mesh.lods with a chain of levels, each simplified from the one before
+// to about half its triangles and ordered for the vertex cache.
+void generate_lods(MeshData& mesh);
+// With jobs every mesh gets its chain on a worker of its own.
+void generate_lods(std::span<MeshData> meshes, Core::JobPool* jobs = nullptr);
+
+// Screen pixels one object space unit covers at distance from a camera with
+// the given vertical field of view (radians), looking at a viewport
+// viewportHeight pixels high.
+inline F32 lod_pixels_per_unit(F32 fovY, F32 viewportHeight, F32 distance) {
+    return viewportHeight / (2.0f * std::tan(fovY * 0.5f) * distance);
+}
+
+// The coarsest level whose error covers at most maxPixels on screen. lods[0]
+// is the full mesh. Switching from current to a coarser level needs the error
+// to be below maxPixels by the hysteresis share as well, so an object at the
+// boundary does not pop between two levels every frame.
+U32 select_lod(std::span<const MeshLod> lods, F32 pixelsPerUnit, U32 current,
+    F32 maxPixels = 1.0f, F32 hysteresis = 0.25f);
+
+} // namespace Resource
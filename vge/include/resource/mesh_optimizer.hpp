@@ -0,0 +1,82 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "model_data.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// FIFO entries the optimizer assumes the post-transform cache has.
+inline constexpr U32 VertexCacheSize = 16;
+
+// How often a triangle list runs the vertex shader through a FIFO
+// post-transform cache. Stats of several meshes add up with +=.
+struct VertexCacheStats {
+    U64 triangles = 0;
+    U64 vertices = 0; // distinct vertices the triangles use
+    U64 transforms = 0; // cache misses, every one shades a vertex
+
+    // Average cache miss ratio, transforms per triangle: 3 without any reuse,
+    // about 0.5 at best.
+    F64 acmr() const { return triangles ? F64(transforms) / F64(triangles) : 0.0; }
+    // Average transform to vertex ratio, 1 when every vertex is shaded once.
+    F64 atvr() const { return vertices ? F64(transforms) / F64(vertices) : 0.0; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& other) {
+        triangles += other.triangles;
+        vertices += other.vertices;
+        transforms += other.transforms;
+        return *this;
+    }
+};
+
+struct MeshOptimizeStats {
+    VertexCacheStats before;
+    VertexCacheStats after;
+
+    MeshOptimizeStats& operator+=(const MeshOptimizeStats& other) {
+        before += other.before;
+        after += other.after;
+        return *this;
+    }
+};
+
+// Indices have to be below vertexCount for all of these.
+VertexCacheStats analyze_vertex_cache(
+    std::span<const U32> indices, size_t vertexCount, U32 cacheSize = VertexCacheSize);
+
+// Merges vertices that are identical bit for bit, the indices point at the
+// first copy.
+void deduplicate_vertices(MeshData& mesh);
+
+// Reorders the triangles for the post-transform cache with Tipsify (Sander,
+// Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and
+// Reduced Overdraw"). Returns the first triangle of every cluster: where the
+// order had to jump to a vertex that is not in the cache.
+std::vector<U32> optimize_vertex_cache(
+    std::span<U32> indices, size_t vertexCount, U32 cacheSize = VertexCacheSize);
+
+// Splits the clusters optimize_vertex_cache() returned further where that
+// costs at most threshold times the cache misses, then sorts them so the
+// ones facing away from the center of the mesh draw first. Those are the
+// likely occluders from any direction.
+void optimize_overdraw(std::span<U32> indices, std::span<const MeshVertex> vertices,
+    std::span<const U32> clusters, U32 cacheSize = VertexCacheSize, F32 threshold = 1.05f);
+
+// Renumbers the vertices in the order the indices first use them, so the
+// vertex fetch walks the buffer front to back. Unused vertices are dropped.
+void optimize_vertex_fetch(MeshData& mesh);
+
+// All of the above in that order. A mesh that is not a triangle list is
+// left as it is.
+MeshOptimizeStats optimize_mesh(MeshData& mesh);
+// With jobs every mesh is optimized on a worker of its own.
+MeshOptimizeStats optimize_meshes(std::span<MeshData> meshes, Core::JobPool* jobs = nullptr);
+
+} // namespace Resource
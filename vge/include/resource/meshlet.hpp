@@ -0,0 +1,59 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "model_data.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// Limits of one meshlet, the ones mesh shading hardware is fastest with: the
+// vertices fit a 64 wide group, 124 triangles keep the local index list of a
+// meshlet under 384 bytes.
+inline constexpr U32 MeshletMaxVertices = 64;
+inline constexpr U32 MeshletMaxTriangles = 124;
+
+// Splits a triangle list into meshlets. Every meshlet grows from a seed
+// triangle over the neighbours that add the fewest vertices, nearest to its
+// center first, so it stays compact and its bounds and normal cone stay
+// tight. The triangles are reordered so every meshlet is a contiguous range
+// of indices, returned in that order.
+std::vector<Meshlet> build_meshlets(std::span<U32> indices, std::span<const MeshVertex> vertices,
+    U32 maxVertices = MeshletMaxVertices, U32 maxTriangles = MeshletMaxTriangles);
+
+// Fills mesh.meshlets for the full mesh. A mesh that is not a triangle list
+// gets none.
+void build_meshlets(MeshData& mesh);
+// With jobs every mesh is split on a worker of its own.
+void build_meshlets(std::span<MeshData> meshes, Core::JobPool* jobs = nullptr);
+
+// What a camera sees, in the object space of the meshlets culled.
+struct ClusterView {
+    // inside where x * plane[0] + y * plane[1] + z * plane[2] + plane[3] >= 0,
+    // normalized so that is a distance
+    std::array<std::array<F32, 4>, 6> planes {};
+    std::array<F32, 3> eye {};
+};
+
+// The frustum of clip = projection * view * model (column major, depth 0 to
+// 1 as in Vulkan) and the camera position in object space.
+ClusterView make_cluster_view(std::span<const F32, 16> clip, const std::array<F32, 3>& eye);
+
+struct IndexRange {
+    U32 firstIndex = 0;
+    U32 indexCount = 0;
+};
+
+// Appends the index ranges of the meshlets that are inside the frustum and
+// do not face away from the eye. Neighbouring visible meshlets become one
+// range. Returns how many meshlets are visible.
+size_t cull_meshlets(
+    std::span<const Meshlet> meshlets, const ClusterView& view, std::vector<IndexRange>& out);
+
+} // namespace Resource
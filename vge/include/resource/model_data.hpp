@@ -0,0 +1,146 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// Vertex as importers produce it. Same layout as the renderer's vertex input
+// (position, color, uv), but free of glm so asset code does not depend on it.
+struct MeshVertex {
+    std::array<F32, 3> position;
+    std::array<F32, 3> color;
+    std::array<F32, 2> texCoord;
+
+    bool operator==(const MeshVertex&) const = default;
+};
+
+static_assert(sizeof(MeshVertex) == 8 * sizeof(F32));
+
+// Quantized form of a MeshVertex, half its size, see vertex_quantization.hpp.
+// The color moves to a stream of its own, most meshes do not need one.
+struct CompactVertex {
+    std::array<U16, 4> position; // unorm16 inside the bounds of its mesh, w is 0
+    std::array<I16, 2> normal; // octahedral, snorm16
+    std::array<U16, 2> texCoord; // half floats
+};
+
+static_assert(std::is_trivially_copyable_v<CompactVertex> && sizeof(CompactVertex) == 16);
+
+// RGBA8 unorm, red first.
+using VertexColor = std::array<U8, 4>;
+
+// Maps the unorm positions of a mesh's CompactVertex back to object space:
+// position = offset + scale * unorm. Identity for full vertices.
+struct VertexQuantization {
+    std::array<F32, 3> offset { 0.0f, 0.0f, 0.0f };
+    std::array<F32, 3> scale { 1.0f, 1.0f, 1.0f };
+};
+
+// Levels of detail a mesh has at most, the full mesh included.
+inline constexpr U32 MaxMeshLods = 5;
+
+// A cluster of neighbouring triangles of a mesh, a range of its index buffer
+// that can be culled on its own (see meshlet.hpp). Stored as is in cooked
+// .vgemesh files.
+struct Meshlet {
+    U32 firstIndex = 0; // relative to its mesh in MeshData, into the packed buffer once packed
+    U32 indexCount = 0;
+    std::array<F32, 4> bounds {}; // sphere around the vertices: center, radius
+    // cone around the triangle normals: axis, sine of the angle it leaves
+    // out, 1 when the normals spread over more than a hemisphere
+    std::array<F32, 4> cone {};
+};
+
+static_assert(std::is_trivially_copyable_v<Meshlet> && sizeof(Meshlet) == 40);
+
+// A simplified version of a mesh, drawing the same vertices.
+struct MeshLodData {
+    std::vector<U32> indices;
+    F32 error = 0.0f; // how far it deviates from the full mesh, in object space
+};
+
+struct MeshData {
+    std::vector<MeshVertex> vertices;
+    std::vector<U32> indices; // triangle list
+    U32 materialIndex = 0; // into ModelData::materials
+    std::vector<MeshLodData> lods; // coarser and coarser, at most MaxMeshLods - 1
+    std::vector<Meshlet> meshlets; // the full mesh in clusters, indices are in their order
+};
+
+struct MaterialData {
+    std::string name;
+    std::string diffusePath; // empty when the material has no diffuse texture
+};
+
+// CPU side of a model, what an importer hands to the ModelStore.
+struct ModelData {
+    std::vector<MeshData> meshes;
+    std::vector<MaterialData> materials;
+};
+
+// One level of detail: a range of the packed index buffer over the vertices
+// of its mesh. Stored as is in cooked .vgemesh files.
+struct MeshLod {
+    U32 firstIndex = 0;
+    U32 indexCount = 0;
+    F32 error = 0.0f; // see MeshLodData
+};
+
+static_assert(std::is_trivially_copyable_v<MeshLod> && sizeof(MeshLod) == 12);
+
+// Draw range of one mesh inside the packed buffers of its model. Stored as is
+// in cooked .vgemesh files.
+struct MeshRange {
+    U32 firstIndex = 0;
+    U32 indexCount = 0;
+    I32 vertexOffset = 0;
+    U32 vertexCount = 0;
+    U32 materialIndex = 0;
+    // simplified levels of the mesh, into GeometryView::lods
+    U32 firstLod = 0;
+    U32 lodCount = 0;
+    std::array<F32, 4> bounds {}; // sphere around the vertices: center, radius
+    // clusters of the full mesh, into GeometryView::meshlets
+    U32 firstMeshlet = 0;
+    U32 meshletCount = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<MeshRange> && sizeof(MeshRange) == 52);
+
+// Packed geometry of a model wherever it lives, owned or mapped from a file.
+struct GeometryView {
+    std::span<const MeshVertex> vertices;
+    std::span<const U32> indices;
+    std::span<const MeshRange> meshes;
+    std::span<const MeshLod> lods;
+    std::span<const Meshlet> meshlets;
+};
+
+// Every mesh of a model in one vertex and one index buffer, the way the GPU
+// draws them.
+struct PackedGeometry {
+    std::vector<MeshVertex> vertices;
+    std::vector<U32> indices;
+    std::vector<MeshRange> meshes;
+    std::vector<MeshLod> lods;
+    std::vector<Meshlet> meshlets;
+
+    GeometryView view() const { return { vertices, indices, meshes, lods, meshlets }; }
+};
+
+// Places the meshes one after another, every mesh followed by its levels of
+// detail in the index buffer. Meshlets move along with the indices of their
+// mesh. With jobs they are copied into place in parallel on its workers.
+PackedGeometry pack_meshes(std::span<const MeshData> meshes, Core::JobPool* jobs = nullptr);
+
+} // namespace Resource
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <filesystem>
+
+#include "model_data.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// Imports a model file (anything assimp reads) into triangle lists. Texture
+// paths are resolved relative to the model's directory. Returns false and
+// logs when the file cannot be imported. With jobs the meshes are converted in
+// parallel on its workers, the call still returns once all are done.
+bool import_model(
+    const std::filesystem::path& path, ModelData& out, Core::JobPool* jobs = nullptr);
+
+} // namespace Resource
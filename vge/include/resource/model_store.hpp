@@ -1 +1,227 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+#include <array>
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.hpp"
+#include "handle.hpp"
+#include "mesh_file.hpp"
+#include "model_data.hpp"
+#include "resource_pool.hpp"
+#include "vertex_quantization.hpp"
+#include "core/concurrency/job_system.hpp"
+#include "core/concurrency/ring_queue.hpp"
+#include "core/containers/flat_hash_map.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+class MaterialStore;
+class Vfs;
+
+// GPU side of the ModelStore, implemented by the renderer backend.
+class GeometryBackend {
+public:
+    virtual ~GeometryBackend() = default;
+
+    // Uploads the vertex and index buffers every mesh of a model draws from.
+    virtual Handle upload_geometry(std::span<const MeshVertex> vertices, std::span<const U32> indices)
+        = 0;
+    // Same with the vertices in the compact format. colors holds one color
+    // per vertex, or none when they are all white.
+    virtual Handle upload_compact_geometry(std::span<const CompactVertex> vertices,
+        std::span<const VertexColor> colors, std::span<const U32> indices)
+        = 0;
+    // Frames in flight may still read the buffers, the backend has to defer
+    // the destruction until they complete.
+    virtual void release_geometry(Handle geometry) = 0;
+};
+
+// Draw range of one mesh inside its model's geometry buffers.
+struct Mesh {
+    Handle geometry;
+    U32 firstIndex = 0;
+    U32 indexCount = 0;
+    I32 vertexOffset = 0;
+    U32 vertexCount = 0;
+    MaterialHandle material;
+    // lods[0] is the full range above, pick one with select_lod() (mesh_lod.hpp)
+    std::array<MeshLod, MaxMeshLods> lods {};
+    U32 lodCount = 1;
+    std::array<F32, 4> bounds {}; // sphere around the vertices: center, radius
+    std::vector<Meshlet> meshlets; // of lods[0], cull with cull_meshlets() (meshlet.hpp)
+    // scales the unorm positions of compact vertices back, the identity otherwise
+    VertexQuantization quantization;
+};
+
+struct Model {
+    std::vector<MeshHandle> meshes;
+    std::vector<MaterialHandle> materials; // one reference each
+    Handle geometry;
+    std::string path;
+    U64 sourceHash = 0; // of the file loaded, a reload that hashes the same changes nothing
+    U32 refCount = 0;
+    // meshes and materials stay empty until the model is Ready
+    LoadState state = LoadState::Ready;
+};
+
+// Loads models once and shares them.
+//
+// Models are deduplicated by normalized path and refcounted: loading the same
+// model a hundred times costs one import and one upload, every instance draws
+// the same meshes. All meshes of a model are packed into one vertex and one
+// index buffer, a Mesh is just a range inside them. Materials go through the
+// MaterialStore, so textures stay shared across models as well.
+//
+// Imported meshes are optimized for the vertex cache, overdraw and vertex
+// fetch (see mesh_optimizer.hpp), get a chain of simplified levels of detail
+// (see mesh_lod.hpp) and are split into meshlets (see meshlet.hpp), then
+// cooked to <source>.vgemesh. Later loads map the cooked file and upload from
+// the mapping as long as its source hash matches, and only import again when
+// the source changed or the format version moved on.
+// A cooked file without its source (as shipped in a pack) is used as is.
+//
+// With compact vertices enabled the geometry is converted to CompactVertex
+// (see vertex_quantization.hpp) on the worker reading it, cooked or imported,
+// and uploaded in that format.
+//
+// With a Vfs set, paths are virtual and files are read through it. Texture
+// paths of imported models are rewritten to virtual paths as well, so the
+// MaterialStore finds them through the same mounts.
+//
+// reload() imports a changed source or cooked file again in the background, the
+// model keeps its handle and is rebuilt by poll_loads().
+//
+// load_async() imports on a JobPool worker and returns at once. Draw what
+// resolve() returns: the placeholder model until poll_loads() has uploaded the
+// real one at a frame boundary.
+class ModelStore {
+public:
+    ModelStore(GeometryBackend& backend, MaterialStore& materials);
+    ~ModelStore();
+
+    ModelStore(const ModelStore&) = delete;
+    ModelStore& operator=(const ModelStore&) = delete;
+
+    // Returns the model at path with one more reference, loading it on first
+    // use. path may also name a .vgemesh directly. Returns a null handle if
+    // the model cannot be loaded.
+    ModelHandle load(const fs::path& path);
+    // Same for geometry built in memory, name only has to be unique per model.
+    ModelHandle load(std::string_view name, const ModelData& data);
+    // Same as load(path), with the meshes of an import converted and the
+    // textures decoded in parallel on the workers of jobs. Returns once
+    // everything is uploaded.
+    ModelHandle load(Core::JobPool& jobs, const fs::path& path);
+    // Imports the file on a worker of jobs, its textures are loaded
+    // asynchronously as well. A model that fails to import keeps resolving
+    // to the placeholder.
+    ModelHandle load_async(Core::JobPool& jobs, const fs::path& path);
+
+    // Imports every loaded model read from path again, on a worker of jobs.
+    // path is a source model or its .vgemesh. poll_loads() replaces the
+    // meshes, materials and geometry of the model and lists it as ready,
+    // unless the source did not change or fails to import, which keeps the
+    // model as it is. Mesh handles of the old meshes become invalid. Returns
+    // the number of models reloading.
+    size_t reload(Core::JobPool& jobs, const fs::path& path);
+
+    // Uploads finished imports and appends their handles to ready. Call on
+    // the render thread, once per frame.
+    size_t poll_loads(std::vector<ModelHandle>& ready);
+    size_t loads_in_flight() const {
+        return static_cast<size_t>(m_LoadsInFlight.load(std::memory_order_acquire));
+    }
+
+    // Reads files through vfs from now on, null reads the host filesystem.
+    // vfs has to outlive the store.
+    void set_vfs(const Vfs* vfs) { m_Vfs = vfs; }
+    // Uploads the models loaded from now on in the compact vertex format.
+    void set_compact_vertices(bool enabled) { m_CompactVertices = enabled; }
+
+    // What loading models resolve to. Takes over the caller's reference.
+    void set_placeholder(ModelHandle model);
+    // h itself once it is Ready, the placeholder before. Null for an invalid h.
+    const Model* resolve(ModelHandle h) const;
+
+    void add_ref(ModelHandle h);
+    // At zero the meshes, materials and GPU buffers of the model are released.
+    void release(ModelHandle h);
+
+    const Model* get(ModelHandle h) const { return m_Models.get(h.handle()); }
+    const Mesh* get(MeshHandle h) const { return m_Meshes.get(h.handle()); }
+
+    // Releases every model, referenced or not.
+    void clear();
+
+    size_t size() const { return m_Models.size(); }
+    size_t mesh_count() const { return m_Meshes.size(); }
+
+private:
+    static constexpr size_t LoadQueueCapacity = 16;
+
+    // A model read from disk: the mapped cooked file when it is current,
+    // otherwise the imported and packed source.
+    struct SourceModel {
+        MeshFile cooked;
+        PackedGeometry imported;
+        CompactGeometry compact; // empty unless compact vertices are enabled
+        std::vector<MaterialData> materials;
+        U64 sourceHash = 0;
+
+        GeometryView geometry() const {
+            return cooked.is_open() ? cooked.geometry() : imported.view();
+        }
+    };
+
+    // Result of a load job, handed back to the owning thread.
+    struct ImportedModel {
+        ModelHandle handle;
+        SourceModel source;
+        Core::JobPool* jobs = nullptr;
+        bool loaded = false;
+        bool reload = false; // rebuilds a Ready model
+    };
+
+    // Reads path on a worker and hands the result to poll_loads(). A source
+    // hashing to unchangedHash is dropped (0 loads anything).
+    void kick_load(Core::JobPool& jobs, ModelHandle h, std::string path, U64 unchangedHash,
+        bool reload);
+    // Safe to call from any thread. An import converts its meshes on jobs.
+    static bool read_source(const Vfs* vfs, const std::string& path, SourceModel& out,
+        Core::JobPool* jobs, bool compact);
+
+    ModelHandle load_now(const fs::path& path, Core::JobPool* jobs);
+    ModelHandle reuse(const std::string& key);
+    ModelHandle create(std::string key, std::span<const MaterialData> materials,
+        const GeometryView& geometry, const CompactGeometry& compact, U64 sourceHash,
+        Core::JobPool* jobs = nullptr);
+    // With jobs the textures load on its workers: in the background if async,
+    // otherwise in parallel but resident before build returns. Uploads compact
+    // instead of geometry's vertices unless it is empty.
+    void build(Model& model, std::span<const MaterialData> materials, const GeometryView& geometry,
+        const CompactGeometry& compact, Core::JobPool* jobs, bool async);
+    // Builds model again from a reload, then releases what it held before.
+    void rebuild(Model& model, const SourceModel& source, Core::JobPool* jobs);
+    void destroy(ModelHandle h);
+
+    GeometryBackend& r_Backend;
+    MaterialStore& r_Materials;
+    const Vfs* m_Vfs = nullptr;
+    bool m_CompactVertices = false;
+
+    ResourcePool<Model> m_Models;
+    ResourcePool<Mesh> m_Meshes;
+    Core::FlatHashMap<std::string, ModelHandle> m_ByPath;
+
+    ModelHandle m_Placeholder;
+    Core::MpmcRing<ImportedModel> m_Imported { LoadQueueCapacity };
+    Core::JobPool::JobCounter m_LoadsInFlight { 0 };
+};
+
+} // namespace Resource
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <filesystem>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.hpp"
+#include "asset_id.hpp"
+#include "platform/mapped_file.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+// .vgepak: a read-only archive of many assets, mapped once. Files are stored
+// uncompressed and aligned to pages, so a file inside the pack is a span into
+// the mapping, as aligned as a file mapped on its own. Little endian.
+//
+//   PackFileHeader
+//   PackEntry[entryCount], sorted by id
+//   strings (virtual paths, not terminated)
+//   file data, each file at a multiple of PackFileAlignment
+inline constexpr U32 PackFileMagic = 0x50454756; // "VGEP"
+inline constexpr U32 PackFileVersion = 1;
+inline constexpr U64 PackFileAlignment = 4096;
+// What vge_cook --pack writes into the asset directory, and what the renderer
+// mounts from it.
+inline constexpr std::string_view AssetPackName = "assets.vgepak";
+
+struct PackFileHeader {
+    U32 magic = PackFileMagic;
+    U32 version = PackFileVersion;
+    U64 entryCount = 0;
+    U64 entriesOffset = 0;
+    U64 stringsOffset = 0;
+    U64 stringsSize = 0;
+};
+
+struct PackEntry {
+    AssetId id;
+    U64 offset = 0;
+    U64 size = 0;
+    U32 pathOffset = 0; // into the string section
+    U32 pathSize = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<PackFileHeader>);
+static_assert(std::is_trivially_copyable_v<PackEntry> && sizeof(PackEntry) == 32);
+
+// One file to pack: the host file at source, found under virtualPath.
+struct PackSource {
+    std::string virtualPath;
+    fs::path source;
+};
+
+// Writes a pack of files through a temporary file. Two files with the same
+// virtual path, or with colliding ids, fail. Returns false and logs on
+// failure.
+bool write_pack_file(const fs::path& path, std::span<const PackSource> files);
+
+// A mapped .vgepak. Lookups are a binary search over the table of contents,
+// every span points into the mapping and stays valid while the pack is open.
+// Safe to read from any thread once open.
+class PackFile {
+public:
+    // Maps the pack and checks the header, the order of the table and the
+    // bounds of every entry.
+    bool open(const fs::path& path);
+    void close() { m_File.close(); }
+
+    bool is_open() const { return m_File.isOpen(); }
+
+    // The contents of the file at virtualPath (normalized), nothing if the
+    // pack does not contain it.
+    std::optional<std::span<const std::byte>> find(std::string_view virtualPath) const;
+    std::optional<std::span<const std::byte>> find(AssetId id) const;
+
+    std::span<const PackEntry> entries() const {
+        return { reinterpret_cast<const PackEntry*>(m_File.data() + header().entriesOffset),
+            static_cast<size_t>(header().entryCount) };
+    }
+    std::string_view path(const PackEntry& entry) const {
+        return { reinterpret_cast<const char*>(m_File.data() + header().stringsOffset)
+                + entry.pathOffset,
+            entry.pathSize };
+    }
+
+private:
+    const PackFileHeader& header() const {
+        return *reinterpret_cast<const PackFileHeader*>(m_File.data());
+    }
+    const PackEntry* lookup(AssetId id) const;
+    std::span<const std::byte> contents(const PackEntry& entry) const {
+        return m_File.bytes().subspan(entry.offset, entry.size);
+    }
+
+    Platform::MappedFile m_File;
+};
+
+} // namespace Resource
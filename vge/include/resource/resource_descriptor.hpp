@@ -1,14 +1,16 @@
 #pragma once
 
 #include <filesystem>
-#include <unordered_map>
+#include <string>
+
+#include "core/containers/flat_hash_map.hpp"
 
 namespace Resource {
 namespace fs = std::filesystem;
 
 struct ResourceDescriptor {
     fs::path path;
-    std::unordered_map<std::string, std::string> metadata;
+    Core::FlatHashMap<std::string, std::string> metadata;
 
     virtual ~ResourceDescriptor() = default;
 };
@@ -18,6 +20,8 @@ struct TextureDescriptor : ResourceDescriptor {
     enum class Filter { Linear, Nearest };
     enum class Tiling { Optimal, Linear };
     enum class SamplerAddressMode { Repeat, Clamp, Mirror };
+    // What the texels hold, picks the block compression of a cooked texture.
+    enum class Usage { Color, Normal };
 
     Format format = Format::SRGBA8;
     Filter minFilter = Filter::Linear;
@@ -25,6 +29,7 @@ struct TextureDescriptor : ResourceDescriptor {
     Tiling tiling = Tiling::Optimal;
     SamplerAddressMode addressMode = SamplerAddressMode::Repeat;
     bool generateMipmaps = true;
+    Usage usage = Usage::Color;
 };
 
 struct MeshDescriptor : ResourceDescriptor {
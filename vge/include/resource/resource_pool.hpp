@@ -1,7 +1,13 @@
 #pragma once
 
+#include <memory>
+#include <new>
+#include <optional>
+#include <vector>
+
 #include "defines.hpp"
 #include "handle.hpp"
+#include "deletion_queue.hpp"
 #include "core/logger.hpp"
 #include "core/assert.hpp"
 
@@ -9,10 +15,28 @@ namespace Resource {
 
 // ResourcePool is an *owning* container of
 // pool of Resource instances.
-template <typename Resource> class ResourcePool {
+//
+// Slots live in fixed size chunks that are never moved or freed while the pool
+// lives, so a pointer returned by get() stays valid until that resource is
+// freed, no matter how many resources are added after it. Growing costs one
+// chunk allocation instead of copying every slot.
+//
+// Free slots are chained through the slots themselves (intrusive freelist),
+// freeing and reusing a slot never allocates.
+//
+// free() destroys the value right away. Resources the GPU may still read go
+// through retire() instead, which invalidates the handle immediately but only
+// destroys the value and recycles the slot once the frame has completed.
+template <typename Resource, U32 ChunkSize = 256> class ResourcePool {
+    static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0,
+        "ResourcePool chunk size must be a power of two");
+
 public:
     ResourcePool() = default;
 
+    ResourcePool(const ResourcePool&) = delete;
+    ResourcePool& operator=(const ResourcePool&) = delete;
+
     // sink:
     //  - with lvalue parameters, resulting operations are 1 copy, 1 move, 1 destruction
     //  - with rvalue parameters (i.e. allocate(std::move(value))), resulting operations are 2 moves
@@ -26,80 +50,137 @@ public:
 
     // emplace: 0 copy/moves, 1 constructing in-place
     template <class... Args> Handle emplace(Args&&... args) {
-        U32 idx = 0;
-        Slot* slot = nullptr;
-
-        if (!m_FreeList.empty()) {
-            // Use the free list if a free slot is available
-            idx = m_FreeList.front();
-            m_FreeList.pop();
-
-            slot = &m_Slots[idx];
-
-            ASSERT_MSG(!slot->value.has_value(), "[ResourcePool]: Slot should be empty");
-        } else {
-            // Allocate a new slot if free list is empty
-            idx = static_cast<U32>(m_Slots.size());
-            m_Slots.emplace_back();
-            slot = &m_Slots.back();
+        if (m_FreeHead == InvalidIndex) {
+            add_chunk();
         }
 
-        slot->value.emplace(std::forward<Args>(args)...);
+        const U32 idx = m_FreeHead;
+        Slot& slot = slot_at(idx);
+
+        ASSERT_MSG(!slot.value.has_value(), "[ResourcePool]: Slot should be empty");
 
-        return Handle::make(idx, slot->generation);
+        slot.value.emplace(std::forward<Args>(args)...);
+        m_FreeHead = slot.nextFree;
+        m_Size++;
+
+        return Handle::make(idx, slot.generation);
     }
 
     Resource* get(Handle h) {
-        if (h.index() >= m_Slots.size())
+        if (h.index() >= capacity())
             return nullptr;
 
-        Slot& resource_slot = m_Slots[h.index()];
+        Slot& resource_slot = slot_at(h.index());
 
-        if (!resource_slot.value.has_value() || resource_slot.generation != h.gen()) {
+        if (!resource_slot.value.has_value() || resource_slot.retired
+            || resource_slot.generation != h.gen()) {
             return nullptr;
         }
 
         return &resource_slot.value.value();
     }
 
+    const Resource* get(Handle h) const { return const_cast<ResourcePool*>(this)->get(h); }
+
     void free(Handle h) {
-        if (h.index() >= m_Slots.size()) {
-            CORE_LOG_WARN("[ResourcePool]: Handle index is larger than slots?");
+        if (invalidate(h)) {
+            release(h.index());
+        }
+    }
+
+    // Deferred free: get(h) fails from now on, the value is destroyed and the
+    // slot reused after queue.collect() reaches frame. The pool must outlive
+    // the queue entry.
+    void retire(Handle h, DeletionQueue& queue, U64 frame) {
+        Slot* slot = invalidate(h);
+        if (!slot) {
             return;
         }
+        slot->retired = true;
+        queue.retire(frame, [this, idx = h.index()] { release(idx); });
+    }
+
+    // Allocates the chunks for count resources up front.
+    void reserve(size_t count) {
+        while (capacity() < count) {
+            add_chunk();
+        }
+    }
+
+    // Live resources, retired ones still waiting for their frame excluded.
+    size_t size() const { return m_Size; }
+    size_t capacity() const { return m_Chunks.size() * ChunkSize; }
+
+private:
+    static constexpr U32 InvalidIndex = ~0u;
+    static constexpr U32 MaxSlots = static_cast<U32>(Handle::IndexMask) + 1;
+
+    struct Slot {
+        std::optional<Resource> value = std::nullopt;
+        U32 nextFree = InvalidIndex; // only meaningful while the slot is free
+        U16 generation = 1; // generation = 0 is a null handle
+        bool retired = false; // value waits in a DeletionQueue
+    };
+
+    Slot& slot_at(U32 idx) { return m_Chunks[idx / ChunkSize][idx % ChunkSize]; }
+
+    // Bumps the generation so h and its copies stop resolving. Returns nullptr
+    // for a stale or unknown handle.
+    Slot* invalidate(Handle h) {
+        if (h.index() >= capacity()) {
+            CORE_LOG_WARN("[ResourcePool]: Handle index is larger than slots?");
+            return nullptr;
+        }
 
-        Slot& slot = m_Slots[h.index()];
+        Slot& slot = slot_at(h.index());
 
-        if (slot.generation != h.gen()) {
+        if (slot.generation != h.gen() || !slot.value.has_value() || slot.retired) {
             CORE_LOG_WARN("[ResourcePool]: Handle index is outdated.");
-            return;
+            return nullptr;
         }
 
-        slot.value.reset(); // TODO: queue destruction
         slot.generation++; // bump the generation
+        m_Size--;
+        return &slot;
+    }
+
+    // Destroys the value of an invalidated slot and returns it to the freelist.
+    void release(U32 idx) {
+        Slot& slot = slot_at(idx);
+        slot.value.reset();
+        slot.retired = false;
 
         // if a generation counter overflow occurs, disable the resource slot
         if (slot.generation == ((1 << Handle::GenBits) - 1)) {
-            CORE_LOG_WARN("[ResourcePool]: Slot with index {} is overflown!", h.index());
+            CORE_LOG_WARN("[ResourcePool]: Slot with index {} is overflown!", idx);
             return;
         }
 
-        m_FreeList.push(h.index());
+        slot.nextFree = m_FreeHead;
+        m_FreeHead = idx;
     }
 
-    size_t size() const { return m_Slots.size() - m_FreeList.size(); }
-
-private:
-    ResourcePool(const ResourcePool&) = delete;
-    ResourcePool& operator=(const ResourcePool&) = delete;
+    // New slots go to the front of the freelist in index order, so a fresh
+    // pool hands out 0, 1, 2, ...
+    void add_chunk() {
+        const U32 first = static_cast<U32>(capacity());
+        if (first + ChunkSize > MaxSlots) {
+            CORE_LOG_FATAL("[ResourcePool]: Out of handle indices ({} slots)", first);
+            throw std::bad_alloc();
+        }
 
-    struct Slot {
-        std::optional<Resource> value = std::nullopt;
-        U16 generation = 1; // generation = 0 is a null handle
-    };
+        m_Chunks.push_back(std::make_unique<Slot[]>(ChunkSize));
+        Slot* chunk = m_Chunks.back().get();
+        for (U32 i = 0; i < ChunkSize; ++i) {
+            chunk[i].nextFree = i + 1 < ChunkSize ? first + i + 1 : m_FreeHead;
+        }
+        m_FreeHead = first;
+    }
 
-    std::queue<U32> m_FreeList;
-    std::vector<Slot> m_Slots;
+    // the chunk table may reallocate, the chunks it points to never do
+    std::vector<std::unique_ptr<Slot[]>> m_Chunks;
+    U32 m_FreeHead = InvalidIndex;
+    size_t m_Size = 0;
 };
 
-} // namespace Resource
\ No newline at end of file
+} // namespace Resource
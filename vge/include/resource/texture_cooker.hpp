@@ -0,0 +1,53 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "resource_descriptor.hpp"
+#include "texture_data.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+struct TextureCookOptions {
+    bool srgb = true; // filter in linear space, the GPU samples it as sRGB
+    // Texels are tangent space normals: the chain is renormalized and only
+    // x and y are kept, the shader reconstructs z.
+    bool normalMap = false;
+    bool compress = true; // BC7 for color, BC5 for normal maps
+    bool generateMipmaps = true;
+};
+
+// What a texture loaded with desc has to be cooked with.
+TextureCookOptions cook_options(const TextureDescriptor& desc);
+
+// All levels of a cooked texture in one block, laid out as TextureImage
+// describes.
+struct CookedTexture {
+    PixelFormat format = PixelFormat::RGBA8;
+    U32 width = 0;
+    U32 height = 0;
+    std::vector<U8> data;
+    std::vector<TextureLevel> levels;
+
+    TextureImage image() const { return { format, width, height, data, levels }; }
+};
+
+// Full mip chain down to 1x1 with a box filter, top level first.
+std::vector<TextureData> build_mip_chain(const TextureData& top, bool srgb, bool normalMap);
+
+// Encode one 4x4 block of RGBA8 texels, row major, into 16 bytes.
+void encode_bc7_block(std::span<const U8, 64> texels, std::span<U8, 16> block);
+// Only red and green are kept.
+void encode_bc5_block(std::span<const U8, 64> texels, std::span<U8, 16> block);
+
+CookedTexture cook_texture(const TextureData& data, const TextureCookOptions& options);
+// Decodes an image file and cooks it. Returns false if it cannot be read or
+// decoded.
+bool cook_texture_file(
+    const fs::path& source, const TextureCookOptions& options, CookedTexture& out);
+
+} // namespace Resource
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+
+namespace Resource {
+
+// Decoded RGBA8 pixels of the top mip level.
+struct TextureData {
+    U32 width = 0;
+    U32 height = 0;
+    std::vector<U8> pixels;
+};
+
+// How texels are stored. Block compressed formats store 4x4 texel blocks of
+// 16 bytes: BC7 for color, BC5 (two channels) for tangent space normals.
+enum class PixelFormat : U32 { RGBA8 = 0, BC7 = 1, BC5 = 2 };
+
+// Byte range of one mip level inside TextureImage::data.
+struct TextureLevel {
+    U64 offset = 0;
+    U64 size = 0;
+};
+
+// Levels start at multiples of this, which satisfies the buffer offset
+// alignment of every format for buffer to image copies.
+inline constexpr U64 TextureLevelAlignment = 16;
+
+// Every mip level of a texture as the backend uploads it: one block, largest
+// level first, so the upload is a single copy into staging memory. Points
+// into a TextureData, a CookedTexture or a mapped .vgetex file.
+struct TextureImage {
+    PixelFormat format = PixelFormat::RGBA8;
+    U32 width = 0;
+    U32 height = 0;
+    std::span<const U8> data;
+    std::span<const TextureLevel> levels;
+};
+
+// Bytes of one level of the given size, whole blocks for compressed formats.
+inline U64 texture_level_size(PixelFormat format, U32 width, U32 height) {
+    if (format == PixelFormat::RGBA8) {
+        return U64(width) * height * 4;
+    }
+    return U64((width + 3) / 4) * ((height + 3) / 4) * 16;
+}
+
+} // namespace Resource
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <filesystem>
+#include <span>
+
+#include "defines.hpp"
+#include "texture_data.hpp"
+#include "vfs_file.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+// .vgetex: a cooked texture, every mip level already in the format the GPU
+// samples. The level data is stored exactly as the backend uploads it, so
+// loading is a mmap and one copy into staging memory. Little endian.
+//
+//   TextureFileHeader
+//   TextureLevel[levelCount] (offsets relative to dataOffset)
+//   level data, dataSize bytes at dataOffset
+inline constexpr U32 TextureFileMagic = 0x54454756; // "VGET"
+// Bump on any change to the layout or to what the cooker produces.
+inline constexpr U32 TextureFileVersion = 1;
+inline constexpr U64 TextureFileAlignment = 64;
+
+enum TextureFileFlags : U32 {
+    TextureFileSrgb = 1 << 0,
+    TextureFileNormalMap = 1 << 1,
+};
+
+struct TextureFileHeader {
+    U32 magic = TextureFileMagic;
+    U32 version = TextureFileVersion;
+    U64 sourceHash = 0; // hash of the image file the texture was cooked from
+    PixelFormat format = PixelFormat::RGBA8;
+    U32 flags = 0;
+    U32 width = 0;
+    U32 height = 0;
+    U32 levelCount = 0;
+    U32 reserved = 0;
+    U64 levelsOffset = 0;
+    U64 dataOffset = 0;
+    U64 dataSize = 0;
+};
+
+static_assert(std::is_trivially_copyable_v<TextureFileHeader>);
+
+// Where the cooked form of a source image lives: next to it, <source>.vgetex.
+fs::path cooked_texture_path(const fs::path& source);
+
+// Writes a cooked texture through a temporary file. flags is a combination
+// of TextureFileFlags. Returns false and logs on failure.
+bool write_texture_file(
+    const fs::path& path, const TextureImage& image, U32 flags, U64 sourceHash);
+
+// A mapped .vgetex, on its own or inside a pack. image() points into the
+// mapping and stays valid while the file is open.
+class TextureFile {
+public:
+    // Maps the file and checks the header and the level table. Fails for any
+    // other version.
+    bool open(const fs::path& path);
+    // Same for a file opened through the Vfs.
+    bool open(VfsFile file);
+    void close() { m_File.close(); }
+
+    bool is_open() const { return m_File.is_open(); }
+
+    U64 source_hash() const { return header().sourceHash; }
+    PixelFormat format() const { return header().format; }
+    bool srgb() const { return header().flags & TextureFileSrgb; }
+    bool normal_map() const { return header().flags & TextureFileNormalMap; }
+    TextureImage image() const;
+
+private:
+    const TextureFileHeader& header() const {
+        return *reinterpret_cast<const TextureFileHeader*>(m_File.data());
+    }
+
+    VfsFile m_File;
+};
+
+} // namespace Resource
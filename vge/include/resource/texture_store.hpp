@@ -1 +1,250 @@
-#pragma once
\ No newline at end of file
+#pragma once
+
+#include <filesystem>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "defines.hpp"
+#include "handle.hpp"
+#include "resource_descriptor.hpp"
+#include "resource_pool.hpp"
+#include "texture_data.hpp"
+#include "texture_file.hpp"
+#include "core/concurrency/job_system.hpp"
+#include "core/concurrency/ring_queue.hpp"
+#include "core/containers/flat_hash_map.hpp"
+
+namespace Resource {
+
+class Vfs;
+
+// What the backend created for an uploaded texture.
+struct GpuTextureInfo {
+    Handle texture; // backend owned handle
+    U32 mipLevels = 1;
+    U64 vramBytes = 0;
+};
+
+// GPU side of the TextureStore, implemented by the renderer backend. The store
+// decides what stays resident, the backend owns the images.
+class TextureBackend {
+public:
+    virtual ~TextureBackend() = default;
+
+    // A single RGBA8 level gets its mip chain generated if desc asks for
+    // mipmaps, otherwise the levels are uploaded as they are.
+    virtual GpuTextureInfo upload_texture(const TextureImage& image, const TextureDescriptor& desc)
+        = 0;
+    // The texture may still be used by frames in flight, the backend has to
+    // defer the destruction until they complete.
+    virtual void release_texture(Handle texture) = 0;
+    // Whether upload_texture accepts images in format. Called from load jobs,
+    // so it has to be safe from any thread.
+    virtual bool supports_format(PixelFormat format) const { return format == PixelFormat::RGBA8; }
+};
+
+struct Texture {
+    GpuTextureInfo gpu;
+    U32 width = 0;
+    U32 height = 0;
+    U32 refCount = 0;
+    U64 contentKey = 0; // file contents + descriptor
+    TextureDescriptor desc; // what it was loaded with, a reload decodes with it again
+    U64 descriptorKey = 0;
+    // every path that resolved to this texture
+    std::vector<std::string> paths;
+    // While Loading or Failed, gpu is the placeholder's and owned by it.
+    LoadState state = LoadState::Ready;
+    // handles of asynchronous loads that turned out to have the same
+    // contents, they resolve to this texture until it is evicted
+    std::vector<TextureHandle> aliases;
+
+    // links of the unused list, only meaningful while refCount == 0
+    TextureHandle lruPrev;
+    TextureHandle lruNext;
+};
+
+// Owns every texture the renderer samples from.
+//
+//  - acquire() deduplicates twice: by normalized path, then by a hash of the
+//    file contents and the descriptor, so a texture shared by many materials
+//    (or copied under another name) is decoded and uploaded once.
+//  - Textures are refcounted by their users (materials). A texture whose last
+//    reference is released stays resident in an LRU list, so loading it again
+//    is free.
+//  - When the VRAM used by resident textures exceeds the budget, unused
+//    textures are evicted least recently released first. Referenced textures
+//    are never evicted, the budget is exceeded instead.
+//  - acquire_async() returns the handle right away and decodes on a JobPool
+//    worker. The handle resolves to the placeholder texture until
+//    poll_loads() uploads the pixels at a frame boundary. Once decoded, a
+//    load with the same contents as a resident texture under another path is
+//    not uploaded: its handle resolves to that texture from then on.
+//  - An image with a current <path>.vgetex next to it (same source hash and
+//    cooked for the same color space and usage) is loaded from the cooked
+//    file: every mip level precomputed and block compressed, no decode. A
+//    cooked file without its source (as shipped in a pack) is used as is.
+//  - acquire_all() loads many textures at once: one decode job per texture
+//    that is not resident yet, while the calling thread uploads each one as
+//    its decode finishes.
+//  - reload() decodes a changed file again on a worker. The texture keeps its
+//    handle and its current image until poll_loads() swaps the new one in.
+//  - With a Vfs set, paths are virtual and files are read through it. Files
+//    are mapped, never copied before decoding.
+class TextureStore {
+public:
+    static constexpr U64 DefaultVramBudget = 512ull * 1024 * 1024;
+
+    explicit TextureStore(TextureBackend& backend, U64 vramBudget = DefaultVramBudget);
+    ~TextureStore();
+
+    TextureStore(const TextureStore&) = delete;
+    TextureStore& operator=(const TextureStore&) = delete;
+
+    // Returns the texture at path with one more reference, loading it on
+    // first use. path may also name a .vgetex directly. Returns a null handle
+    // if the file cannot be read or decoded.
+    TextureHandle acquire(const fs::path& path, const TextureDescriptor& desc = {});
+    // Same for pixels built in memory, name only has to be unique per image.
+    TextureHandle acquire(
+        std::string_view name, const TextureData& data, const TextureDescriptor& desc = {});
+    // Reads and decodes the file on a worker of jobs. A texture that fails to
+    // load keeps resolving to the placeholder.
+    TextureHandle acquire_async(
+        Core::JobPool& jobs, const fs::path& path, const TextureDescriptor& desc = {});
+    // Acquires every path, out[i] is what acquire(paths[i], desc) returns.
+    // The files are decoded in parallel on the workers of jobs, the call
+    // returns once all of them are uploaded. out has to be as long as paths.
+    void acquire_all(Core::JobPool& jobs, std::span<const std::string> paths,
+        std::span<TextureHandle> out, const TextureDescriptor& desc = {});
+
+    // Decodes every loaded texture read from path again, on a worker of jobs.
+    // path is a source image or its .vgetex. poll_loads() replaces the image
+    // and lists the handle as ready, unless the contents did not change or
+    // the file fails to load, which keeps the current image. Returns the
+    // number of textures reloading.
+    size_t reload(Core::JobPool& jobs, const fs::path& path);
+
+    // Uploads up to maxUploads finished decodes and appends their handles to
+    // ready. Call on the render thread, once per frame.
+    size_t poll_loads(std::vector<TextureHandle>& ready, size_t maxUploads = SIZE_MAX);
+    size_t loads_in_flight() const {
+        return static_cast<size_t>(m_LoadsInFlight.load(std::memory_order_acquire));
+    }
+
+    // Reads files through vfs from now on, null reads the host filesystem.
+    // vfs has to outlive the store.
+    void set_vfs(const Vfs* vfs) { m_Vfs = vfs; }
+
+    // What loading textures resolve to. Takes over the caller's reference.
+    void set_placeholder(TextureHandle texture);
+
+    void add_ref(TextureHandle h);
+    // Drops a reference, at zero the texture becomes evictable.
+    void release(TextureHandle h);
+
+    const Texture* get(TextureHandle h) const { return m_Textures.get(resolve(h).handle()); }
+
+    // Evicts unused textures until usage fits the budget.
+    void set_vram_budget(U64 bytes);
+    U64 vram_budget() const { return m_VramBudget; }
+    U64 vram_usage() const { return m_VramUsage; }
+
+    // Evicts every unused texture.
+    void evict_unused();
+    // Releases every texture, referenced or not. Outstanding handles become
+    // invalid.
+    void clear();
+
+    size_t size() const { return m_Textures.size(); }
+
+    // Separator agnostic, lexically normalized form used as the path key, see
+    // normalize_asset_path.
+    static std::string normalize_path(const fs::path& path);
+
+private:
+    static constexpr size_t LoadQueueCapacity = 64;
+
+    // Result of a decode job, handed back to the owning thread.
+    struct DecodedTexture {
+        TextureHandle handle;
+        TextureDescriptor desc;
+        TextureData data;
+        TextureFile cooked; // used instead of data when open
+        U64 contentKey = 0;
+        F64 decodeMs = 0; // on the worker, reading and decoding
+        bool decoded = false;
+        bool reload = false; // replaces the image of a Ready texture
+    };
+
+    Texture* texture(TextureHandle h) { return m_Textures.get(resolve(h).handle()); }
+    // The texture an alias was merged into (see Texture::aliases), h itself
+    // for any other handle.
+    TextureHandle resolve(TextureHandle h) const {
+        auto it = m_Aliases.find(h);
+        return it == m_Aliases.end() ? h : it->second;
+    }
+
+    // Uploads a finished decode. False if there was nothing to upload: the
+    // texture is gone, failed to load, or a reload found it unchanged.
+    bool finish_load(DecodedTexture& result);
+
+    TextureHandle find_path(const std::string& path, U64 descriptorKey) const;
+    // Merges the loading texture alias into target: its references and paths
+    // move over, its slot is freed and the handle resolves to target.
+    void merge_into(TextureHandle alias, TextureHandle target);
+    // Appends the handle of a finished load to ready, after a reload along
+    // with the aliases that show the same image.
+    void list_ready(const DecodedTexture& result, std::vector<TextureHandle>& ready) const;
+    TextureHandle reuse(TextureHandle h, std::string path);
+    TextureHandle upload(const TextureImage& image, const TextureDescriptor& desc, U64 contentKey,
+        U64 descriptorKey, std::string path);
+
+    // Loads path on a worker and hands the result to poll_loads(). Contents
+    // hashing to unchangedKey are not decoded (0 decodes anything).
+    void kick_load(Core::JobPool& jobs, TextureHandle h, const TextureDescriptor& desc,
+        std::string path, U64 unchangedKey, bool reload);
+
+    // Opens what path loads from: the source image, and its cooked form if
+    // that is current. Without a source (path names a .vgetex, or only the
+    // cooked file exists) just the cooked file is opened, and sourceHash is
+    // the hash it was cooked from. Safe to call from any thread.
+    bool open_source(const std::string& path, const TextureDescriptor& desc, VfsFile& source,
+        TextureFile& cooked, U64& sourceHash) const;
+    // Opens the .vgetex at cookedPath if the backend can sample it and it was
+    // cooked for desc from a source with sourceHash (0 accepts any source).
+    bool open_cooked(const fs::path& cookedPath, U64 sourceHash, const TextureDescriptor& desc,
+        TextureFile& file) const;
+
+    void evict(TextureHandle h);
+    void evict_to_budget();
+
+    void lru_push_front(TextureHandle h);
+    void lru_unlink(TextureHandle h);
+
+    TextureBackend& r_Backend;
+    const Vfs* m_Vfs = nullptr;
+
+    ResourcePool<Texture> m_Textures;
+    Core::FlatHashMap<std::string, TextureHandle> m_ByPath;
+    Core::FlatHashMap<U64, TextureHandle> m_ByContent;
+    // alias -> the texture it resolves to
+    Core::FlatHashMap<TextureHandle, TextureHandle> m_Aliases;
+
+    // unused textures, most recently released at the head
+    TextureHandle m_LruHead;
+    TextureHandle m_LruTail;
+
+    TextureHandle m_Placeholder;
+    Core::MpmcRing<DecodedTexture> m_Decoded { LoadQueueCapacity };
+    Core::JobPool::JobCounter m_LoadsInFlight { 0 };
+    // uploaded by acquire_all() for other loads, listed by the next poll_loads()
+    std::vector<TextureHandle> m_Uploaded;
+
+    U64 m_VramBudget;
+    U64 m_VramUsage = 0;
+};
+
+} // namespace Resource
@@ -0,0 +1,44 @@
+#pragma once
+
+#include <array>
+#include <span>
+#include <vector>
+
+#include "defines.hpp"
+#include "model_data.hpp"
+
+namespace Core {
+class JobPool;
+} // namespace Core
+
+namespace Resource {
+
+// The vertices of a model in the compact format, a drop-in for the vertex
+// buffer of a GeometryView: same count, same order, same index buffer.
+struct CompactGeometry {
+    std::vector<CompactVertex> vertices;
+    // one per vertex, empty when every vertex is opaque white
+    std::vector<VertexColor> colors;
+    // one per GeometryView::meshes
+    std::vector<VertexQuantization> meshes;
+};
+
+// Quantizes the vertices of every mesh of geometry into its own bounds and
+// packs its texture coordinates into half floats, with SSE2 where the target
+// has it. MeshVertex carries no normals, they are taken from the area
+// weighted triangles of the full mesh around each vertex. With jobs every
+// mesh is converted on a worker of its own.
+CompactGeometry compact_geometry(const GeometryView& geometry, Core::JobPool* jobs = nullptr);
+
+// IEEE half floats, rounded to nearest even. Values past the half range become
+// infinities, NaNs stay NaNs.
+U16 f32_to_f16(F32 value);
+F32 f16_to_f32(U16 value);
+// Converts in to out four at a time, out holds at least in.size() halves.
+void f32_to_f16(std::span<const F32> in, std::span<U16> out);
+
+// A unit vector folded onto the octahedron and stored as two snorm16.
+std::array<I16, 2> encode_octahedral(const std::array<F32, 3>& normal);
+std::array<F32, 3> decode_octahedral(const std::array<I16, 2>& encoded);
+
+} // namespace Resource
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "asset_id.hpp"
+#include "pack_file.hpp"
+#include "vfs_file.hpp"
+
+namespace Resource {
+
+namespace fs = std::filesystem;
+
+// Virtual file system the asset stores read through. Assets are named by
+// virtual paths ("textures/albedo.png"), which mount points map onto host
+// directories or .vgepak archives:
+//
+//   vfs.mount_pack("", "assets.vgepak");
+//   vfs.mount_directory("", "vge/assets"); // loose files override the pack
+//   VfsFile file = vfs.open("shaders/triangle.spv");
+//
+// Mounts made later take precedence over earlier ones. A file inside a pack
+// is a view into the pack's single mapping, so opening it costs a binary
+// search and no system call. Absolute paths, and paths no mount point
+// matches, are read from the host filesystem as they are.
+//
+// Mount everything before loading starts: open(), resolve() and exists() are
+// safe from any thread, mounting is not.
+class Vfs {
+public:
+    // Returns false if directory does not exist.
+    bool mount_directory(std::string_view mountPoint, const fs::path& directory);
+    // Returns false and logs if the pack cannot be opened.
+    bool mount_pack(std::string_view mountPoint, const fs::path& pack);
+    void unmount_all() { m_Mounts.clear(); }
+
+    // The contents of the file at path, not open if no mount has it.
+    VfsFile open(const fs::path& path) const;
+    bool exists(const fs::path& path) const;
+    // Where the file at path lives on the host, for readers that need a real
+    // file (the model importer). Empty if the file is only in a pack.
+    fs::path resolve(const fs::path& path) const;
+
+    // The host directories mounted, in mount order, for watching them.
+    std::vector<fs::path> directories() const;
+    // The virtual path a host file under a mounted directory is read as,
+    // empty if no directory mount contains it.
+    std::string virtual_path(const fs::path& hostPath) const;
+
+    size_t mount_count() const { return m_Mounts.size(); }
+
+private:
+    struct Mount {
+        std::string point; // normalized, empty for the root
+        fs::path directory;
+        std::unique_ptr<PackFile> pack; // null for directory mounts
+    };
+
+    // path relative to the mount point, false if mount does not contain it
+    static bool relative_to(const Mount& mount, const std::string& path, std::string& relative);
+
+    std::vector<Mount> m_Mounts;
+};
+
+// Opens path through vfs, or straight from the host filesystem without one.
+inline VfsFile open_file(const Vfs* vfs, const fs::path& path) {
+    return vfs ? vfs->open(path) : VfsFile::map(path);
+}
+
+} // namespace Resource
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+#include <utility>
+
+#include "platform/mapped_file.hpp"
+
+namespace Resource {
+
+// The bytes of one file as the Vfs hands them out. A loose file is mapped and
+// owned, a file inside a pack is a view into the pack's mapping and stays
+// valid as long as the pack is mounted.
+class VfsFile {
+public:
+    VfsFile() = default;
+
+    // Maps path from the host filesystem.
+    static VfsFile map(const std::filesystem::path& path) {
+        VfsFile file;
+        if (file.m_Mapping.open(path)) {
+            file.m_Bytes = file.m_Mapping.bytes();
+            file.m_Open = true;
+        }
+        return file;
+    }
+    static VfsFile view(std::span<const std::byte> bytes) {
+        VfsFile file;
+        file.m_Bytes = bytes;
+        file.m_Open = true;
+        return file;
+    }
+
+    VfsFile(VfsFile&& other) noexcept
+        : m_Mapping(std::move(other.m_Mapping))
+        , m_Bytes(std::exchange(other.m_Bytes, {}))
+        , m_Open(std::exchange(other.m_Open, false)) { }
+    VfsFile& operator=(VfsFile&& other) noexcept {
+        m_Mapping = std::move(other.m_Mapping);
+        m_Bytes = std::exchange(other.m_Bytes, {});
+        m_Open = std::exchange(other.m_Open, false);
+        return *this;
+    }
+
+    void close() {
+        m_Mapping.close();
+        m_Bytes = {};
+        m_Open = false;
+    }
+
+    bool is_open() const { return m_Open; }
+    const std::byte* data() const { return m_Bytes.data(); }
+    size_t size() const { return m_Bytes.size(); }
+    std::span<const std::byte> bytes() const { return m_Bytes; }
+
+private:
+    Platform::MappedFile m_Mapping;
+    std::span<const std::byte> m_Bytes;
+    bool m_Open = false;
+};
+
+} // namespace Resource
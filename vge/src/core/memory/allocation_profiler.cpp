@@ -0,0 +1,503 @@
+#include "core/memory/allocation_profiler.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+#include "core/logger.hpp"
+
+#if defined(__PLATFORM_WINDOWS__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <malloc.h>
+#elif __has_include(<execinfo.h>)
+#include <execinfo.h>
+#include <unistd.h>
+#define VGE_HAS_EXECINFO 1
+#endif
+
+namespace Core {
+
+namespace {
+
+constexpr auto Relaxed = std::memory_order_relaxed;
+constexpr std::size_t TagCount = static_cast<std::size_t>(MemoryTag::MEMORY_TAG_MAX_TAGS);
+
+struct ScopeFrame {
+    const char* name;
+    MemoryTag tag;
+};
+
+// Trivial thread locals only: they must be usable from inside operator new
+// without any dynamic TLS initialization.
+thread_local ScopeFrame t_Scopes[AllocationProfiler::MaxScopeDepth];
+thread_local U32 t_Depth = 0;
+thread_local bool t_InProfiler = false;
+
+struct AtomicCounters {
+    std::atomic<U64> allocations{0};
+    std::atomic<U64> bytes{0};
+
+    void add(const std::size_t size) {
+        allocations.fetch_add(1, Relaxed);
+        bytes.fetch_add(size, Relaxed);
+    }
+
+    AllocationProfiler::Counters take() {
+        return {allocations.exchange(0, Relaxed), bytes.exchange(0, Relaxed)};
+    }
+
+    AllocationProfiler::Counters load() const {
+        return {allocations.load(Relaxed), bytes.load(Relaxed)};
+    }
+
+    void clear() {
+        allocations.store(0, Relaxed);
+        bytes.store(0, Relaxed);
+    }
+};
+
+struct ScopeSlot {
+    std::atomic<const char*> name{nullptr};
+    AtomicCounters frame;
+    AtomicCounters total;
+    AllocationProfiler::Counters lastFrame{};
+};
+
+constexpr const char* UnscopedName = "<unscoped>";
+constexpr const char* OverflowName = "<overflow>";
+
+struct State {
+    // current frame, moved into the last* snapshots by end_frame()
+    AtomicCounters frame;
+    std::atomic<U64> frameFrees{0};
+    std::array<AtomicCounters, TagCount> tags;
+    std::array<ScopeSlot, AllocationProfiler::MaxScopes> scopes;
+
+    AllocationProfiler::FrameStats lastFrame{};
+    std::array<AllocationProfiler::Counters, TagCount> lastTags{};
+
+    std::atomic<U64> frameIndex{0};
+    std::atomic<bool> inFrame{false};
+
+    std::atomic<U32> sampleInterval{0};
+    std::atomic<U64> allocationIndex{0};
+    std::atomic_flag samplesLock = ATOMIC_FLAG_INIT;
+    std::array<AllocationProfiler::Callstack, AllocationProfiler::MaxCallstacks> samples{};
+    U32 sampleHead = 0;
+    U32 sampleCount = 0;
+
+    std::atomic<bool> enforcing{false};
+    std::atomic<U64> enforceFromFrame{0};
+    std::atomic<AllocationProfiler::ViolationHandler> handler{nullptr};
+};
+
+// Constant initialized, so hooks running before main() see a valid state.
+constinit State s_State{};
+
+// Keeps the profiler's own allocations (and reentrant hooks) out of the counts.
+class ReentrancyGuard {
+   public:
+    ReentrancyGuard() noexcept : m_Owner(!t_InProfiler) { t_InProfiler = true; }
+    ~ReentrancyGuard() noexcept {
+        if (m_Owner) {
+            t_InProfiler = false;
+        }
+    }
+
+    bool owner() const noexcept { return m_Owner; }
+
+   private:
+    bool m_Owner;
+};
+
+ScopeFrame current_frame() noexcept {
+    if (t_Depth == 0) {
+        return {nullptr, MemoryTag::MEMORY_TAG_UNKNOWN};
+    }
+    return t_Scopes[std::min(t_Depth, AllocationProfiler::MaxScopeDepth) - 1];
+}
+
+// Open addressing on the name pointer. Slot 0 collects unscoped allocations,
+// the last slot everything that did not fit into the table.
+ScopeSlot& find_scope(const char* name) noexcept {
+    auto& scopes = s_State.scopes;
+    if (!name) {
+        return scopes[0];
+    }
+
+    constexpr std::size_t Buckets = AllocationProfiler::MaxScopes - 2;
+    const std::size_t start = (reinterpret_cast<std::uintptr_t>(name) >> 3) % Buckets;
+    for (std::size_t i = 0; i < Buckets; ++i) {
+        ScopeSlot& slot = scopes[1 + (start + i) % Buckets];
+        const char* current = slot.name.load(std::memory_order_acquire);
+        if (current == name) {
+            return slot;
+        }
+        if (!current && slot.name.compare_exchange_strong(current, name,
+                                                          std::memory_order_acq_rel)) {
+            return slot;
+        }
+        if (current == name) {
+            return slot;
+        }
+    }
+    return scopes[AllocationProfiler::MaxScopes - 1];
+}
+
+U32 capture_callstack(std::array<void*, AllocationProfiler::MaxCallstackDepth>& frames) noexcept {
+#if defined(__PLATFORM_WINDOWS__)
+    return CaptureStackBackTrace(2, static_cast<DWORD>(frames.size()), frames.data(), nullptr);
+#elif defined(VGE_HAS_EXECINFO)
+    return static_cast<U32>(backtrace(frames.data(), static_cast<int>(frames.size())));
+#else
+    (void)frames;
+    return 0;
+#endif
+}
+
+void fill_callstack(AllocationProfiler::Callstack& out, const std::size_t bytes,
+                    const ScopeFrame& scope) noexcept {
+    out.frame = s_State.frameIndex.load(Relaxed);
+    out.bytes = bytes;
+    out.scope = scope.name ? scope.name : UnscopedName;
+    out.tag = scope.tag;
+    out.depth = capture_callstack(out.frames);
+}
+
+void record_sample(const std::size_t bytes, const ScopeFrame& scope) noexcept {
+    AllocationProfiler::Callstack sample;
+    fill_callstack(sample, bytes, scope);
+
+    while (s_State.samplesLock.test_and_set(std::memory_order_acquire)) {
+    }
+    s_State.samples[s_State.sampleHead] = sample;
+    s_State.sampleHead = (s_State.sampleHead + 1) % AllocationProfiler::MaxCallstacks;
+    s_State.sampleCount = std::min(s_State.sampleCount + 1, AllocationProfiler::MaxCallstacks);
+    s_State.samplesLock.clear(std::memory_order_release);
+}
+
+void print_callstack(const AllocationProfiler::Callstack& cs) {
+    std::fprintf(stderr, "  %zu bytes in scope '%s' (%s), frame %llu\n", cs.bytes, cs.scope,
+                 memoryTagToString(cs.tag).data(), static_cast<unsigned long long>(cs.frame));
+#if defined(VGE_HAS_EXECINFO)
+    // writes straight to the fd, no allocation
+    backtrace_symbols_fd(cs.frames.data(), static_cast<int>(cs.depth), STDERR_FILENO);
+#else
+    for (U32 i = 0; i < cs.depth; ++i) {
+        std::fprintf(stderr, "    #%u %p\n", i, cs.frames[i]);
+    }
+#endif
+}
+
+void default_violation_handler(const AllocationProfiler::Callstack& cs) {
+    std::fprintf(stderr, "[AllocationProfiler]: Heap allocation in a zero-allocation frame!\n");
+    print_callstack(cs);
+    CORE_LOG_FATAL("[AllocationProfiler]: {} bytes allocated in scope '{}' during frame {}",
+                   cs.bytes, cs.scope, cs.frame);
+    std::fflush(stderr);
+    std::abort();
+}
+
+}  // namespace
+
+void AllocationProfiler::on_allocate(const std::size_t bytes) noexcept {
+    ReentrancyGuard guard;
+    if (!guard.owner()) {
+        return;
+    }
+
+    const ScopeFrame scope = current_frame();
+    s_State.frame.add(bytes);
+    s_State.tags[static_cast<std::size_t>(scope.tag)].add(bytes);
+
+    ScopeSlot& slot = find_scope(scope.name);
+    slot.frame.add(bytes);
+    slot.total.add(bytes);
+
+    const U64 index = s_State.allocationIndex.fetch_add(1, Relaxed);
+    const U32 interval = s_State.sampleInterval.load(Relaxed);
+    if (interval > 0 && index % interval == 0) {
+        record_sample(bytes, scope);
+    }
+
+    if (s_State.enforcing.load(Relaxed) && s_State.inFrame.load(Relaxed) &&
+        s_State.frameIndex.load(Relaxed) >= s_State.enforceFromFrame.load(Relaxed)) {
+        Callstack cs;
+        fill_callstack(cs, bytes, scope);
+        const ViolationHandler handler = s_State.handler.load(Relaxed);
+        (handler ? handler : default_violation_handler)(cs);
+    }
+}
+
+void AllocationProfiler::on_free() noexcept {
+    if (!t_InProfiler) {
+        s_State.frameFrees.fetch_add(1, Relaxed);
+    }
+}
+
+void AllocationProfiler::push_scope(const char* name, const MemoryTag tag) noexcept {
+    if (t_Depth < MaxScopeDepth) {
+        t_Scopes[t_Depth] = {name, tag};
+    }
+    // deeper scopes are folded into the innermost tracked one
+    t_Depth++;
+}
+
+void AllocationProfiler::push_scope(const char* name) noexcept {
+    push_scope(name, current_tag());
+}
+
+void AllocationProfiler::push_scope(const MemoryTag tag) noexcept {
+    push_scope(current_scope(), tag);
+}
+
+void AllocationProfiler::pop_scope() noexcept {
+    if (t_Depth > 0) {
+        t_Depth--;
+    }
+}
+
+const char* AllocationProfiler::current_scope() noexcept {
+    return current_frame().name;
+}
+
+MemoryTag AllocationProfiler::current_tag() noexcept {
+    return current_frame().tag;
+}
+
+void AllocationProfiler::begin_frame() noexcept {
+    // allocations made between frames (loading, event processing) only count
+    // towards the totals
+    s_State.frame.clear();
+    s_State.frameFrees.store(0, Relaxed);
+    for (auto& tag : s_State.tags) {
+        tag.clear();
+    }
+    for (auto& slot : s_State.scopes) {
+        slot.frame.clear();
+    }
+    s_State.inFrame.store(true, Relaxed);
+}
+
+AllocationProfiler::FrameStats AllocationProfiler::end_frame() noexcept {
+    s_State.inFrame.store(false, Relaxed);
+
+    const Counters frame = s_State.frame.take();
+    FrameStats stats{};
+    stats.frame = s_State.frameIndex.fetch_add(1, Relaxed);
+    stats.allocations = frame.allocations;
+    stats.bytes = frame.bytes;
+    stats.frees = s_State.frameFrees.exchange(0, Relaxed);
+    s_State.lastFrame = stats;
+
+    for (std::size_t i = 0; i < TagCount; ++i) {
+        s_State.lastTags[i] = s_State.tags[i].take();
+    }
+    for (auto& slot : s_State.scopes) {
+        slot.lastFrame = slot.frame.take();
+    }
+    return stats;
+}
+
+AllocationProfiler::FrameStats AllocationProfiler::last_frame() noexcept {
+    return s_State.lastFrame;
+}
+
+AllocationProfiler::Counters AllocationProfiler::tag_stats(const MemoryTag tag) noexcept {
+    return s_State.lastTags[static_cast<std::size_t>(tag)];
+}
+
+std::size_t AllocationProfiler::scope_stats(std::span<ScopeStats> out) noexcept {
+    std::size_t written = 0;
+    for (std::size_t i = 0; i < MaxScopes && written < out.size(); ++i) {
+        const ScopeSlot& slot = s_State.scopes[i];
+        const Counters total = slot.total.load();
+
+        const char* name = slot.name.load(std::memory_order_acquire);
+        if (i == 0) {
+            name = UnscopedName;
+        } else if (i == MaxScopes - 1) {
+            name = OverflowName;
+        }
+        if (!name || total.allocations == 0) {
+            continue;
+        }
+        out[written++] = {name, slot.lastFrame, total};
+    }
+    return written;
+}
+
+void AllocationProfiler::set_sample_interval(const U32 interval) noexcept {
+    s_State.sampleInterval.store(interval, Relaxed);
+}
+
+std::size_t AllocationProfiler::sampled_callstacks(std::span<Callstack> out) noexcept {
+    while (s_State.samplesLock.test_and_set(std::memory_order_acquire)) {
+    }
+    const std::size_t count = std::min<std::size_t>(s_State.sampleCount, out.size());
+    for (std::size_t i = 0; i < count; ++i) {
+        const U32 idx =
+            (s_State.sampleHead + MaxCallstacks - 1 - static_cast<U32>(i)) % MaxCallstacks;
+        out[i] = s_State.samples[idx];
+    }
+    s_State.samplesLock.clear(std::memory_order_release);
+    return count;
+}
+
+void AllocationProfiler::enforce_zero_allocation_frames(const U32 warmupFrames,
+                                                        const ViolationHandler handler) noexcept {
+    s_State.handler.store(handler, Relaxed);
+    s_State.enforceFromFrame.store(s_State.frameIndex.load(Relaxed) + warmupFrames, Relaxed);
+    s_State.enforcing.store(true, Relaxed);
+}
+
+void AllocationProfiler::disable_zero_allocation_frames() noexcept {
+    s_State.enforcing.store(false, Relaxed);
+}
+
+void AllocationProfiler::report() {
+    ReentrancyGuard guard;
+
+    const FrameStats frame = s_State.lastFrame;
+    CORE_LOG_INFO("[AllocationProfiler]: Frame {}: {} allocations ({} bytes), {} frees",
+                  frame.frame, frame.allocations, frame.bytes, frame.frees);
+    if (frame.allocations == 0) {
+        return;
+    }
+
+    for (std::size_t i = 0; i < TagCount; ++i) {
+        const Counters& tag = s_State.lastTags[i];
+        if (tag.allocations > 0) {
+            CORE_LOG_INFO("  [tag] {}: {} allocations ({} bytes)",
+                          memoryTagToString(static_cast<MemoryTag>(i)), tag.allocations,
+                          tag.bytes);
+        }
+    }
+
+    std::array<ScopeStats, MaxScopes> scopes;
+    const std::size_t count = scope_stats(scopes);
+    for (std::size_t i = 0; i < count; ++i) {
+        if (scopes[i].lastFrame.allocations > 0) {
+            CORE_LOG_INFO("  [scope] {}: {} allocations ({} bytes), {} total", scopes[i].name,
+                          scopes[i].lastFrame.allocations, scopes[i].lastFrame.bytes,
+                          scopes[i].total.allocations);
+        }
+    }
+
+    std::array<Callstack, MaxCallstacks> samples;
+    const std::size_t sampled = sampled_callstacks(samples);
+    for (std::size_t i = 0; i < sampled; ++i) {
+        if (samples[i].frame == frame.frame) {
+            print_callstack(samples[i]);
+        }
+    }
+}
+
+void AllocationProfiler::reset() noexcept {
+    s_State.frame.clear();
+    s_State.frameFrees.store(0, Relaxed);
+    for (auto& tag : s_State.tags) {
+        tag.clear();
+    }
+    for (auto& slot : s_State.scopes) {
+        slot.name.store(nullptr, Relaxed);
+        slot.frame.clear();
+        slot.total.clear();
+        slot.lastFrame = {};
+    }
+    s_State.lastFrame = {};
+    s_State.lastTags = {};
+
+    s_State.frameIndex.store(0, Relaxed);
+    s_State.inFrame.store(false, Relaxed);
+    s_State.allocationIndex.store(0, Relaxed);
+
+    while (s_State.samplesLock.test_and_set(std::memory_order_acquire)) {
+    }
+    s_State.sampleHead = 0;
+    s_State.sampleCount = 0;
+    s_State.samplesLock.clear(std::memory_order_release);
+
+    s_State.enforcing.store(false, Relaxed);
+    s_State.handler.store(nullptr, Relaxed);
+}
+
+}  // namespace Core
+
+#ifdef VGE_ALLOCATION_PROFILER
+
+// Global replacements. Every form of operator new funnels into
+// profiled_alloc(), every form of operator delete into profiled_free().
+
+namespace {
+
+void* profiled_alloc(std::size_t size, std::size_t align) noexcept {
+    Core::AllocationProfiler::on_allocate(size);
+    size = size ? size : 1;
+
+    if (align <= __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        return std::malloc(size);
+    }
+#if defined(__PLATFORM_WINDOWS__)
+    return _aligned_malloc(size, align);
+#else
+    void* p = nullptr;
+    return posix_memalign(&p, std::max(align, sizeof(void*)), size) == 0 ? p : nullptr;
+#endif
+}
+
+void profiled_free(void* p, std::size_t align) noexcept {
+    if (!p) {
+        return;
+    }
+    Core::AllocationProfiler::on_free();
+#if defined(__PLATFORM_WINDOWS__)
+    if (align > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+        _aligned_free(p);
+        return;
+    }
+#else
+    (void)align;
+#endif
+    std::free(p);
+}
+
+void* profiled_alloc_or_throw(std::size_t size, std::size_t align) {
+    if (void* p = profiled_alloc(size, align)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+constexpr std::size_t DefaultAlign = __STDCPP_DEFAULT_NEW_ALIGNMENT__;
+
+}  // namespace
+
+// clang-format off
+void* operator new(std::size_t n) { return profiled_alloc_or_throw(n, DefaultAlign); }
+void* operator new[](std::size_t n) { return profiled_alloc_or_throw(n, DefaultAlign); }
+void* operator new(std::size_t n, const std::nothrow_t&) noexcept { return profiled_alloc(n, DefaultAlign); }
+void* operator new[](std::size_t n, const std::nothrow_t&) noexcept { return profiled_alloc(n, DefaultAlign); }
+void* operator new(std::size_t n, std::align_val_t a) { return profiled_alloc_or_throw(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a) { return profiled_alloc_or_throw(n, static_cast<std::size_t>(a)); }
+void* operator new(std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return profiled_alloc(n, static_cast<std::size_t>(a)); }
+void* operator new[](std::size_t n, std::align_val_t a, const std::nothrow_t&) noexcept { return profiled_alloc(n, static_cast<std::size_t>(a)); }
+
+void operator delete(void* p) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete[](void* p) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete(void* p, std::size_t) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete[](void* p, std::size_t) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { profiled_free(p, DefaultAlign); }
+void operator delete(void* p, std::align_val_t a) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::align_val_t a) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::size_t, std::align_val_t a) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::size_t, std::align_val_t a) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+void operator delete(void* p, std::align_val_t a, const std::nothrow_t&) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+void operator delete[](void* p, std::align_val_t a, const std::nothrow_t&) noexcept { profiled_free(p, static_cast<std::size_t>(a)); }
+// clang-format on
+
+#endif
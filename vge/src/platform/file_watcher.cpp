@@ -0,0 +1,151 @@
+#include "platform/file_watcher.hpp"
+
+#include <algorithm>
+#include <system_error>
+
+#include "core/logger.hpp"
+
+#if defined(__PLATFORM_LINUX__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+namespace Platform {
+
+#if defined(__PLATFORM_LINUX__)
+
+// written and closed, or renamed into place (editors and the cooker write a
+// temporary file first), plus new directories to watch
+static constexpr uint32_t WatchMask
+    = IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE_SELF | IN_ONLYDIR;
+
+FileWatcher::~FileWatcher() {
+    if (m_Fd >= 0) {
+        ::close(m_Fd); // drops every watch with it
+    }
+}
+
+bool FileWatcher::watch(const std::filesystem::path& directory) {
+    std::error_code error;
+    if (!std::filesystem::is_directory(directory, error)) {
+        CORE_LOG_WARN("[FileWatcher]: Cannot watch {}, not a directory", directory.string());
+        return false;
+    }
+    if (m_Fd < 0) {
+        m_Fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (m_Fd < 0) {
+            CORE_LOG_ERROR("[FileWatcher]: inotify_init1 failed: {}", std::strerror(errno));
+            return false;
+        }
+    }
+
+    if (!addWatch(directory)) {
+        return false;
+    }
+    if (std::find(m_Roots.begin(), m_Roots.end(), directory) == m_Roots.end()) {
+        m_Roots.push_back(directory);
+    }
+    for (auto it = std::filesystem::recursive_directory_iterator(
+             directory, std::filesystem::directory_options::skip_permission_denied, error);
+        !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+        if (it->is_directory(error)) {
+            addWatch(it->path());
+        }
+    }
+    return true;
+}
+
+size_t FileWatcher::poll(std::vector<std::filesystem::path>& changed) {
+    if (m_Fd < 0) {
+        return 0;
+    }
+
+    const size_t first = changed.size();
+    bool overflowed = false;
+    alignas(inotify_event) char buffer[4096];
+    for (;;) {
+        const ssize_t length = ::read(m_Fd, buffer, sizeof(buffer));
+        if (length <= 0) {
+            break; // EAGAIN: nothing left to read
+        }
+
+        for (ssize_t offset = 0; offset < length;) {
+            const auto* event = reinterpret_cast<const inotify_event*>(buffer + offset);
+            offset += static_cast<ssize_t>(sizeof(inotify_event) + event->len);
+
+            // not tied to a watch, wd is -1
+            if (event->mask & IN_Q_OVERFLOW) {
+                overflowed = true;
+                continue;
+            }
+            auto directory = m_Directories.find(event->wd);
+            if (directory == m_Directories.end()) {
+                continue;
+            }
+            if (event->mask & (IN_DELETE_SELF | IN_IGNORED)) {
+                m_Directories.erase(directory);
+                continue;
+            }
+            if (event->len == 0) {
+                continue;
+            }
+
+            std::filesystem::path path = directory->second / event->name;
+            if (event->mask & IN_ISDIR) {
+                // files written into it before the watch was added are missed,
+                // anything written later is reported
+                if (event->mask & (IN_CREATE | IN_MOVED_TO)) {
+                    addWatch(path);
+                }
+            } else if (event->mask & (IN_CLOSE_WRITE | IN_MOVED_TO)) {
+                if (std::find(changed.begin() + static_cast<std::ptrdiff_t>(first), changed.end(),
+                        path)
+                    == changed.end()) {
+                    changed.push_back(std::move(path));
+                }
+            }
+        }
+    }
+
+    if (overflowed) {
+        // events were dropped, which files changed is unknown
+        CORE_LOG_WARN("[FileWatcher]: Event queue overflowed, reporting every watched directory");
+        for (const std::filesystem::path& root : m_Roots) {
+            if (std::find(changed.begin() + static_cast<std::ptrdiff_t>(first), changed.end(), root)
+                == changed.end()) {
+                changed.push_back(root);
+            }
+        }
+    }
+    return changed.size() - first;
+}
+
+bool FileWatcher::addWatch(const std::filesystem::path& directory) {
+    const int wd = inotify_add_watch(m_Fd, directory.c_str(), WatchMask);
+    if (wd < 0) {
+        CORE_LOG_WARN(
+            "[FileWatcher]: Cannot watch {}: {}", directory.string(), std::strerror(errno));
+        return false;
+    }
+    m_Directories.insert_or_assign(wd, directory);
+    return true;
+}
+
+#else
+
+FileWatcher::~FileWatcher() = default;
+
+bool FileWatcher::watch(const std::filesystem::path& directory) {
+    CORE_LOG_WARN("[FileWatcher]: Watching {} is only supported on Linux", directory.string());
+    return false;
+}
+
+size_t FileWatcher::poll(std::vector<std::filesystem::path>&) { return 0; }
+
+bool FileWatcher::addWatch(const std::filesystem::path&) { return false; }
+
+#endif
+
+} // namespace Platform
@@ -0,0 +1,133 @@
+#include "platform/mapped_file.hpp"
+
+#include <utility>
+
+#include "core/logger.hpp"
+
+#if defined(__PLATFORM_WINDOWS__)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Platform {
+
+MappedFile::~MappedFile() { close(); }
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : m_Data(std::exchange(other.m_Data, nullptr))
+    , m_Size(std::exchange(other.m_Size, 0))
+    , m_Open(std::exchange(other.m_Open, false)) { }
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        m_Data = std::exchange(other.m_Data, nullptr);
+        m_Size = std::exchange(other.m_Size, 0);
+        m_Open = std::exchange(other.m_Open, false);
+    }
+    return *this;
+}
+
+#if defined(__PLATFORM_WINDOWS__)
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size)) {
+        CloseHandle(file);
+        return false;
+    }
+    if (size.QuadPart == 0) {
+        CloseHandle(file);
+        m_Open = true;
+        return true;
+    }
+
+    // the view keeps the mapping alive, both handles can be closed right away
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    CloseHandle(file);
+    if (!mapping) {
+        CORE_LOG_ERROR("[MappedFile]: Failed to map {}", path.string());
+        return false;
+    }
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    CloseHandle(mapping);
+    if (!view) {
+        CORE_LOG_ERROR("[MappedFile]: Failed to map {}", path.string());
+        return false;
+    }
+
+    m_Data = static_cast<const std::byte*>(view);
+    m_Size = static_cast<size_t>(size.QuadPart);
+    m_Open = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_Data) {
+        UnmapViewOfFile(m_Data);
+    }
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+#else
+
+bool MappedFile::open(const std::filesystem::path& path) {
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        ::close(fd);
+        return false;
+    }
+    if (info.st_size == 0) {
+        ::close(fd);
+        m_Open = true;
+        return true;
+    }
+
+    // the mapping holds its own reference to the file
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (view == MAP_FAILED) {
+        CORE_LOG_ERROR("[MappedFile]: Failed to map {}", path.string());
+        return false;
+    }
+
+    m_Data = static_cast<const std::byte*>(view);
+    m_Size = static_cast<size_t>(info.st_size);
+    m_Open = true;
+    return true;
+}
+
+void MappedFile::close() {
+    if (m_Data) {
+        munmap(const_cast<std::byte*>(m_Data), m_Size);
+    }
+    m_Data = nullptr;
+    m_Size = 0;
+    m_Open = false;
+}
+
+#endif
+
+} // namespace Platform
@@ -3,6 +3,7 @@
 #include "core/application.hpp"
 #include "core/assert.hpp"
 #include "core/logger.hpp"
+#include "core/memory/allocation_profiler.hpp"
 #include <iostream>
 namespace Platform {
 
@@ -59,6 +60,11 @@ bool Platform::run(Core::Application* app) {
 bool Platform::mainLoop() {
     m_Timer.start();
 
+#ifdef VGE_ZERO_ALLOCATION_FRAMES
+    // loading and the first frames (pipeline/swapchain warm up) may allocate
+    Core::AllocationProfiler::enforce_zero_allocation_frames(ZERO_ALLOCATION_WARMUP_FRAMES);
+#endif
+
     while (m_Running && !m_App->shouldClose()) {
         processEvents();
 
@@ -66,9 +72,22 @@ bool Platform::mainLoop() {
             break;
         }
 
+#ifdef VGE_ALLOCATION_PROFILER
+        Core::AllocationProfiler::begin_frame();
+        updateFrame();
+        const auto allocations = Core::AllocationProfiler::end_frame();
+        if (allocations.frame % ALLOCATION_REPORT_INTERVAL == 0) {
+            Core::AllocationProfiler::report();
+        }
+#else
         updateFrame();
+#endif
     }
 
+#ifdef VGE_ZERO_ALLOCATION_FRAMES
+    Core::AllocationProfiler::disable_zero_allocation_frames();
+#endif
+
     return true;
 }
 
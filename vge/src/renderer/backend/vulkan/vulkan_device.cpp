@@ -6,11 +6,10 @@
 
 #include "core/logger.hpp"
 #include "core/assert.hpp"
+#include "core/containers/static_vector.hpp"
 
 #include <vulkan/vulkan_core.h>
 
-#include <set>
-
 namespace Renderer::Vulkan {
 
 VulkanDevice::VulkanDevice(VulkanContext& context)
@@ -146,10 +145,12 @@ void VulkanDevice::create_device() {
 
     auto& [graphicsFamily, presentFamily] = m_QueueIndices;
 
-    std::set<U32> uniqueQueueFamilies = { graphicsFamily.value(), presentFamily.value() };
+    Core::static_vector<U32, 2> uniqueQueueFamilies { graphicsFamily.value() };
+    if (presentFamily.value() != graphicsFamily.value()) {
+        uniqueQueueFamilies.push_back(presentFamily.value());
+    }
 
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos {};
-    queueCreateInfos.reserve(uniqueQueueFamilies.size());
+    Core::static_vector<VkDeviceQueueCreateInfo, 2> queueCreateInfos {};
     float queuePriority = 1.0f;
     for (U32 queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo {};
@@ -160,8 +161,14 @@ void VulkanDevice::create_device() {
         queueCreateInfos.push_back(queueCreateInfo);
     }
 
+    // cooked textures are BC7/BC5, without the feature they are loaded from their source images
+    VkPhysicalDeviceFeatures supportedFeatures;
+    vkGetPhysicalDeviceFeatures(m_PhysicalDevice, &supportedFeatures);
+    m_BcCompression = supportedFeatures.textureCompressionBC == VK_TRUE;
+
     VkPhysicalDeviceFeatures deviceFeatures {};
     deviceFeatures.samplerAnisotropy = VK_TRUE;
+    deviceFeatures.textureCompressionBC = m_BcCompression ? VK_TRUE : VK_FALSE;
 
     VkDeviceCreateInfo createInfo {};
     createInfo.sType = VK_STRUCTURE_TYPE_DEVICE_CREATE_INFO;
@@ -1,31 +1,46 @@
 #include "renderer/backend/vulkan/vulkan_renderer.hpp"
 #include <algorithm>
-#include <numeric>
 #include <set>
 #include <filesystem>
-#include "assimp/material.h"
-#include "assimp/postprocess.h"
-#include "assimp/scene.h"
 #include "core/logger.hpp"
 #include "core/assert.hpp"
+#include "core/containers/small_vector.hpp"
+#include "core/containers/static_vector.hpp"
+#include "core/memory/allocation_profiler.hpp"
 #include "renderer/backend/renderer.hpp"
-#include "renderer/backend/shader_loader.hpp"
 #include "renderer/backend/vulkan/vulkan_context.hpp"
 #include "renderer/backend/vulkan/vulkan_utils.hpp"
 #include "defines.hpp"
 #include "platform/window/window.hpp"
+#include "resource/mesh_lod.hpp"
 #include "scene/camera.hpp"
 #include "vk_mem_alloc.h"
 
 #include <vulkan/vulkan_core.h>
 
 #include <glm/gtc/matrix_transform.hpp>
-
-#define STB_IMAGE_IMPLEMENTATION
-#include "../extern/stb_image.h"
+#include <glm/gtc/type_ptr.hpp>
 
 namespace Renderer::Vulkan {
 
+// Unit cube drawn in place of a model that is still streaming in. Corner i
+// sits at (i & 1, i & 2, i & 4), faces wind counter clockwise seen from outside.
+static Resource::ModelData placeholder_cube() {
+    Resource::MeshData mesh;
+    for (U32 i = 0; i < 8; i++) {
+        mesh.vertices.push_back({ { (i & 1) ? 0.5f : -0.5f, (i & 2) ? 0.5f : -0.5f,
+                                      (i & 4) ? 0.5f : -0.5f },
+            { 1.0f, 1.0f, 1.0f }, { 0.0f, 0.0f } });
+    }
+    mesh.indices = { 4, 6, 2, 4, 2, 0, 1, 3, 7, 1, 7, 5, 0, 1, 5, 0, 5, 4, 6, 7, 3, 6, 3, 2, 2,
+        3, 1, 2, 1, 0, 4, 5, 7, 4, 7, 6 };
+
+    Resource::ModelData model;
+    model.meshes.push_back(std::move(mesh));
+    model.materials.push_back({ "placeholder", "" });
+    return model;
+}
+
 static VKAPI_ATTR VkBool32 VKAPI_CALL DebugCallback(VkDebugUtilsMessageSeverityFlagBitsEXT severity,
     VkDebugUtilsMessageTypeFlagsEXT, const VkDebugUtilsMessengerCallbackDataEXT* data, void*) {
     const char* msg = data->pMessage;
@@ -98,6 +113,7 @@ static VkPresentModeKHR choose_swap_present_mode(
 VulkanRenderer::VulkanRenderer(Platform::Window& window)
     : m_Window(window)
     , m_CurrentFrame(0)
+    , m_FrameNumber(0)
     , m_Context { m_Window } // todo: context already holds window, do we need window again?
     , m_Device { m_Context }
     , m_Swapchain { m_Device, m_Context.vk_surface(), m_Window }
@@ -112,19 +128,18 @@ VulkanRenderer::VulkanRenderer(Platform::Window& window)
     , m_PresentQueue(VK_NULL_HANDLE)
     , m_RenderPass(VK_NULL_HANDLE)
     , m_PipelineLayout(VK_NULL_HANDLE)
-    , m_GraphicsPipeline(VK_NULL_HANDLE)
+    , m_GraphicsPipelines {}
     , m_DescriptorSetLayout(VK_NULL_HANDLE)
     , m_CommandPool(VK_NULL_HANDLE)
     , m_CommandBuffers {}
-    , m_VertexBuffer(VK_NULL_HANDLE)
-    , m_VertexBufferMemory(VK_NULL_HANDLE)
-    , m_IndexBuffer(VK_NULL_HANDLE)
-    , m_IndexBufferMemory(VK_NULL_HANDLE)
     , m_DescriptorPool(VK_NULL_HANDLE)
     , m_TextureSampler(VK_NULL_HANDLE)
     , m_TextureImage(VK_NULL_HANDLE)
     , m_TextureImageMemory(VK_NULL_HANDLE)
     , m_TextureImageView(VK_NULL_HANDLE)
+    , m_TextureStore { *this, TEXTURE_VRAM_BUDGET }
+    , m_MaterialStore { m_TextureStore }
+    , m_ModelStore { *this, m_MaterialStore }
     , m_DepthImage(VK_NULL_HANDLE)
     , m_DepthImageAllocation {}
     , m_DepthImageMemory(VK_NULL_HANDLE)
@@ -151,6 +166,8 @@ void VulkanRenderer::initialize(const RendererConfig& cfg) {
     // create_logical_device();
     // create_memory_allocator();
     m_Device.initialize();
+    // format queries and memory types go through the device the VulkanDevice picked
+    m_PhysicalDevice = m_Device.physical_device();
     // construct the vulkan device (it will probably call the instance functions as well.)
     // =========SWAPCHAIN=================
     // create_swapchain();
@@ -158,6 +175,7 @@ void VulkanRenderer::initialize(const RendererConfig& cfg) {
     m_Swapchain.initialize();
     // ==================================
 
+    mount_assets(cfg);
     create_render_pass();
     create_descriptor_set_layout();
     create_graphics_pipeline();
@@ -165,10 +183,8 @@ void VulkanRenderer::initialize(const RendererConfig& cfg) {
     create_depth_resources();
     create_framebuffers();
     create_texture_sampler();
-    load_model(
-        "/Users/emirhurturk/Dev/C++/vulkan/vge/assets/models/DamagedHelmet/DamagedHelmet.gltf");
-    create_vertex_buffer();
-    create_index_buffer();
+    m_ModelStore.set_compact_vertices(cfg.compactVertices);
+    load_model("models/DamagedHelmet/DamagedHelmet.gltf");
     setup_game_objects();
     create_uniform_buffers();
     create_descriptor_pool();
@@ -184,17 +200,23 @@ void VulkanRenderer::shutdown() {
     //     return;
 
     vkDeviceWaitIdle(m_Device.device());
+    m_ModelStore.clear();
+    m_MaterialStore.set_default_texture({});
+    m_TextureStore.clear();
+    m_DeletionQueue.flush();
 
     cleanup_swapchain();
 
-    vkDestroyPipeline(m_Device.device(), m_GraphicsPipeline, nullptr);
+    for (VkPipeline pipeline : m_GraphicsPipelines) {
+        vkDestroyPipeline(m_Device.device(), pipeline, nullptr);
+    }
     vkDestroyPipelineLayout(m_Device.device(), m_PipelineLayout, nullptr);
     vkDestroyRenderPass(m_Device.device(), m_RenderPass, nullptr);
 
-    for (auto& game_object : m_GameObjects) {
+    for (auto& uniforms : m_GameObjects.column<GAME_OBJECT_UNIFORMS>()) {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
-            vkDestroyBuffer(m_Device.device(), game_object.uniformBuffers[i], nullptr);
-            vkFreeMemory(m_Device.device(), game_object.uniformBufferMemories[i], nullptr);
+            vkDestroyBuffer(m_Device.device(), uniforms.uniformBuffers[i], nullptr);
+            vkFreeMemory(m_Device.device(), uniforms.uniformBufferMemories[i], nullptr);
         }
     }
 
@@ -205,28 +227,10 @@ void VulkanRenderer::shutdown() {
     vkDestroyImage(m_Device.device(), m_TextureImage, nullptr);
     vkFreeMemory(m_Device.device(), m_TextureImageMemory, nullptr);
 
-    for (auto& material : m_LoadedModel.materials) {
-        if (material.diffuseTextureView != VK_NULL_HANDLE) {
-            vkDestroyImageView(m_Device.device(), material.diffuseTextureView, nullptr);
-        }
-        if (material.diffuseTexture != VK_NULL_HANDLE) {
-            vkDestroyImage(m_Device.device(), material.diffuseTexture, nullptr);
-        }
-        if (material.diffuseTextureMemory != VK_NULL_HANDLE) {
-            vkFreeMemory(m_Device.device(), material.diffuseTextureMemory, nullptr);
-        }
-    }
-
     vkDestroySampler(m_Device.device(), m_TextureSampler, nullptr);
 
     vkDestroyDescriptorSetLayout(m_Device.device(), m_DescriptorSetLayout, nullptr);
 
-    vkDestroyBuffer(m_Device.device(), m_IndexBuffer, nullptr);
-    vkFreeMemory(m_Device.device(), m_IndexBufferMemory, nullptr);
-
-    vkDestroyBuffer(m_Device.device(), m_VertexBuffer, nullptr);
-    vkFreeMemory(m_Device.device(), m_VertexBufferMemory, nullptr);
-
     for (int i = 0; i < static_cast<int>(m_Swapchain.image_count()); i++) {
         vkDestroySemaphore(m_Device.device(), m_ImageAvailableSemaphores[i], nullptr);
         vkDestroySemaphore(m_Device.device(), m_RenderFinishedSemaphores[i], nullptr);
@@ -252,6 +256,9 @@ void VulkanRenderer::shutdown() {
 }
 
 void VulkanRenderer::draw_frame(RenderContext context) {
+    PROFILE_ALLOCATION_SCOPE("VulkanRenderer::draw_frame");
+    PROFILE_ALLOCATION_TAG(Core::MemoryTag::MEMORY_TAG_RENDERER);
+
     // Outline of a frame:
     // 1) wait for the previous frame to finish
     // 2) Acquire an image from the swapchain
@@ -267,6 +274,15 @@ void VulkanRenderer::draw_frame(RenderContext context) {
     vkWaitForFences(m_Device.device(), 1, &m_InFlightFences[m_CurrentFrame], VK_TRUE, UINT64_MAX);
     vkResetFences(m_Device.device(), 1, &m_InFlightFences[m_CurrentFrame]);
 
+    // the fence belongs to frame m_FrameNumber - MAX_FRAMES_IN_FLIGHT, everything
+    // retired up to that frame is no longer referenced by the GPU
+    if (m_FrameNumber >= MAX_FRAMES_IN_FLIGHT) {
+        m_DeletionQueue.collect(m_FrameNumber - MAX_FRAMES_IN_FLIGHT);
+    }
+
+    // safe point to swap in streamed assets: this frame's descriptor sets are idle
+    stream_assets();
+
     U32 imageIdx;
     vkAcquireNextImageKHR(m_Device.device(), m_Swapchain.swapchain(), UINT64_MAX,
         m_ImageAvailableSemaphores[m_CurrentFrame], VK_NULL_HANDLE, &imageIdx);
@@ -274,6 +290,9 @@ void VulkanRenderer::draw_frame(RenderContext context) {
     // Remove all previous commands from the command buffer
     vkResetCommandBuffer(m_CommandBuffers[m_CurrentFrame], /*VkCommandBufferResetFlagBits*/ 0);
 
+    select_lods(*context.camera);
+    cull_draws(*context.camera);
+
     // Record the draw commands to the current frame's command buffer for the image imageIdx
     record_draw_commands(m_CommandBuffers[m_CurrentFrame], imageIdx);
 
@@ -319,6 +338,7 @@ void VulkanRenderer::draw_frame(RenderContext context) {
     vkQueuePresentKHR(m_PresentQueue, &presentInfo);
 
     m_CurrentFrame = (m_CurrentFrame + 1) % MAX_FRAMES_IN_FLIGHT;
+    m_FrameNumber++;
 }
 
 void VulkanRenderer::create_instance() {
@@ -414,10 +434,12 @@ void VulkanRenderer::pick_physical_device() {
 void VulkanRenderer::create_logical_device() {
     auto [graphicsFamily, presentFamily] = find_queue_families(m_PhysicalDevice);
 
-    std::set<U32> uniqueQueueFamilies = { graphicsFamily.value(), presentFamily.value() };
+    Core::static_vector<U32, 2> uniqueQueueFamilies { graphicsFamily.value() };
+    if (presentFamily.value() != graphicsFamily.value()) {
+        uniqueQueueFamilies.push_back(presentFamily.value());
+    }
 
-    std::vector<VkDeviceQueueCreateInfo> queueCreateInfos {};
-    queueCreateInfos.reserve(uniqueQueueFamilies.size());
+    Core::static_vector<VkDeviceQueueCreateInfo, 2> queueCreateInfos {};
     float queuePriority = 1.0f;
     for (U32 queueFamily : uniqueQueueFamilies) {
         VkDeviceQueueCreateInfo queueCreateInfo {};
@@ -542,6 +564,26 @@ void VulkanRenderer::create_swapchain_image_views() {
 // Creates a descriptor set layout object.
 // Initializes bindings for the descriptor
 // set layout.
+void VulkanRenderer::mount_assets(const RendererConfig& cfg) {
+    // a shipped pack holds every cooked asset, loose files mounted on top of
+    // it win so edited assets show up without repacking
+    const std::filesystem::path pack
+        = std::filesystem::path(cfg.assetDirectory) / Resource::AssetPackName;
+    if (std::filesystem::exists(pack)) {
+        m_Vfs.mount_pack("", pack);
+    }
+    m_Vfs.mount_directory("", cfg.assetDirectory);
+
+    m_TextureStore.set_vfs(&m_Vfs);
+    m_ModelStore.set_vfs(&m_Vfs);
+
+    if (cfg.hotReload) {
+        for (const std::filesystem::path& directory : m_Vfs.directories()) {
+            m_AssetWatcher.watch(directory);
+        }
+    }
+}
+
 void VulkanRenderer::create_descriptor_set_layout() {
     VkDescriptorSetLayoutBinding uboLayoutBinding {};
     uboLayoutBinding.binding = 0;
@@ -571,13 +613,11 @@ void VulkanRenderer::create_descriptor_set_layout() {
 }
 
 void VulkanRenderer::create_graphics_pipeline() {
-    // TODO: abstract away the filepath thing, especially for resources such as shaders/textures.
-    CORE_LOG_INFO("I am currently in: {}", std::filesystem::current_path().c_str());
-    auto shader = ShaderLoader::read_file(
-        "/Users/emirhurturk/Dev/C++/vulkan/vge/assets/shaders/triangle.spv");
+    const Resource::VfsFile shader = m_Vfs.open(GRAPHICS_PIPELINE_SHADER);
+    ASSERT_MSG(shader.is_open(), "Could not open shader file.");
 
     // Shader modules && stage creations
-    VkShaderModule shaderModule = create_shader_module(shader);
+    VkShaderModule shaderModule = create_shader_module(shader.bytes());
 
     VkPipelineShaderStageCreateInfo vertShaderStageInfo {};
     vertShaderStageInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_SHADER_STAGE_CREATE_INFO;
@@ -597,17 +637,32 @@ void VulkanRenderer::create_graphics_pipeline() {
 
     // Fixed functions:
 
-    // Vertex Input
+    // Vertex Input, one per VertexLayout
     auto bindingDescription = Vertex::get_binding_description();
     auto attributeDescriptions = Vertex::get_attribute_description();
-
-    VkPipelineVertexInputStateCreateInfo vertexInputInfo {};
-    vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
-    vertexInputInfo.vertexBindingDescriptionCount = 1;
-    vertexInputInfo.pVertexBindingDescriptions = &bindingDescription;
-    vertexInputInfo.vertexAttributeDescriptionCount
+    auto compactBindingDescriptions = CompactVertexInput::get_binding_description(false);
+    auto coloredBindingDescriptions = CompactVertexInput::get_binding_description(true);
+    auto compactAttributeDescriptions = CompactVertexInput::get_attribute_description();
+
+    std::array<VkPipelineVertexInputStateCreateInfo, VERTEX_LAYOUT_COUNT> vertexInputInfos {};
+    for (VkPipelineVertexInputStateCreateInfo& vertexInputInfo : vertexInputInfos) {
+        vertexInputInfo.sType = VK_STRUCTURE_TYPE_PIPELINE_VERTEX_INPUT_STATE_CREATE_INFO;
+        vertexInputInfo.vertexAttributeDescriptionCount
+            = static_cast<U32>(compactAttributeDescriptions.size());
+        vertexInputInfo.pVertexAttributeDescriptions = compactAttributeDescriptions.data();
+        vertexInputInfo.vertexBindingDescriptionCount
+            = static_cast<U32>(compactBindingDescriptions.size());
+    }
+    vertexInputInfos[VERTEX_LAYOUT_FULL].vertexBindingDescriptionCount = 1;
+    vertexInputInfos[VERTEX_LAYOUT_FULL].pVertexBindingDescriptions = &bindingDescription;
+    vertexInputInfos[VERTEX_LAYOUT_FULL].vertexAttributeDescriptionCount
         = static_cast<U32>(attributeDescriptions.size());
-    vertexInputInfo.pVertexAttributeDescriptions = attributeDescriptions.data();
+    vertexInputInfos[VERTEX_LAYOUT_FULL].pVertexAttributeDescriptions
+        = attributeDescriptions.data();
+    vertexInputInfos[VERTEX_LAYOUT_COMPACT].pVertexBindingDescriptions
+        = compactBindingDescriptions.data();
+    vertexInputInfos[VERTEX_LAYOUT_COMPACT_COLORED].pVertexBindingDescriptions
+        = coloredBindingDescriptions.data();
 
     // Input Assembly
     VkPipelineInputAssemblyStateCreateInfo inputAssembly {};
@@ -656,7 +711,7 @@ void VulkanRenderer::create_graphics_pipeline() {
     colorBlending.blendConstants[2] = 0.0f;
     colorBlending.blendConstants[3] = 0.0f;
 
-    std::vector<VkDynamicState> dynamicStates
+    const Core::static_vector<VkDynamicState, 2> dynamicStates
         = { VK_DYNAMIC_STATE_VIEWPORT, VK_DYNAMIC_STATE_SCISSOR };
     VkPipelineDynamicStateCreateInfo dynamicState {};
     dynamicState.sType = VK_STRUCTURE_TYPE_PIPELINE_DYNAMIC_STATE_CREATE_INFO;
@@ -691,7 +746,6 @@ void VulkanRenderer::create_graphics_pipeline() {
     pipelineInfo.sType = VK_STRUCTURE_TYPE_GRAPHICS_PIPELINE_CREATE_INFO;
     pipelineInfo.stageCount = 2;
     pipelineInfo.pStages = shaderStages;
-    pipelineInfo.pVertexInputState = &vertexInputInfo;
     pipelineInfo.pInputAssemblyState = &inputAssembly;
     pipelineInfo.pViewportState = &viewportState;
     pipelineInfo.pRasterizationState = &rasterizer;
@@ -705,8 +759,16 @@ void VulkanRenderer::create_graphics_pipeline() {
     pipelineInfo.basePipelineHandle = VK_NULL_HANDLE;
     pipelineInfo.basePipelineIndex = -1;
 
-    VULKAN_CHECK(vkCreateGraphicsPipelines(
-        m_Device.device(), VK_NULL_HANDLE, 1, &pipelineInfo, nullptr, &m_GraphicsPipeline));
+    // the pipelines only differ in their vertex input
+    std::array<VkGraphicsPipelineCreateInfo, VERTEX_LAYOUT_COUNT> pipelineInfos {};
+    for (size_t i = 0; i < VERTEX_LAYOUT_COUNT; i++) {
+        pipelineInfos[i] = pipelineInfo;
+        pipelineInfos[i].pVertexInputState = &vertexInputInfos[i];
+    }
+
+    VULKAN_CHECK(vkCreateGraphicsPipelines(m_Device.device(), VK_NULL_HANDLE,
+        static_cast<U32>(pipelineInfos.size()), pipelineInfos.data(), nullptr,
+        m_GraphicsPipelines.data()));
 
     vkDestroyShaderModule(m_Device.device(), shaderModule, nullptr);
 }
@@ -864,137 +926,67 @@ void VulkanRenderer::create_texture_sampler() {
     VULKAN_CHECK(vkCreateSampler(m_Device.device(), &samplerInfo, nullptr, &m_TextureSampler));
 }
 
-void VulkanRenderer::process_node(aiNode* node, const aiScene* scene) {
-    m_LoadedModel.meshes.reserve(node->mNumMeshes);
-
-    for (size_t i = 0; i < node->mNumMeshes; i++) {
-        aiMesh* mesh = scene->mMeshes[node->mMeshes[i]];
-        m_LoadedModel.meshes.push_back(process_mesh(mesh, scene));
-    }
-
-    for (size_t i = 0; i < node->mNumChildren; i++) {
-        process_node(node->mChildren[i], scene);
-    }
+Resource::TextureHandle VulkanRenderer::acquire_default_texture() {
+    Resource::TextureDescriptor desc;
+    desc.generateMipmaps = false;
+    return m_TextureStore.acquire(
+        "vge://default_white", Resource::TextureData { 1, 1, { 255, 255, 255, 255 } }, desc);
 }
 
-Mesh VulkanRenderer::process_mesh(aiMesh* mesh, const aiScene* scene) {
-    Mesh result {};
-    std::unordered_map<Vertex, U32> uniqueVertices {};
-
-    result.vertices.reserve(mesh->mNumVertices);
-    for (size_t i = 0; i < mesh->mNumVertices; i++) {
-        result.vertices.emplace_back(
-            glm::vec3 { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z },
-            mesh->mColors[0]
-                ? glm::vec3 { mesh->mColors[0][i].r, mesh->mColors[0][i].g, mesh->mColors[0][i].b }
-                : glm::vec3 { 1.0f, 1.0f, 1.0f },
-            mesh->mTextureCoords[0]
-                ? glm::vec2 { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y }
-                : glm::vec2 { 0.0f, 0.0f });
-    }
-
-    // TODO: reserve for here?
-    for (size_t i = 0; i < mesh->mNumFaces; i++) {
-        const aiFace& face = mesh->mFaces[i];
-        result.indices.insert(
-            result.indices.end(), face.mIndices, face.mIndices + face.mNumIndices);
-    }
-
-    result.materialIndex = mesh->mMaterialIndex;
-
-    return result;
+VkImageView VulkanRenderer::texture_view(Resource::TextureHandle texture) const {
+    const Resource::Texture* entry = m_TextureStore.get(texture);
+    const GpuTexture* gpu = entry ? m_GpuTextures.get(entry->gpu.texture) : nullptr;
+    return gpu ? gpu->view : VK_NULL_HANDLE;
 }
 
-void VulkanRenderer::process_materials(const aiScene* scene) {
-    m_LoadedModel.materials.resize(scene->mNumMaterials);
-
-    for (size_t i = 0; i < scene->mNumMaterials; i++) {
-        aiMaterial* material = scene->mMaterials[i];
-        Material& mat = m_LoadedModel.materials[i];
-
-        mat.materialIndex = i;
-
-        aiString name;
-        material->Get(AI_MATKEY_NAME, name);
-        mat.name = name.C_Str();
-
-        CORE_LOG_INFO("[VulkanRenderer]: Processing material {}: {}", i, mat.name);
-
-        if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
-            aiString texturePath;
-            material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath);
-
-            std::string fullPath = m_LoadedModel.directory + "/" + texturePath.C_Str();
-
-            if (size_t fchar_idx = fullPath.find("\\"); fchar_idx != std::string::npos) {
-                fullPath.replace(
-                    fullPath.begin() + fchar_idx, fullPath.begin() + fchar_idx + 1, "/");
-            }
-
-            CORE_LOG_INFO("[VulkanRenderer]:\tLoading diffuse texture: {}", fullPath);
-
-            load_texture(
-                fullPath, mat.diffuseTexture, mat.diffuseTextureMemory, mat.diffuseTextureView);
-        } else {
-            CORE_LOG_WARN("[VulkanRenderer]:\tNo diffuse texture found for material {}", mat.name);
-            create_default_texture(
-                mat.diffuseTexture, mat.diffuseTextureMemory, mat.diffuseTextureView);
-        }
-    }
+VkImageView VulkanRenderer::mesh_texture_view(Resource::MeshHandle mesh) const {
+    const Resource::Mesh* entry = m_ModelStore.get(mesh);
+    const Resource::Material* material = entry ? m_MaterialStore.get(entry->material) : nullptr;
+    return texture_view(material ? material->diffuseTexture : Resource::TextureHandle {});
 }
 
-void VulkanRenderer::create_default_texture(
-    VkImage& image, VkDeviceMemory& imageMemory, VkImageView& imageView) {
-    const int texWidth = 1;
-    const int texHeight = 1;
-    unsigned char pixels[4] = { 255, 255, 255, 255 }; // White
-
-    VkDeviceSize imageSize = 4;
-
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    create_buffer(imageSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
-        stagingBufferMemory);
-
-    void* data;
-    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, 4);
-    vkUnmapMemory(m_Device.device(), stagingBufferMemory);
-
-    create_image(texWidth, texHeight, 1, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
-        VK_IMAGE_USAGE_TRANSFER_DST_BIT | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, image, imageMemory);
-
-    transition_image_layout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
-        VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1);
-
-    copy_buffer_to_image(stagingBuffer, image, texWidth, texHeight);
-
-    transition_image_layout(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-        VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, 1);
-
-    vkDestroyBuffer(m_Device.device(), stagingBuffer, nullptr);
-    vkFreeMemory(m_Device.device(), stagingBufferMemory, nullptr);
-
-    imageView = create_image_view(image, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, 1);
+void VulkanRenderer::write_texture_descriptor(VkDescriptorSet set, VkImageView view) {
+    VkDescriptorImageInfo imageInfo {};
+    imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
+    imageInfo.imageView = view;
+    imageInfo.sampler = m_TextureSampler;
+
+    VkWriteDescriptorSet descriptorWrite {};
+    descriptorWrite.sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
+    descriptorWrite.dstSet = set;
+    descriptorWrite.dstBinding = 1;
+    descriptorWrite.dstArrayElement = 0;
+    descriptorWrite.descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
+    descriptorWrite.descriptorCount = 1;
+    descriptorWrite.pImageInfo = &imageInfo;
+
+    vkUpdateDescriptorSets(m_Device.device(), 1, &descriptorWrite, 0, nullptr);
 }
 
-void VulkanRenderer::load_texture(const std::string& path, VkImage& textureImage,
-    VkDeviceMemory& textureMemory, VkImageView& textureView) {
-    int texWidth, texHeight, texChannels;
-    stbi_uc* pixels = stbi_load(path.c_str(), &texWidth, &texHeight, &texChannels, STBI_rgb_alpha);
+bool VulkanRenderer::supports_format(Resource::PixelFormat format) const {
+    return format == Resource::PixelFormat::RGBA8 || m_Device.supports_bc_compression();
+}
 
-    if (!pixels) {
-        CORE_LOG_WARN(
-            "[VulkanRenderer]: Failed to load texture: {}. Creating a default texture...", path);
-        create_default_texture(textureImage, textureMemory, textureView);
-        return;
+Resource::GpuTextureInfo VulkanRenderer::upload_texture(
+    const Resource::TextureImage& image, const Resource::TextureDescriptor& desc) {
+    // uncompressed pixels are always decoded to 4 channels
+    const bool srgb = desc.format == Resource::TextureDescriptor::Format::SRGBA8
+        || desc.format == Resource::TextureDescriptor::Format::SRGB8;
+    VkFormat format = srgb ? VK_FORMAT_R8G8B8A8_SRGB : VK_FORMAT_R8G8B8A8_UNORM;
+    if (image.format == Resource::PixelFormat::BC7) {
+        format = srgb ? VK_FORMAT_BC7_SRGB_BLOCK : VK_FORMAT_BC7_UNORM_BLOCK;
+    } else if (image.format == Resource::PixelFormat::BC5) {
+        format = VK_FORMAT_BC5_UNORM_BLOCK;
     }
 
-    U32 mipLevels = static_cast<U32>(glm::floor(std::log2(std::max(texWidth, texHeight)))) + 1;
+    // cooked textures bring their levels, only a lone RGBA8 level gets blitted down
+    const bool blitMipmaps = desc.generateMipmaps && image.levels.size() == 1
+        && image.format == Resource::PixelFormat::RGBA8;
+    const U32 mipLevels = blitMipmaps
+        ? static_cast<U32>(glm::floor(std::log2(std::max(image.width, image.height)))) + 1
+        : static_cast<U32>(image.levels.size());
 
-    VkDeviceSize imageSize = texWidth * texHeight * 4;
+    VkDeviceSize imageSize = image.data.size();
 
     // Create staging buffer
     VkBuffer stagingBuffer;
@@ -1003,42 +995,62 @@ void VulkanRenderer::load_texture(const std::string& path, VkImage& textureImage
         VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT, stagingBuffer,
         stagingBufferMemory);
 
-    // Copy pixel data to staging buffer
-    void* data;
-    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, imageSize, 0, &data);
-    memcpy(data, pixels, static_cast<size_t>(imageSize));
+    // Copy every level to the staging buffer at once, the image is laid out as it is uploaded
+    void* mapped;
+    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, imageSize, 0, &mapped);
+    memcpy(mapped, image.data.data(), static_cast<size_t>(imageSize));
     vkUnmapMemory(m_Device.device(), stagingBufferMemory);
 
-    stbi_image_free(pixels);
-
     // Create the actual image in device local memory
     // Image has an initial layout of UNDEFINED, therefore its layout has to be transitioned to a
     // VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL layout.
-    create_image(texWidth, texHeight, mipLevels, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_TILING_OPTIMAL,
+    GpuTexture texture {};
+    create_image(image.width, image.height, mipLevels, format, VK_IMAGE_TILING_OPTIMAL,
         VK_IMAGE_USAGE_TRANSFER_SRC_BIT | VK_IMAGE_USAGE_TRANSFER_DST_BIT
             | VK_IMAGE_USAGE_SAMPLED_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, textureImage, textureMemory);
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, texture.image, texture.memory);
 
     // Transition image layout and copy from staging buffer
-    transition_image_layout(textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_LAYOUT_UNDEFINED,
+    transition_image_layout(texture.image, format, VK_IMAGE_LAYOUT_UNDEFINED,
         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, mipLevels);
 
-    copy_buffer_to_image(
-        stagingBuffer, textureImage, static_cast<U32>(texWidth), static_cast<U32>(texHeight));
-
-    // transition_image_layout(textureImage, VK_FORMAT_R8G8B8A8_SRGB,
-    //                         VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
-    //                         VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+    copy_buffer_to_image(stagingBuffer, texture.image, image.width, image.height, image.levels);
 
     // Cleanup staging buffer
     vkDestroyBuffer(m_Device.device(), stagingBuffer, nullptr);
     vkFreeMemory(m_Device.device(), stagingBufferMemory, nullptr);
 
-    generate_mipmaps(textureImage, VK_FORMAT_R8G8B8A8_SRGB, texWidth, texHeight, mipLevels);
+    // generate_mipmaps leaves every level in VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL
+    if (blitMipmaps && mipLevels > 1) {
+        generate_mipmaps(texture.image, format, image.width, image.height, mipLevels);
+    } else {
+        transition_image_layout(texture.image, format, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+            VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL, mipLevels);
+    }
 
     // Create image view
-    textureView = create_image_view(
-        textureImage, VK_FORMAT_R8G8B8A8_SRGB, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+    texture.view = create_image_view(texture.image, format, VK_IMAGE_ASPECT_COLOR_BIT, mipLevels);
+
+    VkMemoryRequirements memoryRequirements;
+    vkGetImageMemoryRequirements(m_Device.device(), texture.image, &memoryRequirements);
+
+    return { m_GpuTextures.insert(texture), mipLevels, memoryRequirements.size };
+}
+
+// Frames in flight may still sample the texture, destroy it once they complete.
+void VulkanRenderer::release_texture(Resource::Handle handle) {
+    const GpuTexture* texture = m_GpuTextures.get(handle);
+    if (!texture) {
+        CORE_LOG_WARN("[VulkanRenderer]: Releasing an unknown texture.");
+        return;
+    }
+
+    m_DeletionQueue.retire(m_FrameNumber, [device = m_Device.device(), texture = *texture] {
+        vkDestroyImageView(device, texture.view, nullptr);
+        vkDestroyImage(device, texture.image, nullptr);
+        vkFreeMemory(device, texture.memory, nullptr);
+    });
+    m_GpuTextures.free(handle);
 }
 
 void VulkanRenderer::generate_mipmaps(
@@ -1121,156 +1133,237 @@ void VulkanRenderer::generate_mipmaps(
 }
 
 void VulkanRenderer::load_model(std::string_view path) {
-    Assimp::Importer importer;
+    // materials without a usable diffuse texture sample plain white, and so
+    // do textures that are still streaming
+    m_MaterialStore.set_default_texture(acquire_default_texture());
+    m_TextureStore.set_placeholder(acquire_default_texture());
+    m_ModelStore.set_placeholder(m_ModelStore.load("vge://placeholder_cube", placeholder_cube()));
+
+    // drawn as the placeholder until stream_assets() picks it up
+    m_Model = m_ModelStore.load_async(m_JobPool, std::filesystem::path(path));
+}
 
-    const aiScene* scene = importer.ReadFile(path.data(),
-        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals
-            | aiProcess_JoinIdenticalVertices | aiProcess_MakeLeftHanded
-            | aiProcess_FlipWindingOrder);
+void VulkanRenderer::stream_assets() {
+    reload_changed_assets();
 
-    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
-        CORE_LOG_FATAL(
-            "[VulkanRenderer::load_model()]: Assimp error: {}", importer.GetErrorString());
-        return;
+    m_StreamedModels.clear();
+    m_ModelStore.poll_loads(m_StreamedModels);
+    if (std::find(m_StreamedModels.begin(), m_StreamedModels.end(), m_Model)
+        != m_StreamedModels.end()) {
+        rebuild_game_objects();
     }
 
-    m_LoadedModel.directory = path.substr(0, path.find_last_of('/'));
-    CORE_LOG_INFO("[VulkanRenderer]: Loading model: {}", path);
-    CORE_LOG_INFO("[VulkanRenderer]: Model has {} materials", scene->mNumMaterials);
-    CORE_LOG_INFO("[VulkanRenderer]: Model has {} meshes", scene->mNumMeshes);
-    CORE_LOG_INFO("[VulkanRenderer]: Model has {} textures", scene->mNumTextures);
-
-    process_materials(scene);
-
-    process_node(scene->mRootNode, scene);
+    m_StreamedTextures.clear();
+    m_TextureStore.poll_loads(m_StreamedTextures, MAX_TEXTURE_UPLOADS_PER_FRAME);
+    for (auto& draw : m_GameObjects.column<GAME_OBJECT_DRAW>()) {
+        const Resource::Mesh* mesh = m_ModelStore.get(draw.mesh);
+        const Resource::Material* material = mesh ? m_MaterialStore.get(mesh->material) : nullptr;
+        if (material
+            && std::find(m_StreamedTextures.begin(), m_StreamedTextures.end(),
+                   material->diffuseTexture)
+                != m_StreamedTextures.end()) {
+            draw.staleTextureSets = (1u << MAX_FRAMES_IN_FLIGHT) - 1;
+        }
 
-    CORE_LOG_INFO("[VulkanRenderer]: Model loaded successfully");
-    CORE_LOG_INFO("[VulkanRenderer]: Total Vertices: {}",
-        std::accumulate(m_LoadedModel.meshes.begin(), m_LoadedModel.meshes.end(), 0,
-            [](int sum, const Mesh& m) { return sum + m.vertices.size(); }));
+        // the other frames' sets may still be read, they are rewritten on their turn
+        const U32 frameBit = 1u << m_CurrentFrame;
+        if (draw.staleTextureSets & frameBit) {
+            write_texture_descriptor(
+                draw.descriptorSets[m_CurrentFrame], mesh_texture_view(draw.mesh));
+            draw.staleTextureSets &= ~frameBit;
+        }
+    }
 }
 
-void VulkanRenderer::create_vertex_buffer() {
-    size_t total_vertices
-        = std::accumulate(m_LoadedModel.meshes.begin(), m_LoadedModel.meshes.end(), 0,
-            [](int sum, const Mesh& m) { return sum + m.vertices.size(); });
-
-    VkDeviceSize bufferSize = sizeof(Vertex) * total_vertices;
-
-    if (bufferSize == 0) {
-        CORE_LOG_ERROR("[VulkanRenderer]: No vertices to create buffer for.");
-        throw std::runtime_error("No vertices to create buffer for.");
+// Files written since the last frame are loaded again in the background, the
+// stores swap them in through poll_loads() like any streamed asset.
+void VulkanRenderer::reload_changed_assets() {
+    m_ChangedAssets.clear();
+    if (m_AssetWatcher.poll(m_ChangedAssets) == 0) {
+        return;
     }
 
-    // Create a staging buffer to use it as a source in memory transfer operation
-    VkBuffer stagingBuffer;
-    VkDeviceMemory stagingBufferMemory;
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
-        VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, stagingBuffer,
-        stagingBufferMemory);
-
-    void* data;
-
-    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    VkDeviceSize currentOffset = 0;
-    for (auto& mesh : m_LoadedModel.meshes) {
-        // Store offset information in the mesh
-        mesh.vertexOffset = currentOffset;
-        mesh.vertexCount = static_cast<U32>(mesh.vertices.size());
-        mesh.vertexOffsetIndex = static_cast<I32>(currentOffset / sizeof(Vertex));
-
-        // Copy this mesh's vertices
-        size_t meshSize = mesh.vertices.size() * sizeof(Vertex);
-        memcpy(static_cast<char*>(data) + currentOffset, mesh.vertices.data(), meshSize);
+    for (const std::filesystem::path& file : m_ChangedAssets) {
+        std::error_code error;
+        if (!std::filesystem::is_directory(file, error)) {
+            reload_asset(file);
+            continue;
+        }
+        // the watcher lost events and reports a whole directory, everything
+        // below it is checked again and the stores skip what hashes the same
+        for (auto it = std::filesystem::recursive_directory_iterator(
+                 file, std::filesystem::directory_options::skip_permission_denied, error);
+            !error && it != std::filesystem::recursive_directory_iterator(); it.increment(error)) {
+            if (it->is_regular_file(error)) {
+                reload_asset(it->path());
+            }
+        }
+    }
+}
 
-        currentOffset += meshSize;
+void VulkanRenderer::reload_asset(const std::filesystem::path& file) {
+    const std::string path = m_Vfs.virtual_path(file);
+    if (path.empty()) {
+        return;
     }
-    vkUnmapMemory(m_Device.device(), stagingBufferMemory);
+    const size_t reloading
+        = m_TextureStore.reload(m_JobPool, path) + m_ModelStore.reload(m_JobPool, path);
+    if (reloading > 0) {
+        CORE_LOG_INFO("[VulkanRenderer]: Reloading {}", path);
+    }
+    reload_shader(path);
+}
 
-    // Make the vertex buffer a transfer destination for the memory transfer
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_VertexBuffer, m_VertexBufferMemory);
+// Rebuilds the pipelines built from the shader at path, one per VertexLayout so
+// far. Frames in flight may still use the old pipelines, they are retired.
+void VulkanRenderer::reload_shader(std::string_view path) {
+    if (path != GRAPHICS_PIPELINE_SHADER) {
+        return;
+    }
 
-    copy_buffer(stagingBuffer, m_VertexBuffer, bufferSize);
+    // a shader still being compiled, or one that failed to, keeps the current pipeline
+    const Resource::VfsFile shader = m_Vfs.open(path);
+    const std::span<const std::byte> code = shader.bytes();
+    if (code.size() < 5 * sizeof(U32) || code.size() % sizeof(U32) != 0
+        || *reinterpret_cast<const U32*>(code.data()) != SPIRV_MAGIC) {
+        CORE_LOG_WARN("[VulkanRenderer]: {} is not valid SPIR-V, keeping the current pipeline", path);
+        return;
+    }
 
-    vkDestroyBuffer(m_Device.device(), stagingBuffer, nullptr);
-    vkFreeMemory(m_Device.device(), stagingBufferMemory, nullptr);
+    m_DeletionQueue.retire(m_FrameNumber,
+        [device = m_Device.device(), pipelines = m_GraphicsPipelines, layout = m_PipelineLayout] {
+            for (VkPipeline pipeline : pipelines) {
+                vkDestroyPipeline(device, pipeline, nullptr);
+            }
+            vkDestroyPipelineLayout(device, layout, nullptr);
+        });
+    create_graphics_pipeline();
+    CORE_LOG_INFO("[VulkanRenderer]: Rebuilt the graphics pipeline from {}", path);
 }
 
-void VulkanRenderer::create_index_buffer() {
-    size_t total_indices = std::accumulate(m_LoadedModel.meshes.begin(), m_LoadedModel.meshes.end(),
-        0, [](int sum, const Mesh& m) { return sum + m.indices.size(); });
+// Packs the vertices and indices of every mesh of a model into one device local buffer each.
+Resource::Handle VulkanRenderer::upload_geometry(
+    std::span<const Resource::MeshVertex> vertices, std::span<const U32> indices) {
+    GpuGeometry geometry {};
+    upload_device_local(vertices.data(), vertices.size_bytes(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        geometry.vertexBuffer, geometry.vertexMemory);
+    upload_device_local(indices.data(), indices.size_bytes(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        geometry.indexBuffer, geometry.indexMemory);
+    return m_GpuGeometry.insert(geometry);
+}
 
-    VkDeviceSize bufferSize = sizeof(U32) * total_indices;
+// Same in the compact layout. Geometry without colors gets a single white one
+// all its vertices read.
+Resource::Handle VulkanRenderer::upload_compact_geometry(
+    std::span<const Resource::CompactVertex> vertices,
+    std::span<const Resource::VertexColor> colors, std::span<const U32> indices) {
+    static constexpr Resource::VertexColor WHITE { 0xFF, 0xFF, 0xFF, 0xFF };
+    const std::span<const Resource::VertexColor> colorStream
+        = colors.empty() ? std::span(&WHITE, 1) : colors;
+
+    GpuGeometry geometry {};
+    geometry.layout = colors.empty() ? VERTEX_LAYOUT_COMPACT : VERTEX_LAYOUT_COMPACT_COLORED;
+    upload_device_local(vertices.data(), vertices.size_bytes(), VK_BUFFER_USAGE_VERTEX_BUFFER_BIT,
+        geometry.vertexBuffer, geometry.vertexMemory);
+    upload_device_local(colorStream.data(), colorStream.size_bytes(),
+        VK_BUFFER_USAGE_VERTEX_BUFFER_BIT, geometry.colorBuffer, geometry.colorMemory);
+    upload_device_local(indices.data(), indices.size_bytes(), VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
+        geometry.indexBuffer, geometry.indexMemory);
+    return m_GpuGeometry.insert(geometry);
+}
 
-    if (bufferSize == 0) {
-        CORE_LOG_ERROR("[VulkanRenderer]: No indices to create buffer for!");
-        throw std::runtime_error("No indices to create buffer for!");
+// Frames in flight may still read the buffers, destroy them once they complete.
+void VulkanRenderer::release_geometry(Resource::Handle handle) {
+    const GpuGeometry* geometry = m_GpuGeometry.get(handle);
+    if (!geometry) {
+        CORE_LOG_WARN("[VulkanRenderer]: Releasing unknown geometry.");
+        return;
     }
 
+    m_DeletionQueue.retire(m_FrameNumber, [device = m_Device.device(), geometry = *geometry] {
+        vkDestroyBuffer(device, geometry.indexBuffer, nullptr);
+        vkFreeMemory(device, geometry.indexMemory, nullptr);
+        vkDestroyBuffer(device, geometry.vertexBuffer, nullptr);
+        vkFreeMemory(device, geometry.vertexMemory, nullptr);
+        vkDestroyBuffer(device, geometry.colorBuffer, nullptr);
+        vkFreeMemory(device, geometry.colorMemory, nullptr);
+    });
+    m_GpuGeometry.free(handle);
+}
+
+void VulkanRenderer::upload_device_local(const void* src, VkDeviceSize size,
+    VkBufferUsageFlags usage, VkBuffer& buffer, VkDeviceMemory& bufferMemory) {
     // Create a staging buffer to use it as a source in memory transfer operation
     VkBuffer stagingBuffer;
     VkDeviceMemory stagingBufferMemory;
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
+    create_buffer(size, VK_BUFFER_USAGE_TRANSFER_SRC_BIT,
         VK_MEMORY_PROPERTY_HOST_COHERENT_BIT | VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT, stagingBuffer,
         stagingBufferMemory);
 
     void* data;
-
-    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, bufferSize, 0, &data);
-    VkDeviceSize currentOffset = 0;
-    for (auto& mesh : m_LoadedModel.meshes) {
-        // Store offset information in the mesh
-        mesh.indexOffset = currentOffset;
-        mesh.indexCount = static_cast<U32>(mesh.indices.size());
-        mesh.firstIndex = static_cast<U32>(currentOffset / sizeof(U32));
-
-        // Copy this mesh's indices
-        size_t meshSize = mesh.indices.size() * sizeof(U32);
-        memcpy(static_cast<char*>(data) + currentOffset, mesh.indices.data(), meshSize);
-
-        currentOffset += meshSize;
-    }
-
+    vkMapMemory(m_Device.device(), stagingBufferMemory, 0, size, 0, &data);
+    memcpy(data, src, static_cast<size_t>(size));
     vkUnmapMemory(m_Device.device(), stagingBufferMemory);
 
-    // Make the vertex buffer a transfer destination for the memory transfer
-    create_buffer(bufferSize, VK_BUFFER_USAGE_TRANSFER_DST_BIT | VK_BUFFER_USAGE_INDEX_BUFFER_BIT,
-        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, m_IndexBuffer, m_IndexBufferMemory);
+    // Make the buffer a transfer destination for the memory transfer
+    create_buffer(size, VK_BUFFER_USAGE_TRANSFER_DST_BIT | usage,
+        VK_MEMORY_PROPERTY_DEVICE_LOCAL_BIT, buffer, bufferMemory);
 
-    copy_buffer(stagingBuffer, m_IndexBuffer, bufferSize);
+    copy_buffer(stagingBuffer, buffer, size);
 
     vkDestroyBuffer(m_Device.device(), stagingBuffer, nullptr);
     vkFreeMemory(m_Device.device(), stagingBufferMemory, nullptr);
 }
 
 void VulkanRenderer::setup_game_objects() {
-    for (size_t i = 0; i < m_LoadedModel.meshes.size(); i++) {
-        GameObject obj {};
-        obj.meshIndex = static_cast<U32>(i);
-        obj.materialIndex = m_LoadedModel.meshes[i].materialIndex;
-        obj.position = { 0.0f, 0.0f, 0.0f };
-        obj.rotation = { 0.0f, 0.0f, 0.0f };
-        obj.scale = { 1.0f, 1.0f, 1.0f };
+    // the placeholder cube until the model has streamed in, or if it fails to
+    const Resource::Model& model = *m_ModelStore.resolve(m_Model);
 
-        // TODO: convert this to emplace_back
-        m_GameObjects.push_back(obj);
+    m_GameObjects.reserve(model.meshes.size());
+    for (Resource::MeshHandle mesh : model.meshes) {
+        GameObjectDraw draw {};
+        draw.mesh = mesh;
+
+        m_GameObjects.emplace_back(GameObjectTransform {}, GameObjectUniforms {}, draw);
     }
 
     CORE_LOG_INFO("[VulkanRenderer]: Created {} game objects from model", m_GameObjects.size());
 }
 
+// The streamed model replaces the placeholder's objects. Frames in flight may
+// still read the old uniform buffers and descriptor sets, retire them.
+void VulkanRenderer::rebuild_game_objects() {
+    const auto oldUniforms = m_GameObjects.column<GAME_OBJECT_UNIFORMS>();
+    m_DeletionQueue.retire(m_FrameNumber,
+        [device = m_Device.device(), pool = m_DescriptorPool,
+            uniforms = std::vector<GameObjectUniforms>(oldUniforms.begin(), oldUniforms.end())] {
+            for (const auto& object : uniforms) {
+                for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
+                    vkDestroyBuffer(device, object.uniformBuffers[i], nullptr);
+                    vkFreeMemory(device, object.uniformBufferMemories[i], nullptr);
+                }
+            }
+            vkDestroyDescriptorPool(device, pool, nullptr);
+        });
+
+    m_GameObjects.clear();
+    setup_game_objects();
+    create_uniform_buffers();
+    create_descriptor_pool();
+    create_descriptor_sets();
+}
+
 void VulkanRenderer::create_uniform_buffers() {
-    for (auto& game_object : m_GameObjects) {
+    for (auto& uniforms : m_GameObjects.column<GAME_OBJECT_UNIFORMS>()) {
         for (size_t i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
             VkDeviceSize bufferSize = sizeof(UniformBufferObject);
 
             create_buffer(bufferSize, VK_BUFFER_USAGE_UNIFORM_BUFFER_BIT,
                 VK_MEMORY_PROPERTY_HOST_VISIBLE_BIT | VK_MEMORY_PROPERTY_HOST_COHERENT_BIT,
-                game_object.uniformBuffers[i], game_object.uniformBufferMemories[i]);
+                uniforms.uniformBuffers[i], uniforms.uniformBufferMemories[i]);
 
-            vkMapMemory(m_Device.device(), game_object.uniformBufferMemories[i], 0, bufferSize, 0,
-                &game_object.uniformBuffersMapped[i]);
+            vkMapMemory(m_Device.device(), uniforms.uniformBufferMemories[i], 0, bufferSize, 0,
+                &uniforms.uniformBuffersMapped[i]);
         }
     }
 }
@@ -1295,8 +1388,12 @@ void VulkanRenderer::create_descriptor_pool() {
 
 // Create descriptor sets for each MAX_FRAMES_IN_FLIGHT.
 void VulkanRenderer::create_descriptor_sets() {
-    for (auto& game_object : m_GameObjects) {
-        std::vector<VkDescriptorSetLayout> layouts(MAX_FRAMES_IN_FLIGHT, m_DescriptorSetLayout);
+    for (size_t objectIdx = 0; objectIdx < m_GameObjects.size(); objectIdx++) {
+        const GameObjectUniforms& uniforms = m_GameObjects.get<GAME_OBJECT_UNIFORMS>(objectIdx);
+        GameObjectDraw& draw = m_GameObjects.get<GAME_OBJECT_DRAW>(objectIdx);
+
+        const Core::static_vector<VkDescriptorSetLayout, MAX_FRAMES_IN_FLIGHT> layouts(
+            MAX_FRAMES_IN_FLIGHT, m_DescriptorSetLayout);
 
         // Allocate descriptor sets from the descriptor pool (m_DescriptorPool).
         // We will have MAX_FRAMES_IN_FLIGHT number of descriptor sets (a descriptor
@@ -1308,7 +1405,7 @@ void VulkanRenderer::create_descriptor_sets() {
         allocate_info.pSetLayouts = layouts.data();
 
         VULKAN_CHECK(vkAllocateDescriptorSets(
-            m_Device.device(), &allocate_info, game_object.descriptorSets.data()));
+            m_Device.device(), &allocate_info, draw.descriptorSets.data()));
 
         // Populate every descriptor for our uniform buffers
         for (int i = 0; i < MAX_FRAMES_IN_FLIGHT; i++) {
@@ -1316,21 +1413,19 @@ void VulkanRenderer::create_descriptor_sets() {
             // Offset 0 means read from the beginning of the buffer.
             // This actually gives the buffer information a descriptor set needs.
             VkDescriptorBufferInfo bufferInfo {};
-            bufferInfo.buffer = game_object.uniformBuffers[i];
+            bufferInfo.buffer = uniforms.uniformBuffers[i];
             bufferInfo.offset = 0;
             bufferInfo.range = sizeof(UniformBufferObject);
 
-            const Material& material = m_LoadedModel.materials[game_object.materialIndex];
-
             VkDescriptorImageInfo imageInfo {};
             imageInfo.imageLayout = VK_IMAGE_LAYOUT_SHADER_READ_ONLY_OPTIMAL;
-            imageInfo.imageView = material.diffuseTextureView;
+            imageInfo.imageView = mesh_texture_view(draw.mesh);
             imageInfo.sampler = m_TextureSampler;
 
             std::array<VkWriteDescriptorSet, 2> descriptorWrites {};
 
             descriptorWrites[0].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[0].dstSet = game_object.descriptorSets[i];
+            descriptorWrites[0].dstSet = draw.descriptorSets[i];
             descriptorWrites[0].dstBinding = 0;
             descriptorWrites[0].dstArrayElement = 0;
             descriptorWrites[0].descriptorType = VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER;
@@ -1338,7 +1433,7 @@ void VulkanRenderer::create_descriptor_sets() {
             descriptorWrites[0].pBufferInfo = &bufferInfo;
 
             descriptorWrites[1].sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET;
-            descriptorWrites[1].dstSet = game_object.descriptorSets[i];
+            descriptorWrites[1].dstSet = draw.descriptorSets[i];
             descriptorWrites[1].dstBinding = 1;
             descriptorWrites[1].dstArrayElement = 0;
             descriptorWrites[1].descriptorType = VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER;
@@ -1386,10 +1481,10 @@ void VulkanRenderer::create_sync_objects() {
     }
 }
 
-VkShaderModule VulkanRenderer::create_shader_module(const std::vector<char>& code) const {
+VkShaderModule VulkanRenderer::create_shader_module(std::span<const std::byte> code) const {
     VkShaderModuleCreateInfo createInfo {};
     createInfo.sType = VK_STRUCTURE_TYPE_SHADER_MODULE_CREATE_INFO;
-    createInfo.codeSize = code.size() * sizeof(char);
+    createInfo.codeSize = code.size();
     createInfo.pCode = reinterpret_cast<const U32*>(code.data());
 
     VkShaderModule shaderModule;
@@ -1427,15 +1522,120 @@ void VulkanRenderer::recreate_swapchain() {
         height = frame_height;
     }
 
-    vkDeviceWaitIdle(m_Device.device());
-
-    create_swapchain();
-    create_swapchain_image_views();
+    // no device wait: the old objects are retired and destroyed once the
+    // frames still in flight have completed
+    retire_swapchain_resources(m_Swapchain.recreate());
     create_depth_resources();
     create_framebuffers();
 }
 
+void VulkanRenderer::retire_swapchain_resources(RetiredSwapchain retired) {
+    m_DeletionQueue.retire(m_FrameNumber,
+        [device = m_Device.device(), allocator = m_Allocator,
+            framebuffers = std::move(m_SwapchainFramebuffers), depthView = m_DepthImageView,
+            depthImage = m_DepthImage, depthAllocation = m_DepthImageAllocation,
+            retired = std::move(retired)] {
+            for (VkFramebuffer framebuffer : framebuffers) {
+                vkDestroyFramebuffer(device, framebuffer, nullptr);
+            }
+            vkDestroyImageView(device, depthView, nullptr);
+            vmaDestroyImage(allocator, depthImage, depthAllocation);
+
+            for (VkImageView imageView : retired.imageViews) {
+                vkDestroyImageView(device, imageView, nullptr);
+            }
+            vkDestroySwapchainKHR(device, retired.swapchain, nullptr);
+        });
+
+    m_SwapchainFramebuffers.clear();
+    m_DepthImageView = VK_NULL_HANDLE;
+    m_DepthImage = VK_NULL_HANDLE;
+    m_DepthImageAllocation = {};
+}
+
 // Record a command buffer for image id IMAGE_IDX to be drawn
+// Picks the coarsest level of every object whose simplification error stays
+// below LOD_MAX_PIXEL_ERROR on screen, measured at the near side of the
+// bounding sphere.
+void VulkanRenderer::select_lods(const Scene::Camera& camera) {
+    const F32 fovY = glm::radians(camera.getFov());
+    const F32 height = static_cast<F32>(m_Swapchain.extent().height);
+
+    const auto transforms = m_GameObjects.column<GAME_OBJECT_TRANSFORM>();
+    const auto draws = m_GameObjects.column<GAME_OBJECT_DRAW>();
+    for (size_t i = 0; i < draws.size(); i++) {
+        GameObjectDraw& draw = draws[i];
+        const Resource::Mesh* mesh = m_ModelStore.get(draw.mesh);
+        if (!mesh) {
+            continue;
+        }
+
+        // errors are in object space and grow with the largest axis of the scale
+        const GameObjectTransform& transform = transforms[i];
+        const F32 scale = glm::max(glm::abs(transform.scale.x),
+            glm::max(glm::abs(transform.scale.y), glm::abs(transform.scale.z)));
+        const glm::vec3 center { transform.get_model_matrix()
+            * glm::vec4(mesh->bounds[0], mesh->bounds[1], mesh->bounds[2], 1.0f) };
+        const F32 distance = glm::max(
+            glm::distance(center, camera.getPosition()) - mesh->bounds[3] * scale, 0.01f);
+
+        draw.lod = Resource::select_lod({ mesh->lods.data(), mesh->lodCount },
+            scale * Resource::lod_pixels_per_unit(fovY, height, distance), draw.lod,
+            LOD_MAX_PIXEL_ERROR, LOD_HYSTERESIS);
+    }
+}
+
+// Objects at full detail draw their meshlets inside the frustum that do not
+// face away from the camera, coarser levels draw whole. The tests run in
+// object space, against the frustum of the object's own clip matrix.
+void VulkanRenderer::cull_draws(const Scene::Camera& camera) {
+    const glm::mat4 viewProjection = camera.get_view_projection_matrix(
+        m_Swapchain.extent().width, m_Swapchain.extent().height);
+
+    m_DrawRanges.clear();
+    m_DrawStats = {};
+    const auto transforms = m_GameObjects.column<GAME_OBJECT_TRANSFORM>();
+    const auto draws = m_GameObjects.column<GAME_OBJECT_DRAW>();
+    for (size_t i = 0; i < draws.size(); i++) {
+        GameObjectDraw& draw = draws[i];
+        draw.firstRange = static_cast<U32>(m_DrawRanges.size());
+        draw.rangeCount = 0;
+        const Resource::Mesh* mesh = m_ModelStore.get(draw.mesh);
+        if (!mesh) {
+            continue;
+        }
+
+        const Resource::MeshLod& lod = mesh->lods[draw.lod];
+        if (draw.lod == 0 && !mesh->meshlets.empty()) {
+            const glm::mat4 model = transforms[i].get_model_matrix();
+            const glm::mat4 clip = viewProjection * model;
+            const glm::vec3 eye { glm::inverse(model) * glm::vec4(camera.getPosition(), 1.0f) };
+            const Resource::ClusterView view = Resource::make_cluster_view(
+                std::span<const F32, 16>(glm::value_ptr(clip), 16), { eye.x, eye.y, eye.z });
+            m_DrawStats.meshlets += mesh->meshlets.size();
+            m_DrawStats.visibleMeshlets
+                += Resource::cull_meshlets(mesh->meshlets, view, m_DrawRanges);
+        } else {
+            m_DrawRanges.push_back({ lod.firstIndex, lod.indexCount });
+        }
+        draw.rangeCount = static_cast<U32>(m_DrawRanges.size()) - draw.firstRange;
+
+        for (U32 r = draw.firstRange; r < m_DrawRanges.size(); r++) {
+            m_DrawStats.triangles += m_DrawRanges[r].indexCount / 3;
+        }
+        m_DrawStats.lodTriangles += lod.indexCount / 3;
+        m_DrawStats.fullTriangles += mesh->indexCount / 3;
+    }
+
+    if (m_FrameNumber % DRAW_STATS_INTERVAL == 0 && m_DrawStats.fullTriangles > 0) {
+        CORE_LOG_INFO("[VulkanRenderer]: Drawing {} triangles, {} at the levels picked, {} at full "
+                      "detail ({:.1f}%), {} of {} meshlets",
+            m_DrawStats.triangles, m_DrawStats.lodTriangles, m_DrawStats.fullTriangles,
+            100.0 * F64(m_DrawStats.triangles) / F64(m_DrawStats.fullTriangles),
+            m_DrawStats.visibleMeshlets, m_DrawStats.meshlets);
+    }
+}
+
 void VulkanRenderer::record_draw_commands(VkCommandBuffer commandBuffer, U32 image_idx) const {
     VkCommandBufferBeginInfo beginInfo {};
     beginInfo.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO;
@@ -1467,17 +1667,9 @@ void VulkanRenderer::record_draw_commands(VkCommandBuffer commandBuffer, U32 ima
         // Begin Render Pass:
         vkCmdBeginRenderPass(commandBuffer, &renderPassBeginInfo, VK_SUBPASS_CONTENTS_INLINE);
 
-        // 1) Bind graphics pipeline
-        vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS, m_GraphicsPipeline);
-
-        // 2) Bind vertex & index buffers (shared by all objects)
-        VkBuffer vertexBuffers[] = { m_VertexBuffer };
-        VkDeviceSize offsets[] = { 0 };
+        // 1) Graphics pipelines are bound per geometry below, by its vertex layout
 
-        vkCmdBindVertexBuffers(commandBuffer, 0, 1, vertexBuffers, offsets);
-        vkCmdBindIndexBuffer(commandBuffer, m_IndexBuffer, 0, VK_INDEX_TYPE_UINT32);
-
-        // 3) Submit Viewport Details
+        // 2) Submit Viewport Details
         VkViewport viewport {};
         viewport.x = 0.0f;
         viewport.y = 0.0f;
@@ -1487,29 +1679,54 @@ void VulkanRenderer::record_draw_commands(VkCommandBuffer commandBuffer, U32 ima
         viewport.maxDepth = 1.0f;
         vkCmdSetViewport(commandBuffer, 0, 1, &viewport);
 
-        // 4) Set Scissor
+        // 3) Set Scissor
         VkRect2D scissor {};
         scissor.offset = { 0, 0 };
         scissor.extent = m_Swapchain.extent();
         vkCmdSetScissor(commandBuffer, 0, 1, &scissor);
 
-        // 5) Bind Descriptor Set
+        // 4) Bind vertex & index buffers and descriptor sets
         // NOTE: descriptor sets are not unique to graphics pipelines:
         //    - We have to specify whether we bind descriptors to graphics or compute pipeline
         // This will bind the current descriptor set for the current frame (as we have
         // MAX_FRAMES_IN_FLIGHT) amount of descriptor sets.
         // Draw each object with its own descriptor set
-        for (const auto& game_object : m_GameObjects) {
-            const Mesh& mesh = m_LoadedModel.meshes[game_object.meshIndex];
+        // Meshes of one model share their buffers, only rebind when the geometry changes.
+        Resource::Handle boundGeometry = Resource::Handle::null();
+        VertexLayout boundLayout = VERTEX_LAYOUT_COUNT;
+        for (const auto& draw : m_GameObjects.column<GAME_OBJECT_DRAW>()) {
+            const Resource::Mesh* mesh = m_ModelStore.get(draw.mesh);
+            const GpuGeometry* geometry = mesh ? m_GpuGeometry.get(mesh->geometry) : nullptr;
+            if (!geometry || draw.rangeCount == 0) {
+                continue;
+            }
+
+            if (mesh->geometry != boundGeometry) {
+                if (geometry->layout != boundLayout) {
+                    vkCmdBindPipeline(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
+                        m_GraphicsPipelines[geometry->layout]);
+                    boundLayout = geometry->layout;
+                }
+                VkBuffer vertexBuffers[] = { geometry->vertexBuffer, geometry->colorBuffer };
+                VkDeviceSize offsets[] = { 0, 0 };
+                vkCmdBindVertexBuffers(commandBuffer, 0,
+                    geometry->layout == VERTEX_LAYOUT_FULL ? 1 : 2, vertexBuffers, offsets);
+                vkCmdBindIndexBuffer(
+                    commandBuffer, geometry->indexBuffer, 0, VK_INDEX_TYPE_UINT32);
+                boundGeometry = mesh->geometry;
+            }
 
             vkCmdBindDescriptorSets(commandBuffer, VK_PIPELINE_BIND_POINT_GRAPHICS,
-                m_PipelineLayout, 0, 1, &game_object.descriptorSets[m_CurrentFrame], 0, nullptr);
+                m_PipelineLayout, 0, 1, &draw.descriptorSets[m_CurrentFrame], 0, nullptr);
 
-            // 6) Draw Indexed
-            vkCmdDrawIndexed(
-                commandBuffer, mesh.indexCount, 1, mesh.firstIndex, mesh.vertexOffsetIndex, 0);
+            // 5) Draw Indexed, every level and meshlet indexes the vertices of the full mesh
+            for (U32 r = draw.firstRange; r < draw.firstRange + draw.rangeCount; r++) {
+                const Resource::IndexRange& range = m_DrawRanges[r];
+                vkCmdDrawIndexed(
+                    commandBuffer, range.indexCount, 1, range.firstIndex, mesh->vertexOffset, 0);
+            }
         }
-        // 7) End Render Pass
+        // 6) End Render Pass
         vkCmdEndRenderPass(commandBuffer);
     }
 
@@ -1598,13 +1815,22 @@ void VulkanRenderer::update_uniform_buffer(U32 imageIdx, RenderContext context)
 
     proj[1][1] *= -1; // flip Y position for Vulkan (TODO)
 
-    for (auto& gameObject : m_GameObjects) {
-        glm::mat4 model = gameObject.get_model_matrix();
+    const auto transforms = m_GameObjects.column<GAME_OBJECT_TRANSFORM>();
+    const auto uniforms = m_GameObjects.column<GAME_OBJECT_UNIFORMS>();
+    const auto draws = m_GameObjects.column<GAME_OBJECT_DRAW>();
+    for (size_t i = 0; i < transforms.size(); i++) {
+        glm::mat4 model = transforms[i].get_model_matrix();
+        // compact positions are unorm inside the bounds of their mesh, identity for full ones
+        if (const Resource::Mesh* mesh = m_ModelStore.get(draws[i].mesh)) {
+            const Resource::VertexQuantization& q = mesh->quantization;
+            model = glm::translate(model, glm::vec3(q.offset[0], q.offset[1], q.offset[2]));
+            model = glm::scale(model, glm::vec3(q.scale[0], q.scale[1], q.scale[2]));
+        }
 
         UniformBufferObject ubo { .model = model, .view = view, .proj = proj };
 
         // Copy the UBO data to the mapped memory
-        memcpy(gameObject.uniformBuffersMapped[m_CurrentFrame], &ubo, sizeof(ubo));
+        memcpy(uniforms[i].uniformBuffersMapped[m_CurrentFrame], &ubo, sizeof(ubo));
     }
 }
 
@@ -1715,22 +1941,28 @@ void VulkanRenderer::transition_image_layout(VkImage image, VkFormat format,
     end_single_time_commands(commandBuffer);
 }
 
-void VulkanRenderer::copy_buffer_to_image(VkBuffer buffer, VkImage image, U32 width, U32 height) {
+// One region per level, tightly packed at the offsets the level table gives.
+void VulkanRenderer::copy_buffer_to_image(VkBuffer buffer, VkImage image, U32 width, U32 height,
+    std::span<const Resource::TextureLevel> levels) {
     VkCommandBuffer commandBuffer = begin_single_time_commands();
 
-    VkBufferImageCopy region {};
-    region.bufferOffset = 0;
-    region.bufferRowLength = 0;
-    region.bufferImageHeight = 0;
-    region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
-    region.imageSubresource.mipLevel = 0;
-    region.imageSubresource.baseArrayLayer = 0;
-    region.imageSubresource.layerCount = 1;
-    region.imageOffset = { 0, 0, 0 };
-    region.imageExtent = { width, height, 1 };
-
-    vkCmdCopyBufferToImage(
-        commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL, 1, &region);
+    // a full mip chain of up to 16k fits inline, no allocation per upload
+    Core::small_vector<VkBufferImageCopy, 15> regions(levels.size());
+    for (U32 level = 0; level < levels.size(); level++) {
+        VkBufferImageCopy& region = regions[level];
+        region.bufferOffset = levels[level].offset;
+        region.bufferRowLength = 0;
+        region.bufferImageHeight = 0;
+        region.imageSubresource.aspectMask = VK_IMAGE_ASPECT_COLOR_BIT;
+        region.imageSubresource.mipLevel = level;
+        region.imageSubresource.baseArrayLayer = 0;
+        region.imageSubresource.layerCount = 1;
+        region.imageOffset = { 0, 0, 0 };
+        region.imageExtent = { std::max(width >> level, 1u), std::max(height >> level, 1u), 1 };
+    }
+
+    vkCmdCopyBufferToImage(commandBuffer, buffer, image, VK_IMAGE_LAYOUT_TRANSFER_DST_OPTIMAL,
+        static_cast<U32>(regions.size()), regions.data());
 
     end_single_time_commands(commandBuffer);
 }
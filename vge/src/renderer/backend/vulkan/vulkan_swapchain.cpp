@@ -65,7 +65,16 @@ void VulkanSwapchain::destroy() {
     vkDestroySwapchainKHR(r_Device.device(), m_Swapchain, nullptr);
 }
 
-void VulkanSwapchain::create_swapchain() {
+RetiredSwapchain VulkanSwapchain::recreate() {
+    RetiredSwapchain retired { m_Swapchain, std::move(m_SwapchainImageViews) };
+    m_SwapchainImageViews.clear();
+
+    create_swapchain(retired.swapchain);
+    create_swapchain_image_views();
+    return retired;
+}
+
+void VulkanSwapchain::create_swapchain(VkSwapchainKHR oldSwapchain) {
     // NOTE: device must be created before the swapchain (as it should be) for this to return a
     // valid state
     SwapchainSupportDetails swapchainSupportDeatils = r_Device.swapchain_support_details();
@@ -112,7 +121,8 @@ void VulkanSwapchain::create_swapchain() {
     swapchainCreateInfo.compositeAlpha = VK_COMPOSITE_ALPHA_OPAQUE_BIT_KHR;
     swapchainCreateInfo.presentMode = presentMode;
     swapchainCreateInfo.clipped = VK_TRUE;
-    swapchainCreateInfo.oldSwapchain = VK_NULL_HANDLE;
+    // the old swapchain stays valid for presents already queued on it
+    swapchainCreateInfo.oldSwapchain = oldSwapchain;
 
     VULKAN_CHECK(
         vkCreateSwapchainKHR(r_Device.device(), &swapchainCreateInfo, nullptr, &m_Swapchain));
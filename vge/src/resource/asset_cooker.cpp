@@ -0,0 +1,429 @@
+#include "resource/asset_cooker.hpp"
+
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <fstream>
+#include <set>
+#include <sstream>
+#include <system_error>
+
+#include "resource/mesh_file.hpp"
+#include "resource/model_importer.hpp"
+#include "resource/pack_file.hpp"
+#include "resource/texture_cooker.hpp"
+#include "resource/texture_file.hpp"
+#include "resource/texture_store.hpp"
+#include "core/hash.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+static FileStamp file_stamp(const fs::path& path) {
+    std::error_code error;
+    const U64 size = fs::file_size(path, error);
+    if (error) {
+        return {};
+    }
+    const fs::file_time_type time = fs::last_write_time(path, error);
+    if (error) {
+        return {};
+    }
+    return { size, static_cast<I64>(time.time_since_epoch().count()) };
+}
+
+static fs::path settings_path(const fs::path& source) {
+    fs::path path = source;
+    path += AssetCooker::SettingsExtension;
+    return path;
+}
+
+static std::string_view trim(std::string_view text) {
+    const size_t first = text.find_first_not_of(" \t\r");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r") - first + 1);
+}
+
+// `key = value` lines, # starts a comment.
+static void read_settings(const fs::path& source, ResourceDescriptor& desc) {
+    desc.path = source;
+
+    std::ifstream file(settings_path(source));
+    std::string line;
+    while (std::getline(file, line)) {
+        const std::string_view content = trim(std::string_view(line).substr(0, line.find('#')));
+        if (content.empty()) {
+            continue;
+        }
+        const size_t separator = content.find('=');
+        if (separator == std::string_view::npos) {
+            CORE_LOG_WARN("[AssetCooker]: Ignoring '{}' in {}", content,
+                settings_path(source).string());
+            continue;
+        }
+        desc.metadata.insert_or_assign(std::string(trim(content.substr(0, separator))),
+            std::string(trim(content.substr(separator + 1))));
+    }
+}
+
+static bool setting_flag(const ResourceDescriptor& desc, const std::string& key, bool fallback) {
+    auto it = desc.metadata.find(key);
+    if (it == desc.metadata.end()) {
+        return fallback;
+    }
+    return it->second == "true" || it->second == "on" || it->second == "1";
+}
+
+std::optional<AssetKind> AssetCooker::asset_kind(const fs::path& path) {
+    std::string extension = path.extension().string();
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+        [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+
+    // what stb_image and assimp read
+    static constexpr std::string_view Textures[]
+        = { ".png", ".jpg", ".jpeg", ".tga", ".bmp", ".psd", ".gif", ".ppm", ".pgm" };
+    static constexpr std::string_view Models[]
+        = { ".obj", ".fbx", ".gltf", ".glb", ".dae", ".ply", ".stl", ".3ds" };
+
+    if (std::find(std::begin(Textures), std::end(Textures), extension) != std::end(Textures)) {
+        return AssetKind::Texture;
+    }
+    if (std::find(std::begin(Models), std::end(Models), extension) != std::end(Models)) {
+        return AssetKind::Model;
+    }
+    return std::nullopt;
+}
+
+fs::path AssetCooker::cooked_path(const fs::path& source, AssetKind kind) {
+    return kind == AssetKind::Texture ? cooked_texture_path(source) : cooked_mesh_path(source);
+}
+
+TextureDescriptor AssetCooker::texture_settings(const fs::path& source) {
+    TextureDescriptor desc;
+    read_settings(source, desc);
+
+    if (auto it = desc.metadata.find("color_space"); it != desc.metadata.end()) {
+        desc.format = it->second == "linear" ? TextureDescriptor::Format::RGBA8
+                                             : TextureDescriptor::Format::SRGBA8;
+    }
+    if (auto it = desc.metadata.find("usage"); it != desc.metadata.end()) {
+        desc.usage = it->second == "normal" ? TextureDescriptor::Usage::Normal
+                                            : TextureDescriptor::Usage::Color;
+    }
+    desc.generateMipmaps = setting_flag(desc, "mipmaps", desc.generateMipmaps);
+    return desc;
+}
+
+MeshDescriptor AssetCooker::mesh_settings(const fs::path& source) {
+    MeshDescriptor desc;
+    read_settings(source, desc);
+
+    desc.calculateNormals = setting_flag(desc, "calculate_normals", desc.calculateNormals);
+    desc.calculateTangents = setting_flag(desc, "calculate_tangents", desc.calculateTangents);
+    if (auto it = desc.metadata.find("scale"); it != desc.metadata.end()) {
+        const std::string& value = it->second;
+        std::from_chars(value.data(), value.data() + value.size(), desc.scale);
+    }
+    return desc;
+}
+
+U64 AssetCooker::settings_hash(const TextureDescriptor& desc) {
+    const TextureCookOptions options = cook_options(desc);
+    U64 hash = Core::hash_u64(TextureFileVersion);
+    hash = Core::hash_combine(hash, options.srgb);
+    hash = Core::hash_combine(hash, options.normalMap);
+    hash = Core::hash_combine(hash, options.compress);
+    return Core::hash_combine(hash, options.generateMipmaps);
+}
+
+// The importer does not read these yet, they are keyed so that changing them
+// re-cooks once it does.
+U64 AssetCooker::settings_hash(const MeshDescriptor& desc) {
+    U64 hash = Core::hash_u64(MeshFileVersion);
+    hash = Core::hash_combine(hash, desc.calculateNormals);
+    hash = Core::hash_combine(hash, desc.calculateTangents);
+    return Core::hash_combine(hash, std::hash<float> {}(desc.scale));
+}
+
+AssetCooker::AssetCooker(const fs::path& root)
+    : m_Root(TextureStore::normalize_path(root)) {
+    // keys are relative to the root, a trailing separator would end up in them
+    if (!m_Root.has_filename() && m_Root.has_parent_path()) {
+        m_Root = m_Root.parent_path();
+    }
+}
+
+std::string AssetCooker::key_of(const fs::path& source) const {
+    return TextureStore::normalize_path(source.lexically_relative(m_Root));
+}
+
+CookStats AssetCooker::cook(Core::JobPool& jobs, bool force) {
+    if (!load_manifest()) {
+        m_Manifest.clear(); // missing or written by another version, cook everything
+    }
+
+    std::map<std::string, AssetKind> assets;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(
+             m_Root, fs::directory_options::skip_permission_denied, error);
+        !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        if (!it->is_regular_file(error)) {
+            continue;
+        }
+        if (const std::optional<AssetKind> kind = asset_kind(it->path())) {
+            assets.try_emplace(key_of(it->path()), *kind);
+        }
+    }
+    if (error) {
+        CORE_LOG_ERROR("[AssetCooker]: Failed to walk {}: {}", m_Root.string(), error.message());
+    }
+
+    CookStats stats;
+    std::map<std::string, Entry> manifest;
+    std::set<std::string> visited;
+    bool changed = false;
+
+    // a round cooks what changed, models may bring textures from outside root for the next one
+    while (!assets.empty()) {
+        std::vector<Task> tasks;
+        for (const auto& [key, kind] : assets) {
+            stats.assets++;
+            visited.insert(key);
+            const fs::path source = m_Root / key;
+
+            auto previous = m_Manifest.find(key);
+            const FileStamp sourceStamp = file_stamp(source);
+            const FileStamp settingsStamp = file_stamp(settings_path(source));
+            if (!force && previous != m_Manifest.end() && previous->second.kind == kind
+                && previous->second.source == sourceStamp
+                && previous->second.settings == settingsStamp
+                && fs::exists(cooked_path(source, kind), error)) {
+                stats.upToDate++;
+                manifest.insert_or_assign(key, previous->second);
+                continue;
+            }
+
+            Task& task = tasks.emplace_back();
+            task.key = key;
+            task.source = source;
+            task.entry.kind = kind;
+            task.entry.source = sourceStamp;
+            task.entry.settings = settingsStamp;
+        }
+
+        Core::JobPool::JobCounter counter { 0 };
+        for (Task& task : tasks) {
+            auto previous = m_Manifest.find(task.key);
+            const Entry* entry = previous != m_Manifest.end() ? &previous->second : nullptr;
+            jobs.kickJob([this, &jobs, &task, entry, force] { run(jobs, task, m_Root, entry, force); },
+                &counter);
+        }
+        jobs.waitForCounter(&counter);
+
+        for (Task& task : tasks) {
+            if (task.failed) {
+                stats.failed++;
+                continue; // stays out of the manifest, the next run tries again
+            }
+            if (task.cook) {
+                stats.cooked++;
+                stats.meshes += task.optimized;
+                CORE_LOG_INFO("[AssetCooker]: Cooked {}", task.key);
+            } else {
+                stats.upToDate++;
+            }
+            manifest.insert_or_assign(task.key, std::move(task.entry));
+            changed = true;
+        }
+
+        std::map<std::string, AssetKind> used;
+        for (const auto& [key, entry] : manifest) {
+            for (const std::string& texture : entry.uses) {
+                if (!visited.contains(texture)) {
+                    used.try_emplace(texture, AssetKind::Texture);
+                }
+            }
+        }
+        assets = std::move(used);
+    }
+
+    // sources that were removed drop out of the manifest
+    changed = changed || manifest.size() != m_Manifest.size();
+    m_Manifest = std::move(manifest);
+    if (changed && !save_manifest()) {
+        CORE_LOG_ERROR("[AssetCooker]: Failed to write the manifest to {}", m_Root.string());
+    }
+    return stats;
+}
+
+void AssetCooker::run(
+    Core::JobPool& jobs, Task& task, const fs::path& root, const Entry* previous, bool force) {
+    const U64 settingsHash = task.entry.kind == AssetKind::Texture
+        ? settings_hash(texture_settings(task.source))
+        : settings_hash(mesh_settings(task.source));
+    const U64 sourceHash = hash_source_file(task.source);
+    if (sourceHash == 0) {
+        CORE_LOG_ERROR("[AssetCooker]: Failed to read {}", task.source.string());
+        task.failed = true;
+        return;
+    }
+    task.entry.inputHash = Core::hash_combine(sourceHash, settingsHash);
+
+    // touched but not changed: only the stamps are new
+    std::error_code error;
+    if (!force && previous && previous->kind == task.entry.kind
+        && previous->inputHash == task.entry.inputHash
+        && fs::exists(cooked_path(task.source, task.entry.kind), error)) {
+        task.entry.uses = previous->uses;
+        return;
+    }
+
+    task.cook = true;
+    if (task.entry.kind == AssetKind::Texture) {
+        const TextureDescriptor desc = texture_settings(task.source);
+        const TextureCookOptions options = cook_options(desc);
+        CookedTexture cooked;
+        if (!cook_texture_file(task.source, options, cooked)) {
+            CORE_LOG_ERROR("[AssetCooker]: Failed to decode {}", task.source.string());
+            task.failed = true;
+            return;
+        }
+        const U32 flags = (options.srgb ? TextureFileSrgb : 0u)
+            | (options.normalMap ? TextureFileNormalMap : 0u);
+        task.failed = !write_texture_file(
+            cooked_texture_path(task.source), cooked.image(), flags, sourceHash);
+        return;
+    }
+
+    ModelData data;
+    if (!import_model(task.source, data, &jobs)) {
+        task.failed = true;
+        return;
+    }
+    const CookedModel cooked = cook_model(data, &jobs);
+    task.optimized = cooked.stats;
+    if (!write_mesh_file(
+            cooked_mesh_path(task.source), data.materials, cooked.geometry.view(), sourceHash)) {
+        task.failed = true;
+        return;
+    }
+
+    // the textures a model uses, keyed relative to the root like every other asset
+    std::set<std::string> uses;
+    for (const MaterialData& material : data.materials) {
+        if (!material.diffusePath.empty()) {
+            const fs::path texture = TextureStore::normalize_path(material.diffusePath);
+            uses.insert(TextureStore::normalize_path(texture.lexically_relative(root)));
+        }
+    }
+    task.entry.uses.assign(uses.begin(), uses.end());
+}
+
+bool AssetCooker::pack(const fs::path& output) const {
+    std::vector<PackSource> files;
+    std::error_code error;
+    for (auto it = fs::recursive_directory_iterator(
+             m_Root, fs::directory_options::skip_permission_denied, error);
+        !error && it != fs::recursive_directory_iterator(); it.increment(error)) {
+        const fs::path& path = it->path();
+        if (!it->is_regular_file(error) || path.filename() == ManifestName
+            || path.extension() == SettingsExtension || path.extension() == ".vgepak"
+            || path.extension() == ".tmp") {
+            continue;
+        }
+        // the cooked file stands in for its source, the stores load it without one
+        const std::optional<AssetKind> kind = asset_kind(path);
+        if (kind && fs::exists(cooked_path(path, *kind), error)) {
+            continue;
+        }
+        files.push_back({ key_of(path), path });
+    }
+    if (error) {
+        CORE_LOG_ERROR("[AssetCooker]: Failed to walk {}: {}", m_Root.string(), error.message());
+        return false;
+    }
+
+    if (!write_pack_file(output, files)) {
+        return false;
+    }
+    CORE_LOG_INFO("[AssetCooker]: Packed {} files into {}", files.size(), output.string());
+    return true;
+}
+
+std::vector<std::string> AssetCooker::dependencies(std::string_view path) const {
+    auto it = m_Manifest.find(std::string(path));
+    return it != m_Manifest.end() ? it->second.uses : std::vector<std::string> {};
+}
+
+// vge_cook <manifest> <texture format> <mesh format>
+// <kind> <input hash> <source size> <source time> <settings size> <settings time> <path>
+// > <path of a used texture>
+bool AssetCooker::load_manifest() {
+    m_Manifest.clear();
+
+    std::ifstream file(m_Root / ManifestName);
+    std::string line;
+    if (!std::getline(file, line)) {
+        return false;
+    }
+    std::ostringstream expected;
+    expected << "vge_cook " << ManifestVersion << ' ' << TextureFileVersion << ' ' << MeshFileVersion;
+    if (line != expected.str()) {
+        return false;
+    }
+
+    Entry* current = nullptr;
+    while (std::getline(file, line)) {
+        if (line.starts_with("> ")) {
+            if (!current) {
+                return false;
+            }
+            current->uses.push_back(line.substr(2));
+            continue;
+        }
+
+        std::istringstream fields(line);
+        U32 kind;
+        Entry entry;
+        std::string path;
+        fields >> kind >> std::hex >> entry.inputHash >> std::dec >> entry.source.size
+            >> entry.source.time >> entry.settings.size >> entry.settings.time;
+        if (!fields || kind > static_cast<U32>(AssetKind::Model)) {
+            return false;
+        }
+        std::getline(fields >> std::ws, path);
+        entry.kind = static_cast<AssetKind>(kind);
+        current = &m_Manifest.insert_or_assign(std::move(path), std::move(entry)).first->second;
+    }
+    return true;
+}
+
+bool AssetCooker::save_manifest() const {
+    const fs::path path = m_Root / ManifestName;
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::trunc);
+        file << "vge_cook " << ManifestVersion << ' ' << TextureFileVersion << ' '
+             << MeshFileVersion << '\n';
+        for (const auto& [key, entry] : m_Manifest) {
+            file << static_cast<U32>(entry.kind) << ' ' << std::hex << entry.inputHash << std::dec
+                 << ' ' << entry.source.size << ' ' << entry.source.time << ' '
+                 << entry.settings.size << ' ' << entry.settings.time << ' ' << key << '\n';
+            for (const std::string& texture : entry.uses) {
+                file << "> " << texture << '\n';
+            }
+        }
+        if (!file) {
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    return !error;
+}
+
+} // namespace Resource
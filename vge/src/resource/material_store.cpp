@@ -0,0 +1,99 @@
+#include "resource/material_store.hpp"
+
+#include "resource/model_data.hpp"
+#include "resource/texture_store.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+MaterialStore::MaterialStore(TextureStore& textures)
+    : r_Textures(textures) { }
+
+MaterialStore::~MaterialStore() {
+    if (m_Materials.size() > 0) {
+        CORE_LOG_WARN("[MaterialStore]: {} materials are still referenced", m_Materials.size());
+    }
+    set_default_texture({});
+}
+
+void MaterialStore::set_default_texture(TextureHandle texture) {
+    if (m_DefaultTexture) {
+        r_Textures.release(m_DefaultTexture);
+    }
+    m_DefaultTexture = texture;
+}
+
+MaterialHandle MaterialStore::create(
+    std::string name, const std::string& diffusePath, Core::JobPool* jobs) {
+    TextureHandle diffuse;
+    if (!diffusePath.empty()) {
+        diffuse = jobs ? r_Textures.acquire_async(*jobs, diffusePath)
+                       : r_Textures.acquire(diffusePath);
+        if (!diffuse) {
+            CORE_LOG_WARN("[MaterialStore]: Material {} falls back to the default texture", name);
+        }
+    }
+    return insert(std::move(name), diffuse);
+}
+
+void MaterialStore::create_all(
+    Core::JobPool& jobs, std::span<const MaterialData> materials, std::vector<MaterialHandle>& out) {
+    std::vector<std::string> paths;
+    std::vector<size_t> textured;
+    for (size_t i = 0; i < materials.size(); ++i) {
+        if (!materials[i].diffusePath.empty()) {
+            paths.push_back(materials[i].diffusePath);
+            textured.push_back(i);
+        }
+    }
+
+    std::vector<TextureHandle> textures(paths.size());
+    r_Textures.acquire_all(jobs, paths, textures);
+
+    out.reserve(out.size() + materials.size());
+    for (size_t i = 0, next = 0; i < materials.size(); ++i) {
+        TextureHandle diffuse;
+        if (next < textured.size() && textured[next] == i) {
+            diffuse = textures[next++];
+            if (!diffuse) {
+                CORE_LOG_WARN(
+                    "[MaterialStore]: Material {} falls back to the default texture", materials[i].name);
+            }
+        }
+        out.push_back(insert(materials[i].name, diffuse));
+    }
+}
+
+MaterialHandle MaterialStore::insert(std::string name, TextureHandle diffuse) {
+    if (!diffuse && m_DefaultTexture) {
+        r_Textures.add_ref(m_DefaultTexture);
+        diffuse = m_DefaultTexture;
+    }
+
+    return MaterialHandle { m_Materials.insert(Material { std::move(name), diffuse, 1 }) };
+}
+
+void MaterialStore::add_ref(MaterialHandle h) {
+    Material* material = m_Materials.get(h.handle());
+    if (!material) {
+        CORE_LOG_WARN("[MaterialStore]: Handle is invalid or outdated.");
+        return;
+    }
+    material->refCount++;
+}
+
+void MaterialStore::release(MaterialHandle h) {
+    Material* material = m_Materials.get(h.handle());
+    if (!material) {
+        CORE_LOG_WARN("[MaterialStore]: Handle is invalid or outdated.");
+        return;
+    }
+    if (--material->refCount == 0) {
+        if (material->diffuseTexture) {
+            r_Textures.release(material->diffuseTexture);
+        }
+        m_Materials.free(h.handle());
+    }
+}
+
+} // namespace Resource
@@ -0,0 +1,241 @@
+#include "resource/mesh_file.hpp"
+
+#include <bit>
+#include <fstream>
+#include <string>
+#include <system_error>
+
+#include "resource/mesh_lod.hpp"
+#include "resource/meshlet.hpp"
+#include "core/hash.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+static_assert(std::endian::native == std::endian::little, ".vgemesh files are little endian");
+
+static U64 align_up(U64 offset) {
+    return (offset + MeshFileAlignment - 1) & ~(MeshFileAlignment - 1);
+}
+
+// A section of count Ts at offset lies inside the file and is aligned for T.
+template <typename T> static bool section_fits(U64 offset, U64 count, U64 fileSize) {
+    if (offset % alignof(T) != 0 || offset > fileSize) {
+        return false;
+    }
+    return count <= (fileSize - offset) / sizeof(T);
+}
+
+fs::path cooked_mesh_path(const fs::path& source) {
+    fs::path cooked = source;
+    cooked += ".vgemesh";
+    return cooked;
+}
+
+U64 hash_source_file(const fs::path& source) {
+    Platform::MappedFile file;
+    if (!file.open(source)) {
+        return 0;
+    }
+    return Core::hash_bytes(file.data(), file.size());
+}
+
+bool write_mesh_file(const fs::path& path, std::span<const MaterialData> materials,
+    const GeometryView& geometry, U64 sourceHash) {
+    const fs::path directory = path.parent_path();
+
+    // texture paths relative to the cooked file, so the asset folder can move
+    std::string strings;
+    std::vector<MeshFileMaterial> table;
+    table.reserve(materials.size());
+    for (const MaterialData& material : materials) {
+        std::string diffuse = material.diffusePath;
+        if (!diffuse.empty()) {
+            const fs::path relative = fs::path(diffuse).lexically_relative(directory);
+            if (!relative.empty()) {
+                diffuse = relative.generic_string();
+            }
+        }
+
+        MeshFileMaterial& entry = table.emplace_back();
+        entry.nameOffset = static_cast<U32>(strings.size());
+        entry.nameSize = static_cast<U32>(material.name.size());
+        strings += material.name;
+        entry.diffuseOffset = static_cast<U32>(strings.size());
+        entry.diffuseSize = static_cast<U32>(diffuse.size());
+        strings += diffuse;
+    }
+
+    MeshFileHeader header;
+    header.sourceHash = sourceHash;
+    header.meshCount = static_cast<U32>(geometry.meshes.size());
+    header.materialCount = static_cast<U32>(table.size());
+    header.meshesOffset = align_up(sizeof(MeshFileHeader));
+    header.lodsOffset = align_up(header.meshesOffset + geometry.meshes.size_bytes());
+    header.lodCount = geometry.lods.size();
+    header.meshletsOffset = align_up(header.lodsOffset + geometry.lods.size_bytes());
+    header.meshletCount = geometry.meshlets.size();
+    header.materialsOffset = align_up(header.meshletsOffset + geometry.meshlets.size_bytes());
+    header.stringsOffset = align_up(header.materialsOffset + table.size() * sizeof(MeshFileMaterial));
+    header.stringsSize = strings.size();
+    header.verticesOffset = align_up(header.stringsOffset + strings.size());
+    header.vertexCount = geometry.vertices.size();
+    header.indicesOffset = align_up(header.verticesOffset + geometry.vertices.size_bytes());
+    header.indexCount = geometry.indices.size();
+
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            CORE_LOG_ERROR("[MeshFile]: Failed to create {}", temporary.string());
+            return false;
+        }
+
+        U64 written = 0;
+        auto write_at = [&](U64 offset, const void* bytes, U64 size) {
+            for (; written < offset; written++) {
+                file.put('\0');
+            }
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            written += size;
+        };
+
+        write_at(0, &header, sizeof(header));
+        write_at(header.meshesOffset, geometry.meshes.data(), geometry.meshes.size_bytes());
+        write_at(header.lodsOffset, geometry.lods.data(), geometry.lods.size_bytes());
+        write_at(header.meshletsOffset, geometry.meshlets.data(), geometry.meshlets.size_bytes());
+        write_at(header.materialsOffset, table.data(), table.size() * sizeof(MeshFileMaterial));
+        write_at(header.stringsOffset, strings.data(), strings.size());
+        write_at(header.verticesOffset, geometry.vertices.data(), geometry.vertices.size_bytes());
+        write_at(header.indicesOffset, geometry.indices.data(), geometry.indices.size_bytes());
+
+        if (!file) {
+            CORE_LOG_ERROR("[MeshFile]: Failed to write {}", temporary.string());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        CORE_LOG_ERROR("[MeshFile]: Failed to write {}: {}", path.string(), error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+CookedModel cook_model(ModelData& data, Core::JobPool* jobs) {
+    CookedModel cooked;
+    cooked.stats = optimize_meshes(data.meshes, jobs);
+    generate_lods(data.meshes, jobs);
+    build_meshlets(data.meshes, jobs);
+    // the meshlets reorder the triangles once more, measure what is drawn
+    cooked.stats.after = {};
+    for (const MeshData& mesh : data.meshes) {
+        cooked.stats.after += analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+    }
+    cooked.geometry = pack_meshes(data.meshes, jobs);
+    return cooked;
+}
+
+bool MeshFile::open(const fs::path& path) {
+    return open(VfsFile::map(path), path.parent_path());
+}
+
+bool MeshFile::open(VfsFile file, const fs::path& directory) {
+    m_File = std::move(file);
+    if (!m_File.is_open()) {
+        return false;
+    }
+
+    const U64 size = m_File.size();
+    const bool valid = [&] {
+        if (size < sizeof(MeshFileHeader)) {
+            return false;
+        }
+        const MeshFileHeader& h = header();
+        if (h.magic != MeshFileMagic || h.version != MeshFileVersion) {
+            return false;
+        }
+        if (!section_fits<MeshRange>(h.meshesOffset, h.meshCount, size)
+            || !section_fits<MeshLod>(h.lodsOffset, h.lodCount, size)
+            || !section_fits<Meshlet>(h.meshletsOffset, h.meshletCount, size)
+            || !section_fits<MeshFileMaterial>(h.materialsOffset, h.materialCount, size)
+            || !section_fits<char>(h.stringsOffset, h.stringsSize, size)
+            || !section_fits<MeshVertex>(h.verticesOffset, h.vertexCount, size)
+            || !section_fits<U32>(h.indicesOffset, h.indexCount, size)) {
+            return false;
+        }
+
+        // ranges and strings are read without further checks
+        for (const MeshRange& range : std::span(section<MeshRange>(h.meshesOffset), h.meshCount)) {
+            if (U64(range.firstIndex) + range.indexCount > h.indexCount || range.vertexOffset < 0
+                || U64(range.vertexOffset) + range.vertexCount > h.vertexCount
+                || U64(range.firstLod) + range.lodCount > h.lodCount
+                || U64(range.firstMeshlet) + range.meshletCount > h.meshletCount) {
+                return false;
+            }
+        }
+        for (const MeshLod& lod : std::span(section<MeshLod>(h.lodsOffset), h.lodCount)) {
+            if (U64(lod.firstIndex) + lod.indexCount > h.indexCount) {
+                return false;
+            }
+        }
+        const std::span meshlets(section<Meshlet>(h.meshletsOffset), h.meshletCount);
+        for (const Meshlet& meshlet : meshlets) {
+            if (U64(meshlet.firstIndex) + meshlet.indexCount > h.indexCount) {
+                return false;
+            }
+        }
+        for (const MeshFileMaterial& material :
+            std::span(section<MeshFileMaterial>(h.materialsOffset), h.materialCount)) {
+            if (U64(material.nameOffset) + material.nameSize > h.stringsSize
+                || U64(material.diffuseOffset) + material.diffuseSize > h.stringsSize) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    if (!valid) {
+        m_File.close();
+        return false;
+    }
+
+    m_Directory = directory;
+    return true;
+}
+
+GeometryView MeshFile::geometry() const {
+    const MeshFileHeader& h = header();
+    return { { section<MeshVertex>(h.verticesOffset), h.vertexCount },
+        { section<U32>(h.indicesOffset), h.indexCount },
+        { section<MeshRange>(h.meshesOffset), h.meshCount },
+        { section<MeshLod>(h.lodsOffset), h.lodCount },
+        { section<Meshlet>(h.meshletsOffset), h.meshletCount } };
+}
+
+std::vector<MaterialData> MeshFile::materials() const {
+    const MeshFileHeader& h = header();
+    const char* strings = section<char>(h.stringsOffset);
+
+    std::vector<MaterialData> materials;
+    materials.reserve(h.materialCount);
+    for (const MeshFileMaterial& entry :
+        std::span(section<MeshFileMaterial>(h.materialsOffset), h.materialCount)) {
+        MaterialData& material = materials.emplace_back();
+        material.name.assign(strings + entry.nameOffset, entry.nameSize);
+
+        const std::string_view diffuse(strings + entry.diffuseOffset, entry.diffuseSize);
+        if (!diffuse.empty()) {
+            const fs::path stored(diffuse);
+            material.diffusePath
+                = stored.is_absolute() ? stored.generic_string() : (m_Directory / stored).generic_string();
+        }
+    }
+    return materials;
+}
+
+} // namespace Resource
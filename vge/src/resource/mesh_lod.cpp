@@ -0,0 +1,329 @@
+#include "resource/mesh_lod.hpp"
+
+#include <algorithm>
+#include <numeric>
+
+#include "core/concurrency/job_system.hpp"
+#include "resource/mesh_optimizer.hpp"
+#include "resource/vec3_math.hpp"
+
+namespace Resource {
+
+namespace {
+
+// Sum of squared distances to a set of planes, weighted by the area of the
+// triangles they came from: x'Ax + 2b'x + c.
+struct Quadric {
+    F64 a00 = 0, a01 = 0, a02 = 0, a11 = 0, a12 = 0, a22 = 0;
+    F64 b0 = 0, b1 = 0, b2 = 0;
+    F64 c = 0;
+    F64 weight = 0;
+
+    // n has to be unit length, d = -n.p for a point p on the plane.
+    void add_plane(const Vec3& n, F64 d, F64 w) {
+        a00 += w * n[0] * n[0];
+        a01 += w * n[0] * n[1];
+        a02 += w * n[0] * n[2];
+        a11 += w * n[1] * n[1];
+        a12 += w * n[1] * n[2];
+        a22 += w * n[2] * n[2];
+        b0 += w * n[0] * d;
+        b1 += w * n[1] * d;
+        b2 += w * n[2] * d;
+        c += w * d * d;
+        weight += w;
+    }
+
+    Quadric& operator+=(const Quadric& q) {
+        a00 += q.a00, a01 += q.a01, a02 += q.a02, a11 += q.a11, a12 += q.a12, a22 += q.a22;
+        b0 += q.b0, b1 += q.b1, b2 += q.b2;
+        c += q.c;
+        weight += q.weight;
+        return *this;
+    }
+
+    // Mean squared distance of p to the planes.
+    F64 error(const Vec3& p) const {
+        if (weight <= 0.0) {
+            return 0.0;
+        }
+        const F64 x = p[0], y = p[1], z = p[2];
+        const F64 q = a00 * x * x + a11 * y * y + a22 * z * z
+            + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+            + 2.0 * (b0 * x + b1 * y + b2 * z) + c;
+        return std::max(q, 0.0) / weight;
+    }
+};
+
+Quadric operator+(Quadric a, const Quadric& b) { return a += b; }
+
+struct Collapse {
+    U32 from;
+    U32 to;
+    F64 error; // squared
+};
+
+} // namespace
+
+std::vector<U32> simplify_mesh(std::span<const MeshVertex> vertices, std::span<const U32> indices,
+    size_t targetIndexCount, F32 maxError, F32* error) {
+    std::vector<U32> result(indices.begin(), indices.end());
+    if (error) {
+        *error = 0.0f;
+    }
+    if (result.size() <= targetIndexCount || result.size() % 3 != 0) {
+        return result;
+    }
+    const size_t vertexCount = vertices.size();
+
+    // vertices at one position are one corner of the surface, the first of
+    // them stands for the rest
+    std::vector<U32> order(vertexCount);
+    std::iota(order.begin(), order.end(), 0u);
+    std::sort(order.begin(), order.end(), [&](U32 a, U32 b) {
+        return vertices[a].position != vertices[b].position
+            ? vertices[a].position < vertices[b].position
+            : a < b;
+    });
+    std::vector<U32> corner(vertexCount);
+    std::vector<U32> cornerSize(vertexCount, 0);
+    for (size_t i = 0; i < vertexCount; ++i) {
+        const bool same = i > 0 && vertices[order[i]].position == vertices[order[i - 1]].position;
+        corner[order[i]] = same ? corner[order[i - 1]] : order[i];
+        cornerSize[corner[order[i]]]++;
+    }
+
+    // an edge not shared by exactly two triangles is a border or non-manifold
+    std::vector<std::pair<U32, U32>> edges;
+    edges.reserve(result.size());
+    for (size_t i = 0; i < result.size(); i += 3) {
+        for (U32 k = 0; k < 3; ++k) {
+            const U32 a = corner[result[i + k]];
+            const U32 b = corner[result[i + (k + 1) % 3]];
+            edges.emplace_back(std::min(a, b), std::max(a, b));
+        }
+    }
+    std::sort(edges.begin(), edges.end());
+    std::vector<bool> locked(vertexCount, false);
+    for (size_t i = 0; i < edges.size();) {
+        size_t j = i + 1;
+        while (j < edges.size() && edges[j] == edges[i]) {
+            ++j;
+        }
+        if (j - i != 2) {
+            locked[edges[i].first] = true;
+            locked[edges[i].second] = true;
+        }
+        i = j;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        locked[v] = locked[v] || cornerSize[corner[v]] > 1;
+    }
+
+    std::vector<Quadric> quadrics(vertexCount);
+    for (size_t i = 0; i < result.size(); i += 3) {
+        const Vec3& p0 = vertices[result[i]].position;
+        const Vec3 n = cross(
+            vertices[result[i + 1]].position - p0, vertices[result[i + 2]].position - p0);
+        const F32 length = std::sqrt(dot(n, n));
+        if (length <= 0.0f) {
+            continue;
+        }
+        const Vec3 unit { n[0] / length, n[1] / length, n[2] / length };
+        for (U32 k = 0; k < 3; ++k) {
+            quadrics[corner[result[i + k]]].add_plane(unit, -dot(unit, p0), length * 0.5f);
+        }
+    }
+
+    auto normal = [&](U32 a, U32 b, U32 c) {
+        const Vec3& p = vertices[a].position;
+        return cross(vertices[b].position - p, vertices[c].position - p);
+    };
+
+    const F64 maxErrorSq = F64(maxError) * F64(maxError);
+    F64 worst = 0.0;
+    std::vector<U32> collapse(vertexCount);
+    std::iota(collapse.begin(), collapse.end(), 0u);
+    std::vector<Collapse> collapses;
+    std::vector<U32> first(vertexCount + 1);
+    std::vector<U32> adjacency;
+    std::vector<bool> touched(vertexCount);
+
+    // every pass collapses the cheapest edges whose neighbourhoods do not
+    // overlap, so the costs of a pass stay valid until it ends
+    while (result.size() > targetIndexCount) {
+        const size_t triangleCount = result.size() / 3;
+
+        // only a vertex of its own can move, and only onto a vertex of its own:
+        // moving onto a seam would stretch the texture across it
+        collapses.clear();
+        for (size_t i = 0; i < result.size(); i += 3) {
+            for (U32 k = 0; k < 3; ++k) {
+                const U32 a = result[i + k];
+                const U32 b = result[i + (k + 1) % 3];
+                const bool ab = !locked[a] && cornerSize[corner[b]] == 1;
+                const bool ba = !locked[b] && cornerSize[corner[a]] == 1;
+                const Quadric q = quadrics[corner[a]] + quadrics[corner[b]];
+                const F64 toB = ab ? q.error(vertices[b].position) : INFINITY;
+                const F64 toA = ba ? q.error(vertices[a].position) : INFINITY;
+                if (ab && toB <= toA) {
+                    collapses.push_back({ a, b, toB });
+                } else if (ba) {
+                    collapses.push_back({ b, a, toA });
+                }
+            }
+        }
+        std::sort(collapses.begin(), collapses.end(),
+            [](const Collapse& a, const Collapse& b) { return a.error < b.error; });
+
+        std::fill(first.begin(), first.end(), 0u);
+        for (U32 v : result) {
+            first[v + 1]++;
+        }
+        for (size_t v = 0; v < vertexCount; ++v) {
+            first[v + 1] += first[v];
+        }
+        adjacency.resize(result.size());
+        std::vector<U32> filled(first.begin(), first.end() - 1);
+        for (size_t i = 0; i < result.size(); ++i) {
+            adjacency[filled[result[i]]++] = static_cast<U32>(i / 3);
+        }
+
+        std::fill(touched.begin(), touched.end(), false);
+        const size_t removable = triangleCount - targetIndexCount / 3;
+        size_t removed = 0;
+        for (const Collapse& c : collapses) {
+            if (removed >= removable) {
+                break;
+            }
+            if (c.error > maxErrorSq) {
+                break;
+            }
+            if (touched[c.from] || touched[c.to]) {
+                continue;
+            }
+
+            // the triangles that keep their area must not turn over
+            size_t shared = 0;
+            bool flips = false;
+            for (U32 a = first[c.from]; a < first[c.from + 1] && !flips; ++a) {
+                const U32* t = &result[adjacency[a] * 3];
+                if (t[0] == c.to || t[1] == c.to || t[2] == c.to) {
+                    shared++;
+                    continue;
+                }
+                const Vec3 before = normal(t[0], t[1], t[2]);
+                const Vec3 after = normal(t[0] == c.from ? c.to : t[0],
+                    t[1] == c.from ? c.to : t[1], t[2] == c.from ? c.to : t[2]);
+                flips = dot(before, after) <= 0.0f;
+            }
+            if (flips) {
+                continue;
+            }
+
+            collapse[c.from] = c.to;
+            quadrics[c.to] += quadrics[c.from];
+            for (U32 a = first[c.from]; a < first[c.from + 1]; ++a) {
+                const U32* t = &result[adjacency[a] * 3];
+                touched[corner[t[0]]] = touched[corner[t[1]]] = touched[corner[t[2]]] = true;
+                touched[t[0]] = touched[t[1]] = touched[t[2]] = true;
+            }
+            removed += shared;
+            worst = std::max(worst, c.error);
+        }
+        if (removed == 0) {
+            break;
+        }
+
+        size_t kept = 0;
+        for (size_t i = 0; i < result.size(); i += 3) {
+            const U32 a = collapse[result[i]];
+            const U32 b = collapse[result[i + 1]];
+            const U32 c = collapse[result[i + 2]];
+            if (a != b && b != c && c != a) {
+                result[kept++] = a;
+                result[kept++] = b;
+                result[kept++] = c;
+            }
+        }
+        result.resize(kept);
+        std::iota(collapse.begin(), collapse.end(), 0u);
+    }
+
+    if (error) {
+        *error = static_cast<F32>(std::sqrt(worst));
+    }
+    return result;
+}
+
+void generate_lods(MeshData& mesh) {
+    mesh.lods.clear();
+    if (mesh.indices.size() % 3 != 0 || mesh.vertices.empty()) {
+        return;
+    }
+
+    Vec3 min = mesh.vertices[0].position;
+    Vec3 max = min;
+    for (const MeshVertex& vertex : mesh.vertices) {
+        for (U32 k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], vertex.position[k]);
+            max[k] = std::max(max[k], vertex.position[k]);
+        }
+    }
+    const Vec3 extent = max - min;
+    const F32 maxError = LodMaxRelativeError * 0.5f * std::sqrt(dot(extent, extent));
+
+    // the levels point into each other, they must not move
+    mesh.lods.reserve(MaxMeshLods - 1);
+    std::span<const U32> previous = mesh.indices;
+    F32 previousError = 0.0f;
+    while (mesh.lods.size() + 1 < MaxMeshLods) {
+        const size_t target = previous.size() / 6 * 3;
+        if (target < LodMinTriangles * 3) {
+            break;
+        }
+        F32 error = 0.0f;
+        std::vector<U32> indices = simplify_mesh(mesh.vertices, previous, target, maxError, &error);
+        if (F32(indices.size()) > LodMinReduction * F32(previous.size())) {
+            break;
+        }
+        optimize_vertex_cache(indices, mesh.vertices.size());
+
+        // errors of the steps add up at most
+        previousError += error;
+        mesh.lods.push_back({ std::move(indices), previousError });
+        previous = mesh.lods.back().indices;
+    }
+}
+
+void generate_lods(std::span<MeshData> meshes, Core::JobPool* jobs) {
+    if (jobs && meshes.size() > 1) {
+        Core::JobPool::JobCounter counter { 0 };
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            jobs->kickJob([&, i] { generate_lods(meshes[i]); }, &counter);
+        }
+        jobs->waitForCounter(&counter);
+    } else {
+        for (MeshData& mesh : meshes) {
+            generate_lods(mesh);
+        }
+    }
+}
+
+U32 select_lod(std::span<const MeshLod> lods, F32 pixelsPerUnit, U32 current, F32 maxPixels,
+    F32 hysteresis) {
+    if (lods.empty()) {
+        return 0;
+    }
+    U32 lod = std::min<U32>(current, static_cast<U32>(lods.size() - 1));
+    while (lod > 0 && lods[lod].error * pixelsPerUnit > maxPixels) {
+        lod--;
+    }
+    while (lod + 1 < lods.size()
+        && lods[lod + 1].error * pixelsPerUnit <= maxPixels * (1.0f - hysteresis)) {
+        lod++;
+    }
+    return lod;
+}
+
+} // namespace Resource
@@ -0,0 +1,340 @@
+#include "resource/mesh_optimizer.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+
+#include "resource/vec3_math.hpp"
+#include "core/concurrency/job_system.hpp"
+#include "core/hash.hpp"
+
+namespace Resource {
+
+namespace {
+
+// FIFO cache as timestamps: a vertex is cached while fewer than size misses
+// happened since it was loaded. Stepping time by more than size empties it.
+class VertexCache {
+public:
+    VertexCache(size_t vertexCount, U32 size)
+        : m_LoadedAt(vertexCount, 0)
+        , m_Size(size)
+        , m_Time(size + 1) { }
+
+    // Returns whether v missed, and loads it.
+    bool touch(U32 v) {
+        if (m_Time - m_LoadedAt[v] <= m_Size) {
+            return false;
+        }
+        m_LoadedAt[v] = m_Time++;
+        return true;
+    }
+
+    // How many misses ago v was loaded.
+    U32 age(U32 v) const { return m_Time - m_LoadedAt[v]; }
+
+    void flush() { m_Time += m_Size + 1; }
+
+private:
+    std::vector<U32> m_LoadedAt;
+    U32 m_Size;
+    U32 m_Time;
+};
+
+} // namespace
+
+VertexCacheStats analyze_vertex_cache(std::span<const U32> indices, size_t vertexCount, U32 cacheSize) {
+    VertexCacheStats stats;
+    stats.triangles = indices.size() / 3;
+
+    VertexCache cache(vertexCount, cacheSize);
+    std::vector<bool> used(vertexCount, false);
+    for (U32 v : indices) {
+        stats.transforms += cache.touch(v);
+        if (!used[v]) {
+            used[v] = true;
+            stats.vertices++;
+        }
+    }
+    return stats;
+}
+
+void deduplicate_vertices(MeshData& mesh) {
+    constexpr U32 Empty = ~0u;
+
+    // open addressing, at most half full
+    size_t capacity = 1;
+    while (capacity < mesh.vertices.size() * 2) {
+        capacity <<= 1;
+    }
+    std::vector<U32> table(capacity, Empty);
+
+    std::vector<MeshVertex> unique;
+    unique.reserve(mesh.vertices.size());
+    std::vector<U32> remap(mesh.vertices.size());
+    for (size_t i = 0; i < mesh.vertices.size(); ++i) {
+        const MeshVertex& vertex = mesh.vertices[i];
+        size_t slot = Core::hash_bytes(&vertex, sizeof(MeshVertex)) & (capacity - 1);
+        while (table[slot] != Empty
+            && std::memcmp(&unique[table[slot]], &vertex, sizeof(MeshVertex)) != 0) {
+            slot = (slot + 1) & (capacity - 1);
+        }
+        if (table[slot] == Empty) {
+            table[slot] = static_cast<U32>(unique.size());
+            unique.push_back(vertex);
+        }
+        remap[i] = table[slot];
+    }
+
+    for (U32& index : mesh.indices) {
+        index = remap[index];
+    }
+    mesh.vertices = std::move(unique);
+}
+
+std::vector<U32> optimize_vertex_cache(std::span<U32> indices, size_t vertexCount, U32 cacheSize) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return {};
+    }
+
+    // the triangles around every vertex, and how many of them are not emitted yet
+    std::vector<U32> first(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        first[indices[i] + 1]++;
+    }
+    std::vector<U32> live(first.begin() + 1, first.end());
+    for (size_t v = 0; v < vertexCount; ++v) {
+        first[v + 1] += first[v];
+    }
+    std::vector<U32> adjacency(triangleCount * 3);
+    std::vector<U32> filled(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacency[filled[indices[i]]++] = static_cast<U32>(i / 3);
+    }
+
+    VertexCache cache(vertexCount, cacheSize);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<U32> deadEnd; // vertices of emitted triangles, most recent on top
+    std::vector<U32> candidates;
+    std::vector<U32> output;
+    output.reserve(triangleCount * 3);
+    std::vector<U32> clusters { 0 };
+    size_t cursor = 0;
+
+    I64 fanning = indices[0];
+    while (fanning >= 0) {
+        // emit every triangle left around the fanning vertex
+        candidates.clear();
+        for (U32 a = first[fanning]; a < first[fanning + 1]; ++a) {
+            const U32 t = adjacency[a];
+            if (emitted[t]) {
+                continue;
+            }
+            emitted[t] = true;
+            for (U32 k = 0; k < 3; ++k) {
+                const U32 v = indices[t * 3 + k];
+                output.push_back(v);
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                live[v]--;
+                cache.touch(v);
+            }
+        }
+
+        // fan around the oldest candidate that is still cached once its triangles are emitted
+        fanning = -1;
+        I64 bestPriority = -1;
+        for (U32 v : candidates) {
+            if (live[v] == 0) {
+                continue;
+            }
+            const I64 priority = cache.age(v) + 2 * live[v] <= cacheSize ? cache.age(v) : 0;
+            if (priority > bestPriority) {
+                fanning = v;
+                bestPriority = priority;
+            }
+        }
+        if (fanning >= 0) {
+            continue;
+        }
+
+        // dead end: a recently used vertex with triangles left, else the next one in input order
+        while (fanning < 0 && !deadEnd.empty()) {
+            const U32 v = deadEnd.back();
+            deadEnd.pop_back();
+            if (live[v] > 0) {
+                fanning = v;
+            }
+        }
+        for (; fanning < 0 && cursor < vertexCount; ++cursor) {
+            if (live[cursor] > 0) {
+                fanning = static_cast<I64>(cursor);
+            }
+        }
+        if (fanning >= 0) {
+            clusters.push_back(static_cast<U32>(output.size() / 3));
+        }
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+    return clusters;
+}
+
+void optimize_overdraw(std::span<U32> indices, std::span<const MeshVertex> vertices,
+    std::span<const U32> clusters, U32 cacheSize, F32 threshold) {
+    const U32 triangleCount = static_cast<U32>(indices.size() / 3);
+    if (triangleCount == 0 || clusters.empty()) {
+        return;
+    }
+
+    auto misses = [&](VertexCache& cache, U32 t) {
+        return cache.touch(indices[t * 3]) + cache.touch(indices[t * 3 + 1])
+            + cache.touch(indices[t * 3 + 2]);
+    };
+
+    // cut every cluster wherever the triangles so far miss the cache about as
+    // little as the whole cluster, starting over with an empty cache there
+    // costs little
+    std::vector<U32> starts;
+    VertexCache cache(vertices.size(), cacheSize);
+    for (size_t c = 0; c < clusters.size(); ++c) {
+        const U32 begin = clusters[c];
+        const U32 end = c + 1 < clusters.size() ? clusters[c + 1] : triangleCount;
+
+        cache.flush();
+        U32 clusterMisses = 0;
+        for (U32 t = begin; t < end; ++t) {
+            clusterMisses += misses(cache, t);
+        }
+        const F32 limit = threshold * F32(clusterMisses) / F32(end - begin);
+
+        cache.flush();
+        starts.push_back(begin);
+        U32 start = begin;
+        U32 missesSoFar = 0;
+        for (U32 t = begin; t < end; ++t) {
+            missesSoFar += misses(cache, t);
+            if (t + 1 < end && F32(missesSoFar) <= limit * F32(t + 1 - start)) {
+                starts.push_back(t + 1);
+                start = t + 1;
+                missesSoFar = 0;
+                cache.flush();
+            }
+        }
+    }
+
+    Vec3 center {};
+    for (const MeshVertex& vertex : vertices) {
+        for (U32 k = 0; k < 3; ++k) {
+            center[k] += vertex.position[k] / F32(vertices.size());
+        }
+    }
+
+    // how far a cluster faces away from the center: area weighted centroid
+    // along the area weighted normal, front faces wind counter-clockwise
+    struct Cluster {
+        U32 begin;
+        U32 end;
+        F32 facing;
+    };
+    std::vector<Cluster> sorted;
+    sorted.reserve(starts.size());
+    for (size_t c = 0; c < starts.size(); ++c) {
+        Cluster& cluster = sorted.emplace_back();
+        cluster.begin = starts[c];
+        cluster.end = c + 1 < starts.size() ? starts[c + 1] : triangleCount;
+
+        Vec3 centroid {};
+        Vec3 normal {};
+        F32 area = 0.0f;
+        for (U32 t = cluster.begin; t < cluster.end; ++t) {
+            const Vec3& a = vertices[indices[t * 3]].position;
+            const Vec3& b = vertices[indices[t * 3 + 1]].position;
+            const Vec3& c = vertices[indices[t * 3 + 2]].position;
+            const Vec3 n = cross(b - a, c - a);
+            const F32 length = std::sqrt(dot(n, n));
+            for (U32 k = 0; k < 3; ++k) {
+                centroid[k] += (a[k] + b[k] + c[k]) / 3.0f * length;
+                normal[k] += n[k];
+            }
+            area += length;
+        }
+        const F32 normalLength = std::sqrt(dot(normal, normal));
+        if (area > 0.0f && normalLength > 0.0f) {
+            for (U32 k = 0; k < 3; ++k) {
+                centroid[k] /= area;
+                normal[k] /= normalLength;
+            }
+            cluster.facing = dot(centroid - center, normal);
+        } else {
+            cluster.facing = 0.0f;
+        }
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+        [](const Cluster& a, const Cluster& b) { return a.facing > b.facing; });
+
+    std::vector<U32> output;
+    output.reserve(indices.size());
+    for (const Cluster& cluster : sorted) {
+        output.insert(output.end(), indices.begin() + cluster.begin * 3,
+            indices.begin() + cluster.end * 3);
+    }
+    std::copy(output.begin(), output.end(), indices.begin());
+}
+
+void optimize_vertex_fetch(MeshData& mesh) {
+    constexpr U32 Unused = ~0u;
+
+    std::vector<U32> remap(mesh.vertices.size(), Unused);
+    std::vector<MeshVertex> vertices;
+    vertices.reserve(mesh.vertices.size());
+    for (U32& index : mesh.indices) {
+        if (remap[index] == Unused) {
+            remap[index] = static_cast<U32>(vertices.size());
+            vertices.push_back(mesh.vertices[index]);
+        }
+        index = remap[index];
+    }
+    mesh.vertices = std::move(vertices);
+}
+
+MeshOptimizeStats optimize_mesh(MeshData& mesh) {
+    MeshOptimizeStats stats;
+    stats.before = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+    if (mesh.indices.size() % 3 != 0) {
+        stats.after = stats.before;
+        return stats;
+    }
+
+    deduplicate_vertices(mesh);
+    const std::vector<U32> clusters = optimize_vertex_cache(mesh.indices, mesh.vertices.size());
+    optimize_overdraw(mesh.indices, mesh.vertices, clusters);
+    optimize_vertex_fetch(mesh);
+
+    stats.after = analyze_vertex_cache(mesh.indices, mesh.vertices.size());
+    return stats;
+}
+
+MeshOptimizeStats optimize_meshes(std::span<MeshData> meshes, Core::JobPool* jobs) {
+    std::vector<MeshOptimizeStats> stats(meshes.size());
+    if (jobs && meshes.size() > 1) {
+        Core::JobPool::JobCounter counter { 0 };
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            jobs->kickJob([&, i] { stats[i] = optimize_mesh(meshes[i]); }, &counter);
+        }
+        jobs->waitForCounter(&counter);
+    } else {
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            stats[i] = optimize_mesh(meshes[i]);
+        }
+    }
+
+    MeshOptimizeStats total;
+    for (const MeshOptimizeStats& mesh : stats) {
+        total += mesh;
+    }
+    return total;
+}
+
+} // namespace Resource
@@ -0,0 +1,293 @@
+#include "resource/meshlet.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/concurrency/job_system.hpp"
+#include "resource/mesh_optimizer.hpp"
+#include "resource/vec3_math.hpp"
+
+namespace Resource {
+
+namespace {
+
+// Bounding sphere and normal cone of the triangles in indices.
+void compute_bounds(Meshlet& meshlet, std::span<const U32> indices,
+    std::span<const MeshVertex> vertices) {
+    Vec3 min = vertices[indices[0]].position;
+    Vec3 max = min;
+    for (U32 v : indices) {
+        for (U32 k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], vertices[v].position[k]);
+            max[k] = std::max(max[k], vertices[v].position[k]);
+        }
+    }
+    const Vec3 center { (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f,
+        (min[2] + max[2]) * 0.5f };
+    F32 radius = 0.0f;
+    for (U32 v : indices) {
+        const Vec3 d = vertices[v].position - center;
+        radius = std::max(radius, dot(d, d));
+    }
+    meshlet.bounds = { center[0], center[1], center[2], std::sqrt(radius) };
+
+    std::vector<Vec3> normals;
+    normals.reserve(indices.size() / 3);
+    Vec3 axis {};
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const Vec3& a = vertices[indices[i]].position;
+        const Vec3 n = cross(
+            vertices[indices[i + 1]].position - a, vertices[indices[i + 2]].position - a);
+        const F32 length = std::sqrt(dot(n, n));
+        if (length > 0.0f) {
+            normals.push_back({ n[0] / length, n[1] / length, n[2] / length });
+            for (U32 k = 0; k < 3; ++k) {
+                axis[k] += normals.back()[k];
+            }
+        }
+    }
+    const F32 axisLength = std::sqrt(dot(axis, axis));
+    if (axisLength <= 0.0f) {
+        meshlet.cone = { 0.0f, 0.0f, 0.0f, 1.0f };
+        return;
+    }
+    axis = { axis[0] / axisLength, axis[1] / axisLength, axis[2] / axisLength };
+    F32 spread = 1.0f; // cosine of the widest normal
+    for (const Vec3& n : normals) {
+        spread = std::min(spread, dot(n, axis));
+    }
+    meshlet.cone = { axis[0], axis[1], axis[2],
+        spread <= 0.0f ? 1.0f : std::sqrt(1.0f - spread * spread) };
+}
+
+} // namespace
+
+std::vector<Meshlet> build_meshlets(std::span<U32> indices, std::span<const MeshVertex> vertices,
+    U32 maxVertices, U32 maxTriangles) {
+    const size_t triangleCount = indices.size() / 3;
+    if (triangleCount == 0) {
+        return {};
+    }
+    const size_t vertexCount = vertices.size();
+
+    // the triangles around every vertex
+    std::vector<U32> first(vertexCount + 1, 0);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        first[indices[i] + 1]++;
+    }
+    for (size_t v = 0; v < vertexCount; ++v) {
+        first[v + 1] += first[v];
+    }
+    std::vector<U32> adjacency(triangleCount * 3);
+    std::vector<U32> filled(first.begin(), first.end() - 1);
+    for (size_t i = 0; i < triangleCount * 3; ++i) {
+        adjacency[filled[indices[i]]++] = static_cast<U32>(i / 3);
+    }
+
+    auto centroid = [&](U32 t) {
+        Vec3 c {};
+        for (U32 k = 0; k < 3; ++k) {
+            for (U32 j = 0; j < 3; ++j) {
+                c[j] += vertices[indices[t * 3 + k]].position[j] / 3.0f;
+            }
+        }
+        return c;
+    };
+
+    std::vector<bool> emitted(triangleCount, false);
+    // the meshlet a vertex was last added to, so membership needs no clearing
+    std::vector<U32> owner(vertexCount, ~0u);
+    std::vector<U32> candidates;
+    std::vector<U32> local; // vertices of the meshlet, in order of first use
+    std::vector<U32> output;
+    output.reserve(triangleCount * 3);
+    std::vector<Meshlet> meshlets;
+    size_t cursor = 0;
+
+    for (;;) {
+        while (cursor < triangleCount && emitted[cursor]) {
+            ++cursor;
+        }
+        if (cursor == triangleCount) {
+            break;
+        }
+
+        const U32 id = static_cast<U32>(meshlets.size());
+        Meshlet& meshlet = meshlets.emplace_back();
+        meshlet.firstIndex = static_cast<U32>(output.size());
+        candidates.clear();
+        U32 meshletVertices = 0;
+        U32 meshletTriangles = 0;
+        Vec3 sum {};
+
+        I64 next = static_cast<I64>(cursor);
+        while (next >= 0) {
+            const U32 t = static_cast<U32>(next);
+            emitted[t] = true;
+            for (U32 k = 0; k < 3; ++k) {
+                const U32 v = indices[t * 3 + k];
+                output.push_back(v);
+                if (owner[v] == id) {
+                    continue;
+                }
+                owner[v] = id;
+                meshletVertices++;
+                for (U32 j = 0; j < 3; ++j) {
+                    sum[j] += vertices[v].position[j];
+                }
+                for (U32 a = first[v]; a < first[v + 1]; ++a) {
+                    if (!emitted[adjacency[a]]) {
+                        candidates.push_back(adjacency[a]);
+                    }
+                }
+            }
+            if (++meshletTriangles == maxTriangles) {
+                break;
+            }
+
+            // the neighbour adding the fewest vertices, the nearest one of those
+            const Vec3 center { sum[0] / F32(meshletVertices), sum[1] / F32(meshletVertices),
+                sum[2] / F32(meshletVertices) };
+            next = -1;
+            U32 bestNew = 4;
+            F32 bestDistance = INFINITY;
+            size_t live = 0;
+            for (U32 c : candidates) {
+                if (emitted[c]) {
+                    continue;
+                }
+                candidates[live++] = c;
+                const U32 added = (owner[indices[c * 3]] != id) + (owner[indices[c * 3 + 1]] != id)
+                    + (owner[indices[c * 3 + 2]] != id);
+                if (meshletVertices + added > maxVertices || added > bestNew) {
+                    continue;
+                }
+                const Vec3 d = centroid(c) - center;
+                const F32 distance = dot(d, d);
+                if (added < bestNew || distance < bestDistance) {
+                    next = c;
+                    bestNew = added;
+                    bestDistance = distance;
+                }
+            }
+            candidates.resize(live);
+        }
+
+        meshlet.indexCount = static_cast<U32>(output.size()) - meshlet.firstIndex;
+        const std::span<U32> triangles
+            = std::span(output).subspan(meshlet.firstIndex, meshlet.indexCount);
+
+        // growing by distance undoes the vertex cache order, restore it inside
+        // the meshlet on its own few vertices
+        local.clear();
+        for (U32& v : triangles) {
+            const auto it = std::find(local.begin(), local.end(), v);
+            const U32 slot = static_cast<U32>(it - local.begin());
+            if (it == local.end()) {
+                local.push_back(v);
+            }
+            v = slot;
+        }
+        optimize_vertex_cache(triangles, local.size());
+        for (U32& v : triangles) {
+            v = local[v];
+        }
+        compute_bounds(meshlet, triangles, vertices);
+    }
+
+    std::copy(output.begin(), output.end(), indices.begin());
+    return meshlets;
+}
+
+void build_meshlets(MeshData& mesh) {
+    mesh.meshlets.clear();
+    if (mesh.indices.size() % 3 != 0) {
+        return;
+    }
+    mesh.meshlets = build_meshlets(mesh.indices, mesh.vertices);
+}
+
+void build_meshlets(std::span<MeshData> meshes, Core::JobPool* jobs) {
+    if (jobs && meshes.size() > 1) {
+        Core::JobPool::JobCounter counter { 0 };
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            jobs->kickJob([&, i] { build_meshlets(meshes[i]); }, &counter);
+        }
+        jobs->waitForCounter(&counter);
+    } else {
+        for (MeshData& mesh : meshes) {
+            build_meshlets(mesh);
+        }
+    }
+}
+
+ClusterView make_cluster_view(std::span<const F32, 16> clip, const std::array<F32, 3>& eye) {
+    // Gribb and Hartmann: the planes are sums of the rows of the matrix
+    auto row = [&](U32 r) {
+        return std::array<F32, 4> { clip[r], clip[4 + r], clip[8 + r], clip[12 + r] };
+    };
+    const std::array<F32, 4> x = row(0);
+    const std::array<F32, 4> y = row(1);
+    const std::array<F32, 4> z = row(2);
+    const std::array<F32, 4> w = row(3);
+
+    ClusterView view;
+    view.eye = eye;
+    for (U32 k = 0; k < 4; ++k) {
+        view.planes[0][k] = w[k] + x[k]; // left
+        view.planes[1][k] = w[k] - x[k]; // right
+        view.planes[2][k] = w[k] + y[k]; // bottom
+        view.planes[3][k] = w[k] - y[k]; // top
+        view.planes[4][k] = z[k]; // near, depth starts at 0
+        view.planes[5][k] = w[k] - z[k]; // far
+    }
+    for (std::array<F32, 4>& plane : view.planes) {
+        const F32 length
+            = std::sqrt(plane[0] * plane[0] + plane[1] * plane[1] + plane[2] * plane[2]);
+        if (length > 0.0f) {
+            for (F32& k : plane) {
+                k /= length;
+            }
+        }
+    }
+    return view;
+}
+
+size_t cull_meshlets(
+    std::span<const Meshlet> meshlets, const ClusterView& view, std::vector<IndexRange>& out) {
+    size_t visible = 0;
+    bool extending = false;
+    for (const Meshlet& meshlet : meshlets) {
+        const Vec3 center { meshlet.bounds[0], meshlet.bounds[1], meshlet.bounds[2] };
+        const F32 radius = meshlet.bounds[3];
+
+        bool inside = true;
+        for (const std::array<F32, 4>& plane : view.planes) {
+            inside = inside
+                && center[0] * plane[0] + center[1] * plane[1] + center[2] * plane[2] + plane[3]
+                    >= -radius;
+        }
+
+        // every normal is within the cone, seen from anywhere in the sphere
+        // they all point away
+        const Vec3 toCenter = center - view.eye;
+        const Vec3 axis { meshlet.cone[0], meshlet.cone[1], meshlet.cone[2] };
+        const bool backfacing
+            = dot(toCenter, axis) >= meshlet.cone[3] * std::sqrt(dot(toCenter, toCenter)) + radius;
+
+        if (!inside || backfacing) {
+            extending = false;
+            continue;
+        }
+        visible++;
+        if (extending && out.back().firstIndex + out.back().indexCount == meshlet.firstIndex) {
+            out.back().indexCount += meshlet.indexCount;
+        } else {
+            out.push_back({ meshlet.firstIndex, meshlet.indexCount });
+        }
+        extending = true;
+    }
+    return visible;
+}
+
+} // namespace Resource
@@ -0,0 +1,107 @@
+#include "resource/model_data.hpp"
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/concurrency/job_system.hpp"
+
+namespace Resource {
+
+// Center of the bounding box, radius to the farthest vertex.
+static std::array<F32, 4> bounding_sphere(std::span<const MeshVertex> vertices) {
+    if (vertices.empty()) {
+        return {};
+    }
+
+    std::array<F32, 3> min = vertices[0].position;
+    std::array<F32, 3> max = vertices[0].position;
+    for (const MeshVertex& vertex : vertices) {
+        for (U32 k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], vertex.position[k]);
+            max[k] = std::max(max[k], vertex.position[k]);
+        }
+    }
+
+    std::array<F32, 4> sphere { (min[0] + max[0]) * 0.5f, (min[1] + max[1]) * 0.5f,
+        (min[2] + max[2]) * 0.5f, 0.0f };
+    for (const MeshVertex& vertex : vertices) {
+        F32 distance = 0.0f;
+        for (U32 k = 0; k < 3; ++k) {
+            distance += (vertex.position[k] - sphere[k]) * (vertex.position[k] - sphere[k]);
+        }
+        sphere[3] = std::max(sphere[3], distance);
+    }
+    sphere[3] = std::sqrt(sphere[3]);
+    return sphere;
+}
+
+PackedGeometry pack_meshes(std::span<const MeshData> meshes, Core::JobPool* jobs) {
+    PackedGeometry packed;
+    packed.meshes.resize(meshes.size());
+
+    // exclusive prefix sums over the mesh sizes place every mesh and its
+    // levels of detail in the shared buffers
+    size_t vertexCount = 0;
+    size_t indexCount = 0;
+    size_t meshletCount = 0;
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        MeshRange& range = packed.meshes[i];
+        range.firstIndex = static_cast<U32>(indexCount);
+        range.indexCount = static_cast<U32>(meshes[i].indices.size());
+        range.vertexOffset = static_cast<I32>(vertexCount);
+        range.vertexCount = static_cast<U32>(meshes[i].vertices.size());
+        range.materialIndex = meshes[i].materialIndex;
+        range.firstLod = static_cast<U32>(packed.lods.size());
+        range.lodCount = static_cast<U32>(meshes[i].lods.size());
+        range.firstMeshlet = static_cast<U32>(meshletCount);
+        range.meshletCount = static_cast<U32>(meshes[i].meshlets.size());
+
+        vertexCount += meshes[i].vertices.size();
+        indexCount += meshes[i].indices.size();
+        meshletCount += meshes[i].meshlets.size();
+        for (const MeshLodData& lod : meshes[i].lods) {
+            packed.lods.push_back(
+                { static_cast<U32>(indexCount), static_cast<U32>(lod.indices.size()), lod.error });
+            indexCount += lod.indices.size();
+        }
+    }
+    packed.vertices.resize(vertexCount);
+    packed.indices.resize(indexCount);
+    packed.meshlets.resize(meshletCount);
+
+    // the ranges do not overlap, every mesh is copied independently
+    auto copy_mesh = [&](size_t i) {
+        MeshRange& range = packed.meshes[i];
+        std::copy(meshes[i].vertices.begin(), meshes[i].vertices.end(),
+            packed.vertices.begin() + range.vertexOffset);
+        std::copy(meshes[i].indices.begin(), meshes[i].indices.end(),
+            packed.indices.begin() + range.firstIndex);
+        for (U32 l = 0; l < range.lodCount; ++l) {
+            const std::vector<U32>& lod = meshes[i].lods[l].indices;
+            std::copy(lod.begin(), lod.end(),
+                packed.indices.begin() + packed.lods[range.firstLod + l].firstIndex);
+        }
+        for (U32 m = 0; m < range.meshletCount; ++m) {
+            Meshlet& meshlet = packed.meshlets[range.firstMeshlet + m];
+            meshlet = meshes[i].meshlets[m];
+            meshlet.firstIndex += range.firstIndex;
+        }
+        range.bounds = bounding_sphere(meshes[i].vertices);
+    };
+
+    if (!jobs || meshes.size() < 2) {
+        for (size_t i = 0; i < meshes.size(); ++i) {
+            copy_mesh(i);
+        }
+        return packed;
+    }
+
+    Core::JobPool::JobCounter counter { 0 };
+    for (size_t i = 0; i < meshes.size(); ++i) {
+        jobs->kickJob([&copy_mesh, i] { copy_mesh(i); }, &counter);
+    }
+    jobs->waitForCounter(&counter);
+    return packed;
+}
+
+} // namespace Resource
@@ -0,0 +1,123 @@
+#include "resource/model_importer.hpp"
+
+#include <algorithm>
+
+#include <assimp/Importer.hpp>
+#include <assimp/postprocess.h>
+#include <assimp/scene.h>
+
+#include "core/concurrency/job_system.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+// Touches nothing but result, so meshes convert on any thread.
+static void convert_mesh(const aiMesh* mesh, MeshData& result) {
+    result.vertices.resize(mesh->mNumVertices);
+    for (size_t i = 0; i < mesh->mNumVertices; i++) {
+        MeshVertex& vertex = result.vertices[i];
+        vertex.position = { mesh->mVertices[i].x, mesh->mVertices[i].y, mesh->mVertices[i].z };
+        vertex.color = mesh->mColors[0]
+            ? std::array<F32, 3> { mesh->mColors[0][i].r, mesh->mColors[0][i].g,
+                  mesh->mColors[0][i].b }
+            : std::array<F32, 3> { 1.0f, 1.0f, 1.0f };
+        vertex.texCoord = mesh->mTextureCoords[0]
+            ? std::array<F32, 2> { mesh->mTextureCoords[0][i].x, mesh->mTextureCoords[0][i].y }
+            : std::array<F32, 2> { 0.0f, 0.0f };
+    }
+
+    // aiProcess_Triangulate leaves three indices per face, but points and lines pass through
+    size_t indexCount = 0;
+    for (size_t i = 0; i < mesh->mNumFaces; i++) {
+        indexCount += mesh->mFaces[i].mNumIndices;
+    }
+    result.indices.resize(indexCount);
+    U32* index = result.indices.data();
+    for (size_t i = 0; i < mesh->mNumFaces; i++) {
+        const aiFace& face = mesh->mFaces[i];
+        index = std::copy_n(face.mIndices, face.mNumIndices, index);
+    }
+
+    result.materialIndex = mesh->mMaterialIndex;
+}
+
+// The meshes the node hierarchy references, in traversal order.
+static void collect_meshes(const aiNode* node, const aiScene* scene, std::vector<const aiMesh*>& out) {
+    for (size_t i = 0; i < node->mNumMeshes; i++) {
+        out.push_back(scene->mMeshes[node->mMeshes[i]]);
+    }
+
+    for (size_t i = 0; i < node->mNumChildren; i++) {
+        collect_meshes(node->mChildren[i], scene, out);
+    }
+}
+
+static void convert_meshes(const aiScene* scene, Core::JobPool* jobs, ModelData& out) {
+    std::vector<const aiMesh*> meshes;
+    collect_meshes(scene->mRootNode, scene, meshes);
+    out.meshes.resize(meshes.size());
+
+    if (!jobs || meshes.size() < 2) {
+        for (size_t i = 0; i < meshes.size(); i++) {
+            convert_mesh(meshes[i], out.meshes[i]);
+        }
+        return;
+    }
+
+    // one job per mesh, each converts into its own slot
+    Core::JobPool::JobCounter counter { 0 };
+    for (size_t i = 0; i < meshes.size(); i++) {
+        jobs->kickJob([&, i] { convert_mesh(meshes[i], out.meshes[i]); }, &counter);
+    }
+    jobs->waitForCounter(&counter);
+}
+
+static void convert_materials(const aiScene* scene, const std::string& directory, ModelData& out) {
+    out.materials.resize(scene->mNumMaterials);
+
+    for (size_t i = 0; i < scene->mNumMaterials; i++) {
+        const aiMaterial* material = scene->mMaterials[i];
+        MaterialData& mat = out.materials[i];
+
+        aiString name;
+        material->Get(AI_MATKEY_NAME, name);
+        mat.name = name.C_Str();
+
+        if (material->GetTextureCount(aiTextureType_DIFFUSE) > 0) {
+            aiString texturePath;
+            material->GetTexture(aiTextureType_DIFFUSE, 0, &texturePath);
+            // the TextureStore normalizes separators
+            mat.diffusePath = directory + "/" + texturePath.C_Str();
+        } else {
+            CORE_LOG_WARN("[ModelImporter]:\tNo diffuse texture found for material {}", mat.name);
+        }
+    }
+}
+
+bool import_model(const std::filesystem::path& path, ModelData& out, Core::JobPool* jobs) {
+    Assimp::Importer importer;
+
+    const std::string file = path.generic_string();
+    const aiScene* scene = importer.ReadFile(file,
+        aiProcess_Triangulate | aiProcess_FlipUVs | aiProcess_GenNormals
+            | aiProcess_JoinIdenticalVertices | aiProcess_MakeLeftHanded
+            | aiProcess_FlipWindingOrder);
+
+    if (!scene || scene->mFlags & AI_SCENE_FLAGS_INCOMPLETE || !scene->mRootNode) {
+        CORE_LOG_ERROR("[ModelImporter]: Assimp error while importing {}: {}", file,
+            importer.GetErrorString());
+        return false;
+    }
+
+    CORE_LOG_INFO("[ModelImporter]: Importing model: {}", file);
+    CORE_LOG_INFO("[ModelImporter]: Model has {} materials", scene->mNumMaterials);
+    CORE_LOG_INFO("[ModelImporter]: Model has {} meshes", scene->mNumMeshes);
+    CORE_LOG_INFO("[ModelImporter]: Model has {} textures", scene->mNumTextures);
+
+    out = {};
+    convert_materials(scene, path.parent_path().generic_string(), out);
+    convert_meshes(scene, jobs, out);
+    return true;
+}
+
+} // namespace Resource
@@ -0,0 +1,380 @@
+#include "resource/model_store.hpp"
+
+#include <thread>
+#include <utility>
+
+#include "resource/material_store.hpp"
+#include "resource/model_importer.hpp"
+#include "resource/texture_store.hpp"
+#include "resource/vfs.hpp"
+#include "core/hash.hpp"
+#include "core/logger.hpp"
+
+namespace Resource {
+
+ModelStore::ModelStore(GeometryBackend& backend, MaterialStore& materials)
+    : r_Backend(backend)
+    , r_Materials(materials) { }
+
+ModelStore::~ModelStore() {
+    // import jobs still running push into m_Imported, keep it drained until they are done
+    ImportedModel discarded;
+    while (m_LoadsInFlight.load(std::memory_order_acquire) > 0) {
+        while (m_Imported.try_pop(discarded)) { }
+        std::this_thread::yield();
+    }
+    clear();
+}
+
+ModelHandle ModelStore::load(const fs::path& path) {
+    return load_now(path, nullptr);
+}
+
+ModelHandle ModelStore::load(Core::JobPool& jobs, const fs::path& path) {
+    return load_now(path, &jobs);
+}
+
+ModelHandle ModelStore::load(std::string_view name, const ModelData& data) {
+    std::string key(name);
+    if (ModelHandle h = reuse(key)) {
+        return h;
+    }
+    const PackedGeometry packed = pack_meshes(data.meshes);
+    const CompactGeometry compact
+        = m_CompactVertices ? compact_geometry(packed.view()) : CompactGeometry {};
+    return create(std::move(key), data.materials, packed.view(), compact, 0);
+}
+
+ModelHandle ModelStore::load_async(Core::JobPool& jobs, const fs::path& path) {
+    std::string key = TextureStore::normalize_path(path);
+    if (ModelHandle h = reuse(key)) {
+        return h;
+    }
+
+    Model model;
+    model.path = key;
+    model.refCount = 1;
+    model.state = LoadState::Loading;
+
+    const ModelHandle h { m_Models.insert(std::move(model)) };
+    m_ByPath.try_emplace(key, h);
+
+    kick_load(jobs, h, std::move(key), 0, false);
+    return h;
+}
+
+size_t ModelStore::reload(Core::JobPool& jobs, const fs::path& path) {
+    const std::string key = TextureStore::normalize_path(path);
+    size_t reloading = 0;
+    auto reload_model = [&](const std::string& modelKey) {
+        auto it = m_ByPath.find(modelKey);
+        if (it == m_ByPath.end() || get(it->second)->state != LoadState::Ready) {
+            return;
+        }
+        // the .vgemesh written by importing a changed source hashes like the import, and is skipped
+        kick_load(jobs, it->second, modelKey, get(it->second)->sourceHash, true);
+        reloading++;
+    };
+
+    // the model named by path, and the model a changed .vgemesh was cooked for
+    reload_model(key);
+    if (fs::path(key).extension() == ".vgemesh") {
+        reload_model(fs::path(key).replace_extension().generic_string());
+    }
+    return reloading;
+}
+
+size_t ModelStore::poll_loads(std::vector<ModelHandle>& ready) {
+    size_t uploaded = 0;
+    ImportedModel result;
+    while (m_Imported.try_pop(result)) {
+        // released while importing, a reload only replaces a loaded model
+        Model* model = m_Models.get(result.handle.handle());
+        if (!model || model->state != (result.reload ? LoadState::Ready : LoadState::Loading)) {
+            continue;
+        }
+        if (!result.loaded) {
+            if (!result.reload) {
+                model->state = LoadState::Failed;
+            }
+            continue; // a failed or unchanged reload keeps the model as it is
+        }
+
+        if (result.reload) {
+            rebuild(*model, result.source, result.jobs);
+        } else {
+            build(*model, result.source.materials, result.source.geometry(),
+                result.source.compact, result.jobs, true);
+            model->sourceHash = result.source.sourceHash;
+            model->state = LoadState::Ready;
+        }
+
+        ready.push_back(result.handle);
+        uploaded++;
+    }
+    return uploaded;
+}
+
+void ModelStore::set_placeholder(ModelHandle model) {
+    if (m_Placeholder && get(m_Placeholder)) {
+        release(m_Placeholder);
+    }
+    m_Placeholder = model;
+}
+
+const Model* ModelStore::resolve(ModelHandle h) const {
+    const Model* model = get(h);
+    if (model && model->state != LoadState::Ready) {
+        return get(m_Placeholder);
+    }
+    return model;
+}
+
+void ModelStore::add_ref(ModelHandle h) {
+    Model* model = m_Models.get(h.handle());
+    if (!model) {
+        CORE_LOG_WARN("[ModelStore]: Handle is invalid or outdated.");
+        return;
+    }
+    model->refCount++;
+}
+
+void ModelStore::release(ModelHandle h) {
+    Model* model = m_Models.get(h.handle());
+    if (!model) {
+        CORE_LOG_WARN("[ModelStore]: Handle is invalid or outdated.");
+        return;
+    }
+    if (--model->refCount == 0) {
+        destroy(h);
+    }
+}
+
+void ModelStore::clear() {
+    std::vector<ModelHandle> all;
+    all.reserve(m_ByPath.size());
+    for (const auto& [key, h] : m_ByPath) {
+        all.push_back(h);
+    }
+    for (ModelHandle h : all) {
+        destroy(h);
+    }
+    m_Placeholder = {};
+}
+
+ModelHandle ModelStore::load_now(const fs::path& path, Core::JobPool* jobs) {
+    std::string key = TextureStore::normalize_path(path);
+    if (ModelHandle h = reuse(key)) {
+        return h;
+    }
+
+    SourceModel source;
+    if (!read_source(m_Vfs, key, source, jobs, m_CompactVertices)) {
+        return {};
+    }
+    return create(std::move(key), source.materials, source.geometry(), source.compact,
+        source.sourceHash, jobs);
+}
+
+ModelHandle ModelStore::reuse(const std::string& key) {
+    auto it = m_ByPath.find(key);
+    if (it == m_ByPath.end()) {
+        return {};
+    }
+    m_Models.get(it->second.handle())->refCount++;
+    return it->second;
+}
+
+void ModelStore::kick_load(
+    Core::JobPool& jobs, ModelHandle h, std::string path, U64 unchangedHash, bool reload) {
+    jobs.kickJob(
+        [this, h, pool = &jobs, vfs = m_Vfs, compact = m_CompactVertices, unchangedHash, reload,
+            key = std::move(path)] {
+            ImportedModel result;
+            result.handle = h;
+            result.jobs = pool;
+            result.reload = reload;
+            result.loaded = read_source(vfs, key, result.source, pool, compact)
+                && (unchangedHash == 0 || result.source.sourceHash != unchangedHash);
+
+            // the owner drains the queue every frame, a full queue only stalls this worker
+            while (!m_Imported.try_push(std::move(result))) {
+                std::this_thread::yield();
+            }
+        },
+        &m_LoadsInFlight);
+}
+
+bool ModelStore::read_source(const Vfs* vfs, const std::string& path, SourceModel& out,
+    Core::JobPool* jobs, bool compact) {
+    const fs::path directory = fs::path(path).parent_path();
+    // converted here too, off the render thread
+    auto loaded = [&] {
+        if (compact) {
+            out.compact = compact_geometry(out.geometry(), jobs);
+        }
+        return true;
+    };
+
+    // a cooked file named directly has no source to check against
+    if (fs::path(path).extension() == ".vgemesh") {
+        if (!out.cooked.open(open_file(vfs, path), directory)) {
+            CORE_LOG_ERROR("[ModelStore]: {} is missing or not a valid .vgemesh", path);
+            return false;
+        }
+        out.materials = out.cooked.materials();
+        out.sourceHash = out.cooked.source_hash();
+        return loaded();
+    }
+
+    U64 sourceHash = 0;
+    if (const VfsFile source = open_file(vfs, path); source.is_open()) {
+        sourceHash = Core::hash_bytes(source.data(), source.size());
+    }
+    if (out.cooked.open(open_file(vfs, cooked_mesh_path(path)), directory)) {
+        // without a source there is nothing to import instead
+        if (sourceHash == 0 || out.cooked.source_hash() == sourceHash) {
+            out.materials = out.cooked.materials();
+            out.sourceHash = out.cooked.source_hash();
+            return loaded();
+        }
+        out.cooked.close();
+    }
+
+    // the importer reads host files, a model only inside a pack cannot be imported
+    const fs::path hostPath = vfs ? vfs->resolve(path) : fs::path(path);
+    ModelData data;
+    if (hostPath.empty() || !import_model(hostPath, data, jobs)) {
+        if (hostPath.empty()) {
+            CORE_LOG_ERROR("[ModelStore]: {} is not a file on disk and has no cooked form", path);
+        }
+        return false;
+    }
+    CookedModel cooked = cook_model(data, jobs);
+    CORE_LOG_INFO("[ModelStore]: Optimized {}: ACMR {:.3f} -> {:.3f}, ATVR {:.3f} -> {:.3f}", path,
+        cooked.stats.before.acmr(), cooked.stats.after.acmr(), cooked.stats.before.atvr(),
+        cooked.stats.after.atvr());
+    out.materials = std::move(data.materials);
+    out.imported = std::move(cooked.geometry);
+    out.sourceHash = sourceHash;
+
+    // the next load maps the result instead of importing again
+    const fs::path cookedPath = cooked_mesh_path(hostPath);
+    if (sourceHash != 0
+        && write_mesh_file(cookedPath, out.materials, out.imported.view(), sourceHash)) {
+        CORE_LOG_INFO("[ModelStore]: Cooked {}", cookedPath.string());
+    }
+
+    // texture paths next to the model become virtual paths next to it
+    for (MaterialData& material : out.materials) {
+        const fs::path relative
+            = fs::path(material.diffusePath).lexically_relative(hostPath.parent_path());
+        if (!material.diffusePath.empty() && !relative.empty() && hostPath != fs::path(path)) {
+            material.diffusePath = (directory / relative).generic_string();
+        }
+    }
+    return loaded();
+}
+
+ModelHandle ModelStore::create(std::string key, std::span<const MaterialData> materials,
+    const GeometryView& geometry, const CompactGeometry& compact, U64 sourceHash,
+    Core::JobPool* jobs) {
+    Model model;
+    model.path = key;
+    model.sourceHash = sourceHash;
+    model.refCount = 1;
+    build(model, materials, geometry, compact, jobs, false);
+
+    const ModelHandle h { m_Models.insert(std::move(model)) };
+    m_ByPath.try_emplace(std::move(key), h);
+    return h;
+}
+
+void ModelStore::build(Model& model, std::span<const MaterialData> materials,
+    const GeometryView& geometry, const CompactGeometry& compact, Core::JobPool* jobs,
+    bool async) {
+    if (jobs && !async) {
+        r_Materials.create_all(*jobs, materials, model.materials);
+    } else {
+        model.materials.reserve(materials.size());
+        for (const MaterialData& material : materials) {
+            model.materials.push_back(r_Materials.create(material.name, material.diffusePath, jobs));
+        }
+    }
+
+    // for a cooked model the spans point into the mapped file
+    if (!geometry.vertices.empty() && !geometry.indices.empty()) {
+        model.geometry = compact.vertices.empty()
+            ? r_Backend.upload_geometry(geometry.vertices, geometry.indices)
+            : r_Backend.upload_compact_geometry(compact.vertices, compact.colors, geometry.indices);
+    }
+
+    model.meshes.reserve(geometry.meshes.size());
+    for (size_t i = 0; i < geometry.meshes.size(); ++i) {
+        const MeshRange& range = geometry.meshes[i];
+        Mesh mesh;
+        mesh.geometry = model.geometry;
+        mesh.firstIndex = range.firstIndex;
+        mesh.indexCount = range.indexCount;
+        mesh.vertexOffset = range.vertexOffset;
+        mesh.vertexCount = range.vertexCount;
+        mesh.lods[0] = { range.firstIndex, range.indexCount, 0.0f };
+        for (U32 l = 0; l < range.lodCount && mesh.lodCount < MaxMeshLods; ++l) {
+            mesh.lods[mesh.lodCount++] = geometry.lods[range.firstLod + l];
+        }
+        mesh.bounds = range.bounds;
+        mesh.meshlets.assign(geometry.meshlets.begin() + range.firstMeshlet,
+            geometry.meshlets.begin() + range.firstMeshlet + range.meshletCount);
+        if (range.materialIndex < model.materials.size()) {
+            mesh.material = model.materials[range.materialIndex];
+        }
+        if (i < compact.meshes.size()) {
+            mesh.quantization = compact.meshes[i];
+        }
+        model.meshes.push_back(MeshHandle { m_Meshes.insert(std::move(mesh)) });
+    }
+
+    CORE_LOG_INFO("[ModelStore]: Loaded {} ({} meshes, {} materials, {} {}vertices)", model.path,
+        model.meshes.size(), model.materials.size(), geometry.vertices.size(),
+        compact.vertices.empty() ? "" : "compact ");
+}
+
+void ModelStore::rebuild(Model& model, const SourceModel& source, Core::JobPool* jobs) {
+    std::vector<MeshHandle> meshes = std::exchange(model.meshes, {});
+    std::vector<MaterialHandle> materials = std::exchange(model.materials, {});
+    const Handle geometry = std::exchange(model.geometry, {});
+
+    // materials first, so textures shared with the old ones stay resident
+    build(model, source.materials, source.geometry(), source.compact, jobs, true);
+    model.sourceHash = source.sourceHash;
+
+    for (MeshHandle mesh : meshes) {
+        m_Meshes.free(mesh.handle());
+    }
+    for (MaterialHandle material : materials) {
+        r_Materials.release(material);
+    }
+    // frames in flight may still draw the old buffers, the backend defers their destruction
+    if (geometry) {
+        r_Backend.release_geometry(geometry);
+    }
+}
+
+void ModelStore::destroy(ModelHandle h) {
+    Model& model = *m_Models.get(h.handle());
+
+    for (MeshHandle mesh : model.meshes) {
+        m_Meshes.free(mesh.handle());
+    }
+    for (MaterialHandle material : model.materials) {
+        r_Materials.release(material);
+    }
+    if (model.geometry) {
+        r_Backend.release_geometry(model.geometry);
+    }
+
+    m_ByPath.erase(model.path);
+    m_Models.free(h.handle());
+}
+
+} // namespace Resource
@@ -0,0 +1,198 @@
+#include "resource/pack_file.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <system_error>
+
+#include "core/logger.hpp"
+
+namespace Resource {
+
+static_assert(std::endian::native == std::endian::little, ".vgepak files are little endian");
+
+static U64 align_up(U64 offset, U64 alignment) {
+    return (offset + alignment - 1) & ~(alignment - 1);
+}
+
+bool write_pack_file(const fs::path& path, std::span<const PackSource> files) {
+    struct Pending {
+        PackEntry entry;
+        std::string virtualPath;
+        const fs::path* source = nullptr;
+    };
+
+    std::vector<Pending> pending;
+    pending.reserve(files.size());
+    for (const PackSource& file : files) {
+        Pending& p = pending.emplace_back();
+        p.virtualPath = normalize_asset_path(file.virtualPath);
+        p.entry.id = AssetId::from_path(p.virtualPath);
+        p.source = &file.source;
+
+        std::error_code error;
+        p.entry.size = fs::file_size(file.source, error);
+        if (error) {
+            CORE_LOG_ERROR("[PackFile]: Failed to read {}: {}", file.source.string(), error.message());
+            return false;
+        }
+    }
+
+    std::sort(pending.begin(), pending.end(),
+        [](const Pending& a, const Pending& b) { return a.entry.id < b.entry.id; });
+    for (size_t i = 1; i < pending.size(); ++i) {
+        if (pending[i].entry.id != pending[i - 1].entry.id) {
+            continue;
+        }
+        if (pending[i].virtualPath == pending[i - 1].virtualPath) {
+            CORE_LOG_ERROR("[PackFile]: {} is packed twice", pending[i].virtualPath);
+        } else {
+            CORE_LOG_ERROR("[PackFile]: {} and {} have the same asset id",
+                pending[i - 1].virtualPath, pending[i].virtualPath);
+        }
+        return false;
+    }
+
+    std::string strings;
+    for (Pending& p : pending) {
+        p.entry.pathOffset = static_cast<U32>(strings.size());
+        p.entry.pathSize = static_cast<U32>(p.virtualPath.size());
+        strings += p.virtualPath;
+    }
+
+    PackFileHeader header;
+    header.entryCount = pending.size();
+    header.entriesOffset = align_up(sizeof(PackFileHeader), alignof(PackEntry));
+    header.stringsOffset = header.entriesOffset + pending.size() * sizeof(PackEntry);
+    header.stringsSize = strings.size();
+
+    U64 offset = header.stringsOffset + strings.size();
+    for (Pending& p : pending) {
+        p.entry.offset = align_up(offset, PackFileAlignment);
+        offset = p.entry.offset + p.entry.size;
+    }
+
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            CORE_LOG_ERROR("[PackFile]: Failed to create {}", temporary.string());
+            return false;
+        }
+
+        U64 written = 0;
+        auto write_at = [&](U64 at, const void* bytes, U64 size) {
+            for (; written < at; written++) {
+                file.put('\0');
+            }
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            written += size;
+        };
+
+        write_at(0, &header, sizeof(header));
+        for (const Pending& p : pending) {
+            write_at(written, &p.entry, sizeof(PackEntry));
+        }
+        write_at(header.stringsOffset, strings.data(), strings.size());
+
+        for (const Pending& p : pending) {
+            Platform::MappedFile source;
+            if (!source.open(*p.source) || source.size() != p.entry.size) {
+                CORE_LOG_ERROR("[PackFile]: {} changed or vanished while packing", p.source->string());
+                file.close();
+                std::error_code error;
+                fs::remove(temporary, error);
+                return false;
+            }
+            write_at(p.entry.offset, source.data(), source.size());
+        }
+
+        if (!file) {
+            CORE_LOG_ERROR("[PackFile]: Failed to write {}", temporary.string());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        CORE_LOG_ERROR("[PackFile]: Failed to write {}: {}", path.string(), error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool PackFile::open(const fs::path& path) {
+    if (!m_File.open(path)) {
+        return false;
+    }
+
+    const U64 size = m_File.size();
+    const bool valid = [&] {
+        if (size < sizeof(PackFileHeader)) {
+            return false;
+        }
+        const PackFileHeader& h = header();
+        if (h.magic != PackFileMagic || h.version != PackFileVersion) {
+            return false;
+        }
+        if (h.entriesOffset % alignof(PackEntry) != 0 || h.entriesOffset > size
+            || h.entryCount > (size - h.entriesOffset) / sizeof(PackEntry)
+            || h.stringsOffset > size || h.stringsSize > size - h.stringsOffset) {
+            return false;
+        }
+
+        // lookups binary search the table and hand out spans without further checks
+        const std::span<const PackEntry> table = entries();
+        for (size_t i = 0; i < table.size(); ++i) {
+            const PackEntry& entry = table[i];
+            if ((i > 0 && !(table[i - 1].id < entry.id)) || entry.offset > size
+                || entry.size > size - entry.offset
+                || U64(entry.pathOffset) + entry.pathSize > h.stringsSize) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    if (!valid) {
+        m_File.close();
+        return false;
+    }
+    return true;
+}
+
+std::optional<std::span<const std::byte>> PackFile::find(std::string_view virtualPath) const {
+    const std::string normalized = normalize_asset_path(virtualPath);
+    const PackEntry* entry = lookup(AssetId::from_path(normalized));
+    // an id names one path, but a path that is not packed may still collide with one that is
+    if (!entry || path(*entry) != normalized) {
+        return std::nullopt;
+    }
+    return contents(*entry);
+}
+
+std::optional<std::span<const std::byte>> PackFile::find(AssetId id) const {
+    const PackEntry* entry = lookup(id);
+    if (!entry) {
+        return std::nullopt;
+    }
+    return contents(*entry);
+}
+
+const PackEntry* PackFile::lookup(AssetId id) const {
+    if (!is_open()) {
+        return nullptr;
+    }
+    const std::span<const PackEntry> table = entries();
+    auto it = std::lower_bound(table.begin(), table.end(), id,
+        [](const PackEntry& entry, AssetId value) { return entry.id < value; });
+    if (it == table.end() || it->id != id) {
+        return nullptr;
+    }
+    return &*it;
+}
+
+} // namespace Resource
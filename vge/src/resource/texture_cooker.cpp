@@ -0,0 +1,420 @@
+#include "resource/texture_cooker.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstring>
+
+#include "../extern/stb_image.h"
+
+namespace Resource {
+
+namespace {
+
+constexpr std::array<U32, 16> Bc7Weights = { 0, 4, 9, 13, 17, 21, 26, 30, 34, 38, 43, 47, 51, 55,
+    60, 64 };
+
+const std::array<F32, 256>& srgb_to_linear_table() {
+    static const std::array<F32, 256> table = [] {
+        std::array<F32, 256> values {};
+        for (U32 i = 0; i < 256; ++i) {
+            const F32 c = static_cast<F32>(i) / 255.0f;
+            values[i] = c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+        }
+        return values;
+    }();
+    return table;
+}
+
+U8 to_unorm8(F32 value) {
+    return static_cast<U8>(std::lround(std::clamp(value, 0.0f, 1.0f) * 255.0f));
+}
+
+U8 linear_to_srgb(F32 c) {
+    c = std::clamp(c, 0.0f, 1.0f);
+    return to_unorm8(c <= 0.0031308f ? c * 12.92f : 1.055f * std::pow(c, 1.0f / 2.4f) - 0.055f);
+}
+
+// Averages each 2x2 footprint, an odd last row or column is folded into the
+// footprint before it.
+TextureData downsample(const TextureData& src, bool srgb, bool normalMap) {
+    const auto& toLinear = srgb_to_linear_table();
+
+    TextureData dst;
+    dst.width = std::max(src.width / 2, 1u);
+    dst.height = std::max(src.height / 2, 1u);
+    dst.pixels.resize(size_t(dst.width) * dst.height * 4);
+
+    for (U32 y = 0; y < dst.height; ++y) {
+        for (U32 x = 0; x < dst.width; ++x) {
+            const U32 x0 = std::min(x * 2, src.width - 1);
+            const U32 y0 = std::min(y * 2, src.height - 1);
+            const U32 x1 = std::min(x0 + 1, src.width - 1);
+            const U32 y1 = std::min(y0 + 1, src.height - 1);
+            const U8* taps[4] = {
+                &src.pixels[(size_t(y0) * src.width + x0) * 4],
+                &src.pixels[(size_t(y0) * src.width + x1) * 4],
+                &src.pixels[(size_t(y1) * src.width + x0) * 4],
+                &src.pixels[(size_t(y1) * src.width + x1) * 4],
+            };
+
+            std::array<F32, 4> sum {};
+            for (const U8* tap : taps) {
+                for (U32 c = 0; c < 4; ++c) {
+                    const F32 unorm = static_cast<F32>(tap[c]) / 255.0f;
+                    if (c == 3) {
+                        sum[c] += unorm;
+                    } else if (normalMap) {
+                        sum[c] += unorm * 2.0f - 1.0f;
+                    } else {
+                        sum[c] += srgb ? toLinear[tap[c]] : unorm;
+                    }
+                }
+            }
+
+            U8* out = &dst.pixels[(size_t(y) * dst.width + x) * 4];
+            if (normalMap) {
+                // the average of unit vectors is shorter than one
+                const F32 length
+                    = std::sqrt(sum[0] * sum[0] + sum[1] * sum[1] + sum[2] * sum[2]);
+                const F32 scale = length > 0.0f ? 1.0f / length : 0.0f;
+                for (U32 c = 0; c < 3; ++c) {
+                    out[c] = to_unorm8(sum[c] * scale * 0.5f + 0.5f);
+                }
+            } else {
+                for (U32 c = 0; c < 3; ++c) {
+                    out[c] = srgb ? linear_to_srgb(sum[c] / 4.0f) : to_unorm8(sum[c] / 4.0f);
+                }
+            }
+            out[3] = to_unorm8(sum[3] / 4.0f);
+        }
+    }
+    return dst;
+}
+
+// Little endian bit stream, the layout of every BCn block.
+struct BlockWriter {
+    std::array<U64, 2> bits {};
+    U32 position = 0;
+
+    void write(U32 value, U32 count) {
+        for (U32 i = 0; i < count; ++i, ++position) {
+            bits[position / 64] |= U64((value >> i) & 1) << (position % 64);
+        }
+    }
+};
+
+// BC7 mode 6 endpoint: 7 bits per channel and a p-bit shared by all four,
+// the decoder expands a channel to (c << 1) | p.
+struct Bc7Endpoint {
+    std::array<U32, 4> channels {};
+    U32 pbit = 0;
+
+    U32 expanded(U32 c) const { return (channels[c] << 1) | pbit; }
+};
+
+Bc7Endpoint quantize_endpoint(const std::array<F32, 4>& color) {
+    Bc7Endpoint best;
+    F32 bestError = INFINITY;
+    for (U32 pbit = 0; pbit < 2; ++pbit) {
+        Bc7Endpoint candidate;
+        candidate.pbit = pbit;
+        F32 error = 0.0f;
+        for (U32 c = 0; c < 4; ++c) {
+            const F32 value = std::clamp(color[c], 0.0f, 255.0f);
+            candidate.channels[c] = static_cast<U32>(
+                std::clamp(std::lround((value - static_cast<F32>(pbit)) / 2.0f), 0l, 127l));
+            const F32 delta = static_cast<F32>(candidate.expanded(c)) - value;
+            error += delta * delta;
+        }
+        if (error < bestError) {
+            bestError = error;
+            best = candidate;
+        }
+    }
+    return best;
+}
+
+// Picks the nearest palette entry for every texel, returns the total squared
+// error.
+U64 select_bc7_indices(const std::array<std::array<I32, 4>, 16>& texels, const Bc7Endpoint& e0,
+    const Bc7Endpoint& e1, std::array<U32, 16>& indices) {
+    std::array<std::array<I32, 4>, 16> palette;
+    for (U32 i = 0; i < 16; ++i) {
+        for (U32 c = 0; c < 4; ++c) {
+            palette[i][c] = static_cast<I32>(
+                ((64 - Bc7Weights[i]) * e0.expanded(c) + Bc7Weights[i] * e1.expanded(c) + 32) >> 6);
+        }
+    }
+
+    U64 total = 0;
+    for (U32 t = 0; t < 16; ++t) {
+        U64 best = UINT64_MAX;
+        for (U32 i = 0; i < 16; ++i) {
+            U64 error = 0;
+            for (U32 c = 0; c < 4; ++c) {
+                const I64 delta = texels[t][c] - palette[i][c];
+                error += static_cast<U64>(delta * delta);
+            }
+            if (error < best) {
+                best = error;
+                indices[t] = i;
+            }
+        }
+        total += best;
+    }
+    return total;
+}
+
+// Least squares endpoints for fixed indices, false if all texels picked the
+// same weight.
+bool refine_endpoints(const std::array<std::array<I32, 4>, 16>& texels,
+    const std::array<U32, 16>& indices, std::array<F32, 4>& e0, std::array<F32, 4>& e1) {
+    F32 aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    std::array<F32, 4> ax {}, bx {};
+    for (U32 t = 0; t < 16; ++t) {
+        const F32 b = static_cast<F32>(Bc7Weights[indices[t]]) / 64.0f;
+        const F32 a = 1.0f - b;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (U32 c = 0; c < 4; ++c) {
+            ax[c] += a * static_cast<F32>(texels[t][c]);
+            bx[c] += b * static_cast<F32>(texels[t][c]);
+        }
+    }
+
+    const F32 determinant = aa * bb - ab * ab;
+    if (std::abs(determinant) < 1e-6f) {
+        return false;
+    }
+    for (U32 c = 0; c < 4; ++c) {
+        e0[c] = (bb * ax[c] - ab * bx[c]) / determinant;
+        e1[c] = (aa * bx[c] - ab * ax[c]) / determinant;
+    }
+    return true;
+}
+
+void encode_bc4_block(std::span<const U8, 64> texels, U32 channel, U8* block) {
+    U32 lo = 255, hi = 0;
+    for (U32 t = 0; t < 16; ++t) {
+        lo = std::min<U32>(lo, texels[t * 4 + channel]);
+        hi = std::max<U32>(hi, texels[t * 4 + channel]);
+    }
+
+    // red0 > red1 selects the eight value palette, with red0 == red1 every
+    // texel picks index 0 and the palette does not matter
+    std::array<U32, 8> palette { hi, lo };
+    for (U32 i = 2; i < 8; ++i) {
+        palette[i] = ((8 - i) * hi + (i - 1) * lo + 3) / 7;
+    }
+
+    U64 indices = 0;
+    for (U32 t = 0; t < 16; ++t) {
+        const I32 value = texels[t * 4 + channel];
+        U32 best = 0;
+        for (U32 i = 1; i < 8; ++i) {
+            if (std::abs(value - static_cast<I32>(palette[i]))
+                < std::abs(value - static_cast<I32>(palette[best]))) {
+                best = i;
+            }
+        }
+        indices |= U64(best) << (t * 3);
+    }
+
+    block[0] = static_cast<U8>(hi);
+    block[1] = static_cast<U8>(lo);
+    for (U32 i = 0; i < 6; ++i) {
+        block[2 + i] = static_cast<U8>(indices >> (i * 8));
+    }
+}
+
+} // namespace
+
+TextureCookOptions cook_options(const TextureDescriptor& desc) {
+    TextureCookOptions options;
+    options.srgb = desc.format == TextureDescriptor::Format::SRGBA8
+        || desc.format == TextureDescriptor::Format::SRGB8;
+    options.normalMap = desc.usage == TextureDescriptor::Usage::Normal;
+    options.generateMipmaps = desc.generateMipmaps;
+    return options;
+}
+
+std::vector<TextureData> build_mip_chain(const TextureData& top, bool srgb, bool normalMap) {
+    std::vector<TextureData> chain;
+    chain.push_back(top);
+    while (chain.back().width > 1 || chain.back().height > 1) {
+        chain.push_back(downsample(chain.back(), srgb, normalMap));
+    }
+    return chain;
+}
+
+void encode_bc7_block(std::span<const U8, 64> texels, std::span<U8, 16> block) {
+    std::array<std::array<I32, 4>, 16> pixels;
+    std::array<F32, 4> mean {};
+    for (U32 t = 0; t < 16; ++t) {
+        for (U32 c = 0; c < 4; ++c) {
+            pixels[t][c] = texels[t * 4 + c];
+            mean[c] += static_cast<F32>(texels[t * 4 + c]) / 16.0f;
+        }
+    }
+
+    // principal axis of the block's colors by power iteration on the covariance
+    std::array<std::array<F32, 4>, 4> covariance {};
+    for (const auto& pixel : pixels) {
+        for (U32 i = 0; i < 4; ++i) {
+            for (U32 j = 0; j < 4; ++j) {
+                covariance[i][j] += (static_cast<F32>(pixel[i]) - mean[i])
+                    * (static_cast<F32>(pixel[j]) - mean[j]);
+            }
+        }
+    }
+    std::array<F32, 4> axis { 1.0f, 1.0f, 1.0f, 1.0f };
+    for (U32 iteration = 0; iteration < 8; ++iteration) {
+        std::array<F32, 4> next {};
+        for (U32 i = 0; i < 4; ++i) {
+            for (U32 j = 0; j < 4; ++j) {
+                next[i] += covariance[i][j] * axis[j];
+            }
+        }
+        const F32 length = std::sqrt(
+            next[0] * next[0] + next[1] * next[1] + next[2] * next[2] + next[3] * next[3]);
+        if (length < 1e-6f) {
+            axis = {}; // flat block, both endpoints are the mean
+            break;
+        }
+        for (U32 i = 0; i < 4; ++i) {
+            axis[i] = next[i] / length;
+        }
+    }
+
+    F32 tMin = 0.0f, tMax = 0.0f;
+    for (const auto& pixel : pixels) {
+        F32 t = 0.0f;
+        for (U32 c = 0; c < 4; ++c) {
+            t += (static_cast<F32>(pixel[c]) - mean[c]) * axis[c];
+        }
+        tMin = std::min(tMin, t);
+        tMax = std::max(tMax, t);
+    }
+
+    std::array<F32, 4> low, high;
+    for (U32 c = 0; c < 4; ++c) {
+        low[c] = mean[c] + tMin * axis[c];
+        high[c] = mean[c] + tMax * axis[c];
+    }
+
+    Bc7Endpoint e0 = quantize_endpoint(low);
+    Bc7Endpoint e1 = quantize_endpoint(high);
+    std::array<U32, 16> indices;
+    U64 error = select_bc7_indices(pixels, e0, e1, indices);
+
+    // one least squares pass on the chosen indices usually beats the box of
+    // the principal axis
+    if (error > 0 && refine_endpoints(pixels, indices, low, high)) {
+        const Bc7Endpoint r0 = quantize_endpoint(low);
+        const Bc7Endpoint r1 = quantize_endpoint(high);
+        std::array<U32, 16> refined;
+        if (const U64 refinedError = select_bc7_indices(pixels, r0, r1, refined);
+            refinedError < error) {
+            e0 = r0;
+            e1 = r1;
+            indices = refined;
+            error = refinedError;
+        }
+    }
+
+    // the first index is stored without its top bit, it has to be below 8
+    if (indices[0] >= 8) {
+        std::swap(e0, e1);
+        for (U32& index : indices) {
+            index = 15 - index;
+        }
+    }
+
+    BlockWriter writer;
+    writer.write(1 << 6, 7); // mode 6
+    for (U32 c = 0; c < 4; ++c) {
+        writer.write(e0.channels[c], 7);
+        writer.write(e1.channels[c], 7);
+    }
+    writer.write(e0.pbit, 1);
+    writer.write(e1.pbit, 1);
+    writer.write(indices[0], 3);
+    for (U32 t = 1; t < 16; ++t) {
+        writer.write(indices[t], 4);
+    }
+    std::memcpy(block.data(), writer.bits.data(), 16);
+}
+
+void encode_bc5_block(std::span<const U8, 64> texels, std::span<U8, 16> block) {
+    encode_bc4_block(texels, 0, block.data());
+    encode_bc4_block(texels, 1, block.data() + 8);
+}
+
+CookedTexture cook_texture(const TextureData& data, const TextureCookOptions& options) {
+    const std::vector<TextureData> chain = options.generateMipmaps
+        ? build_mip_chain(data, options.srgb, options.normalMap)
+        : std::vector<TextureData> { data };
+
+    CookedTexture cooked;
+    cooked.format = !options.compress ? PixelFormat::RGBA8
+        : options.normalMap           ? PixelFormat::BC5
+                                      : PixelFormat::BC7;
+    cooked.width = data.width;
+    cooked.height = data.height;
+
+    for (const TextureData& level : chain) {
+        TextureLevel& range = cooked.levels.emplace_back();
+        range.offset = (cooked.data.size() + TextureLevelAlignment - 1) & ~(TextureLevelAlignment - 1);
+        range.size = texture_level_size(cooked.format, level.width, level.height);
+        cooked.data.resize(range.offset + range.size);
+        U8* out = cooked.data.data() + range.offset;
+
+        if (cooked.format == PixelFormat::RGBA8) {
+            std::memcpy(out, level.pixels.data(), range.size);
+            continue;
+        }
+
+        // partial blocks at the right and bottom edge repeat the last texel
+        const U32 blocksX = (level.width + 3) / 4;
+        const U32 blocksY = (level.height + 3) / 4;
+        std::array<U8, 64> texels;
+        for (U32 by = 0; by < blocksY; ++by) {
+            for (U32 bx = 0; bx < blocksX; ++bx) {
+                for (U32 t = 0; t < 16; ++t) {
+                    const U32 x = std::min(bx * 4 + t % 4, level.width - 1);
+                    const U32 y = std::min(by * 4 + t / 4, level.height - 1);
+                    std::memcpy(&texels[t * 4], &level.pixels[(size_t(y) * level.width + x) * 4], 4);
+                }
+                const std::span<U8, 16> block(out + (size_t(by) * blocksX + bx) * 16, 16);
+                if (cooked.format == PixelFormat::BC5) {
+                    encode_bc5_block(texels, block);
+                } else {
+                    encode_bc7_block(texels, block);
+                }
+            }
+        }
+    }
+    return cooked;
+}
+
+bool cook_texture_file(
+    const fs::path& source, const TextureCookOptions& options, CookedTexture& out) {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load(source.string().c_str(), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        return false;
+    }
+
+    TextureData data;
+    data.width = static_cast<U32>(width);
+    data.height = static_cast<U32>(height);
+    data.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+
+    out = cook_texture(data, options);
+    return true;
+}
+
+} // namespace Resource
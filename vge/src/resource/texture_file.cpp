@@ -0,0 +1,139 @@
+#include "resource/texture_file.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <fstream>
+#include <system_error>
+
+#include "core/logger.hpp"
+
+namespace Resource {
+
+static_assert(std::endian::native == std::endian::little, ".vgetex files are little endian");
+
+static U64 align_up(U64 offset) {
+    return (offset + TextureFileAlignment - 1) & ~(TextureFileAlignment - 1);
+}
+
+fs::path cooked_texture_path(const fs::path& source) {
+    fs::path cooked = source;
+    cooked += ".vgetex";
+    return cooked;
+}
+
+bool write_texture_file(
+    const fs::path& path, const TextureImage& image, U32 flags, U64 sourceHash) {
+    TextureFileHeader header;
+    header.sourceHash = sourceHash;
+    header.format = image.format;
+    header.flags = flags;
+    header.width = image.width;
+    header.height = image.height;
+    header.levelCount = static_cast<U32>(image.levels.size());
+    header.levelsOffset = align_up(sizeof(TextureFileHeader));
+    header.dataOffset = align_up(header.levelsOffset + image.levels.size_bytes());
+    header.dataSize = image.data.size();
+
+    fs::path temporary = path;
+    temporary += ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) {
+            CORE_LOG_ERROR("[TextureFile]: Failed to create {}", temporary.string());
+            return false;
+        }
+
+        U64 written = 0;
+        auto write_at = [&](U64 offset, const void* bytes, U64 size) {
+            for (; written < offset; written++) {
+                file.put('\0');
+            }
+            file.write(static_cast<const char*>(bytes), static_cast<std::streamsize>(size));
+            written += size;
+        };
+
+        write_at(0, &header, sizeof(header));
+        write_at(header.levelsOffset, image.levels.data(), image.levels.size_bytes());
+        write_at(header.dataOffset, image.data.data(), image.data.size());
+
+        if (!file) {
+            CORE_LOG_ERROR("[TextureFile]: Failed to write {}", temporary.string());
+            return false;
+        }
+    }
+
+    std::error_code error;
+    fs::rename(temporary, path, error);
+    if (error) {
+        CORE_LOG_ERROR("[TextureFile]: Failed to write {}: {}", path.string(), error.message());
+        fs::remove(temporary, error);
+        return false;
+    }
+    return true;
+}
+
+bool TextureFile::open(const fs::path& path) {
+    return open(VfsFile::map(path));
+}
+
+bool TextureFile::open(VfsFile file) {
+    m_File = std::move(file);
+    if (!m_File.is_open()) {
+        return false;
+    }
+
+    const U64 size = m_File.size();
+    const bool valid = [&] {
+        if (size < sizeof(TextureFileHeader)) {
+            return false;
+        }
+        const TextureFileHeader& h = header();
+        if (h.magic != TextureFileMagic || h.version != TextureFileVersion) {
+            return false;
+        }
+        if (h.format > PixelFormat::BC5 || h.width == 0 || h.height == 0 || h.levelCount == 0
+            || h.levelCount > 32) {
+            return false;
+        }
+        if (h.levelsOffset % alignof(TextureLevel) != 0 || h.levelsOffset > size
+            || h.levelCount > (size - h.levelsOffset) / sizeof(TextureLevel)
+            || h.dataOffset % TextureLevelAlignment != 0 || h.dataOffset > size
+            || h.dataSize > size - h.dataOffset) {
+            return false;
+        }
+
+        // every level has to be as large as its format and size say, the
+        // backend copies them without further checks
+        const auto* levels = reinterpret_cast<const TextureLevel*>(m_File.data() + h.levelsOffset);
+        for (U32 i = 0; i < h.levelCount; ++i) {
+            const U32 width = std::max(h.width >> i, 1u);
+            const U32 height = std::max(h.height >> i, 1u);
+            if (levels[i].offset % TextureLevelAlignment != 0 || levels[i].offset > h.dataSize
+                || levels[i].size > h.dataSize - levels[i].offset
+                || levels[i].size != texture_level_size(h.format, width, height)) {
+                return false;
+            }
+        }
+        return true;
+    }();
+
+    if (!valid) {
+        m_File.close();
+        return false;
+    }
+    return true;
+}
+
+TextureImage TextureFile::image() const {
+    const TextureFileHeader& h = header();
+    TextureImage image;
+    image.format = h.format;
+    image.width = h.width;
+    image.height = h.height;
+    image.data = { reinterpret_cast<const U8*>(m_File.data() + h.dataOffset), h.dataSize };
+    image.levels
+        = { reinterpret_cast<const TextureLevel*>(m_File.data() + h.levelsOffset), h.levelCount };
+    return image;
+}
+
+} // namespace Resource
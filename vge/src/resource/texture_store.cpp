@@ -0,0 +1,574 @@
+#include "resource/texture_store.hpp"
+
+#include <algorithm>
+#include <thread>
+#include <utility>
+
+#include "resource/texture_cooker.hpp"
+#include "resource/vfs.hpp"
+#include "core/hash.hpp"
+#include "core/logger.hpp"
+#include "core/timer.hpp"
+
+#define STB_IMAGE_IMPLEMENTATION
+#include "../extern/stb_image.h"
+
+namespace Resource {
+
+// Only what changes the GPU image is part of the key, sampler state is not.
+static U64 descriptor_key(const TextureDescriptor& desc) {
+    U64 key = Core::hash_combine(Core::hash_u64(static_cast<U64>(desc.format)), desc.generateMipmaps);
+    return Core::hash_combine(key, static_cast<U64>(desc.usage));
+}
+
+static TextureImage single_level(const TextureData& data, const TextureLevel& level) {
+    return { PixelFormat::RGBA8, data.width, data.height, data.pixels, { &level, 1 } };
+}
+
+// Without mipmaps only the top level of a cooked file is uploaded.
+static TextureImage cooked_image(const TextureFile& file, const TextureDescriptor& desc) {
+    TextureImage image = file.image();
+    if (!desc.generateMipmaps) {
+        image.levels = image.levels.first(1);
+    }
+    return image;
+}
+
+static bool decode_rgba8(std::span<const std::byte> bytes, TextureData& data) {
+    int width, height, channels;
+    stbi_uc* pixels = stbi_load_from_memory(reinterpret_cast<const stbi_uc*>(bytes.data()),
+        static_cast<int>(bytes.size()), &width, &height, &channels, STBI_rgb_alpha);
+    if (!pixels) {
+        return false;
+    }
+
+    data.width = static_cast<U32>(width);
+    data.height = static_cast<U32>(height);
+    data.pixels.assign(pixels, pixels + static_cast<size_t>(width) * height * 4);
+    stbi_image_free(pixels);
+    return true;
+}
+
+TextureStore::TextureStore(TextureBackend& backend, U64 vramBudget)
+    : r_Backend(backend)
+    , m_VramBudget(vramBudget) { }
+
+TextureStore::~TextureStore() {
+    // decode jobs still running push into m_Decoded, keep it drained until they are done
+    DecodedTexture discarded;
+    while (m_LoadsInFlight.load(std::memory_order_acquire) > 0) {
+        while (m_Decoded.try_pop(discarded)) { }
+        std::this_thread::yield();
+    }
+    clear();
+}
+
+std::string TextureStore::normalize_path(const fs::path& path) {
+    return normalize_asset_path(path);
+}
+
+TextureHandle TextureStore::acquire(const fs::path& path, const TextureDescriptor& desc) {
+    std::string key = normalize_path(path);
+    const U64 descriptorKey = descriptor_key(desc);
+
+    if (TextureHandle h = find_path(key, descriptorKey)) {
+        return reuse(h, std::move(key));
+    }
+
+    VfsFile source;
+    TextureFile cooked;
+    U64 sourceHash = 0;
+    if (!open_source(key, desc, source, cooked, sourceHash)) {
+        CORE_LOG_WARN("[TextureStore]: Failed to read texture {}", key);
+        return {};
+    }
+
+    // same image under another path, a cooked file is keyed like its source
+    const U64 contentKey = Core::hash_combine(sourceHash, descriptorKey);
+    if (auto it = m_ByContent.find(contentKey); it != m_ByContent.end()) {
+        return reuse(it->second, std::move(key));
+    }
+
+    if (cooked.is_open()) {
+        return upload(cooked_image(cooked, desc), desc, contentKey, descriptorKey, std::move(key));
+    }
+
+    TextureData data;
+    if (!decode_rgba8(source.bytes(), data)) {
+        CORE_LOG_WARN("[TextureStore]: Failed to decode texture {}: {}", key, stbi_failure_reason());
+        return {};
+    }
+
+    const TextureLevel level { 0, data.pixels.size() };
+    return upload(single_level(data, level), desc, contentKey, descriptorKey, std::move(key));
+}
+
+TextureHandle TextureStore::acquire(
+    std::string_view name, const TextureData& data, const TextureDescriptor& desc) {
+    std::string key(name);
+    const U64 descriptorKey = descriptor_key(desc);
+
+    if (TextureHandle h = find_path(key, descriptorKey)) {
+        return reuse(h, std::move(key));
+    }
+
+    U64 contentKey = Core::hash_bytes(data.pixels.data(), data.pixels.size());
+    contentKey = Core::hash_combine(contentKey, (static_cast<U64>(data.width) << 32) | data.height);
+    contentKey = Core::hash_combine(contentKey, descriptorKey);
+    if (auto it = m_ByContent.find(contentKey); it != m_ByContent.end()) {
+        return reuse(it->second, std::move(key));
+    }
+
+    const TextureLevel level { 0, data.pixels.size() };
+    return upload(single_level(data, level), desc, contentKey, descriptorKey, std::move(key));
+}
+
+TextureHandle TextureStore::acquire_async(
+    Core::JobPool& jobs, const fs::path& path, const TextureDescriptor& desc) {
+    std::string key = normalize_path(path);
+    const U64 descriptorKey = descriptor_key(desc);
+
+    if (TextureHandle h = find_path(key, descriptorKey)) {
+        return reuse(h, std::move(key));
+    }
+
+    const TextureHandle h { m_Textures.emplace() };
+    Texture& tex = *texture(h);
+    tex.refCount = 1;
+    tex.desc = desc;
+    tex.descriptorKey = descriptorKey;
+    tex.state = LoadState::Loading;
+    if (const Texture* placeholder = get(m_Placeholder)) {
+        tex.gpu = { placeholder->gpu.texture, placeholder->gpu.mipLevels, 0 };
+        tex.width = placeholder->width;
+        tex.height = placeholder->height;
+    }
+
+    m_ByPath.try_emplace(key, h);
+    tex.paths.push_back(key);
+
+    kick_load(jobs, h, desc, std::move(key), 0, false);
+    return h;
+}
+
+void TextureStore::acquire_all(Core::JobPool& jobs, std::span<const std::string> paths,
+    std::span<TextureHandle> out, const TextureDescriptor& desc) {
+    Core::Timer timer;
+    timer.start();
+
+    // one decode job per texture, paths already loaded or loading share it
+    std::vector<TextureHandle> loading;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        out[i] = acquire_async(jobs, paths[i], desc);
+        if (get(out[i])->state == LoadState::Loading
+            && std::find(loading.begin(), loading.end(), out[i]) == loading.end()) {
+            loading.push_back(out[i]);
+        }
+    }
+
+    auto still_loading = [&] {
+        return std::any_of(loading.begin(), loading.end(), [&](TextureHandle h) {
+            const Texture* tex = get(h);
+            return tex && tex->state == LoadState::Loading;
+        });
+    };
+
+    // upload each texture as its decode finishes, while the workers decode the rest
+    F64 decodeMs = 0;
+    DecodedTexture result;
+    while (still_loading()) {
+        if (!m_Decoded.try_pop(result)) {
+            std::this_thread::yield();
+            continue;
+        }
+        const bool ours = !result.reload
+            && std::find(loading.begin(), loading.end(), result.handle) != loading.end();
+        if (ours) {
+            decodeMs += result.decodeMs;
+        }
+        // a load somebody else started is still reported by poll_loads()
+        if (finish_load(result) && !ours) {
+            list_ready(result, m_Uploaded);
+        }
+    }
+
+    const size_t loaded = std::count_if(loading.begin(), loading.end(),
+        [&](TextureHandle h) { return get(h)->state == LoadState::Ready; });
+
+    // failures are null like for acquire(), and a later acquire tries again
+    for (TextureHandle& h : out) {
+        if (const Texture* tex = get(h); tex && tex->state == LoadState::Failed) {
+            release(std::exchange(h, {}));
+        }
+    }
+    for (TextureHandle h : loading) {
+        if (const Texture* tex = get(h); tex && tex->state == LoadState::Failed && tex->refCount == 0) {
+            evict(h);
+        }
+    }
+    evict_to_budget();
+
+    if (!loading.empty()) {
+        // the decode times add up to what loading them one after another costs
+        CORE_LOG_INFO("[TextureStore]: Loaded {} textures in {:.2f} ms, {:.2f} ms serially",
+            loaded, timer.stop<Core::Timer::Milliseconds>(), decodeMs);
+    }
+}
+
+size_t TextureStore::reload(Core::JobPool& jobs, const fs::path& path) {
+    const std::string key = normalize_path(path);
+    // a texture cooked again is swapped in even though its source did not change
+    const bool recooked = fs::path(key).extension() == ".vgetex";
+    const std::string source = recooked ? fs::path(key).replace_extension().generic_string() : key;
+
+    size_t reloading = 0;
+    for (const auto& [contentKey, h] : m_ByContent) {
+        const Texture& tex = *get(h);
+        auto loadedFrom = std::find_if(tex.paths.begin(), tex.paths.end(),
+            [&](const std::string& p) { return p == key || p == source; });
+        if (tex.state != LoadState::Ready || loadedFrom == tex.paths.end()) {
+            continue;
+        }
+        kick_load(jobs, h, tex.desc, *loadedFrom, recooked ? 0 : tex.contentKey, true);
+        reloading++;
+    }
+    return reloading;
+}
+
+size_t TextureStore::poll_loads(std::vector<TextureHandle>& ready, size_t maxUploads) {
+    size_t uploaded = 0;
+    for (TextureHandle h : std::exchange(m_Uploaded, {})) {
+        if (get(h)) {
+            ready.push_back(h);
+            uploaded++;
+        }
+    }
+
+    DecodedTexture result;
+    while (uploaded < maxUploads && m_Decoded.try_pop(result)) {
+        if (finish_load(result)) {
+            list_ready(result, ready);
+            uploaded++;
+        }
+    }
+
+    evict_to_budget();
+    return uploaded;
+}
+
+void TextureStore::set_placeholder(TextureHandle texture) {
+    if (m_Placeholder && get(m_Placeholder)) {
+        release(m_Placeholder);
+    }
+    m_Placeholder = texture;
+}
+
+void TextureStore::add_ref(TextureHandle h) {
+    h = resolve(h);
+    Texture* tex = texture(h);
+    if (!tex) {
+        CORE_LOG_WARN("[TextureStore]: Handle is invalid or outdated.");
+        return;
+    }
+    if (tex->refCount++ == 0) {
+        lru_unlink(h);
+    }
+}
+
+void TextureStore::release(TextureHandle h) {
+    h = resolve(h);
+    Texture* tex = texture(h);
+    if (!tex || tex->refCount == 0) {
+        CORE_LOG_WARN("[TextureStore]: Releasing an invalid or unreferenced texture.");
+        return;
+    }
+    if (--tex->refCount == 0) {
+        lru_push_front(h);
+        evict_to_budget();
+    }
+}
+
+void TextureStore::set_vram_budget(U64 bytes) {
+    m_VramBudget = bytes;
+    evict_to_budget();
+}
+
+void TextureStore::evict_unused() {
+    while (m_LruTail) {
+        evict(m_LruTail);
+    }
+}
+
+void TextureStore::clear() {
+    // textures still loading have no content key yet, and a texture may be
+    // listed under several paths
+    std::vector<TextureHandle> all;
+    all.reserve(m_ByContent.size() + m_ByPath.size());
+    for (const auto& [key, h] : m_ByContent) {
+        all.push_back(h);
+    }
+    for (const auto& [path, h] : m_ByPath) {
+        all.push_back(h);
+    }
+    for (TextureHandle h : all) {
+        if (get(h)) {
+            evict(h);
+        }
+    }
+    m_Placeholder = {};
+}
+
+bool TextureStore::finish_load(DecodedTexture& result) {
+    // released and evicted while decoding, a reload only replaces a loaded image
+    Texture* tex = texture(result.handle);
+    if (!tex || tex->state != (result.reload ? LoadState::Ready : LoadState::Loading)) {
+        return false;
+    }
+    if (!result.decoded) {
+        if (!result.reload) {
+            tex->state = LoadState::Failed;
+        }
+        return false; // a failed or unchanged reload keeps the current image
+    }
+
+    // loaded under another path already, the pixels are dropped instead of uploaded
+    if (auto it = m_ByContent.find(result.contentKey); !result.reload && it != m_ByContent.end()) {
+        merge_into(result.handle, it->second);
+        return true;
+    }
+
+    if (result.reload) {
+        // frames in flight may still sample the old image, the backend defers its destruction
+        r_Backend.release_texture(tex->gpu.texture);
+        m_VramUsage -= tex->gpu.vramBytes;
+        if (auto it = m_ByContent.find(tex->contentKey);
+            it != m_ByContent.end() && it->second == result.handle) {
+            m_ByContent.erase(it);
+        }
+    }
+
+    const TextureLevel level { 0, result.data.pixels.size() };
+    const TextureImage image = result.cooked.is_open() ? cooked_image(result.cooked, result.desc)
+                                                       : single_level(result.data, level);
+    tex->gpu = r_Backend.upload_texture(image, result.desc);
+    tex->width = image.width;
+    tex->height = image.height;
+    tex->contentKey = result.contentKey;
+    tex->state = LoadState::Ready;
+    m_ByContent.try_emplace(result.contentKey, result.handle);
+    m_VramUsage += tex->gpu.vramBytes;
+    return true;
+}
+
+TextureHandle TextureStore::find_path(const std::string& path, U64 descriptorKey) const {
+    auto it = m_ByPath.find(path);
+    if (it == m_ByPath.end() || get(it->second)->descriptorKey != descriptorKey) {
+        return {};
+    }
+    return it->second;
+}
+
+void TextureStore::merge_into(TextureHandle alias, TextureHandle target) {
+    Texture& from = *texture(alias);
+    Texture& to = *texture(target);
+    if (from.refCount == 0) {
+        lru_unlink(alias); // released while loading
+    } else if (to.refCount == 0) {
+        lru_unlink(target);
+    }
+    to.refCount += from.refCount;
+
+    // the paths keep returning the alias, so acquiring one again hands out the same handle
+    for (std::string& path : from.paths) {
+        if (std::find(to.paths.begin(), to.paths.end(), path) == to.paths.end()) {
+            to.paths.push_back(std::move(path));
+        }
+    }
+
+    // its users may still hold the handle, it keeps resolving until target is evicted
+    to.aliases.push_back(alias);
+    m_Textures.free(alias.handle());
+    m_Aliases.try_emplace(alias, target);
+}
+
+void TextureStore::list_ready(
+    const DecodedTexture& result, std::vector<TextureHandle>& ready) const {
+    ready.push_back(result.handle);
+    if (result.reload) {
+        const std::vector<TextureHandle>& aliases = get(result.handle)->aliases;
+        ready.insert(ready.end(), aliases.begin(), aliases.end());
+    }
+}
+
+TextureHandle TextureStore::reuse(TextureHandle h, std::string path) {
+    add_ref(h);
+
+    Texture* tex = texture(h);
+    if (std::find(tex->paths.begin(), tex->paths.end(), path) == tex->paths.end()) {
+        m_ByPath.try_emplace(path, h);
+        tex->paths.push_back(std::move(path));
+    }
+    return h;
+}
+
+TextureHandle TextureStore::upload(const TextureImage& image, const TextureDescriptor& desc,
+    U64 contentKey, U64 descriptorKey, std::string path) {
+    const GpuTextureInfo gpu = r_Backend.upload_texture(image, desc);
+
+    const TextureHandle h { m_Textures.emplace() };
+    Texture& tex = *texture(h);
+    tex.gpu = gpu;
+    tex.width = image.width;
+    tex.height = image.height;
+    tex.refCount = 1;
+    tex.contentKey = contentKey;
+    tex.desc = desc;
+    tex.descriptorKey = descriptorKey;
+
+    m_ByContent.try_emplace(contentKey, h);
+    m_ByPath.try_emplace(path, h);
+    tex.paths.push_back(std::move(path));
+
+    m_VramUsage += gpu.vramBytes;
+    evict_to_budget();
+    if (m_VramUsage > m_VramBudget) {
+        CORE_LOG_WARN("[TextureStore]: {} bytes of referenced textures exceed the budget of {}",
+            m_VramUsage, m_VramBudget);
+    }
+
+    return h;
+}
+
+void TextureStore::kick_load(Core::JobPool& jobs, TextureHandle h, const TextureDescriptor& desc,
+    std::string path, U64 unchangedKey, bool reload) {
+    jobs.kickJob(
+        [this, h, desc, unchangedKey, reload, key = std::move(path)] {
+            Core::Timer timer;
+            timer.start();
+
+            DecodedTexture result;
+            result.handle = h;
+            result.desc = desc;
+            result.reload = reload;
+
+            VfsFile source;
+            U64 sourceHash = 0;
+            const bool opened = open_source(key, desc, source, result.cooked, sourceHash);
+            result.contentKey = Core::hash_combine(sourceHash, descriptor_key(desc));
+            // saved without changes, or the cooked file written for a source that did not change
+            const bool unchanged = opened && result.contentKey == unchangedKey;
+            if (opened && !unchanged) {
+                result.decoded = result.cooked.is_open() || decode_rgba8(source.bytes(), result.data);
+            }
+            if (!result.decoded && !unchanged) {
+                CORE_LOG_WARN("[TextureStore]: Failed to load texture {}", key);
+            }
+            result.decodeMs = timer.stop<Core::Timer::Milliseconds>();
+
+            // the owner drains the queue every frame, a full queue only stalls this worker
+            while (!m_Decoded.try_push(std::move(result))) {
+                std::this_thread::yield();
+            }
+        },
+        &m_LoadsInFlight);
+}
+
+bool TextureStore::open_source(const std::string& path, const TextureDescriptor& desc,
+    VfsFile& source, TextureFile& cooked, U64& sourceHash) const {
+    if (fs::path(path).extension() != ".vgetex") {
+        source = open_file(m_Vfs, path);
+    }
+    if (source.is_open()) {
+        sourceHash = Core::hash_bytes(source.data(), source.size());
+        open_cooked(cooked_texture_path(path), sourceHash, desc, cooked);
+        return true;
+    }
+
+    // a .vgetex named directly, or a pack that ships the cooked file without its source
+    const fs::path cookedPath
+        = fs::path(path).extension() == ".vgetex" ? fs::path(path) : cooked_texture_path(path);
+    if (!open_cooked(cookedPath, 0, desc, cooked)) {
+        return false;
+    }
+    sourceHash = cooked.source_hash();
+    return true;
+}
+
+bool TextureStore::open_cooked(const fs::path& cookedPath, U64 sourceHash,
+    const TextureDescriptor& desc, TextureFile& file) const {
+    if (!file.open(open_file(m_Vfs, cookedPath))) {
+        return false;
+    }
+
+    const TextureCookOptions options = cook_options(desc);
+    if ((sourceHash != 0 && file.source_hash() != sourceHash) || file.srgb() != options.srgb
+        || file.normal_map() != options.normalMap || !r_Backend.supports_format(file.format())) {
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+void TextureStore::evict(TextureHandle h) {
+    h = resolve(h);
+    Texture& tex = *texture(h);
+    if (tex.refCount == 0) {
+        lru_unlink(h);
+    }
+
+    for (const std::string& path : tex.paths) {
+        // the path may resolve to a texture with another descriptor
+        if (auto it = m_ByPath.find(path); it != m_ByPath.end() && resolve(it->second) == h) {
+            m_ByPath.erase(it);
+        }
+    }
+    if (auto it = m_ByContent.find(tex.contentKey); it != m_ByContent.end() && it->second == h) {
+        m_ByContent.erase(it);
+    }
+    for (TextureHandle alias : tex.aliases) {
+        m_Aliases.erase(alias);
+    }
+
+    // a texture that never finished loading borrows the placeholder's image
+    if (tex.state == LoadState::Ready) {
+        r_Backend.release_texture(tex.gpu.texture);
+        m_VramUsage -= tex.gpu.vramBytes;
+    }
+    m_Textures.free(h.handle());
+}
+
+void TextureStore::evict_to_budget() {
+    while (m_VramUsage > m_VramBudget && m_LruTail) {
+        evict(m_LruTail);
+    }
+}
+
+void TextureStore::lru_push_front(TextureHandle h) {
+    Texture& tex = *texture(h);
+    tex.lruPrev = {};
+    tex.lruNext = m_LruHead;
+    if (m_LruHead) {
+        texture(m_LruHead)->lruPrev = h;
+    } else {
+        m_LruTail = h;
+    }
+    m_LruHead = h;
+}
+
+void TextureStore::lru_unlink(TextureHandle h) {
+    Texture& tex = *texture(h);
+    if (tex.lruPrev) {
+        texture(tex.lruPrev)->lruNext = tex.lruNext;
+    } else {
+        m_LruHead = tex.lruNext;
+    }
+    if (tex.lruNext) {
+        texture(tex.lruNext)->lruPrev = tex.lruPrev;
+    } else {
+        m_LruTail = tex.lruPrev;
+    }
+    tex.lruPrev = {};
+    tex.lruNext = {};
+}
+
+} // namespace Resource
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <array>
+
+#include "defines.hpp"
+
+namespace Resource {
+
+// The little vector math the mesh processing needs, on the plain arrays
+// MeshVertex stores so asset code stays free of glm.
+using Vec3 = std::array<F32, 3>;
+
+inline Vec3 operator-(const Vec3& a, const Vec3& b) {
+    return { a[0] - b[0], a[1] - b[1], a[2] - b[2] };
+}
+
+inline Vec3 cross(const Vec3& a, const Vec3& b) {
+    return { a[1] * b[2] - a[2] * b[1], a[2] * b[0] - a[0] * b[2], a[0] * b[1] - a[1] * b[0] };
+}
+
+inline F32 dot(const Vec3& a, const Vec3& b) { return a[0] * b[0] + a[1] * b[1] + a[2] * b[2]; }
+
+} // namespace Resource
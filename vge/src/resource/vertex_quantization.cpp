@@ -0,0 +1,289 @@
+#include "resource/vertex_quantization.hpp"
+
+#include <algorithm>
+#include <bit>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define VGE_QUANTIZE_SSE2 1
+#endif
+
+#include "resource/vec3_math.hpp"
+#include "core/concurrency/job_system.hpp"
+
+namespace Resource {
+
+namespace {
+
+// Bit patterns of the half conversion: the first float past the half range,
+// the float infinity, the smallest float that is a normal half, and the float
+// whose addition leaves a subnormal half rounded in the low mantissa bits.
+constexpr U32 F16Overflow = (127u + 16u) << 23;
+constexpr U32 F32Infinity = 255u << 23;
+constexpr U32 F16MinNormal = (127u - 14u) << 23;
+constexpr U32 F16SubnormalMagic = ((127u - 15u) + (23u - 10u) + 1u) << 23;
+// rebiases the exponent from float to half, with the rounding bias below the kept mantissa
+constexpr U32 F16Rebias = ((15u - 127u) << 23) + 0xFFFu;
+
+constexpr U16 MaxUnorm16 = 0xFFFF;
+
+#if defined(VGE_QUANTIZE_SSE2)
+
+__m128i select(__m128i mask, __m128i a, __m128i b) {
+    return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+}
+
+// f32_to_f16() on four lanes, the halves in the low 16 bits of each.
+__m128i f32_to_f16_sse2(__m128 value) {
+    const __m128i bits = _mm_castps_si128(value);
+    const __m128i sign = _mm_and_si128(bits, _mm_set1_epi32(static_cast<I32>(0x80000000u)));
+    const __m128i magnitude = _mm_xor_si128(bits, sign);
+
+    const __m128i odd = _mm_and_si128(_mm_srli_epi32(magnitude, 13), _mm_set1_epi32(1));
+    const __m128i normal = _mm_srli_epi32(
+        _mm_add_epi32(_mm_add_epi32(magnitude, _mm_set1_epi32(static_cast<I32>(F16Rebias))), odd),
+        13);
+
+    const __m128 magic = _mm_castsi128_ps(_mm_set1_epi32(static_cast<I32>(F16SubnormalMagic)));
+    const __m128i subnormal = _mm_sub_epi32(
+        _mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(magnitude), magic)), _mm_castps_si128(magic));
+
+    const __m128i nan = _mm_cmpgt_epi32(magnitude, _mm_set1_epi32(static_cast<I32>(F32Infinity)));
+    const __m128i special = _mm_or_si128(
+        _mm_set1_epi32(0x7C00), _mm_and_si128(nan, _mm_set1_epi32(0x0200)));
+
+    // the magnitude has no sign bit left, signed compares order it correctly
+    __m128i half = select(
+        _mm_cmplt_epi32(magnitude, _mm_set1_epi32(static_cast<I32>(F16MinNormal))), subnormal,
+        normal);
+    half = select(_mm_cmpgt_epi32(magnitude, _mm_set1_epi32(static_cast<I32>(F16Overflow - 1))),
+        special, half);
+    return _mm_or_si128(half, _mm_srli_epi32(sign, 16));
+}
+
+// Four lanes of 0 to 0xFFFF into the low four U16 of the result. SSE2 only
+// packs with signed saturation, sign extending first keeps the bits as they are.
+__m128i pack_u16(__m128i value) {
+    const __m128i extended = _mm_srai_epi32(_mm_slli_epi32(value, 16), 16);
+    return _mm_packs_epi32(extended, extended);
+}
+
+#endif
+
+// Quantizes the positions of vertices to unorm16 into out:
+// (position - offset) * scale, with scale mapping the bounds to 0 to 65535.
+void quantize_positions(std::span<const MeshVertex> vertices, const Vec3& offset,
+    const Vec3& scale, std::span<CompactVertex> out) {
+#if defined(VGE_QUANTIZE_SSE2)
+    const __m128 lanes = _mm_castsi128_ps(_mm_setr_epi32(-1, -1, -1, 0));
+    const __m128 o = _mm_setr_ps(offset[0], offset[1], offset[2], 0.0f);
+    const __m128 s = _mm_setr_ps(scale[0], scale[1], scale[2], 0.0f);
+    const __m128 max = _mm_set1_ps(F32(MaxUnorm16));
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        // the fourth lane loads the red of the color, masked off to give w = 0
+        const __m128 p = _mm_and_ps(_mm_loadu_ps(vertices[i].position.data()), lanes);
+        const __m128 q
+            = _mm_min_ps(_mm_max_ps(_mm_mul_ps(_mm_sub_ps(p, o), s), _mm_setzero_ps()), max);
+        _mm_storel_epi64(
+            reinterpret_cast<__m128i*>(out[i].position.data()), pack_u16(_mm_cvtps_epi32(q)));
+    }
+#else
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        for (U32 k = 0; k < 3; ++k) {
+            const F32 q = (vertices[i].position[k] - offset[k]) * scale[k];
+            out[i].position[k]
+                = static_cast<U16>(std::nearbyint(std::clamp(q, 0.0f, F32(MaxUnorm16))));
+        }
+        out[i].position[3] = 0;
+    }
+#endif
+}
+
+VertexColor pack_color(const std::array<F32, 3>& color) {
+    VertexColor packed { 0, 0, 0, 0xFF };
+    for (U32 k = 0; k < 3; ++k) {
+        packed[k] = static_cast<U8>(std::clamp(color[k], 0.0f, 1.0f) * 255.0f + 0.5f);
+    }
+    return packed;
+}
+
+constexpr VertexColor White { 0xFF, 0xFF, 0xFF, 0xFF };
+
+void compact_mesh(const GeometryView& geometry, size_t meshIndex, CompactGeometry& out) {
+    const MeshRange& range = geometry.meshes[meshIndex];
+    const std::span<const MeshVertex> vertices
+        = geometry.vertices.subspan(range.vertexOffset, range.vertexCount);
+    const std::span<CompactVertex> compact
+        = std::span(out.vertices).subspan(range.vertexOffset, range.vertexCount);
+    if (vertices.empty()) {
+        return;
+    }
+
+    Vec3 min = vertices[0].position;
+    Vec3 max = min;
+    for (const MeshVertex& vertex : vertices) {
+        for (U32 k = 0; k < 3; ++k) {
+            min[k] = std::min(min[k], vertex.position[k]);
+            max[k] = std::max(max[k], vertex.position[k]);
+        }
+    }
+    // a mesh flat along an axis quantizes it to 0, any scale gets that back
+    VertexQuantization& quantization = out.meshes[meshIndex];
+    Vec3 toUnorm {};
+    for (U32 k = 0; k < 3; ++k) {
+        const F32 extent = max[k] - min[k];
+        quantization.offset[k] = min[k];
+        quantization.scale[k] = extent > 0.0f ? extent : 1.0f;
+        toUnorm[k] = extent > 0.0f ? F32(MaxUnorm16) / extent : 0.0f;
+    }
+    quantize_positions(vertices, min, toUnorm, compact);
+
+    std::vector<F32> texCoords(vertices.size() * 2);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        texCoords[i * 2] = vertices[i].texCoord[0];
+        texCoords[i * 2 + 1] = vertices[i].texCoord[1];
+    }
+    std::vector<U16> halves(texCoords.size());
+    f32_to_f16(texCoords, halves);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        compact[i].texCoord = { halves[i * 2], halves[i * 2 + 1] };
+    }
+
+    // cross products are twice the area of their triangle, larger ones weigh more
+    std::vector<Vec3> normals(vertices.size(), Vec3 {});
+    const std::span<const U32> indices
+        = geometry.indices.subspan(range.firstIndex, range.indexCount);
+    for (size_t i = 0; i + 2 < indices.size(); i += 3) {
+        const U32 a = indices[i];
+        const U32 b = indices[i + 1];
+        const U32 c = indices[i + 2];
+        if (a >= vertices.size() || b >= vertices.size() || c >= vertices.size()) {
+            continue;
+        }
+        const Vec3 n = cross(vertices[b].position - vertices[a].position,
+            vertices[c].position - vertices[a].position);
+        for (U32 v : { a, b, c }) {
+            for (U32 k = 0; k < 3; ++k) {
+                normals[v][k] += n[k];
+            }
+        }
+    }
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        compact[i].normal = encode_octahedral(normals[i]);
+    }
+
+    if (!out.colors.empty()) {
+        for (size_t i = 0; i < vertices.size(); ++i) {
+            out.colors[range.vertexOffset + i] = pack_color(vertices[i].color);
+        }
+    }
+}
+
+} // namespace
+
+CompactGeometry compact_geometry(const GeometryView& geometry, Core::JobPool* jobs) {
+    CompactGeometry out;
+    out.vertices.resize(geometry.vertices.size());
+    out.meshes.resize(geometry.meshes.size());
+    const bool colored = std::any_of(geometry.vertices.begin(), geometry.vertices.end(),
+        [](const MeshVertex& vertex) { return pack_color(vertex.color) != White; });
+    if (colored) {
+        out.colors.resize(geometry.vertices.size(), White);
+    }
+
+    if (jobs && geometry.meshes.size() > 1) {
+        Core::JobPool::JobCounter counter { 0 };
+        for (size_t i = 0; i < geometry.meshes.size(); ++i) {
+            jobs->kickJob([&, i] { compact_mesh(geometry, i, out); }, &counter);
+        }
+        jobs->waitForCounter(&counter);
+    } else {
+        for (size_t i = 0; i < geometry.meshes.size(); ++i) {
+            compact_mesh(geometry, i, out);
+        }
+    }
+    return out;
+}
+
+U16 f32_to_f16(F32 value) {
+    U32 bits = std::bit_cast<U32>(value);
+    const U32 sign = bits & 0x80000000u;
+    bits ^= sign;
+
+    U32 half;
+    if (bits >= F16Overflow) {
+        half = bits > F32Infinity ? 0x7E00 : 0x7C00;
+    } else if (bits < F16MinNormal) {
+        // the addition shifts the mantissa down and rounds it in hardware
+        half = std::bit_cast<U32>(
+                   std::bit_cast<F32>(bits) + std::bit_cast<F32>(F16SubnormalMagic))
+            - F16SubnormalMagic;
+    } else {
+        // a carry out of the mantissa moves the exponent up, up to infinity
+        half = (bits + F16Rebias + ((bits >> 13) & 1)) >> 13;
+    }
+    return static_cast<U16>(half | (sign >> 16));
+}
+
+F32 f16_to_f32(U16 value) {
+    const U32 sign = U32(value & 0x8000) << 16;
+    const U32 exponent = (value >> 10) & 0x1F;
+    const U32 mantissa = value & 0x3FF;
+
+    F32 magnitude;
+    if (exponent == 0) {
+        magnitude = std::ldexp(F32(mantissa), -24);
+    } else if (exponent == 0x1F) {
+        magnitude = mantissa != 0 ? NAN : INFINITY;
+    } else {
+        magnitude = std::bit_cast<F32>(((exponent + 112) << 23) | (mantissa << 13));
+    }
+    return std::bit_cast<F32>(std::bit_cast<U32>(magnitude) | sign);
+}
+
+void f32_to_f16(std::span<const F32> in, std::span<U16> out) {
+    size_t i = 0;
+#if defined(VGE_QUANTIZE_SSE2)
+    for (; i + 4 <= in.size(); i += 4) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(out.data() + i),
+            pack_u16(f32_to_f16_sse2(_mm_loadu_ps(in.data() + i))));
+    }
+#endif
+    for (; i < in.size(); ++i) {
+        out[i] = f32_to_f16(in[i]);
+    }
+}
+
+std::array<I16, 2> encode_octahedral(const std::array<F32, 3>& normal) {
+    const F32 length = std::abs(normal[0]) + std::abs(normal[1]) + std::abs(normal[2]);
+    if (length <= 0.0f) {
+        return { 0, 0 }; // +z
+    }
+    F32 x = normal[0] / length;
+    F32 y = normal[1] / length;
+    // the lower half folds over the diagonals onto the corners
+    if (normal[2] < 0.0f) {
+        const F32 foldedX = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        y = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = foldedX;
+    }
+    auto snorm = [](F32 v) {
+        return static_cast<I16>(std::lround(std::clamp(v, -1.0f, 1.0f) * 32767.0f));
+    };
+    return { snorm(x), snorm(y) };
+}
+
+std::array<F32, 3> decode_octahedral(const std::array<I16, 2>& encoded) {
+    F32 x = std::max(F32(encoded[0]) / 32767.0f, -1.0f);
+    F32 y = std::max(F32(encoded[1]) / 32767.0f, -1.0f);
+    const F32 z = 1.0f - std::abs(x) - std::abs(y);
+    const F32 fold = std::max(-z, 0.0f);
+    x += x >= 0.0f ? -fold : fold;
+    y += y >= 0.0f ? -fold : fold;
+    const Vec3 n { x, y, z };
+    const F32 length = std::sqrt(dot(n, n));
+    return { x / length, y / length, z / length };
+}
+
+} // namespace Resource
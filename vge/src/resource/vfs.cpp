@@ -0,0 +1,141 @@
+#include "resource/vfs.hpp"
+
+#include "core/logger.hpp"
+
+namespace Resource {
+
+static std::string normalize_mount_point(std::string_view mountPoint) {
+    std::string point = normalize_asset_path(mountPoint);
+    if (point == ".") {
+        point.clear();
+    }
+    while (!point.empty() && point.back() == '/') {
+        point.pop_back();
+    }
+    return point;
+}
+
+bool Vfs::mount_directory(std::string_view mountPoint, const fs::path& directory) {
+    std::error_code error;
+    if (!fs::is_directory(directory, error)) {
+        CORE_LOG_WARN("[Vfs]: Cannot mount {}, not a directory", directory.string());
+        return false;
+    }
+    m_Mounts.push_back({ normalize_mount_point(mountPoint), directory, nullptr });
+    CORE_LOG_INFO("[Vfs]: Mounted {} at /{}", directory.string(), m_Mounts.back().point);
+    return true;
+}
+
+bool Vfs::mount_pack(std::string_view mountPoint, const fs::path& pack) {
+    auto file = std::make_unique<PackFile>();
+    if (!file->open(pack)) {
+        CORE_LOG_ERROR("[Vfs]: {} is missing or not a valid .vgepak", pack.string());
+        return false;
+    }
+    const size_t entries = file->entries().size();
+    m_Mounts.push_back({ normalize_mount_point(mountPoint), pack, std::move(file) });
+    CORE_LOG_INFO(
+        "[Vfs]: Mounted {} ({} files) at /{}", pack.string(), entries, m_Mounts.back().point);
+    return true;
+}
+
+VfsFile Vfs::open(const fs::path& path) const {
+    if (path.is_absolute()) {
+        return VfsFile::map(path);
+    }
+
+    const std::string normalized = normalize_asset_path(path);
+    std::string relative;
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); ++mount) {
+        if (!relative_to(*mount, normalized, relative)) {
+            continue;
+        }
+        if (mount->pack) {
+            if (auto bytes = mount->pack->find(relative)) {
+                return VfsFile::view(*bytes);
+            }
+        } else if (VfsFile file = VfsFile::map(mount->directory / relative); file.is_open()) {
+            return file;
+        }
+    }
+
+    // relative to the working directory, as without a Vfs
+    return VfsFile::map(path);
+}
+
+bool Vfs::exists(const fs::path& path) const {
+    if (!resolve(path).empty()) {
+        return true;
+    }
+    const std::string normalized = normalize_asset_path(path);
+    std::string relative;
+    for (const Mount& mount : m_Mounts) {
+        if (mount.pack && relative_to(mount, normalized, relative) && mount.pack->find(relative)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+fs::path Vfs::resolve(const fs::path& path) const {
+    std::error_code error;
+    if (path.is_absolute()) {
+        return fs::is_regular_file(path, error) ? path : fs::path();
+    }
+
+    const std::string normalized = normalize_asset_path(path);
+    std::string relative;
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); ++mount) {
+        if (!relative_to(*mount, normalized, relative)) {
+            continue;
+        }
+        if (mount->pack) {
+            if (mount->pack->find(relative)) {
+                return {}; // shadows loose files mounted before it
+            }
+        } else if (fs::is_regular_file(mount->directory / relative, error)) {
+            return mount->directory / relative;
+        }
+    }
+    return fs::is_regular_file(path, error) ? path : fs::path();
+}
+
+std::vector<fs::path> Vfs::directories() const {
+    std::vector<fs::path> directories;
+    for (const Mount& mount : m_Mounts) {
+        if (!mount.pack) {
+            directories.push_back(mount.directory);
+        }
+    }
+    return directories;
+}
+
+std::string Vfs::virtual_path(const fs::path& hostPath) const {
+    for (auto mount = m_Mounts.rbegin(); mount != m_Mounts.rend(); ++mount) {
+        if (mount->pack) {
+            continue;
+        }
+        const fs::path relative = hostPath.lexically_normal().lexically_relative(
+            mount->directory.lexically_normal());
+        if (relative.empty() || relative == "." || *relative.begin() == "..") {
+            continue;
+        }
+        return normalize_asset_path(mount->point.empty() ? relative : fs::path(mount->point) / relative);
+    }
+    return {};
+}
+
+bool Vfs::relative_to(const Mount& mount, const std::string& path, std::string& relative) {
+    if (mount.point.empty()) {
+        relative = path;
+        return true;
+    }
+    if (path.size() <= mount.point.size() || !path.starts_with(mount.point)
+        || path[mount.point.size()] != '/') {
+        return false;
+    }
+    relative = path.substr(mount.point.size() + 1);
+    return true;
+}
+
+} // namespace Resource